@@ -0,0 +1,228 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+
+#include "testsupport.h"
+#include <xscontroller/columnardatalogger.h>
+#include <xscontroller/columnarlogreader.h>
+#include <xscontroller/mtbdatalogger.h>
+#include <xscontroller/protocolhandler.h>
+#include <xstypes/xsdatapacket.h>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#ifdef __linux__
+	#include <sys/resource.h>
+#endif
+
+/*! \file
+	\brief Write CPU time, file size and read throughput of ColumnarDataLogger compared to MtbDataLogger
+	\details The messages are synthetic 400 Hz MtData2 messages with a packet counter, sample time, quaternion and
+	noisy float accelerations and rates of turn. The write CPU time includes the background thread of the columnar
+	logger. The .mtb file is read from memory with ProtocolHandler, like the device does for live data.
+	Usage: bench_columnarformat [message count], the default is 200000.
+*/
+
+namespace
+{
+//! \returns The CPU time used by the process in seconds
+double cpuTime()
+{
+#ifdef __linux__
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+#else
+	return 0;
+#endif
+}
+
+//! \returns The time since \a start in seconds
+double since(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+//! \returns The size of file \a name in bytes
+long fileSize(char const* name)
+{
+	FILE* f = fopen(name, "rb");
+	if (!f)
+		return 0;
+	fseek(f, 0, SEEK_END);
+	long size = ftell(f);
+	fclose(f);
+	return size;
+}
+
+//! \brief Append item \a id with the big endian floats \a values to \a payload
+void appendFloats(std::vector<uint8_t>& payload, uint16_t id, float const* values, int count)
+{
+	payload.push_back((uint8_t)(id >> 8));
+	payload.push_back((uint8_t) id);
+	payload.push_back((uint8_t)(4 * count));
+	for (int i = 0; i < count; ++i)
+	{
+		uint32_t bits;
+		memcpy(&bits, &values[i], 4);
+		for (int b = 3; b >= 0; --b)
+			payload.push_back((uint8_t)(bits >> (8 * b)));
+	}
+}
+
+//! \brief Returns \a count synthetic MtData2 messages
+std::vector<XsMessage> makeMessages(XsSize count)
+{
+	std::mt19937 rng(1);
+	std::normal_distribution<float> noise(0.0f, 0.02f);
+	std::vector<XsMessage> messages;
+	messages.reserve(count);
+	for (XsSize i = 0; i < count; ++i)
+	{
+		std::vector<uint8_t> payload;
+		uint16_t counter = (uint16_t) i;
+		uint32_t stf = (uint32_t)(i * 25);
+		uint8_t header[] = {
+			0x10, 0x20, 2, (uint8_t)(counter >> 8), (uint8_t) counter,
+			0x10, 0x60, 4, (uint8_t)(stf >> 24), (uint8_t)(stf >> 16), (uint8_t)(stf >> 8), (uint8_t) stf
+		};
+		payload.insert(payload.end(), header, header + sizeof(header));
+
+		float angle = 0.001f * (float) i;
+		float quat[4] = { std::cos(angle), 0.0f, 0.0f, std::sin(angle) };
+		float acc[3] = { noise(rng), noise(rng), 9.81f + noise(rng) };
+		float gyr[3] = { noise(rng), noise(rng), 0.4f + noise(rng) };
+		appendFloats(payload, XDI_Quaternion, quat, 4);
+		appendFloats(payload, XDI_Acceleration, acc, 3);
+		appendFloats(payload, XDI_RateOfTurn, gyr, 3);
+
+		XsMessage msg(XMID_MtData2, payload.size());
+		msg.setDataBuffer(payload.data(), payload.size(), 0);
+		messages.push_back(msg);
+	}
+	return messages;
+}
+
+//! \brief Write \a messages with \a logger, which must have been created, and report the cost
+template <typename Logger>
+void measureWrite(char const* name, Logger& logger, std::vector<XsMessage> const& messages, char const* filename)
+{
+	double cpu = cpuTime();
+	auto start = std::chrono::steady_clock::now();
+	for (auto const& msg : messages)
+		logger.writeMessage(msg);
+	logger.close();
+	double wall = since(start);
+	cpu = cpuTime() - cpu;
+	long size = fileSize(filename);
+	printf("write %-8s %6.2f us CPU, %6.2f us wall per message, %8.1f kB, %5.1f bytes per message\n",
+		name, 1e6 * cpu / messages.size(), 1e6 * wall / messages.size(), size / 1024.0, (double) size / messages.size());
+}
+
+//! \brief Report the throughput of reading \a count items in \a seconds
+void reportRead(char const* name, XsSize count, double seconds)
+{
+	printf("read %-24s %6.2f us per message, %8.0f messages/s, %u messages\n", name, 1e6 * seconds / count, count / seconds, (unsigned) count);
+}
+}
+
+int main(int argc, char* argv[])
+{
+	XsSize count = argc > 1 ? (XsSize) atol(argv[1]) : 200000;
+	char const* columnarName = "bench_columnarformat.xcl";
+	char const* mtbName = "bench_columnarformat.mtb";
+	std::vector<XsMessage> messages = makeMessages(count);
+
+	{
+		ColumnarDataLogger logger;
+		logger.create(XsString(columnarName));
+		measureWrite("columnar", logger, messages, columnarName);
+	}
+	{
+		MtbDataLogger logger;
+		logger.create(XsString(mtbName));
+		measureWrite(".mtb", logger, messages, mtbName);
+	}
+	printf("compression ratio %.2f\n", (double) fileSize(mtbName) / (double) fileSize(columnarName));
+
+	XsMessage msg;
+	XsDataPacket packet;
+	{
+		ColumnarLogReader reader;
+		reader.open(XsString(columnarName));
+		auto start = std::chrono::steady_clock::now();
+		XsSize n = 0;
+		while (reader.readMessage(msg))
+			++n;
+		reportRead("columnar XsMessage", n, since(start));
+
+		reader.seek(0);
+		start = std::chrono::steady_clock::now();
+		n = 0;
+		while (reader.readDataPacket(packet))
+			++n;
+		reportRead("columnar XsDataPacket", n, since(start));
+	}
+	{
+		XsByteArray data((XsSize) fileSize(mtbName));
+		FILE* f = fopen(mtbName, "rb");
+		if (!f || fread(data.data(), 1, data.size(), f) != data.size())
+			return 1;
+		fclose(f);
+
+		ProtocolHandler handler;
+		for (int toPacket = 0; toPacket < 2; ++toPacket)
+		{
+			auto start = std::chrono::steady_clock::now();
+			XsSize offset = 0, n = 0;
+			while (offset < data.size())
+			{
+				XsByteArray rest(data.data() + offset, data.size() - offset, XSDF_None);
+				MessageLocation location = handler.findMessage(rest);
+				if (location.m_startPos < 0 || location.m_size <= 0)
+					break;
+				msg = handler.convertToMessage(location, rest);
+				if (toPacket)
+					packet.setMessage(msg);
+				offset += (XsSize)(location.m_startPos + location.m_size);
+				++n;
+			}
+			reportRead(toPacket ? ".mtb XsDataPacket" : ".mtb XsMessage", n, since(start));
+		}
+	}
+
+	remove(columnarName);
+	remove(mtbName);
+	return 0;
+}
@@ -0,0 +1,160 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+
+#include "testsupport.h"
+#include <xstypes/xsdatapacket.h>
+#include <atomic>
+#include <chrono>
+#include <errno.h>
+#include <stdlib.h>
+
+/*! \file
+	\brief Per-field access cost of XsDataPacket
+	\details Compares the XsVector returning accessors, as XsensReader::readPacket uses them, with getValues into
+	fixed-size arrays, vector3() and the multi-get for 2 and 5 items. The packet holds the items of a typical
+	orientation tracker. Reported are the time and heap allocations per retrieved field.
+	Usage: bench_datapacketaccess [packets per measurement], the default is 1000000.
+*/
+
+namespace
+{
+std::atomic<uint64_t> g_allocations(0);
+}
+
+// count the heap allocations, operator new uses malloc and XsVector uses posix_memalign
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+extern "C" void* __libc_memalign(size_t alignment, size_t size);
+
+extern "C" void* malloc(size_t size)
+{
+	g_allocations.fetch_add(1, std::memory_order_relaxed);
+	return __libc_malloc(size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size)
+{
+	g_allocations.fetch_add(1, std::memory_order_relaxed);
+	return __libc_realloc(ptr, size);
+}
+
+extern "C" int posix_memalign(void** ptr, size_t alignment, size_t size)
+{
+	g_allocations.fetch_add(1, std::memory_order_relaxed);
+	*ptr = __libc_memalign(alignment, size);
+	return *ptr ? 0 : ENOMEM;
+}
+
+namespace
+{
+volatile double g_sink;
+
+/*! \brief Run \a op \a count times, where each run retrieves \a fields fields, and report the cost per field */
+template <typename Op>
+void measure(char const* name, int fields, int count, Op op)
+{
+	uint64_t allocations = g_allocations.load();
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < count; ++i)
+		op();
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	allocations = g_allocations.load() - allocations;
+	double perField = (double) count * fields;
+	printf("%-34s %7.1f ns per field, %5.2f allocations per field\n",
+		name, 1e9 * elapsed / perField, (double) allocations / perField);
+}
+}
+
+int main(int argc, char* argv[])
+{
+	int count = argc > 1 ? atoi(argv[1]) : 1000000;
+
+	XsDataPacket pack;
+	pack.setPacketCounter(0);
+	pack.setSampleTimeFine(0);
+	pack.setOrientationQuaternion(XsQuaternion(1.0, 0.0, 0.0, 0.0), XDI_CoordSysEnu);
+	pack.setCalibratedAcceleration(XsVector3(0.0, 0.0, 9.81));
+	pack.setCalibratedGyroscopeData(XsVector3(0.0, 0.1, 0.0));
+	pack.setCalibratedMagneticField(XsVector3(0.5, 0.0, 0.2));
+	pack.setStatus(0);
+
+	measure("calibratedAcceleration()", 1, count, [&]()
+	{
+		g_sink = pack.calibratedAcceleration()[2];
+	});
+	measure("calibratedAcc+Gyr() (readPacket)", 2, count, [&]()
+	{
+		XsVector acc = pack.calibratedAcceleration();
+		XsVector gyr = pack.calibratedGyroscopeData();
+		g_sink = acc[2] + gyr[1];
+	});
+	measure("getValues(id, float[3])", 1, count, [&]()
+	{
+		float acc[3];
+		pack.getValues(XDI_Acceleration, acc);
+		g_sink = acc[2];
+	});
+	measure("getValues(id, double[3])", 1, count, [&]()
+	{
+		double acc[3];
+		pack.getValues(XDI_Acceleration, acc);
+		g_sink = acc[2];
+	});
+	measure("vector3(id)", 1, count, [&]()
+	{
+		g_sink = pack.vector3(XDI_Acceleration)[2];
+	});
+
+	double acc[3], gyr[3], mag[3], quat[4], status[1];
+	XsDataPacketValueRequest two[] = {
+		XsDataPacketValueRequest(XDI_Acceleration, acc, 3),
+		XsDataPacketValueRequest(XDI_RateOfTurn, gyr, 3)
+	};
+	measure("getValues(requests) 2 items", 2, count, [&]()
+	{
+		pack.getValues(two, 2);
+		g_sink = acc[2] + gyr[1];
+	});
+	XsDataPacketValueRequest five[] = {
+		XsDataPacketValueRequest(XDI_Acceleration, acc, 3),
+		XsDataPacketValueRequest(XDI_RateOfTurn, gyr, 3),
+		XsDataPacketValueRequest(XDI_MagneticField, mag, 3),
+		XsDataPacketValueRequest(XDI_Quaternion, quat, 4),
+		XsDataPacketValueRequest(XDI_StatusWord, status, 1)
+	};
+	measure("getValues(requests) 5 items", 5, count, [&]()
+	{
+		pack.getValues(five, 5);
+		g_sink = acc[2] + gyr[1] + mag[0] + quat[0] + status[0];
+	});
+	return 0;
+}
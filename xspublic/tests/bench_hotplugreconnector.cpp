@@ -0,0 +1,178 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+
+#include "testsupport.h"
+#include <xscontroller/hotplugreconnector.h>
+#include <xscontroller/mtbdatalogger.h>
+#include <xscontroller/xscontrol_def.h>
+#include <xscontroller/xsdevice_def.h>
+#include <xscontroller/xsdeviceconfiguration.h>
+#include <xscommon/journaller.h>
+#include <atomic>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <unistd.h>
+
+/*! \file
+	\brief Time that HotplugReconnector needs to hand a returning device to its worker thread
+	\details A device is opened from a generated mtb file and its connection loss and return are simulated. The
+	reconnect is replaced by a wait of a fixed duration, since reopening a real USB device is not possible here. For
+	each duration the benchmark reports how long handleEvent() blocks its caller (the udev monitor thread), the
+	time from the add event until the worker starts the reconnect and lastReconnectTime(), which includes the
+	simulated reconnect.
+	Usage: bench_hotplugreconnector [iterations], the default is 200 per duration.
+	The library is linked with the journaller, which is not used here, so its entry points are stubbed.
+*/
+
+AbstractAdditionalLogger* Journaller::m_additionalLogger = nullptr;
+void Journaller::log(JournalLogLevel, const std::string&) {}
+
+namespace
+{
+const uint32_t deviceId = 0x03630001;
+
+//! \brief Write a file \a name with a configuration message for an MTi-630
+bool writeFile(char const* name)
+{
+	MtbDataLogger logger;
+	if (!logger.create(XsString(name)))
+		return false;
+
+	XsDeviceConfiguration config(1);
+	config.masterInfo().m_masterDeviceId = deviceId;
+	config.masterInfo().m_samplingPeriod = 1152;
+	strcpy((char*) config.masterInfo().m_productCode, "MTi-630");
+	config.deviceInfo(XS_BID_MASTER).m_deviceId = deviceId;
+	config.deviceInfo(XS_BID_MASTER).m_fwRevMajor = 1;
+	XsMessage configMsg(XMID_Configuration);
+	config.writeToMessage(configMsg);
+	bool ok = logger.writeMessage(configMsg);
+	logger.close();
+	return ok;
+}
+
+//! \brief A reconnector whose reconnect records when it started and then waits m_durationMs
+class BenchReconnector : public HotplugReconnector
+{
+public:
+	BenchReconnector(XsControl* control)
+		: HotplugReconnector(control)
+		, m_calls(0)
+		, m_durationMs(0)
+		, m_startUs(0)
+	{
+	}
+
+	//! \brief Simulate the connection loss of \a dev as reported by its data poller
+	void disconnect(XsDevice* dev)
+	{
+		onConnectivityChanged(dev, XCS_Disconnected);
+	}
+
+	std::atomic<int> m_calls;
+	uint32_t m_durationMs;
+	std::atomic<int64_t> m_startUs;
+
+protected:
+	bool reconnect(LostDevice const&, XsPortInfo const&) override
+	{
+		m_startUs.store(XsTime_monotonicUs());
+		if (m_durationMs)
+			XsTime_msleep(m_durationMs);
+		++m_calls;
+		return true;
+	}
+};
+
+//! \brief Measure \a iterations simulated reconnects of \a dev that take \a durationMs each
+void measure(XsControl* control, XsDevice* dev, uint32_t durationMs, int iterations)
+{
+	BenchReconnector reconnector(control);
+	reconnector.m_durationMs = durationMs;
+	reconnector.start(false);
+
+	std::vector<int64_t> blocked, dispatch, total;
+	for (int i = 0; i < iterations; ++i)
+	{
+		reconnector.disconnect(dev);
+
+		HotplugEvent event;
+		event.m_action = HPA_Added;
+		event.m_portInfo.setPortName("/dev/ttyUSB0");
+		event.m_portInfo.setDeviceId(XsDeviceId(deviceId));
+		event.m_timeUs = XsTime_monotonicUs();
+		reconnector.handleEvent(event);
+		blocked.push_back(XsTime_monotonicUs() - event.m_timeUs);
+
+		while (reconnector.m_calls <= i)
+			XsTime_msleep(0);
+		// the statistics are updated after reconnect() returned
+		while ((int) reconnector.reconnectCount() <= i)
+			XsTime_msleep(0);
+		dispatch.push_back(reconnector.m_startUs.load() - event.m_timeUs);
+		total.push_back(reconnector.lastReconnectTime());
+	}
+	reconnector.stop();
+
+	printf("reconnect %4u ms: handleEvent p50 %6lld us p99 %6lld us, dispatch p50 %6lld us p99 %6lld us, "
+		"lastReconnectTime p50 %8lld us\n", durationMs,
+		(long long) percentile(blocked, 50), (long long) percentile(blocked, 99),
+		(long long) percentile(dispatch, 50), (long long) percentile(dispatch, 99),
+		(long long) percentile(total, 50));
+}
+}
+
+int main(int argc, char** argv)
+{
+	int iterations = argc > 1 ? atoi(argv[1]) : 200;
+
+	char name[64];
+	snprintf(name, sizeof(name), "/tmp/bench_hotplugreconnector_%d.mtb", (int) getpid());
+	XsControl* control = XsControl::construct();
+	XsDevice* dev = nullptr;
+	if (writeFile(name) && control->openLogFile(XsString(name)) && !control->mainDeviceIds().empty())
+		dev = control->device(control->mainDeviceIds()[0]);
+
+	if (dev)
+	{
+		measure(control, dev, 0, iterations);
+		measure(control, dev, 5, iterations);
+		measure(control, dev, 100, iterations / 10 + 1);
+	}
+	else
+		printf("bench_hotplugreconnector: could not open the log file\n");
+
+	control->destruct();
+	remove(name);
+	return 0;
+}
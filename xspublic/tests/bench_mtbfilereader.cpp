@@ -0,0 +1,271 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+#include "testsupport.h"
+#include <xscontroller/mtbfilereader.h>
+#include <xscontroller/mtbdatalogger.h>
+#include <xscontroller/xscontrol_def.h>
+#include <xscontroller/xsdevice_def.h>
+#include <xscontroller/xsdeviceconfiguration.h>
+#include <xscontroller/xscallback.h>
+#include <xscommon/journaller.h>
+#include <xstypes/xsdatapacket.h>
+#include <chrono>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#ifdef __linux__
+	#include <unistd.h>
+#endif
+
+/*! \file
+	\brief Throughput and memory use of MtbFileReader compared to XsControl::openLogFile and XsDevice::loadLogFile
+	\details A synthetic mtb file with a configuration message and 400 Hz MtData2 messages is written first. The
+	reader is measured pulling raw frames, XsMessages and XsDataPackets, the device is measured loading the file
+	with the default options and with XSO_RetainBufferedData, which keeps every packet in the device. The resident
+	memory is sampled after each pass, so the growth of the loadLogFile passes remains visible. The device delivers its packets through
+	XsCallback::onDataAvailable in the later ones.
+	Usage: bench_mtbfilereader [packet count], the default is 1000000 (about 90 MB), use 30000000 or more for a
+	multi-GB file.
+	The library is linked with the journaller, which is not used here, so its entry points are stubbed.
+*/
+
+AbstractAdditionalLogger* Journaller::m_additionalLogger = nullptr;
+void Journaller::log(JournalLogLevel, const std::string&) {}
+
+namespace
+{
+//! \returns The time since \a start in seconds
+double since(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+//! \returns The resident memory of the process in MB
+double residentMB()
+{
+#ifdef __linux__
+	long pages = 0, resident = 0;
+	FILE* f = fopen("/proc/self/statm", "r");
+	if (f)
+	{
+		if (fscanf(f, "%ld %ld", &pages, &resident) != 2)
+			resident = 0;
+		fclose(f);
+	}
+	return resident * (double) sysconf(_SC_PAGESIZE) / (1024.0 * 1024.0);
+#else
+	return 0;
+#endif
+}
+
+//! \returns The size of file \a name in bytes
+double fileSize(char const* name)
+{
+	FILE* f = fopen(name, "rb");
+	if (!f)
+		return 0;
+	fseek(f, 0, SEEK_END);
+	double size = (double) ftell(f);
+	fclose(f);
+	return size;
+}
+
+//! \brief Append item \a id with the big endian floats \a values to \a payload
+void appendFloats(std::vector<uint8_t>& payload, uint16_t id, float const* values, int count)
+{
+	payload.push_back((uint8_t)(id >> 8));
+	payload.push_back((uint8_t) id);
+	payload.push_back((uint8_t)(4 * count));
+	for (int i = 0; i < count; ++i)
+	{
+		uint32_t bits;
+		memcpy(&bits, &values[i], 4);
+		for (int b = 3; b >= 0; --b)
+			payload.push_back((uint8_t)(bits >> (8 * b)));
+	}
+}
+
+//! \returns An MtData2 message with a packet counter, sample time, quaternion, acceleration and rate of turn
+XsMessage makeMessage(XsSize index)
+{
+	uint16_t counter = (uint16_t) index;
+	uint32_t stf = (uint32_t)(index * 25);
+	std::vector<uint8_t> payload = {
+		0x10, 0x20, 2, (uint8_t)(counter >> 8), (uint8_t) counter,
+		0x10, 0x60, 4, (uint8_t)(stf >> 24), (uint8_t)(stf >> 16), (uint8_t)(stf >> 8), (uint8_t) stf
+	};
+	float quat[4] = { 1.0f, 0.0f, 0.0f, 0.0f };
+	float acc[3] = { 0.01f, -0.02f, 9.81f };
+	float gyr[3] = { 0.001f, 0.002f, (float) index };
+	appendFloats(payload, XDI_Quaternion, quat, 4);
+	appendFloats(payload, XDI_Acceleration, acc, 3);
+	appendFloats(payload, XDI_RateOfTurn, gyr, 3);
+
+	XsMessage msg(XMID_MtData2, payload.size());
+	msg.setDataBuffer(payload.data(), payload.size(), 0);
+	return msg;
+}
+
+//! \brief Write a file \a name with a configuration message for an MTi-630 and \a count data messages
+bool writeFile(char const* name, XsSize count)
+{
+	MtbDataLogger logger;
+	if (!logger.create(XsString(name)))
+		return false;
+
+	XsDeviceConfiguration config(1);
+	const uint64_t deviceId = 0x03630001;
+	config.masterInfo().m_masterDeviceId = deviceId;
+	config.masterInfo().m_samplingPeriod = 1152;
+	config.masterInfo().m_outputSkipFactor = 0;
+	strcpy((char*) config.masterInfo().m_productCode, "MTi-630");
+	config.deviceInfo(XS_BID_MASTER).m_deviceId = deviceId;
+	config.deviceInfo(XS_BID_MASTER).m_fwRevMajor = 1;
+	XsMessage configMsg(XMID_Configuration);
+	config.writeToMessage(configMsg);
+	if (!logger.writeMessage(configMsg))
+		return false;
+
+	XsMessage msg = makeMessage(0);
+	for (XsSize i = 0; i < count; ++i)
+	{
+		msg.setDataShort((uint16_t) i, 3);
+		msg.setDataLong((uint32_t)(i * 25), 8);
+		if (!logger.writeMessage(msg))
+			return false;
+	}
+	logger.close();
+	return true;
+}
+
+//! \brief Print the throughput and memory use of a pass over \a bytes of file data that yielded \a count packets
+void report(char const* name, XsSize count, double bytes, double seconds)
+{
+	printf("%-32s %8.3f s, %8.1f MB/s, %9.0f packets/s, %8u packets, resident %7.1f MB\n",
+		name, seconds, bytes / (1024.0 * 1024.0) / seconds, count / seconds, (unsigned) count, residentMB());
+}
+
+//! \brief Read \a name with an MtbFileReader, \a mode 0 reads frames, 1 messages and 2 data packets
+void measureReader(char const* name, double bytes, int mode)
+{
+	static char const* const names[] = { "MtbFileReader::readFrame", "MtbFileReader::readMessage", "MtbFileReader::readDataPacket" };
+	auto start = std::chrono::steady_clock::now();
+	MtbFileReader reader;
+	if (!reader.open(XsString(name)))
+	{
+		printf("%s: open failed\n", names[mode]);
+		return;
+	}
+	XsSize count = 0;
+	uint8_t const* frame;
+	XsSize frameSize;
+	XsMessage msg;
+	XsDataPacket packet;
+	switch (mode)
+	{
+		case 0:
+			while (reader.readFrame(frame, frameSize))
+				++count;
+			break;
+		case 1:
+			while (reader.readMessage(msg))
+				++count;
+			break;
+		default:
+			while (reader.readDataPacket(packet))
+				++count;
+			break;
+	}
+	report(names[mode], count, bytes, since(start));
+}
+
+//! \brief Counts the packets that a device delivers while loading a file
+class PacketCounter : public XsCallback
+{
+public:
+	PacketCounter() : m_count(0) {}
+	XsSize m_count;	//!< The number of delivered packets
+
+protected:
+	void onDataAvailable(XsDevice*, const XsDataPacket*) override
+	{
+		++m_count;
+	}
+};
+
+/*! \brief Load \a name with XsControl::openLogFile and XsDevice::loadLogFile
+	\param retain Whether XSO_RetainBufferedData is set, which keeps every packet in the device
+*/
+void measureLoadLogFile(char const* name, double bytes, bool retain)
+{
+	char const* label = retain ? "loadLogFile, retained" : "loadLogFile";
+	auto start = std::chrono::steady_clock::now();
+	XsControl* control = XsControl::construct();
+	XsDevice* device = nullptr;
+	if (control->openLogFile(XsString(name)) && control->mainDeviceCount())
+		device = control->device(control->mainDeviceIds()[0]);
+	if (!device)
+	{
+		printf("%s: open failed\n", label);
+		control->destruct();
+		return;
+	}
+	PacketCounter counter;
+	device->addCallbackHandler(&counter);
+	if (retain)
+		device->setOptions(XSO_RetainBufferedData, XSO_None);
+	device->loadLogFile();
+	device->waitForLoadLogFileDone();
+	report(label, counter.m_count, bytes, since(start));
+	device->removeCallbackHandler(&counter);
+	control->destruct();
+}
+}
+
+int main(int argc, char* argv[])
+{
+	XsSize count = argc > 1 ? (XsSize) atol(argv[1]) : 1000000;
+	char const* name = "bench_mtbfilereader.mtb";
+	if (!writeFile(name, count))
+		return 1;
+	double bytes = fileSize(name);
+	printf("%u packets, %.1f MB, resident %.1f MB before reading\n", (unsigned) count, bytes / (1024.0 * 1024.0), residentMB());
+
+	for (int mode = 0; mode < 3; ++mode)
+		measureReader(name, bytes, mode);
+	measureLoadLogFile(name, bytes, false);
+	measureLoadLogFile(name, bytes, true);
+
+	remove(name);
+	return 0;
+}
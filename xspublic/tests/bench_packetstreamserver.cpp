@@ -0,0 +1,214 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+#include "testsupport.h"
+#include <xscontroller/packetstreamserver.h>
+#include <xstypes/xstime.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+/*! \file
+	\brief Throughput and tail latency of PacketStreamServer with 10 to 100 TCP subscribers over loopback
+	\details All subscribers are read by one thread with poll(), so the number of subscribers does not change the
+	number of threads. The latency of a record is the time from publishing it to parsing it in the subscriber, over
+	all records of all subscribers. Each subscriber count is measured paced at 1 kHz and flat out, where the
+	publisher does not wait at all and records that the server thread can not accept are counted as overflow.
+	Usage: bench_packetstreamserver [flat out frame count] [paced frame count], the defaults are 50000 and 2000.
+*/
+
+namespace
+{
+//! \brief The size of the published frames, an MTi with orientation and inertial data
+const XsSize frameSize = 118;
+//! \brief The size of a record on the wire
+const XsSize recordSize = PacketStreamServer::recordHeaderSize + frameSize;
+
+//! \returns A non-blocking socket connected to the server on \a port or -1
+int connectClient(uint16_t port)
+{
+	int sd = socket(AF_INET, SOCK_STREAM, 0);
+	struct sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_port = htons(port);
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if (connect(sd, (struct sockaddr*) &address, sizeof(address)) != 0)
+	{
+		close(sd);
+		return -1;
+	}
+	fcntl(sd, F_SETFL, fcntl(sd, F_GETFL, 0) | O_NONBLOCK);
+	return sd;
+}
+
+//! \brief What the subscribers received
+struct Reception
+{
+	uint64_t m_records;				//!< The number of records received by all subscribers
+	std::vector<int64_t> m_latencies;	//!< The latency of every received record in us
+	int m_closed;					//!< The number of subscribers that were disconnected by the server
+};
+
+/*! \brief Read the subscribers \a sockets until each received \a count records, was disconnected or nothing
+	arrived for a second
+	\details \a count is lowered to the number of accepted records when publishing has finished.
+*/
+void readSubscribers(std::vector<int> const& sockets, std::atomic<uint64_t> const& count, Reception& reception)
+{
+	std::vector<struct pollfd> fds(sockets.size());
+	std::vector<std::vector<uint8_t>> buffers(sockets.size());
+	std::vector<uint64_t> received(sockets.size(), 0);
+	for (XsSize i = 0; i < sockets.size(); ++i)
+	{
+		fds[i].fd = sockets[i];
+		fds[i].events = POLLIN;
+	}
+
+	XsSize active = sockets.size();
+	uint8_t data[65536];
+	while (active)
+	{
+		for (XsSize i = 0; i < fds.size(); ++i)
+		{
+			if (fds[i].fd >= 0 && received[i] >= count)
+			{
+				fds[i].fd = -1;
+				--active;
+			}
+		}
+		if (!active || poll(fds.data(), fds.size(), 1000) <= 0)
+			break;
+		for (XsSize i = 0; i < fds.size(); ++i)
+		{
+			if (fds[i].fd < 0 || !fds[i].revents)
+				continue;
+			ssize_t size = recv(fds[i].fd, data, sizeof(data), 0);
+			if (size <= 0)
+			{
+				if (size == 0 || (errno != EAGAIN && errno != EWOULDBLOCK))
+				{
+					++reception.m_closed;
+					fds[i].fd = -1;
+					--active;
+				}
+				continue;
+			}
+
+			int64_t now = XsTime_monotonicUs();
+			std::vector<uint8_t>& buffer = buffers[i];
+			buffer.insert(buffer.end(), data, data + size);
+			XsSize offset = 0;
+			for (; offset + recordSize <= buffer.size(); offset += recordSize)
+			{
+				int64_t time = 0;
+				memcpy(&time, buffer.data() + offset + 16, 8);
+				reception.m_latencies.push_back(now - time);
+				++received[i];
+			}
+			buffer.erase(buffer.begin(), buffer.begin() + (ptrdiff_t) offset);
+		}
+	}
+	for (uint64_t r : received)
+		reception.m_records += r;
+}
+
+/*! \brief Publish \a frames frames to \a subscribers subscribers and print the results
+	\param interval The interval between frames in us, 0 publishes as fast as possible
+*/
+void measure(int subscribers, XsSize frames, int64_t interval)
+{
+	uint16_t port = (uint16_t)(40000 + getpid() % 20000);
+	PacketStreamServer server;
+	if (server.open(port) != XRV_OK)
+	{
+		printf("opening the server failed\n");
+		return;
+	}
+
+	std::vector<int> sockets;
+	for (int i = 0; i < subscribers; ++i)
+		sockets.push_back(connectClient(port));
+	for (int i = 0; i < 2000 && server.clientCount() < (XsSize) subscribers; ++i)
+		XsTime_msleep(1);
+
+	Reception reception = {};
+	reception.m_latencies.reserve(frames * subscribers);
+	std::atomic<uint64_t> count(frames);
+	std::thread reader([&]() { readSubscribers(sockets, count, reception); });
+
+	std::vector<uint8_t> frame(frameSize, 0x5A);
+	auto start = std::chrono::steady_clock::now();
+	for (XsSize i = 0; i < frames; ++i)
+	{
+		if (interval)
+			std::this_thread::sleep_until(start + std::chrono::microseconds(interval * (int64_t) i));
+		server.publish(frame.data(), frame.size(), 1, XsTime_monotonicUs());
+	}
+	count = server.publishedCount();
+	reader.join();
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	printf("%-9s %3d subscribers: %7.1f MB/s delivered, %9.0f records/s, received %5.1f%%, overflow %6u, "
+		"disconnected %3d, latency p50 %6d p99 %6d p99.9 %6d us\n",
+		interval ? "1 kHz" : "flat out", subscribers, reception.m_records * recordSize / (1024.0 * 1024.0) / seconds,
+		reception.m_records / seconds, 100.0 * reception.m_records / ((double) frames * subscribers),
+		(unsigned) server.overflowCount(), (int) server.droppedClientCount(),
+		(int) percentile(reception.m_latencies, 50), (int) percentile(reception.m_latencies, 99),
+		(int) percentile(reception.m_latencies, 99.9));
+
+	server.close();
+	for (int sd : sockets)
+		close(sd);
+}
+}
+
+int main(int argc, char* argv[])
+{
+	XsSize frames = argc > 1 ? (XsSize) atol(argv[1]) : 50000;
+	XsSize pacedFrames = argc > 2 ? (XsSize) atol(argv[2]) : 2000;
+
+	const int subscriberCounts[] = { 10, 25, 50, 100 };
+	for (int subscribers : subscriberCounts)
+		measure(subscribers, pacedFrames, 1000);
+	for (int subscribers : subscriberCounts)
+		measure(subscribers, frames, 0);
+	return 0;
+}
@@ -0,0 +1,240 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+
+#include "testsupport.h"
+#include <xscontroller/portscheduler.h>
+#include <xscommon/threading.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+/*! \file
+	\brief Scaling of the PortScheduler against the thread-per-port model with 1 to 64 simulated devices
+	\details Every simulated device is a pipe that receives an 8 byte timestamp at 400 Hz. In the thread-per-port
+	model each device has a poller thread and a parser thread, like SerialCommunicator. In the shared model the
+	PortScheduler polls and parses all devices. Reported are the CPU time, the number of context switches and the
+	latency from writing a sample to parsing it.
+	Usage: bench_portscheduler [seconds per run], the default is 2.
+*/
+
+namespace
+{
+//! \brief The interval between two samples of a device in us
+const int64_t sampleInterval = 2500;
+
+//! \brief A simulated device
+struct Device
+{
+	int m_fd[2];						//!< The pipe, the simulator writes to m_fd[1]
+	xsens::Mutex m_mutex;				//!< Guards m_pending
+	std::vector<int64_t> m_pending;		//!< Samples read by the poller, not parsed yet
+	xsens::WaitCondition m_parse;		//!< Signalled when m_pending is not empty
+	std::vector<int64_t> m_latencies;	//!< The latencies of the parsed samples in us
+
+	Device() : m_parse(m_mutex)
+	{
+		if (pipe(m_fd) == 0)
+		{
+			fcntl(m_fd[0], F_SETFL, O_NONBLOCK);
+			fcntl(m_fd[1], F_SETFL, O_NONBLOCK);
+		}
+	}
+
+	~Device()
+	{
+		close(m_fd[0]);
+		close(m_fd[1]);
+	}
+
+	/*! \brief Read the available samples into \a samples
+		\returns The poll delay in ms, like DataPoller
+	*/
+	int32_t read(std::vector<int64_t>& samples)
+	{
+		int64_t buffer[64];
+		ssize_t n = ::read(m_fd[0], buffer, sizeof(buffer));
+		if (n <= 0)
+			return 1;
+		samples.insert(samples.end(), buffer, buffer + n / (ssize_t) sizeof(int64_t));
+		return 0;
+	}
+
+	//! \brief Record the latency of \a samples
+	void parse(std::vector<int64_t> const& samples)
+	{
+		int64_t now = XsTime_monotonicUs();
+		for (int64_t t : samples)
+			m_latencies.push_back(now - t);
+	}
+};
+
+//! \brief The poller thread of a device in the thread-per-port model
+class PollerThread : public xsens::StandardThread
+{
+public:
+	explicit PollerThread(Device& device) : m_device(device) {}
+	~PollerThread() override { stopThread(); }
+
+protected:
+	int32_t innerFunction() override
+	{
+		std::vector<int64_t> samples;
+		int32_t delay = m_device.read(samples);
+		if (!samples.empty())
+		{
+			xsens::Lock lock(&m_device.m_mutex);
+			m_device.m_pending.insert(m_device.m_pending.end(), samples.begin(), samples.end());
+			m_device.m_parse.signal();
+		}
+		return delay;
+	}
+
+private:
+	Device& m_device;
+};
+
+//! \brief The parser thread of a device in the thread-per-port model
+class ParserThread : public xsens::StandardThread
+{
+public:
+	explicit ParserThread(Device& device) : m_device(device) {}
+	~ParserThread() override { stopThread(); }
+
+protected:
+	int32_t innerFunction() override
+	{
+		std::vector<int64_t> samples;
+		{
+			xsens::Lock lock(&m_device.m_mutex);
+			if (m_device.m_pending.empty())
+				m_device.m_parse.wait(10);
+			samples.swap(m_device.m_pending);
+		}
+		m_device.parse(samples);
+		return 0;
+	}
+
+private:
+	Device& m_device;
+};
+
+//! \returns The CPU time of the process in us and the number of context switches in \a switches
+int64_t cpuTime(long& switches)
+{
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	switches = usage.ru_nvcsw + usage.ru_nivcsw;
+	return (int64_t) usage.ru_utime.tv_sec * 1000000 + usage.ru_utime.tv_usec + (int64_t) usage.ru_stime.tv_sec * 1000000 + usage.ru_stime.tv_usec;
+}
+
+//! \brief Run \a count devices for \a seconds in the shared or the thread-per-port model and print the results
+void run(int count, bool shared, int seconds)
+{
+	std::vector<std::unique_ptr<Device>> devices;
+	for (int i = 0; i < count; ++i)
+		devices.emplace_back(new Device);
+
+	std::vector<std::unique_ptr<xsens::StandardThread>> threads;
+	std::vector<PortScheduler::PortId> ports;
+	for (auto& device : devices)
+	{
+		Device* dev = device.get();
+		if (shared)
+		{
+			ports.push_back(PortScheduler::instance()->addPort([dev]()
+			{
+				std::vector<int64_t> samples;
+				int32_t delay = dev->read(samples);
+				dev->parse(samples);
+				return delay;
+			}));
+		}
+		else
+		{
+			threads.emplace_back(new PollerThread(*dev));
+			threads.emplace_back(new ParserThread(*dev));
+		}
+	}
+	for (auto& thread : threads)
+		thread->startThread();
+
+	long switchesBefore, switchesAfter;
+	int64_t cpuBefore = cpuTime(switchesBefore);
+	int64_t start = XsTime_monotonicUs();
+	int64_t end = start + seconds * 1000000LL;
+	for (int64_t next = start; next < end; next += sampleInterval)
+	{
+		int64_t now = XsTime_monotonicUs();
+		if (next > now)
+			std::this_thread::sleep_for(std::chrono::microseconds(next - now));
+		for (auto& device : devices)
+		{
+			int64_t t = XsTime_monotonicUs();
+			if (write(device->m_fd[1], &t, sizeof(t)) != (ssize_t) sizeof(t))
+				break;
+		}
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	int64_t cpu = cpuTime(switchesAfter) - cpuBefore;
+
+	for (auto id : ports)
+		PortScheduler::instance()->removePort(id);
+	threads.clear();
+
+	std::vector<int64_t> latencies;
+	for (auto& device : devices)
+		latencies.insert(latencies.end(), device->m_latencies.begin(), device->m_latencies.end());
+	int64_t p50 = percentile(latencies, 50);
+	int64_t p99 = percentile(latencies, 99);
+	printf("%-15s %3d devices: cpu %5.1f%%, %7.0f switches/s, latency p50 %5lld us, p99 %6lld us, max %6lld us\n",
+		shared ? "PortScheduler" : "thread-per-port", count, 100.0 * (double) cpu / (double)(seconds * 1000000LL),
+		(double)(switchesAfter - switchesBefore) / seconds, (long long) p50, (long long) p99,
+		(long long)(latencies.empty() ? 0 : latencies.back()));
+}
+}
+
+int main(int argc, char** argv)
+{
+	int seconds = argc > 1 ? atoi(argv[1]) : 2;
+	printf("%d workers\n", PortScheduler::instance()->workerCount());
+	for (int count : {1, 4, 16, 64})
+	{
+		run(count, false, seconds);
+		run(count, true, seconds);
+	}
+	PortScheduler::destroy();
+	return 0;
+}
@@ -0,0 +1,238 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+
+#include "testsupport.h"
+#include <xscommon/threading.h>
+#include <xstypes/xsdatapacket.h>
+#include <xstypes/xsportinfo.h>
+#include <xscontroller/serialinterface.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+/*! \file
+	\brief Cyclictest-style latency of a communication thread reading a simulated device on a pseudo terminal
+	\details A simulator thread writes an MtData2 frame containing the write time to the master side of a pty at a
+	fixed rate. A StandardThread reads the slave side through SerialInterface, like the poller thread of a
+	SerialCommunicator, and parses each frame into an XsDataPacket. The latency from writing a frame to parsing it
+	is measured with the default scheduling and with the thread pinned to a processor at a SCHED_FIFO priority,
+	optionally with busy threads loading the other processors and with the memory of the process locked.
+	Usage: bench_realtime_pty [seconds per run] [cpu] [priority] [load threads], the defaults are 5 0 80 0.
+	Real-time priorities and memory locking need CAP_SYS_NICE and CAP_IPC_LOCK or suitable rlimits, the
+	benchmark reports which settings were applied.
+*/
+
+namespace
+{
+//! \brief The interval between two frames in us, 1 kHz like a fast IMU
+const int64_t frameInterval = 1000;
+
+//! \brief The time that frame timestamps are relative to in us
+int64_t g_epoch = 0;
+
+//! \returns The time since g_epoch in us
+uint32_t now()
+{
+	return (uint32_t)(XsTime_monotonicUs() - g_epoch);
+}
+
+//! \brief Returns the bytes of an MtData2 frame that contains \a time
+std::vector<uint8_t> makeFrame(uint32_t time)
+{
+	XsDataPacket pack;
+	pack.setSampleTimeFine(time);
+	XsMessage msg;
+	XsDataPacket_toMessage(&pack, &msg);
+	return std::vector<uint8_t>(msg.getMessageStart(), msg.getMessageStart() + msg.getTotalMessageSize());
+}
+
+//! \brief Reads and parses the frames of the simulated device and records their latency
+class ReaderThread : public xsens::StandardThread
+{
+public:
+	ReaderThread(SerialInterface& port, XsSize frameSize)
+		: m_port(port)
+		, m_frameSize(frameSize)
+	{
+		m_latencies.reserve(1000000);
+	}
+
+	~ReaderThread() override
+	{
+		stopThread();
+	}
+
+	std::vector<int64_t> m_latencies;		//!< The latency of each frame in us
+
+protected:
+	int32_t innerFunction() override
+	{
+		XsByteArray data;
+		if (m_port.readData(4096, data) != XRV_OK)
+			return 0;
+
+		uint32_t received = now();
+		m_buffer.insert(m_buffer.end(), data.data(), data.data() + data.size());
+		XsSize offset = 0;
+		while (m_buffer.size() - offset >= m_frameSize)
+		{
+			if (m_buffer[offset] != 0xFA)
+			{
+				++offset;
+				continue;
+			}
+			XsMessage msg(&m_buffer[offset], m_frameSize);
+			XsDataPacket pack(&msg);
+			if (pack.containsSampleTimeFine())
+				m_latencies.push_back((int64_t)(received - pack.sampleTimeFine()));
+			offset += m_frameSize;
+		}
+		m_buffer.erase(m_buffer.begin(), m_buffer.begin() + (ptrdiff_t) offset);
+		return 0;
+	}
+
+private:
+	SerialInterface& m_port;
+	XsSize m_frameSize;
+	std::vector<uint8_t> m_buffer;
+};
+
+//! \brief Describe the ThreadRealTimeResult flags in \a result
+std::string describe(int result)
+{
+	std::string rv;
+	if (result & xsens::TRR_Pinned)
+		rv += " pinned";
+	if (result & xsens::TRR_RealTime)
+		rv += " real-time";
+	if (result & xsens::TRR_Pending)
+		rv += " pending";
+	if (result & xsens::TRR_Failed)
+		rv += " failed";
+	return rv.empty() ? " none" : rv;
+}
+
+//! \brief Run the simulated device for \a seconds with \a settings and print the latency distribution
+void run(char const* name, int seconds, xsens::ThreadRealTimeSettings const& settings)
+{
+	int master = posix_openpt(O_RDWR | O_NOCTTY);
+	if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+	{
+		printf("%s: no pseudo terminal available\n", name);
+		return;
+	}
+	struct termios tio;
+	tcgetattr(master, &tio);
+	cfmakeraw(&tio);
+	tcsetattr(master, TCSANOW, &tio);
+
+	SerialInterface port;
+	if (port.open(XsPortInfo(ptsname(master), XBR_921k6)) != XRV_OK)
+	{
+		printf("%s: cannot open %s\n", name, ptsname(master));
+		close(master);
+		return;
+	}
+	port.setTimeout(100);
+
+	std::vector<uint8_t> frame = makeFrame(0);
+	ReaderThread reader(port, frame.size());
+	reader.startThread("pty reader");
+	int result = xsens::TRR_None;
+	if (settings.m_cpu >= 0 || settings.m_priority > 0)
+		result = reader.setRealTimeSettings(settings);
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+	int64_t start = XsTime_monotonicUs();
+	int64_t end = start + seconds * 1000000LL;
+	for (int64_t next = start; next < end; next += frameInterval)
+	{
+		int64_t wait = next - XsTime_monotonicUs();
+		if (wait > 0)
+			std::this_thread::sleep_for(std::chrono::microseconds(wait));
+		frame = makeFrame(now());
+		if (write(master, frame.data(), frame.size()) != (ssize_t) frame.size())
+			break;
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(200));
+	reader.stopThread();
+	port.close();
+	close(master);
+
+	std::vector<int64_t>& lat = reader.m_latencies;
+	double sum = 0;
+	for (int64_t l : lat)
+		sum += (double) l;
+	XsSize count = lat.size();
+	int64_t p50 = percentile(lat, 50);
+	int64_t p99 = percentile(lat, 99);
+	int64_t p999 = percentile(lat, 99.9);
+	printf("%-9s settings:%s\n", name, describe(result).c_str());
+	printf("%-9s frames %zu, min %lld us, avg %.0f us, p50 %lld us, p99 %lld us, p99.9 %lld us, max %lld us\n", name,
+		(size_t) count, (long long)(count ? lat.front() : 0), count ? sum / (double) count : 0.0,
+		(long long) p50, (long long) p99, (long long) p999, (long long)(count ? lat.back() : 0));
+}
+}
+
+int main(int argc, char** argv)
+{
+	int seconds = argc > 1 ? atoi(argv[1]) : 5;
+	int cpu = argc > 2 ? atoi(argv[2]) : 0;
+	int priority = argc > 3 ? atoi(argv[3]) : 80;
+	int loadThreads = argc > 4 ? atoi(argv[4]) : 0;
+	g_epoch = XsTime_monotonicUs();
+
+	std::atomic<bool> stop(false);
+	std::vector<std::thread> load;
+	for (int i = 0; i < loadThreads; ++i)
+		load.emplace_back([&stop]()
+		{
+			volatile uint64_t x = 0;
+			while (!stop.load(std::memory_order_relaxed))
+				++x;
+		});
+
+	run("default", seconds, xsens::ThreadRealTimeSettings());
+	printf("mlockall: %s\n", mlockall(MCL_CURRENT | MCL_FUTURE) == 0 ? "applied" : "failed");
+	run("realtime", seconds, xsens::ThreadRealTimeSettings(cpu, priority));
+	munlockall();
+
+	stop = true;
+	for (auto& t : load)
+		t.join();
+	return 0;
+}
@@ -0,0 +1,236 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+
+#include "testsupport.h"
+#include <xscontroller/dataparser.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <stdlib.h>
+
+/*! \file
+	\brief Throughput and allocations of the handoff of received data from the reading thread to the parser thread
+	\details Blocks of 64 bytes to 8 KiB are passed from a reading thread to a parsing thread in three ways:
+	- copy queue: the handoff that DataParser used before the receive pool, a mutex protected std::queue of
+	  XsByteArray copies that the parser appends to a local buffer before handing it to the message extractor,
+	  which appends it to its own buffer
+	- addRawData: DataParser::addRawData, which copies the data into a pooled receive buffer
+	- submit: DataParser::acquireReceiveBuffer and submitReceiveBuffer as used by DataPoller, the data is read into
+	  the pooled buffer so it is not copied at all
+	The parser only counts the bytes, so the results show the cost of the handoff itself. Reported are the bytes per
+	second and the heap allocations per second and per block.
+	Usage: bench_receivebufferpool [MiB per run], the default is 64.
+*/
+
+namespace
+{
+std::atomic<uint64_t> g_allocations(0);
+}
+
+// count the heap allocations of all threads, operator new uses malloc as well
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+
+extern "C" void* malloc(size_t size)
+{
+	g_allocations.fetch_add(1, std::memory_order_relaxed);
+	return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size)
+{
+	g_allocations.fetch_add(1, std::memory_order_relaxed);
+	return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size)
+{
+	g_allocations.fetch_add(1, std::memory_order_relaxed);
+	return __libc_realloc(ptr, size);
+}
+
+namespace
+{
+//! \brief A parser that only counts the bytes it receives
+class CountingParser : public DataParser
+{
+public:
+	std::atomic<uint64_t> m_parsed;	//!< The number of bytes parsed so far
+	bool m_pushed;					//!< When true the data is supplied through addRawData
+
+	explicit CountingParser(bool pushed) : m_parsed(0), m_pushed(pushed) {}
+	~CountingParser() override
+	{
+		terminate();
+	}
+
+	XsResultValue readDataToBuffer(XsByteArray&) override
+	{
+		return XRV_OK;
+	}
+
+	XsResultValue processBufferedData(const XsByteArray& rawIn, std::deque<XsMessage>&) override
+	{
+		m_parsed.fetch_add(rawIn.size(), std::memory_order_relaxed);
+		return XRV_OK;
+	}
+
+	void handleMessage(const XsMessage&) override {}
+
+	bool receivesPushedData() const override
+	{
+		return m_pushed;
+	}
+};
+
+/*! \brief The handoff that DataParser used before the receive pool
+	\details addRawData copies the block into the queue, the parser thread appends each queued block to a local
+	buffer and then to the buffer of the message extractor.
+*/
+class CopyQueue
+{
+public:
+	std::atomic<uint64_t> m_parsed;	//!< The number of bytes parsed so far
+
+	CopyQueue() : m_parsed(0), m_stop(false), m_thread([this]() { run(); }) {}
+	~CopyQueue()
+	{
+		m_stop = true;
+		m_event.set();
+		m_thread.join();
+	}
+
+	void addRawData(XsByteArray const& arr)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_queue.push(arr);
+		}
+		m_event.set();
+	}
+
+private:
+	//! \brief The loop of the previous DataParser::innerFunction
+	void run()
+	{
+		XsByteArray extractorBuffer;
+		while (!m_stop)
+		{
+			if (!m_event.wait())
+				break;
+
+			XsByteArray raw;
+			std::unique_lock<std::mutex> lock(m_mutex);
+			while (!m_queue.empty())
+			{
+				raw.append(m_queue.front());
+				m_queue.pop();
+				lock.unlock();
+
+				// stands in for processBufferedData, which appended the data to the buffer of the message extractor
+				extractorBuffer.append(raw);
+				m_parsed.fetch_add(raw.size(), std::memory_order_relaxed);
+				extractorBuffer.clear();
+				raw.clear();
+
+				lock.lock();
+			}
+			m_event.reset();
+		}
+	}
+
+	std::mutex m_mutex;
+	std::queue<XsByteArray> m_queue;
+	xsens::WaitEvent m_event;
+	std::atomic<bool> m_stop;
+	std::thread m_thread;
+};
+
+void report(char const* name, XsSize blockSize, uint64_t bytes, double elapsed, uint64_t allocations)
+{
+	uint64_t blocks = bytes / blockSize;
+	printf("%-11s block %5u: %8.1f MiB/s, %10.0f allocations/s, %5.2f allocations per block\n",
+		name, (unsigned) blockSize, bytes / elapsed / (1 << 20), allocations / elapsed, (double) allocations / blocks);
+}
+
+template <typename Consumer, typename Push>
+void run(char const* name, Consumer& consumer, Push push, XsSize blockSize, uint64_t total)
+{
+	uint64_t blocks = total / blockSize;
+	uint64_t allocations = g_allocations.load();
+	auto start = std::chrono::steady_clock::now();
+	for (uint64_t i = 0; i < blocks; ++i)
+		push();
+	while (consumer.m_parsed.load() < blocks * blockSize)
+		std::this_thread::yield();
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	report(name, blockSize, blocks * blockSize, elapsed, g_allocations.load() - allocations);
+}
+}
+
+int main(int argc, char* argv[])
+{
+	uint64_t total = (uint64_t) (argc > 1 ? atoi(argv[1]) : 64) << 20;
+	XsSize blockSizes[] = { 64, 512, 4096, 8192 };
+
+	for (XsSize blockSize : blockSizes)
+	{
+		XsByteArray block(blockSize, nullptr);
+		for (XsSize i = 0; i < blockSize; ++i)
+			block[i] = (uint8_t) i;
+
+		{
+			CopyQueue queue;
+			run("copy queue", queue, [&]() { queue.addRawData(block); }, blockSize, total);
+		}
+		{
+			CountingParser parser(true);
+			run("addRawData", parser, [&]() { parser.addRawData(block); }, blockSize, total);
+		}
+		{
+			CountingParser parser(false);
+			run("submit", parser, [&]()
+			{
+				ReceiveBuffer* buffer;
+				while ((buffer = parser.acquireReceiveBuffer()) == nullptr)
+					std::this_thread::yield();
+				// stands in for reading from the device into the buffer
+				buffer->m_data.assign(blockSize, block.data());
+				parser.submitReceiveBuffer(buffer);
+			}, blockSize, total);
+		}
+	}
+	return 0;
+}
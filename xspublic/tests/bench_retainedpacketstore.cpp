@@ -0,0 +1,152 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+
+#include "testsupport.h"
+#include <xscontroller/retainedpacketstore.h>
+#include <chrono>
+#include <random>
+#include <stdlib.h>
+#ifdef __linux__
+	#include <unistd.h>
+#endif
+
+/*! \file
+	\brief Memory usage and lookup latency of RetainedPacketStore during a long synthetic session
+	\details Usage: bench_retainedpacketstore [packet count], the default is 2 million packets, a bit more than
+	5 hours at 100 Hz. Packets are appended with their source message, as XsDevice does for live data.
+*/
+
+namespace
+{
+//! \returns The resident set size of the process in bytes or 0 when unknown
+XsSize residentSize()
+{
+#ifdef __linux__
+	FILE* f = fopen("/proc/self/statm", "r");
+	if (!f)
+		return 0;
+	unsigned long pages = 0, resident = 0;
+	int n = fscanf(f, "%lu %lu", &pages, &resident);
+	fclose(f);
+	return n == 2 ? (XsSize) resident * (XsSize) sysconf(_SC_PAGESIZE) : 0;
+#else
+	return 0;
+#endif
+}
+
+//! \brief Returns a packet with the items of a typical orientation tracker
+XsDataPacket makePacket()
+{
+	XsDataPacket pack;
+	pack.setPacketCounter(0);
+	pack.setSampleTimeFine(0);
+	pack.setOrientationQuaternion(XsQuaternion(1.0, 0.0, 0.0, 0.0), XDI_CoordSysEnu);
+	pack.setCalibratedAcceleration(XsVector3(0.0, 0.0, 9.81));
+	pack.setCalibratedGyroscopeData(XsVector3(0.0, 0.1, 0.0));
+	pack.setCalibratedMagneticField(XsVector3(0.5, 0.0, 0.2));
+	pack.setStatus(0);
+	return pack;
+}
+
+/*! \brief Returns the average time in ns of appending \a count packets to \a store, with or without source message
+	\details Only the packet id changes between packets, the payload does not affect the store.
+*/
+double appendPackets(RetainedPacketStore& store, XsSize count, bool withSource)
+{
+	XsDataPacket pack = makePacket();
+	XsMessage msg;
+	XsDataPacket_toMessage(&pack, &msg);
+
+	auto start = std::chrono::steady_clock::now();
+	for (XsSize i = 0; i < count; ++i)
+	{
+		pack.setPacketId((int64_t) store.size());
+		store.append(pack, withSource ? &msg : nullptr);
+	}
+	auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+	return (double) ns / (double) count;
+}
+}
+
+int main(int argc, char** argv)
+{
+	XsSize count = argc > 1 ? (XsSize) strtoull(argv[1], nullptr, 10) : 2000000;
+	XsSize rssBefore = residentSize();
+
+	RetainedPacketStore serialized;
+	double serializedNs = appendPackets(serialized, std::min(count, (XsSize) 100000), false);
+	serialized.clear();
+
+	RetainedPacketStore store;
+	double appendNs = appendPackets(store, count, true);
+	printf("packets:              %zu\n", (size_t) store.size());
+	printf("append (source):      %.0f ns/packet\n", appendNs);
+	printf("append (serialized):  %.0f ns/packet\n", serializedNs);
+	printf("memoryUsage:          %.1f MiB\n", store.memoryUsage() / 1048576.0);
+	printf("spill file:           %.1f MiB\n", store.spilledSize() / 1048576.0);
+	printf("resident growth:      %.1f MiB\n", (residentSize() - rssBefore) / 1048576.0);
+
+	std::mt19937_64 rng(42);
+	std::uniform_int_distribution<XsSize> anyIndex(0, store.size() - 1);
+	std::vector<double> latencies;
+	for (int i = 0; i < 20000; ++i)
+	{
+		XsSize index = anyIndex(rng);
+		auto start = std::chrono::steady_clock::now();
+		XsDataPacket pack = store.at(index);
+		latencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+		if (pack.packetId() != (int64_t) index)
+		{
+			printf("lookup of %zu returned packet %lld\n", (size_t) index, (long long) pack.packetId());
+			return 1;
+		}
+	}
+	double p50 = percentile(latencies, 50);
+	double p99 = percentile(latencies, 99);
+	printf("random at():          p50 %.1f us, p99 %.1f us, max %.1f us\n", p50, p99, latencies.back());
+
+	std::vector<double> columns(4 * store.size());
+	std::vector<int64_t> ids(store.size());
+	XsColumnRequest req(XDI_Quaternion, 4, columns.data(), store.size());
+	int64_t start = XsTime_monotonicUs();
+	store.exportColumns(0, store.size(), &req, 1, ids.data());
+	printf("exportColumns:        %.1f ms for %zu samples\n", (XsTime_monotonicUs() - start) / 1000.0, (size_t) req.m_found);
+
+	XsDataPacket taken;
+	XsSize take = store.size() * 3 / 4;
+	start = XsTime_monotonicUs();
+	for (XsSize i = 0; i < take; ++i)
+		store.takeFirst(taken);
+	printf("takeFirst:            %.0f ns/packet\n", 1000.0 * (XsTime_monotonicUs() - start) / (double) take);
+	printf("spill file after:     %.1f MiB for %zu packets\n", store.spilledSize() / 1048576.0, (size_t) store.size());
+	return 0;
+}
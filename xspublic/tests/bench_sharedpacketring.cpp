@@ -0,0 +1,232 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+#include "testsupport.h"
+#include <xscontroller/sharedpacketring.h>
+#include <xstypes/xsdatapacket.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+/*! \file
+	\brief Fan-out latency and throughput of SharedRingPublisher to 1-8 SharedRingReader processes
+	\details The readers are forked processes that attach to the ring before publishing starts and read every frame
+	with peekFrame and consumeFrame. The latency of a frame is the time from publishing it to reading it in the
+	reader process. Three runs are made for each reader count: paced at 1 kHz in a default size ring, flat out in a
+	ring that is large enough to hold all frames, and flat out in the default size ring, where slow readers lose
+	frames. Each reader reports its received and dropped frames and its latency percentiles through a pipe.
+	Usage: bench_sharedpacketring [flat out frame count] [paced frame count], the defaults are 200000 and 2000.
+*/
+
+namespace
+{
+//! \brief What a reader process reports to the benchmark
+struct ReaderResult
+{
+	uint64_t m_received;	//!< The number of intact frames that were read
+	uint64_t m_dropped;		//!< The number of frames that were lost, see SharedRingReader::droppedCount
+	int64_t m_p50;			//!< The median latency in us
+	int64_t m_p99;			//!< The 99th percentile of the latency in us
+	int64_t m_p999;			//!< The 99.9th percentile of the latency in us
+};
+
+//! \brief Append item \a id with \a count big endian floats with value \a value to \a payload
+void appendFloats(std::vector<uint8_t>& payload, uint16_t id, float value, int count)
+{
+	payload.push_back((uint8_t)(id >> 8));
+	payload.push_back((uint8_t) id);
+	payload.push_back((uint8_t)(4 * count));
+	uint32_t bits;
+	memcpy(&bits, &value, 4);
+	for (int i = 0; i < count; ++i)
+		for (int b = 3; b >= 0; --b)
+			payload.push_back((uint8_t)(bits >> (8 * b)));
+}
+
+//! \returns An MtData2 message like an MTi sends with the inertial data and orientation enabled
+XsMessage makeMessage()
+{
+	std::vector<uint8_t> payload = { 0x10, 0x20, 2, 0, 0, 0x10, 0x60, 4, 0, 0, 0, 0 };
+	appendFloats(payload, XDI_Quaternion, 0.5f, 4);
+	appendFloats(payload, XDI_EulerAngles, 10.0f, 3);
+	appendFloats(payload, XDI_Acceleration, 9.81f, 3);
+	appendFloats(payload, XDI_FreeAcceleration, 0.01f, 3);
+	appendFloats(payload, XDI_RateOfTurn, 0.02f, 3);
+	appendFloats(payload, XDI_MagneticField, 0.8f, 3);
+	appendFloats(payload, XDI_BaroPressure, 101325.0f, 1);
+	XsMessage msg(XMID_MtData2, payload.size());
+	msg.setDataBuffer(payload.data(), payload.size(), 0);
+	return msg;
+}
+
+/*! \brief The body of a reader process
+	\details Attaches to ring \a name, signals \a readyFd, reads until the publisher closes the ring and writes a
+	ReaderResult to \a resultFd.
+*/
+int runReader(std::string const& name, XsSize expected, int readyFd, int resultFd)
+{
+	SharedRingReader reader;
+	if (reader.attach(XsString(name.c_str()), true) != XRV_OK)
+		return 1;
+	char ready = 1;
+	if (write(readyFd, &ready, 1) != 1)
+		return 1;
+
+	std::vector<int64_t> latencies;
+	latencies.reserve(expected);
+	auto readFrame = [&]() -> bool
+	{
+		uint8_t const* data;
+		XsSize size;
+		if (!reader.peekFrame(data, size))
+			return false;
+		int64_t time = reader.frameTimeOfArrival();
+		if (reader.consumeFrame())
+			latencies.push_back(XsTime_monotonicUs() - time);
+		return true;
+	};
+
+	while (true)
+	{
+		if (readFrame())
+			continue;
+		// frames that were published before the ring was closed can still be read
+		if (reader.publisherClosed())
+		{
+			if (readFrame())
+				continue;
+			break;
+		}
+		reader.waitForData(100);
+	}
+
+	ReaderResult result;
+	result.m_received = latencies.size();
+	result.m_dropped = reader.droppedCount();
+	result.m_p50 = percentile(latencies, 50);
+	result.m_p99 = percentile(latencies, 99);
+	result.m_p999 = percentile(latencies, 99.9);
+	reader.detach();
+	return write(resultFd, &result, sizeof(result)) == (ssize_t) sizeof(result) ? 0 : 1;
+}
+
+/*! \brief Publish \a frames frames to \a readers reader processes and print the results
+	\param capacity The capacity of the ring in bytes
+	\param interval The interval between frames in us, 0 publishes as fast as possible
+*/
+void measure(char const* label, int readers, XsSize frames, XsSize capacity, int64_t interval)
+{
+	std::string name = "/bench_sharedpacketring_" + std::to_string((long) getpid());
+	SharedRingPublisher publisher;
+	if (publisher.create(XsString(name.c_str()), capacity) != XRV_OK)
+	{
+		printf("%s: creating the ring failed\n", label);
+		return;
+	}
+
+	int readyPipe[2], resultPipe[2];
+	if (pipe(readyPipe) || pipe(resultPipe))
+		return;
+	std::vector<pid_t> children;
+	for (int i = 0; i < readers; ++i)
+	{
+		pid_t pid = fork();
+		if (pid == 0)
+			_exit(runReader(name, frames, readyPipe[1], resultPipe[1]));
+		if (pid > 0)
+			children.push_back(pid);
+	}
+	close(readyPipe[1]);
+	close(resultPipe[1]);
+
+	int attached = 0;
+	char ready;
+	while (attached < (int) children.size() && read(readyPipe[0], &ready, 1) == 1)
+		++attached;
+
+	XsMessage msg = makeMessage();
+	auto start = std::chrono::steady_clock::now();
+	for (XsSize i = 0; i < frames; ++i)
+	{
+		if (interval)
+			std::this_thread::sleep_until(start + std::chrono::microseconds(interval * (int64_t) i));
+		msg.setDataShort((uint16_t) i, 3);
+		publisher.publish(msg, 0x03630001);
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	publisher.close();
+
+	ReaderResult worst = {};
+	worst.m_received = frames;
+	uint64_t dropped = 0;
+	int reported = 0;
+	ReaderResult result;
+	while (read(resultPipe[0], &result, sizeof(result)) == (ssize_t) sizeof(result))
+	{
+		++reported;
+		worst.m_received = std::min(worst.m_received, result.m_received);
+		dropped += result.m_dropped;
+		worst.m_p50 = std::max(worst.m_p50, result.m_p50);
+		worst.m_p99 = std::max(worst.m_p99, result.m_p99);
+		worst.m_p999 = std::max(worst.m_p999, result.m_p999);
+	}
+	for (pid_t pid : children)
+		waitpid(pid, nullptr, 0);
+	close(readyPipe[0]);
+	close(resultPipe[0]);
+
+	printf("%-18s %d readers (%d reported): %9.0f frames/s published, fewest received %7u of %u, dropped %8u, "
+		"latency p50 %6d p99 %6d p99.9 %6d us\n",
+		label, readers, reported, frames / seconds, (unsigned) worst.m_received, (unsigned) frames, (unsigned) dropped,
+		(int) worst.m_p50, (int) worst.m_p99, (int) worst.m_p999);
+}
+}
+
+int main(int argc, char* argv[])
+{
+	XsSize frames = argc > 1 ? (XsSize) atol(argv[1]) : 200000;
+	XsSize pacedFrames = argc > 2 ? (XsSize) atol(argv[2]) : 2000;
+	printf("frame size %u bytes\n", (unsigned) makeMessage().getTotalMessageSize());
+
+	const int readerCounts[] = { 1, 2, 4, 8 };
+	for (int readers : readerCounts)
+		measure("1 kHz", readers, pacedFrames, SharedRingPublisher::defaultCapacity, 1000);
+	for (int readers : readerCounts)
+		measure("flat out, 64 MB", readers, frames, 64 * 1024 * 1024, 0);
+	for (int readers : readerCounts)
+		measure("flat out, 4 MB", readers, frames, SharedRingPublisher::defaultCapacity, 0);
+	return 0;
+}
@@ -0,0 +1,237 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+
+#include "testsupport.h"
+#include <xscommon/xsens_threadpool.h>
+#include <xscommon/threading.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <stdlib.h>
+#include <sys/resource.h>
+
+/*! \file
+	\brief Throughput of the ThreadPool with many small tasks
+	\details Three workloads are run for several pool sizes:
+	- flat: all tasks are added from the main thread
+	- nested: every root task adds its child tasks from inside the pool
+	- chained: tasks are added in chains where every task waits for the previous one with addTask(task, afterId)
+	Every task does well under a microsecond of work. Each workload runs three times and the fastest run is reported:
+	the tasks per second, the average overhead per task relative to calling the work function directly and the
+	context switches per 1000 tasks.
+	Finally the latency from adding a single task to an idle pool until the task starts is measured.
+	The program only uses the addTask/waitForCompletion API, so it can also be built against older ThreadPool
+	implementations for comparison.
+	Usage: bench_threadpool [tasks per run], the default is 200000.
+*/
+
+namespace
+{
+std::atomic<unsigned int> g_done(0);
+std::atomic<uint64_t> g_sink(0);
+
+//! \brief Well under a microsecond of work
+void work(unsigned int seed)
+{
+	uint64_t x = seed;
+	for (int i = 0; i < 64; ++i)
+		x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+	g_sink += x >> 60;
+}
+
+//! \brief A task that only does the work
+class SmallTask : public xsens::ThreadPoolTask
+{
+public:
+	explicit SmallTask(unsigned int seed) : m_seed(seed) {}
+	bool exec() override
+	{
+		work(m_seed);
+		++g_done;
+		return true;
+	}
+private:
+	unsigned int m_seed;
+};
+
+//! \brief A task that adds \a children SmallTasks to the pool before doing its own work
+class SpawningTask : public xsens::ThreadPoolTask
+{
+public:
+	SpawningTask(unsigned int seed, unsigned int children) : m_seed(seed), m_children(children) {}
+	bool exec() override
+	{
+		for (unsigned int i = 0; i < m_children; ++i)
+			xsens::ThreadPool::instance()->addTask(new SmallTask(m_seed + i));
+		work(m_seed);
+		++g_done;
+		return true;
+	}
+private:
+	unsigned int m_seed;
+	unsigned int m_children;
+};
+
+//! \brief A task that records the time at which it was started
+class StartTask : public xsens::ThreadPoolTask
+{
+public:
+	explicit StartTask(std::chrono::steady_clock::time_point* started) : m_started(started) {}
+	bool exec() override
+	{
+		*m_started = std::chrono::steady_clock::now();
+		return true;
+	}
+private:
+	std::chrono::steady_clock::time_point* m_started;
+};
+
+double seconds(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+//! \brief Wait until \a count tasks have completed
+void waitForAll(unsigned int count)
+{
+	while (g_done < count)
+		std::this_thread::yield();
+}
+
+long contextSwitches()
+{
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_nvcsw + usage.ru_nivcsw;
+}
+
+const unsigned int chainLength = 16;	//!< The number of tasks in a chain of the chained workload
+const unsigned int children = 63;		//!< The number of tasks added by every root task of the nested workload
+
+//! \brief Add \a count tasks from the main thread
+void runFlat(xsens::ThreadPool* pool, unsigned int count)
+{
+	for (unsigned int i = 0; i < count; ++i)
+		pool->addTask(new SmallTask(i));
+	waitForAll(count);
+}
+
+//! \brief Add root tasks from the main thread that add the other tasks from inside the pool
+void runNested(xsens::ThreadPool* pool, unsigned int count)
+{
+	for (unsigned int i = 0; i < count; i += children + 1)
+		pool->addTask(new SpawningTask(i, children));
+	waitForAll(count);
+}
+
+//! \brief Add chains of tasks that each wait for the previous task in the chain
+void runChained(xsens::ThreadPool* pool, unsigned int count)
+{
+	xsens::ThreadPool::TaskId last = 0;
+	for (unsigned int i = 0; i < count; i += chainLength)
+	{
+		xsens::ThreadPool::TaskId previous = 0;
+		for (unsigned int k = 0; k < chainLength; ++k)
+			previous = pool->addTask(new SmallTask(i + k), previous);
+		last = previous;
+	}
+	pool->waitForCompletion(last);
+	waitForAll(count);
+}
+
+/*! \brief Run \a workload three times and report the fastest run
+	\details The best of several runs filters out interference from other processes on the machine.
+*/
+void measure(char const* name, void (*workload)(xsens::ThreadPool*, unsigned int), unsigned int poolSize, unsigned int count, double direct)
+{
+	double best = 0;
+	long bestSwitches = 0;
+	for (int run = 0; run < 3; ++run)
+	{
+		g_done = 0;
+		long switches = contextSwitches();
+		auto start = std::chrono::steady_clock::now();
+		workload(xsens::ThreadPool::instance(), count);
+		double elapsed = seconds(start);
+		switches = contextSwitches() - switches;
+		if (run == 0 || elapsed < best)
+		{
+			best = elapsed;
+			bestSwitches = switches;
+		}
+	}
+	printf("%-8s threads %3u: %10.0f tasks/s, %6.2f us per task, overhead %6.2f us, %6.1f switches per 1000 tasks\n",
+		name, poolSize, count / best, 1e6 * best / count, 1e6 * (best - direct) / count, 1000.0 * bestSwitches / count);
+}
+}
+
+int main(int argc, char* argv[])
+{
+	unsigned int count = argc > 1 ? (unsigned int)atoi(argv[1]) : 200000;
+	count -= count % ((children + 1) * chainLength);
+
+	auto start = std::chrono::steady_clock::now();
+	for (unsigned int i = 0; i < count; ++i)
+		work(i);
+	double direct = seconds(start);
+	printf("direct: %.2f us per task\n", 1e6 * direct / count);
+
+	unsigned int hw = std::max(1u, std::thread::hardware_concurrency());
+	std::vector<unsigned int> sizes = { 1, 2, 4 };
+	if (hw > 4)
+		sizes.push_back(hw);
+
+	xsens::ThreadPool* pool = xsens::ThreadPool::instance();
+	for (unsigned int poolSize : sizes)
+	{
+		pool->setPoolSize(poolSize);
+		measure("flat", runFlat, poolSize, count, direct);
+		measure("nested", runNested, poolSize, count, direct);
+		measure("chained", runChained, poolSize, count, direct);
+	}
+
+	// the start latency of a task added to an idle pool
+	std::vector<int64_t> latencies;
+	for (int i = 0; i < 1000; ++i)
+	{
+		XsTime_msleep(2);
+		std::chrono::steady_clock::time_point started;
+		auto added = std::chrono::steady_clock::now();
+		pool->waitForCompletion(pool->addTask(new StartTask(&started)));
+		latencies.push_back(std::chrono::duration_cast<std::chrono::microseconds>(started - added).count());
+	}
+	printf("idle start latency: p50 %lld us, p99 %lld us, max %lld us\n",
+		(long long) percentile(latencies, 50), (long long) percentile(latencies, 99), (long long) percentile(latencies, 100));
+
+	xsens::ThreadPool::destroy();
+	return 0;
+}
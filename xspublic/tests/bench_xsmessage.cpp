@@ -0,0 +1,164 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+
+#include "testsupport.h"
+#include <xstypes/xsmessage.h>
+#include <xscontroller/protocolhandler.h>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <utility>
+#include <stdlib.h>
+
+/*! \file
+	\brief Construct, copy, move and destroy rates of XsMessage and the cost of finding messages in received data
+	\details For messages with 20, 126, 500 and 2000 data bytes the program measures loading a message from raw data
+	and destroying it, copy construction, copy assignment, move construction and adding messages to a deque by copy
+	and by move. Finally ProtocolHandler::findMessage and convertToMessage are run over a buffer of back-to-back
+	messages, like MessageExtractor does. Reported are the operations per second and the heap allocations per
+	operation.
+	Usage: bench_xsmessage [operations per measurement], the default is 1000000.
+*/
+
+namespace
+{
+std::atomic<uint64_t> g_allocations(0);
+}
+
+// count the heap allocations, operator new uses malloc as well
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+
+extern "C" void* malloc(size_t size)
+{
+	g_allocations.fetch_add(1, std::memory_order_relaxed);
+	return __libc_malloc(size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size)
+{
+	g_allocations.fetch_add(1, std::memory_order_relaxed);
+	return __libc_realloc(ptr, size);
+}
+
+namespace
+{
+volatile uint8_t g_sink;
+
+/*! \brief Run \a op \a count times and report the rate and allocations per operation */
+template <typename Op>
+void measure(char const* name, XsSize dataSize, int count, Op op)
+{
+	uint64_t allocations = g_allocations.load();
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < count; ++i)
+		op(i);
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	allocations = g_allocations.load() - allocations;
+	printf("%-16s data %4u: %8.2f Mops/s, %6.1f ns per op, %5.2f allocations per op\n",
+		name, (unsigned) dataSize, count / elapsed / 1e6, 1e9 * elapsed / count, (double) allocations / count);
+}
+}
+
+int main(int argc, char* argv[])
+{
+	int count = argc > 1 ? atoi(argv[1]) : 1000000;
+	XsSize dataSizes[] = { 20, 126, 500, 2000 };
+
+	for (XsSize dataSize : dataSizes)
+	{
+		XsMessage source(XMID_MtData2, dataSize);
+		for (XsSize i = 0; i < dataSize; ++i)
+			source.setDataByte((uint8_t) i, i);
+		XsByteArray raw = source.rawMessage();
+
+		measure("load+destroy", dataSize, count, [&](int)
+		{
+			XsMessage msg;
+			msg.loadFromString(raw.data(), raw.size());
+			g_sink = msg.getDataByte(0);
+		});
+		measure("copy construct", dataSize, count, [&](int)
+		{
+			XsMessage msg(source);
+			g_sink = msg.getDataByte(0);
+		});
+		XsMessage target;
+		measure("copy assign", dataSize, count, [&](int)
+		{
+			target = source;
+			g_sink = target.getDataByte(0);
+		});
+		XsMessage moving(source);
+		measure("move construct", dataSize, count, [&](int)
+		{
+			XsMessage msg(std::move(moving));
+			moving = std::move(msg);
+		});
+
+		std::deque<XsMessage> messages;
+		measure("deque copy", dataSize, count, [&](int i)
+		{
+			XsMessage msg(source);
+			messages.push_back(msg);
+			if ((i & 63) == 63)
+				messages.clear();
+		});
+		messages.clear();
+		measure("deque move", dataSize, count, [&](int i)
+		{
+			XsMessage msg(source);
+			messages.push_back(std::move(msg));
+			if ((i & 63) == 63)
+				messages.clear();
+		});
+		messages.clear();
+
+		// a buffer of 64 messages that is searched and converted like MessageExtractor::processNewData does
+		XsByteArray stream;
+		for (int i = 0; i < 64; ++i)
+			stream.append(raw);
+		ProtocolHandler handler;
+		XsSize offset = 0;
+		measure("find+convert", dataSize, count, [&](int)
+		{
+			if (offset >= stream.size())
+				offset = 0;
+			XsByteArray rest(stream.data() + offset, stream.size() - offset, XSDF_None);
+			MessageLocation location = handler.findMessage(rest);
+			XsMessage msg = handler.convertToMessage(location, rest);
+			offset += (XsSize) location.m_size;
+			g_sink = msg.getDataByte(0);
+		});
+	}
+	return 0;
+}
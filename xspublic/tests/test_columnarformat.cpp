@@ -0,0 +1,181 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+
+#include "testsupport.h"
+#include <xscontroller/columnarformat.h>
+#include <xscontroller/columnardatalogger.h>
+#include <xscontroller/columnarlogreader.h>
+#include <xstypes/xsdatapacket.h>
+#include <stdlib.h>
+#include <vector>
+#ifdef __linux__
+	#include <sys/resource.h>
+#endif
+
+namespace
+{
+//! \brief Append item \a id with \a size bytes of data derived from \a seed to \a payload
+void appendItem(std::vector<uint8_t>& payload, uint16_t id, uint8_t size, uint32_t seed)
+{
+	payload.push_back((uint8_t)(id >> 8));
+	payload.push_back((uint8_t) id);
+	payload.push_back(size);
+	for (uint8_t i = 0; i < size; ++i)
+		payload.push_back((uint8_t)(seed * (i + 1) >> (i % 3)));
+}
+
+//! \brief Returns an MtData2 message with sample \a sample of a typical inertial sensor
+XsMessage makeMessage(uint32_t sample)
+{
+	std::vector<uint8_t> payload;
+	appendItem(payload, XDI_PacketCounter, 2, sample);
+	appendItem(payload, XDI_SampleTimeFine, 4, sample * 100);
+	appendItem(payload, XDI_Quaternion, 16, sample / 8);
+	appendItem(payload, XDI_Acceleration, 12, sample * 7);
+	appendItem(payload, XDI_RateOfTurn, 12, sample * 13);
+	XsMessage msg(XMID_MtData2, payload.size());
+	msg.setDataBuffer(payload.data(), payload.size(), 0);
+	return msg;
+}
+
+//! \returns The peak resident set size of the process in kB, 0 when unknown
+long peakResidentKb()
+{
+#ifdef __linux__
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) == 0)
+		return usage.ru_maxrss;
+#endif
+	return 0;
+}
+
+void testChunkRoundTrip()
+{
+	std::vector<uint8_t> records;
+	XsSize count = 300;
+	for (XsSize i = 0; i < count; ++i)
+	{
+		XsByteArray raw = makeMessage((uint32_t) i).rawMessage();
+		if (i == 100)
+		{
+			uint8_t other[] = { 1, 2, 3 };
+			ColumnarFormat::appendRecord(records, ColumnarFormat::RT_Raw, other, sizeof(other));
+		}
+		else
+			ColumnarFormat::appendRecord(records, ColumnarFormat::RT_Message, raw.data(), raw.size());
+	}
+
+	std::vector<uint8_t> body, decoded;
+	ColumnarFormat::encodeChunk(records, count, body);
+	CHECK(ColumnarFormat::decodeChunk(body.data(), body.size(), count, decoded));
+	CHECK(decoded == records);
+
+	// a truncated body and a record count that the body cannot hold are rejected
+	CHECK(!ColumnarFormat::decodeChunk(body.data(), body.size() - 1, count, decoded));
+	CHECK(!ColumnarFormat::decodeChunk(body.data(), body.size(), body.size(), decoded));
+}
+
+void testCorruptLayoutCount()
+{
+	// a layout stream with large items that claims many samples but holds no column data, decoding it must fail
+	// without first allocating the samples, which would take more than 1 GB
+	const XsSize itemCount = 2000;
+	const XsSize recordCount = 2000;
+	std::vector<uint8_t> body;
+	body.push_back(1);
+	body.push_back(0);
+	body.push_back(0);		// SK_Layout
+	body.push_back(0xFF);	// bus id
+	body.push_back((uint8_t) itemCount);
+	body.push_back((uint8_t)(itemCount >> 8));
+	for (XsSize i = 0; i < itemCount; ++i)
+	{
+		body.push_back(0x20);
+		body.push_back(0x40);
+		body.push_back(252);
+	}
+	for (int i = 0; i < 4; ++i)
+		body.push_back((uint8_t)(recordCount >> (8 * i)));
+	body.resize(body.size() + 2 * recordCount, 0);
+
+	long before = peakResidentKb();
+	std::vector<uint8_t> decoded;
+	CHECK(!ColumnarFormat::decodeChunk(body.data(), body.size(), recordCount, decoded));
+	CHECK(peakResidentKb() - before < 64 * 1024);
+}
+
+void testFileRoundTrip()
+{
+	char const* name = "test_columnarformat.xcl";
+	std::vector<XsMessage> messages;
+	for (uint32_t i = 0; i < 1000; ++i)
+		messages.push_back(makeMessage(i));
+
+	{
+		ColumnarDataLogger logger(256);
+		CHECK(logger.create(XsString(name)));
+		for (auto const& msg : messages)
+			CHECK(logger.writeMessage(msg));
+		logger.close();
+	}
+
+	ColumnarLogReader reader;
+	CHECK(reader.open(XsString(name)));
+	CHECK(reader.hasIndex());
+	CHECK(reader.recordCount() == messages.size());
+	XsMessage msg;
+	XsSize read = 0;
+	while (reader.readMessage(msg))
+	{
+		if (read < messages.size())
+			CHECK(msg.rawMessage() == messages[read].rawMessage());
+		++read;
+	}
+	CHECK(read == messages.size());
+
+	CHECK(reader.seek(700));
+	XsDataPacket packet;
+	CHECK(reader.readDataPacket(packet));
+	XsDataPacket expected(&messages[700]);
+	CHECK(packet.packetCounter() == expected.packetCounter());
+	reader.close();
+	remove(name);
+}
+}
+
+int main()
+{
+	testChunkRoundTrip();
+	testCorruptLayoutCount();
+	testFileRoundTrip();
+	return testResult("test_columnarformat");
+}
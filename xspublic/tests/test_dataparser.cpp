@@ -0,0 +1,222 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+
+#include "testsupport.h"
+#include <xscontroller/dataparser.h>
+#include <xscontroller/rawcapture.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+/*! \brief A parser that receives pushed data and only counts it
+	\details Parsing blocks while the gate is closed, so the receive pool can be filled.
+*/
+class GatedParser : public DataParser
+{
+public:
+	std::atomic<XsSize> m_parsed;	//!< The number of bytes parsed so far
+
+	GatedParser() : m_parsed(0), m_open(true) {}
+	~GatedParser() override
+	{
+		open(true);
+		terminate();
+	}
+
+	void open(bool isOpen)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_open = isOpen;
+		m_changed.notify_all();
+	}
+
+	XsResultValue readDataToBuffer(XsByteArray&) override
+	{
+		return XRV_OK;
+	}
+
+	XsResultValue processBufferedData(const XsByteArray& rawIn, std::deque<XsMessage>&) override
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_changed.wait(lock, [this]() { return m_open; });
+		m_parsed += rawIn.size();
+		return XRV_OK;
+	}
+
+	void handleMessage(const XsMessage&) override {}
+
+	bool receivesPushedData() const override
+	{
+		return true;
+	}
+
+	bool isRunning()
+	{
+		return isAlive();
+	}
+
+private:
+	std::mutex m_mutex;
+	std::condition_variable m_changed;
+	bool m_open;
+};
+
+const XsSize blockSize = 100;
+
+void waitUntil(std::function<bool()> condition)
+{
+	for (int i = 0; i < 1000 && !condition(); ++i)
+		XsTime_msleep(1);
+}
+
+void testWaitForRelease()
+{
+	// a pusher that runs out of buffers waits for the parser and then continues without losing data
+	GatedParser parser;
+	waitUntil([&]() { return parser.isRunning(); });
+	parser.open(false);
+
+	const int blocks = 100;
+	XsByteArray block(blockSize, nullptr);
+	std::atomic<int> pushed(0);
+	std::thread pusher([&]()
+	{
+		for (int i = 0; i < blocks; ++i)
+		{
+			parser.addRawData(block);
+			++pushed;
+		}
+	});
+
+	// one buffer is held by the blocked parser, the others are queued
+	waitUntil([&]() { return parser.receiveBufferPool().exhaustedCount() > 0; });
+	XsTime_msleep(20);
+	CHECK(pushed <= (int) parser.receiveBufferPool().bufferCount() + 1);
+
+	parser.open(true);
+	pusher.join();
+	waitUntil([&]() { return parser.m_parsed == blocks * blockSize; });
+	CHECK(parser.m_parsed == blocks * blockSize);
+	CHECK(parser.droppedByteCount() == 0);
+}
+
+void testDropOnTerminate()
+{
+	// data that is queued or pushed while the parser stops is counted as dropped
+	GatedParser parser;
+	waitUntil([&]() { return parser.isRunning(); });
+	parser.open(false);
+
+	XsByteArray block(blockSize, nullptr);
+	XsSize count = parser.receiveBufferPool().bufferCount();
+	for (XsSize i = 0; i < count; ++i)
+		parser.addRawData(block);
+
+	// the pusher blocks because all buffers are in use
+	std::atomic<bool> returned(false);
+	std::thread pusher([&]()
+	{
+		parser.addRawData(block);
+		returned = true;
+	});
+	XsTime_msleep(20);
+	CHECK(!returned);
+
+	std::thread stopper([&]() { parser.terminate(); });
+	XsTime_msleep(20);
+	parser.open(true);
+	stopper.join();
+	pusher.join();
+	CHECK(returned);
+
+	// the parser may finish the block it is working on, everything else is dropped
+	CHECK(parser.m_parsed + parser.droppedByteCount() == (count + 1) * blockSize);
+	CHECK(parser.droppedByteCount() >= (count - 1) * blockSize);
+
+	XsSize dropped = parser.droppedByteCount();
+	parser.addRawData(block);
+	CHECK(parser.droppedByteCount() == dropped + blockSize);
+}
+
+void testRawCapture()
+{
+	// more blocks than can be queued are written by the background thread and read back in order
+	char const* name = "test_dataparser.xsraw";
+	const XsSize chunks = 5000;
+	auto chunkSize = [](XsSize i) { return (XsSize) (1 + (i * 37) % 500); };
+	{
+		RawCaptureWriter writer;
+		CHECK(writer.create(XsString(name)) == XRV_OK);
+		CHECK(writer.isOpen());
+		int64_t start = XsTime_monotonicUs();
+		std::vector<uint8_t> data;
+		for (XsSize i = 0; i < chunks; ++i)
+		{
+			data.assign(chunkSize(i), (uint8_t) i);
+			writer.write(start + 1000 * (int64_t) (i + 1), data.data(), data.size());
+		}
+		CHECK(writer.chunkCount() == chunks);
+		CHECK(writer.close() == XRV_OK);
+		CHECK(!writer.isOpen());
+	}
+
+	RawCaptureReader reader;
+	CHECK(reader.open(XsString(name)) == XRV_OK);
+	int64_t timeUs, lastTime = 0;
+	XsByteArray data;
+	XsSize count = 0;
+	bool ordered = true;
+	while (reader.readChunk(timeUs, data))
+	{
+		ordered = ordered && data.size() == chunkSize(count) && data[0] == (uint8_t) count && data[data.size() - 1] == (uint8_t) count;
+		ordered = ordered && timeUs - lastTime == (count ? 1000 : timeUs);
+		lastTime = timeUs;
+		++count;
+	}
+	CHECK(reader.lastResult() == XRV_ENDOFFILE);
+	CHECK(count == chunks);
+	CHECK(ordered);
+	reader.close();
+	remove(name);
+}
+}
+
+int main()
+{
+	testWaitForRelease();
+	testDropOnTerminate();
+	testRawCapture();
+	return testResult("test_dataparser");
+}
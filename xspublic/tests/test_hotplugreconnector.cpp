@@ -0,0 +1,259 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+
+#include "testsupport.h"
+#include <xscontroller/hotplugreconnector.h>
+#include <xscontroller/mtbdatalogger.h>
+#include <xscontroller/xscontrol_def.h>
+#include <xscontroller/xsdevice_def.h>
+#include <xscontroller/xsdeviceconfiguration.h>
+#include <xscommon/journaller.h>
+#include <xstypes/xsoutputconfiguration.h>
+#include <atomic>
+#include <string.h>
+#include <thread>
+#include <unistd.h>
+
+/*! \file
+	\brief Tests of HotplugReconnector with simulated hot-plug events
+	\details A device is opened from a generated mtb file, its connection loss and the add event of its port are
+	simulated. The reconnect itself is replaced, so the tests verify which events lead to a reconnect, that the
+	reconnect runs in the worker thread without blocking handleEvent() and what happens after a failure.
+	The library is linked with the journaller, which is not used here, so its entry points are stubbed.
+*/
+
+AbstractAdditionalLogger* Journaller::m_additionalLogger = nullptr;
+void Journaller::log(JournalLogLevel, const std::string&) {}
+
+namespace
+{
+const uint32_t deviceId = 0x03630001;
+
+//! \brief Write a file \a name with a configuration message for an MTi-630
+bool writeFile(char const* name)
+{
+	MtbDataLogger logger;
+	if (!logger.create(XsString(name)))
+		return false;
+
+	XsDeviceConfiguration config(1);
+	config.masterInfo().m_masterDeviceId = deviceId;
+	config.masterInfo().m_samplingPeriod = 1152;
+	strcpy((char*) config.masterInfo().m_productCode, "MTi-630");
+	config.deviceInfo(XS_BID_MASTER).m_deviceId = deviceId;
+	config.deviceInfo(XS_BID_MASTER).m_fwRevMajor = 1;
+	XsMessage configMsg(XMID_Configuration);
+	config.writeToMessage(configMsg);
+	bool ok = logger.writeMessage(configMsg);
+	logger.close();
+	return ok;
+}
+
+//! \brief A reconnector whose reconnect only records the call, it succeeds or fails on request after a delay
+class TestReconnector : public HotplugReconnector
+{
+public:
+	TestReconnector(XsControl* control)
+		: HotplugReconnector(control)
+		, m_calls(0)
+		, m_succeed(true)
+		, m_delayMs(0)
+	{
+	}
+
+	//! \brief Simulate the connection loss of \a dev as reported by its data poller
+	void disconnect(XsDevice* dev)
+	{
+		onConnectivityChanged(dev, XCS_Disconnected);
+	}
+
+	//! \brief Check that LostDevice copies its output configuration
+	static void testLostDeviceCopy()
+	{
+		LostDevice lost;
+		CHECK(lost.m_device == nullptr && !lost.m_wasMeasuring && lost.m_outputConfiguration.empty());
+		lost.m_deviceId = XsDeviceId(deviceId);
+		lost.m_outputConfiguration.push_back(XsOutputConfiguration(XDI_PacketCounter, 65535));
+		lost.m_outputConfiguration.push_back(XsOutputConfiguration(XDI_Quaternion, 100));
+
+		LostDevice copy(lost);
+		CHECK(copy.m_deviceId == lost.m_deviceId);
+		CHECK(copy.m_outputConfiguration == lost.m_outputConfiguration);
+
+		LostDevice assigned;
+		assigned.m_outputConfiguration.push_back(XsOutputConfiguration(XDI_Acceleration, 400));
+		assigned = lost;
+		CHECK(assigned.m_outputConfiguration == lost.m_outputConfiguration);
+		assigned = assigned;
+		CHECK(assigned.m_outputConfiguration.size() == 2);
+	}
+
+	std::atomic<int> m_calls;
+	std::atomic<bool> m_succeed;
+	std::atomic<int> m_delayMs;
+	std::thread::id m_thread;
+	XsDeviceId m_lostId;
+
+protected:
+	bool reconnect(LostDevice const& lost, XsPortInfo const&) override
+	{
+		m_thread = std::this_thread::get_id();
+		m_lostId = lost.m_deviceId;
+		if (m_delayMs)
+			XsTime_msleep((uint32_t) m_delayMs);
+		++m_calls;
+		return m_succeed;
+	}
+};
+
+//! \returns An add event for the port of the device with id \a id
+HotplugEvent addEvent(uint32_t id)
+{
+	HotplugEvent event;
+	event.m_action = HPA_Added;
+	event.m_portInfo.setPortName("/dev/ttyUSB0");
+	event.m_portInfo.setDeviceId(XsDeviceId(id));
+	event.m_timeUs = XsTime_monotonicUs();
+	return event;
+}
+
+//! \brief Wait at most \a timeoutMs until \a count reaches \a expected
+bool waitFor(std::atomic<int> const& count, int expected, int timeoutMs = 2000)
+{
+	int64_t until = XsTime_monotonicUs() + timeoutMs * 1000;
+	while (count < expected && XsTime_monotonicUs() < until)
+		XsTime_msleep(1);
+	return count >= expected;
+}
+
+//! \brief The reconnect runs in the worker thread, a failed device waits for the next add event
+void testReconnect(XsControl* control, XsDevice* dev)
+{
+	TestReconnector reconnector(control);
+	CHECK(reconnector.start(false) == XRV_OK);
+	CHECK(reconnector.isStarted());
+	CHECK(reconnector.start(false) == XRV_ALREADYOPEN);
+
+	// nothing is lost yet
+	reconnector.handleEvent(addEvent(deviceId));
+	XsTime_msleep(50);
+	CHECK(reconnector.m_calls == 0);
+
+	reconnector.disconnect(dev);
+	reconnector.disconnect(dev);
+
+	// a port of another device is ignored
+	reconnector.handleEvent(addEvent(deviceId + 1));
+	XsTime_msleep(50);
+	CHECK(reconnector.m_calls == 0);
+
+	// a slow failing reconnect does not block the caller
+	reconnector.m_succeed = false;
+	reconnector.m_delayMs = 200;
+	int64_t start = XsTime_monotonicUs();
+	reconnector.handleEvent(addEvent(deviceId));
+	CHECK(XsTime_monotonicUs() - start < 50000);
+	CHECK(waitFor(reconnector.m_calls, 1));
+	XsTime_msleep(20);
+	CHECK(reconnector.m_thread != std::this_thread::get_id());
+	CHECK(reconnector.m_lostId == XsDeviceId(deviceId));
+	CHECK(reconnector.failureCount() == 1);
+	CHECK(reconnector.reconnectCount() == 0);
+
+	// the device was lost once, so the next add is the only other reconnect
+	reconnector.m_succeed = true;
+	reconnector.m_delayMs = 0;
+	reconnector.handleEvent(addEvent(deviceId));
+	CHECK(waitFor(reconnector.m_calls, 2));
+	XsTime_msleep(20);
+	CHECK(reconnector.reconnectCount() == 1);
+	CHECK(reconnector.failureCount() == 1);
+	CHECK(reconnector.lastReconnectTime() >= 0);
+	CHECK(reconnector.lastOutageTime() > 0);
+
+	reconnector.handleEvent(addEvent(deviceId));
+	XsTime_msleep(50);
+	CHECK(reconnector.m_calls == 2);
+
+	reconnector.stop();
+	CHECK(!reconnector.isStarted());
+}
+
+//! \brief Stopping waits for a reconnect in progress and the reconnector can be started again
+void testStopDuringReconnect(XsControl* control, XsDevice* dev)
+{
+	TestReconnector reconnector(control);
+	CHECK(reconnector.start(false) == XRV_OK);
+	reconnector.m_delayMs = 200;
+	reconnector.disconnect(dev);
+	reconnector.handleEvent(addEvent(deviceId));
+	XsTime_msleep(20);
+	reconnector.stop();
+	CHECK(reconnector.m_calls == 1);
+	CHECK(reconnector.reconnectCount() == 1);
+
+	// the lost devices are forgotten when stopped
+	CHECK(reconnector.start(false) == XRV_OK);
+	reconnector.m_delayMs = 0;
+	reconnector.handleEvent(addEvent(deviceId));
+	XsTime_msleep(50);
+	CHECK(reconnector.m_calls == 1);
+
+	reconnector.disconnect(dev);
+	reconnector.handleEvent(addEvent(deviceId));
+	CHECK(waitFor(reconnector.m_calls, 2));
+}
+}
+
+int main()
+{
+	TestReconnector::testLostDeviceCopy();
+
+	char name[64];
+	snprintf(name, sizeof(name), "/tmp/test_hotplugreconnector_%d.mtb", (int) getpid());
+	CHECK(writeFile(name));
+
+	XsControl* control = XsControl::construct();
+	CHECK(control->openLogFile(XsString(name)));
+	XsDevice* dev = control->mainDeviceIds().empty() ? nullptr : control->device(control->mainDeviceIds()[0]);
+	CHECK(dev != nullptr);
+	if (dev)
+	{
+		CHECK(dev->deviceId() == XsDeviceId(deviceId));
+		testReconnect(control, dev);
+		testStopDuringReconnect(control, dev);
+	}
+
+	control->destruct();
+	remove(name);
+	return testResult("test_hotplugreconnector");
+}
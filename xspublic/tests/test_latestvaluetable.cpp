@@ -0,0 +1,127 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+
+#include "testsupport.h"
+#include <xscontroller/latestvaluetable.h>
+#include <xstypes/xsdatapacket.h>
+#include <atomic>
+#include <thread>
+
+namespace
+{
+void testReadWatched()
+{
+	LatestValueTable table;
+	LatestValue value;
+	CHECK(table.empty());
+	CHECK(table.watch(XDI_Acceleration));
+	CHECK(table.watch(XDI_PacketCounter | XDI_SubFormatDouble));
+	CHECK(table.watch(XDI_StatusWord));
+	CHECK(!table.read(XDI_Acceleration, value));
+
+	XsDataPacket pack;
+	pack.setPacketId(5);
+	pack.setTimeOfArrival(XsTimeStamp((int64_t) 1234));
+	pack.setCalibratedAcceleration(XsVector3(1.0, 2.0, 3.0));
+	pack.setPacketCounter(77);
+	pack.setCalibratedGyroscopeData(XsVector3(4.0, 5.0, 6.0));
+	table.update(pack);
+
+	CHECK(table.read(XDI_Acceleration | XDI_SubFormatDouble, value));
+	CHECK(value.m_id == XDI_Acceleration);
+	CHECK(value.m_packetId == 5);
+	CHECK(value.m_toa == 1234);
+	double acc[3] = {};
+	CHECK(value.toDoubles(acc, 3) == 3);
+	CHECK(acc[0] == 1.0 && acc[1] == 2.0 && acc[2] == 3.0);
+
+	CHECK(table.read(XDI_PacketCounter, value));
+	CHECK(value.toUnsigned() == 77);
+	CHECK(!table.read(XDI_StatusWord, value));
+	CHECK(!table.read(XDI_RateOfTurn, value));
+
+	// items that are missing from a packet keep their previous value
+	XsDataPacket next;
+	next.setPacketId(6);
+	next.setStatus(3);
+	table.update(next);
+	CHECK(table.read(XDI_StatusWord, value) && value.toUnsigned() == 3 && value.m_packetId == 6);
+	CHECK(table.read(XDI_Acceleration, value) && value.m_packetId == 5);
+
+	table.clear();
+	CHECK(table.empty());
+	CHECK(!table.read(XDI_Acceleration, value));
+}
+
+void testConcurrentReads()
+{
+	LatestValueTable table;
+	table.watch(XDI_Acceleration);
+	std::atomic<bool> done(false);
+	std::atomic<int> torn(0);
+	std::atomic<int> reads(0);
+
+	std::thread reader([&]()
+	{
+		LatestValue value;
+		while (!done.load())
+		{
+			if (!table.read(XDI_Acceleration, value))
+				continue;
+			++reads;
+			double v[3];
+			value.toDoubles(v, 3);
+			if (v[0] != v[1] || v[1] != v[2] || v[0] != (double) value.m_packetId)
+				++torn;
+		}
+	});
+
+	XsDataPacket pack;
+	for (int i = 0; i < 200000; ++i)
+	{
+		pack.setPacketId(i);
+		pack.setCalibratedAcceleration(XsVector3((double) i, (double) i, (double) i));
+		table.update(pack);
+	}
+	done = true;
+	reader.join();
+	CHECK(torn == 0);
+	CHECK(reads > 0);
+}
+}
+
+int main()
+{
+	testReadWatched();
+	testConcurrentReads();
+	return testResult("test_latestvaluetable");
+}
@@ -0,0 +1,163 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+
+#include "testsupport.h"
+#include <xscontroller/mtbexporter.h>
+#include <xscontroller/mtbdatalogger.h>
+#include <xstypes/xsmessage.h>
+#include <string>
+#include <vector>
+#include <stdio.h>
+
+namespace
+{
+//! \brief Append item \a id with the big endian floats \a values to \a payload
+void appendFloats(std::vector<uint8_t>& payload, uint16_t id, float const* values, int count)
+{
+	payload.push_back((uint8_t)(id >> 8));
+	payload.push_back((uint8_t) id);
+	payload.push_back((uint8_t)(4 * count));
+	for (int i = 0; i < count; ++i)
+	{
+		uint32_t bits;
+		memcpy(&bits, &values[i], 4);
+		for (int b = 3; b >= 0; --b)
+			payload.push_back((uint8_t)(bits >> (8 * b)));
+	}
+}
+
+/*! \brief Returns an MtData2 message with packet counter \a counter and an acceleration
+	\details Only every third message contains a rate of turn, starting with the second one.
+*/
+XsMessage makeMessage(uint16_t counter)
+{
+	std::vector<uint8_t> payload = { 0x10, 0x20, 2, (uint8_t)(counter >> 8), (uint8_t) counter };
+	float acc[3] = { 1.0f, 2.0f, (float) counter };
+	appendFloats(payload, XDI_Acceleration, acc, 3);
+	if (counter % 3 == 1)
+	{
+		float gyr[3] = { 0.5f, 0.25f, -1.0f };
+		appendFloats(payload, XDI_RateOfTurn, gyr, 3);
+	}
+	XsMessage msg(XMID_MtData2, payload.size());
+	msg.setDataBuffer(payload.data(), payload.size(), 0);
+	return msg;
+}
+
+//! \returns The lines of text file \a name
+std::vector<std::string> readLines(char const* name)
+{
+	std::vector<std::string> lines;
+	FILE* f = fopen(name, "rb");
+	if (!f)
+		return lines;
+	std::string line;
+	int c;
+	while ((c = fgetc(f)) != EOF)
+	{
+		if (c == '\n')
+		{
+			lines.push_back(line);
+			line.clear();
+		}
+		else
+			line += (char) c;
+	}
+	fclose(f);
+	return lines;
+}
+
+//! \returns The number of fields in CSV line \a line
+XsSize fieldCount(std::string const& line)
+{
+	XsSize count = 1;
+	for (char c : line)
+		if (c == ',')
+			++count;
+	return count;
+}
+
+void testUnionLayout()
+{
+	char const* input = "test_mtbexporter.mtb";
+	char const* output = "test_mtbexporter.csv";
+	const uint16_t count = 100;
+	{
+		MtbDataLogger logger;
+		CHECK(logger.create(XsString(input)));
+		for (uint16_t i = 0; i < count; ++i)
+			CHECK(logger.writeMessage(makeMessage(i)));
+		logger.close();
+	}
+
+	MtbExporter exporter;
+	exporter.setChunkMessages(16);
+	exporter.setDecimals(2);
+	MtbExportStatistics statistics;
+	CHECK(exporter.exportFile(XsString(input), XsString(output), &statistics) == XRV_OK);
+	CHECK(statistics.m_rows == count);
+
+	// the rate of turn is missing in the first message, but must still get columns
+	std::vector<std::string> lines = readLines(output);
+	CHECK(lines.size() == count + 1u);
+	if (lines.size() == count + 1u)
+	{
+		CHECK(lines[0].find("Gyr") != std::string::npos);
+		for (XsSize i = 0; i <= count; ++i)
+			CHECK(fieldCount(lines[i]) == 7);
+		CHECK(lines[1] == "0,1.00,2.00,0.00,,,");
+		CHECK(lines[2] == "1,1.00,2.00,1.00,0.50,0.25,-1.00");
+		CHECK(lines[3] == "2,1.00,2.00,2.00,,,");
+	}
+
+	// limiting the items keeps the order in which they occur in the file
+	exporter.setItems({ XDI_RateOfTurn, XDI_PacketCounter });
+	CHECK(exporter.exportFile(XsString(input), XsString(output)) == XRV_OK);
+	lines = readLines(output);
+	CHECK(lines.size() == count + 1u);
+	if (lines.size() == count + 1u)
+	{
+		CHECK(fieldCount(lines[0]) == 4);
+		CHECK(lines[1] == "0,,,");
+		CHECK(lines[2] == "1,0.50,0.25,-1.00");
+	}
+
+	remove(input);
+	remove(output);
+}
+}
+
+int main()
+{
+	testUnionLayout();
+	return testResult("test_mtbexporter");
+}
@@ -0,0 +1,227 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+#include "testsupport.h"
+#include <xscontroller/packetstreamserver.h>
+#include <xstypes/xstime.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+namespace
+{
+//! \brief The size of the published frames
+const XsSize frameSize = 118;
+
+//! \returns A TCP port for the server, different for concurrent runs
+uint16_t testPort()
+{
+	return (uint16_t)(40000 + getpid() % 20000);
+}
+
+//! \returns A socket connected to the server on \a port or -1
+int connectClient(uint16_t port)
+{
+	int sd = socket(AF_INET, SOCK_STREAM, 0);
+	struct timeval timeout = { 5, 0 };
+	setsockopt(sd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+	struct sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_port = htons(port);
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if (connect(sd, (struct sockaddr*) &address, sizeof(address)) != 0)
+	{
+		close(sd);
+		return -1;
+	}
+	return sd;
+}
+
+//! \brief Receive exactly \a size bytes, returns false when the connection was closed or timed out
+bool receive(int sd, uint8_t* data, XsSize size)
+{
+	while (size)
+	{
+		ssize_t count = recv(sd, data, size, 0);
+		if (count <= 0)
+			return false;
+		data += count;
+		size -= (XsSize) count;
+	}
+	return true;
+}
+
+//! \brief A subscriber that reads records on its own thread and checks that their sequence numbers are contiguous
+class Subscriber
+{
+public:
+	explicit Subscriber(uint16_t port)
+		: m_socket(connectClient(port))
+		, m_received(0)
+		, m_inOrder(true)
+	{
+	}
+
+	~Subscriber()
+	{
+		if (m_thread.joinable())
+			m_thread.join();
+		if (m_socket >= 0)
+			close(m_socket);
+	}
+
+	//! \brief Start reading until \a count records were received or the connection ends
+	void start(uint32_t count)
+	{
+		m_thread = std::thread([this, count]()
+		{
+			std::vector<uint8_t> record(PacketStreamServer::recordHeaderSize + frameSize);
+			while (m_received < count && receive(m_socket, record.data(), record.size()))
+			{
+				uint32_t sequence = record[4] | (record[5] << 8) | (record[6] << 16) | ((uint32_t) record[7] << 24);
+				if (sequence != m_received)
+					m_inOrder = false;
+				++m_received;
+			}
+		});
+	}
+
+	void join()
+	{
+		m_thread.join();
+	}
+
+	int m_socket;
+	std::atomic<uint32_t> m_received;	//!< The number of records that were received
+	std::atomic<bool> m_inOrder;		//!< False when a record was missing
+
+private:
+	std::thread m_thread;
+};
+
+//! \brief Wait until \a server has \a count subscribers
+bool waitForClients(PacketStreamServer const& server, XsSize count)
+{
+	for (int i = 0; i < 2000 && server.clientCount() < count; ++i)
+		XsTime_msleep(1);
+	return server.clientCount() == count;
+}
+
+/*! \brief Publish \a bursts bursts of \a burstSize bytes of records as fast as possible, pausing between bursts
+	\returns The number of published records
+*/
+uint32_t publishBursts(PacketStreamServer& server, int bursts, XsSize burstSize)
+{
+	std::vector<uint8_t> frame(frameSize, 0x5A);
+	uint32_t count = 0;
+	for (int burst = 0; burst < bursts; ++burst)
+	{
+		for (XsSize bytes = 0; bytes < burstSize; bytes += PacketStreamServer::recordHeaderSize + frameSize)
+		{
+			CHECK(server.publish(frame.data(), frame.size(), 1, XsTime_monotonicUs()) == XRV_OK);
+			++count;
+		}
+		XsTime_msleep(20);
+	}
+	return count;
+}
+
+void testBurstLargerThanQueueLimit()
+{
+	// a burst of twice the queue limit must reach subscribers that keep reading, it used to disconnect all of them
+	const XsSize queueLimit = 64 * 1024;
+	PacketStreamServer server;
+	CHECK(server.open(testPort(), XsString(), 0, queueLimit) == XRV_OK);
+
+	const int clientCount = 4;
+	std::vector<std::unique_ptr<Subscriber>> clients;
+	for (int i = 0; i < clientCount; ++i)
+		clients.emplace_back(new Subscriber(testPort()));
+	CHECK(waitForClients(server, clientCount));
+
+	const int bursts = 20;
+	const XsSize burstSize = 2 * queueLimit;
+	uint32_t expected = (uint32_t)(bursts * ((burstSize + PacketStreamServer::recordHeaderSize + frameSize - 1) / (PacketStreamServer::recordHeaderSize + frameSize)));
+	for (auto& client : clients)
+		client->start(expected);
+
+	CHECK(publishBursts(server, bursts, burstSize) == expected);
+	for (auto& client : clients)
+	{
+		client->join();
+		CHECK(client->m_received == expected);
+		CHECK(client->m_inOrder);
+	}
+	CHECK(server.droppedClientCount() == 0);
+	CHECK(server.overflowCount() == 0);
+	server.close();
+}
+
+void testSlowClientIsDropped()
+{
+	// a subscriber that stops reading is disconnected, the other one still receives every record
+	const XsSize queueLimit = 64 * 1024;
+	PacketStreamServer server;
+	CHECK(server.open(testPort(), XsString(), 0, queueLimit) == XRV_OK);
+
+	Subscriber reader(testPort());
+	Subscriber stalled(testPort());
+	CHECK(waitForClients(server, 2));
+
+	// enough data to fill the socket buffers of the stalled subscriber and its send queue
+	const int bursts = 100;
+	const XsSize burstSize = 64 * 1024;
+	uint32_t expected = (uint32_t)(bursts * ((burstSize + PacketStreamServer::recordHeaderSize + frameSize - 1) / (PacketStreamServer::recordHeaderSize + frameSize)));
+	reader.start(expected);
+	CHECK(publishBursts(server, bursts, burstSize) == expected);
+	reader.join();
+
+	CHECK(reader.m_received == expected);
+	CHECK(reader.m_inOrder);
+	CHECK(server.droppedClientCount() == 1);
+	CHECK(waitForClients(server, 1));
+	server.close();
+}
+}
+
+int main()
+{
+	testBurstLargerThanQueueLimit();
+	testSlowClientIsDropped();
+	return testResult("test_packetstreamserver");
+}
@@ -0,0 +1,263 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+
+#include "testsupport.h"
+#include <xscontroller/retainedpacketstore.h>
+#include <xstypes/xsglovesnapshot.h>
+#include <xstypes/xsmatrix3x3.h>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+//! \brief Returns a packet with id \a id and a few items derived from it
+XsDataPacket makePacket(int64_t id)
+{
+	XsDataPacket pack;
+	pack.setPacketId(id);
+	pack.setSampleTimeFine((uint32_t) id * 100);
+	pack.setPacketCounter((uint16_t) id);
+	pack.setCalibratedAcceleration(XsVector3(1.0 * id, 2.0, 3.0));
+	pack.setOrientationQuaternion(XsQuaternion(1.0, 0.0, 0.0, 0.0), XDI_CoordSysEnu);
+	return pack;
+}
+
+//! \brief Returns the MtData2 message of a left hand glove snapshot with frame number \a frame
+XsMessage makeGloveMessage(uint32_t frame)
+{
+	std::vector<uint8_t> payload(3 + 255 + 3 + 124, 0);
+	payload[0] = 0xC8;
+	payload[1] = 0x30;
+	payload[2] = 255;
+	payload[3] = (uint8_t)(frame >> 24);
+	payload[4] = (uint8_t)(frame >> 16);
+	payload[5] = (uint8_t)(frame >> 8);
+	payload[6] = (uint8_t) frame;
+	payload[258] = 0xC8;
+	payload[259] = 0x30;
+	payload[260] = 124;
+
+	XsMessage msg(XMID_MtData2, payload.size());
+	msg.setDataBuffer(payload.data(), payload.size(), 0);
+	return msg;
+}
+
+void testRoundTrip()
+{
+	RetainedPacketStore store(16, 2);
+	for (int64_t id = 0; id < 200; ++id)
+	{
+		XsDataPacket pack = makePacket(id);
+		if (id % 2)
+		{
+			XsMessage msg;
+			XsDataPacket_toMessage(&pack, &msg);
+			store.append(pack, &msg);
+		}
+		else
+			store.append(pack);
+	}
+	CHECK(store.size() == 200);
+	CHECK(store.spilledSize() > 0);
+	CHECK(store.rejectedCount() == 0);
+
+	for (XsSize i = 0; i < store.size(); ++i)
+	{
+		XsDataPacket pack = store.at(i);
+		CHECK(pack.packetId() == (int64_t) i);
+		CHECK(pack.sampleTimeFine() == (uint32_t) i * 100);
+		CHECK(pack.calibratedAcceleration()[0] == (double) i);
+	}
+
+	std::vector<double> acc(3 * 200);
+	std::vector<int64_t> ids(200);
+	XsColumnRequest req(XDI_Acceleration, 3, acc.data(), 200);
+	CHECK(store.exportColumns(0, 200, &req, 1, ids.data()) == 200);
+	CHECK(req.m_found == 200);
+	for (XsSize i = 0; i < 200; ++i)
+	{
+		CHECK(ids[i] == (int64_t) i);
+		CHECK(acc[i] == (double) i);
+		CHECK(acc[200 + i] == 2.0);
+	}
+}
+
+void testGloveSnapshot()
+{
+	RetainedPacketStore store;
+	XsMessage msg = makeGloveMessage(1234);
+	XsDataPacket pack(&msg);
+	CHECK(pack.containsGloveSnapshot(XHI_LeftHand));
+
+	// without its source message the snapshot cannot be serialized
+	pack.setPacketId(1);
+	store.append(pack);
+	CHECK(store.size() == 0);
+	CHECK(store.rejectedCount() == 1);
+
+	// with the source message the received payload is retained
+	for (int64_t id = 1; id <= 3; ++id)
+	{
+		pack.setPacketId(id);
+		store.append(pack, &msg);
+	}
+	CHECK(store.size() == 3);
+	for (XsSize i = 0; i < 3; ++i)
+	{
+		XsDataPacket stored = store.at(i);
+		CHECK(stored.packetId() == (int64_t) i + 1);
+		CHECK(stored.containsGloveSnapshot(XHI_LeftHand));
+		CHECK(stored.gloveSnapshot(XHI_LeftHand).m_frameNumber == 1234);
+	}
+
+	// merging into a retained snapshot would require serializing it
+	XsDataPacket late = makePacket(3);
+	store.append(late);
+	CHECK(store.rejectedCount() == 2);
+	CHECK(store.at(2).containsGloveSnapshot(XHI_LeftHand));
+}
+
+void testMerge()
+{
+	RetainedPacketStore store;
+	XsDataPacket pack = makePacket(7);
+	XsMessage msg;
+	XsDataPacket_toMessage(&pack, &msg);
+	store.append(pack, &msg);
+
+	XsDataPacket late;
+	late.setPacketId(7);
+	late.setTemperature(21.5);
+	store.append(late);
+	store.append(makePacket(8));
+	CHECK(store.size() == 2);
+
+	XsDataPacket merged = store.at(0);
+	CHECK(merged.containsTemperature());
+	CHECK(merged.containsCalibratedAcceleration());
+}
+
+void testCompaction()
+{
+	// large packets so the spill file passes the compaction threshold quickly
+	const XsSize perChunk = 1024;
+	RetainedPacketStore store(perChunk, 1);
+	XsDataPacket pack = makePacket(0);
+	pack.setOrientationMatrix(XsMatrix3x3(), XDI_CoordSysEnu);
+	pack.setOrientationEuler(XsEuler(), XDI_CoordSysEnu);
+	pack.setCalibratedGyroscopeData(XsVector3());
+	pack.setCalibratedMagneticField(XsVector3());
+	pack.setFreeAcceleration(XsVector3());
+	pack.setVelocityIncrement(XsVector3());
+	pack.setOrientationIncrement(XsQuaternion());
+	XsMessage msg;
+	XsDataPacket_toMessage(&pack, &msg);
+
+	XsSize recordSize = msg.getDataSize() + 64;
+	XsSize total = (XsSize)(3 * RetainedPacketStore::spillCompactionThreshold / recordSize);
+	total -= total % perChunk;
+	for (XsSize i = 0; i < total; ++i)
+	{
+		pack.setPacketId((int64_t) i);
+		store.append(pack, &msg);
+	}
+	CHECK(store.size() == total);
+	XsSize spilled = store.spilledSize();
+	CHECK(spilled > 2 * RetainedPacketStore::spillCompactionThreshold);
+
+	// export across the boundary of two spilled chunks
+	std::vector<int64_t> ids(4);
+	XsColumnRequest req(XDI_Acceleration, 0, nullptr, 0);
+	CHECK(store.exportColumns(perChunk - 2, 4, &req, 1, ids.data()) == 4);
+
+	XsDataPacket taken;
+	XsSize take = total * 3 / 4;
+	for (XsSize i = 0; i < take; ++i)
+	{
+		CHECK(store.takeFirst(taken));
+		if (taken.packetId() != (int64_t) i)
+		{
+			CHECK(taken.packetId() == (int64_t) i);
+			break;
+		}
+	}
+	CHECK(store.spilledSize() < spilled / 2);
+	CHECK(store.size() == total - take);
+	CHECK(store.at(0).packetId() == (int64_t) take);
+	CHECK(store.at(store.size() - 1).packetId() == (int64_t) total - 1);
+	CHECK(ids[0] == (int64_t) perChunk - 2 && ids[3] == (int64_t) perChunk + 1);
+}
+
+void testSnapshot()
+{
+	// two complete chunks of which one is spilled, an incomplete chunk and the pending packet
+	RetainedPacketStore store(16, 1);
+	for (int64_t id = 0; id < 40; ++id)
+		store.append(makePacket(id));
+
+	RetainedPacketStore::ColumnSnapshotPtr snapshot = store.snapshotColumns(10, 100);
+	CHECK(snapshot != nullptr);
+
+	// the snapshot must not be affected by modifying the store
+	for (int64_t id = 40; id < 100; ++id)
+		store.append(makePacket(id));
+	XsDataPacket taken;
+	for (int i = 0; i < 50; ++i)
+		store.takeFirst(taken);
+	store.clear();
+
+	std::vector<double> acc(3 * 30);
+	std::vector<int64_t> ids(30);
+	XsColumnRequest req(XDI_Acceleration, 3, acc.data(), 30);
+	CHECK(RetainedPacketStore::exportColumns(snapshot, &req, 1, ids.data()) == 30);
+	CHECK(req.m_found == 30);
+	for (XsSize i = 0; i < 30; ++i)
+	{
+		CHECK(ids[i] == (int64_t) i + 10);
+		CHECK(acc[i] == (double) i + 10);
+		CHECK(acc[60 + i] == 3.0);
+	}
+
+	CHECK(RetainedPacketStore::exportColumns(store.snapshotColumns(0, 10), &req, 1, ids.data()) == 0);
+	CHECK(RetainedPacketStore::exportColumns(RetainedPacketStore::ColumnSnapshotPtr(), &req, 1, ids.data()) == 0);
+}
+}
+
+int main()
+{
+	testRoundTrip();
+	testGloveSnapshot();
+	testMerge();
+	testCompaction();
+	testSnapshot();
+	return testResult("test_retainedpacketstore");
+}
@@ -0,0 +1,220 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+#include "testsupport.h"
+#include <xscontroller/socketstreaminterface.h>
+#include <xstypes/xsportinfo.h>
+#include <xstypes/xstime.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+namespace
+{
+//! \brief The GotoConfig request that the tests send to the stand-in device
+const uint8_t gotoConfig[] = { 0xFA, 0xFF, 0x30, 0x00, 0xD1 };
+//! \brief The reply of the stand-in device to gotoConfig
+const uint8_t gotoConfigAck[] = { 0xFA, 0xFF, 0x31, 0x00, 0xD0 };
+
+/*! \brief A device server on the loopback interface that behaves like a device
+	\details The stand-in waits for a GotoConfig request, acknowledges it and then sends \a frameCount MtData2
+	frames in chunks of varying size, like a device server that forwards whatever the serial port received.
+*/
+class StandInDevice
+{
+public:
+	StandInDevice(int type, XsSize frameCount)
+		: m_requestOk(false)
+		, m_type(type)
+		, m_socket(socket(AF_INET, type, 0))
+		, m_port(0)
+	{
+		struct sockaddr_in address;
+		memset(&address, 0, sizeof(address));
+		address.sin_family = AF_INET;
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		socklen_t length = sizeof(address);
+		if (bind(m_socket, (struct sockaddr*) &address, sizeof(address)) == 0
+			&& getsockname(m_socket, (struct sockaddr*) &address, &length) == 0)
+			m_port = ntohs(address.sin_port);
+		if (type == SOCK_STREAM)
+			listen(m_socket, 1);
+
+		for (XsSize i = 0; i < frameCount; ++i)
+		{
+			uint8_t frame[] = { 0xFA, 0xFF, 0x36, 0x05, 0x10, 0x20, 0x02, (uint8_t)(i >> 8), (uint8_t) i, 0 };
+			uint8_t checksum = 0;
+			for (XsSize b = 1; b < sizeof(frame) - 1; ++b)
+				checksum += frame[b];
+			frame[sizeof(frame) - 1] = (uint8_t)(0 - checksum);
+			m_stream.insert(m_stream.end(), frame, frame + sizeof(frame));
+		}
+		m_thread = std::thread([this]() { run(); });
+	}
+
+	~StandInDevice()
+	{
+		m_thread.join();
+		close(m_socket);
+	}
+
+	//! \returns The URL to open the stand-in with
+	std::string url() const
+	{
+		return std::string(m_type == SOCK_STREAM ? "tcp" : "udp") + "://127.0.0.1:" + std::to_string(m_port);
+	}
+
+	std::vector<uint8_t> m_stream;	//!< The frames that the stand-in sends after the acknowledge
+	bool m_requestOk;				//!< True when the stand-in received the expected request
+
+private:
+	void run()
+	{
+		int connection = m_socket;
+		if (m_type == SOCK_STREAM)
+			connection = accept(m_socket, nullptr, nullptr);
+
+		// UDP replies go to the address that the request came from
+		uint8_t request[64];
+		struct sockaddr_in peer;
+		socklen_t peerLength = sizeof(peer);
+		ssize_t size = recvfrom(connection, request, sizeof(request), 0, (struct sockaddr*) &peer, &peerLength);
+		m_requestOk = size == (ssize_t) sizeof(gotoConfig) && memcmp(request, gotoConfig, sizeof(gotoConfig)) == 0;
+		if (m_type == SOCK_DGRAM)
+			connect(connection, (struct sockaddr*) &peer, peerLength);
+
+		send(connection, gotoConfigAck, sizeof(gotoConfigAck), 0);
+		for (XsSize offset = 0, chunk = 1; offset < m_stream.size(); offset += chunk, chunk = chunk % 97 + 1)
+		{
+			chunk = std::min(chunk, m_stream.size() - offset);
+			send(connection, m_stream.data() + offset, chunk, 0);
+			if (m_type == SOCK_DGRAM)
+				XsTime_msleep(1);
+		}
+		if (m_type == SOCK_STREAM)
+			close(connection);
+	}
+
+	int m_type;
+	int m_socket;
+	uint16_t m_port;
+	std::thread m_thread;
+};
+
+//! \brief Read from \a stream until \a size bytes were received or reading fails
+std::vector<uint8_t> readBytes(SocketStreamInterface& stream, XsSize size)
+{
+	std::vector<uint8_t> result;
+	XsByteArray data;
+	for (int i = 0; i < 10000 && result.size() < size; ++i)
+	{
+		XsResultValue res = stream.readData(1024, data);
+		if (res == XRV_OK)
+			result.insert(result.end(), data.data(), data.data() + data.size());
+		else if (res != XRV_TIMEOUT)
+			break;
+	}
+	return result;
+}
+
+void testParseUrl()
+{
+	IpProtocol protocol;
+	XsString host;
+	uint16_t port = 0, localPort = 0;
+
+	CHECK(SocketStreamInterface::parseUrl("tcp://192.168.1.20:4001", protocol, host, port, localPort));
+	CHECK(protocol == IP_TCP && host == "192.168.1.20" && port == 4001 && localPort == 0);
+	CHECK(SocketStreamInterface::parseUrl("udp://devsrv.local:4002?local=5002", protocol, host, port, localPort));
+	CHECK(protocol == IP_UDP && host == "devsrv.local" && port == 4002 && localPort == 5002);
+	CHECK(SocketStreamInterface::parseUrl("tcp://[fe80::1]:4001", protocol, host, port, localPort));
+	CHECK(host == "fe80::1" && port == 4001);
+
+	CHECK(!SocketStreamInterface::parseUrl("tcp://", protocol, host, port, localPort));
+	CHECK(!SocketStreamInterface::parseUrl("tcp:/", protocol, host, port, localPort));
+	CHECK(!SocketStreamInterface::parseUrl("/dev/ttyUSB0", protocol, host, port, localPort));
+	CHECK(!SocketStreamInterface::parseUrl("tcp://host", protocol, host, port, localPort));
+	CHECK(!SocketStreamInterface::parseUrl("tcp://host:0", protocol, host, port, localPort));
+	CHECK(!SocketStreamInterface::parseUrl("tcp://host:70000", protocol, host, port, localPort));
+	CHECK(!SocketStreamInterface::parseUrl("tcp://:4001", protocol, host, port, localPort));
+	CHECK(!SocketStreamInterface::parseUrl("tcp://fe80::1:4001", protocol, host, port, localPort));
+	CHECK(!SocketStreamInterface::parseUrl("tcp://host:4001?local=5002", protocol, host, port, localPort));
+}
+
+void testStandInDevice(int type)
+{
+	// a request reaches the stand-in and its acknowledge and data stream arrive complete and in order
+	StandInDevice device(type, 200);
+	SocketStreamInterface stream;
+	XsPortInfo portInfo(device.url().c_str());
+	CHECK(stream.open(portInfo) == XRV_OK);
+	CHECK(stream.isOpen());
+
+	// without a timeout, a read returns at once when nothing was received
+	XsByteArray data;
+	int64_t start = XsTime_monotonicUs();
+	CHECK(stream.readData(1024, data) == XRV_TIMEOUT);
+	CHECK(data.empty());
+	CHECK(XsTime_monotonicUs() - start < 100000);
+
+	CHECK(stream.writeData(XsByteArray(const_cast<uint8_t*>(gotoConfig), sizeof(gotoConfig), XSDF_None)) == XRV_OK);
+	stream.setTimeout(100);
+	std::vector<uint8_t> expected(gotoConfigAck, gotoConfigAck + sizeof(gotoConfigAck));
+	expected.insert(expected.end(), device.m_stream.begin(), device.m_stream.end());
+	std::vector<uint8_t> received = readBytes(stream, expected.size());
+	CHECK(received == expected);
+
+	if (type == SOCK_STREAM)
+	{
+		// the stand-in closed the connection after sending the stream
+		XsResultValue res = XRV_TIMEOUT;
+		for (int i = 0; i < 50 && res == XRV_TIMEOUT; ++i)
+			res = stream.readData(1024, data);
+		CHECK(res == XRV_UNEXPECTED_DISCONNECT);
+	}
+	CHECK(stream.close() == XRV_OK);
+	CHECK(!stream.isOpen());
+	CHECK(device.m_requestOk);
+}
+}
+
+int main()
+{
+	testParseUrl();
+	testStandInDevice(SOCK_STREAM);
+	testStandInDevice(SOCK_DGRAM);
+	return testResult("test_socketstreaminterface");
+}
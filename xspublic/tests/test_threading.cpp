@@ -0,0 +1,107 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+
+#include "testsupport.h"
+#include <xscommon/threading.h>
+#include <atomic>
+#include <thread>
+#include <sched.h>
+
+namespace
+{
+//! \brief A thread that only records on which processor it runs
+class IdleThread : public xsens::StandardThread
+{
+public:
+	std::atomic<int> m_cpu;		//!< The processor the thread last ran on
+
+	IdleThread() : m_cpu(-1) {}
+	~IdleThread() override
+	{
+		stopThread();
+	}
+
+protected:
+	int32_t innerFunction() override
+	{
+		m_cpu = sched_getcpu();
+		return 1;
+	}
+};
+
+void testOutOfRangeCpu()
+{
+	IdleThread thread;
+	CHECK(thread.setRealTimeSettings(xsens::ThreadRealTimeSettings(CPU_SETSIZE)) == xsens::TRR_Failed);
+	CHECK(thread.setRealTimeSettings(xsens::ThreadRealTimeSettings(1 << 20)) == xsens::TRR_Failed);
+	CHECK(thread.setRealTimeSettings(xsens::ThreadRealTimeSettings(0)) == xsens::TRR_Pending);
+
+	// the rejected settings did not replace the pending ones
+	thread.startThread("pinned");
+	for (int i = 0; i < 100 && thread.m_cpu < 0; ++i)
+		XsTime_msleep(5);
+	CHECK(thread.m_cpu == 0);
+	CHECK(thread.setRealTimeSettings(xsens::ThreadRealTimeSettings(CPU_SETSIZE)) == xsens::TRR_Failed);
+	CHECK(thread.setRealTimeSettings(xsens::ThreadRealTimeSettings(0)) == xsens::TRR_Pinned);
+	thread.stopThread();
+}
+
+void testConcurrentStart()
+{
+	// settings changed while the thread starts must not be lost or torn
+	IdleThread thread;
+	std::atomic<bool> done(false);
+	std::thread setter([&]()
+	{
+		while (!done)
+			thread.setRealTimeSettings(xsens::ThreadRealTimeSettings(0));
+	});
+	for (int i = 0; i < 50; ++i)
+	{
+		thread.m_cpu = -1;
+		thread.startThread("restarted");
+		for (int w = 0; w < 100 && thread.m_cpu < 0; ++w)
+			XsTime_msleep(1);
+		CHECK(thread.m_cpu == 0);
+		thread.stopThread();
+	}
+	done = true;
+	setter.join();
+}
+}
+
+int main()
+{
+	testOutOfRangeCpu();
+	testConcurrentStart();
+	return testResult("test_threading");
+}
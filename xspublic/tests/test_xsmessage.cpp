@@ -0,0 +1,141 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+
+#include "testsupport.h"
+#include <xstypes/xsmessage.h>
+#include <xscontroller/protocolhandler.h>
+#include <deque>
+#include <utility>
+
+namespace
+{
+XsMessage makeMessage(XsXbusMessageId id, XsSize dataSize)
+{
+	XsMessage msg(id, dataSize);
+	for (XsSize i = 0; i < dataSize; ++i)
+		msg.setDataByte((uint8_t) (i * 7), i);
+	return msg;
+}
+
+void testMoveConstruct()
+{
+	XsMessage src = makeMessage(XMID_MtData2, 126);
+	uint8_t const* data = src.getMessageStart();
+	XsMessage dst(std::move(src));
+	CHECK(dst.getMessageStart() == data);
+	CHECK(dst.getDataSize() == 126);
+	CHECK(dst.isChecksumOk());
+	CHECK(src.empty());
+	CHECK(src.getTotalMessageSize() == 0);
+
+	// a moved-from message can be reused
+	src = dst;
+	CHECK(src.getDataSize() == 126);
+	CHECK(src.isChecksumOk());
+	CHECK(src.getMessageStart() != dst.getMessageStart());
+}
+
+void testMoveAssign()
+{
+	XsMessage src = makeMessage(XMID_MtData2, 2000);
+	XsMessage dst = makeMessage(XMID_GotoConfig, 0);
+	uint8_t const* data = src.getMessageStart();
+	dst = std::move(src);
+	CHECK(dst.getMessageStart() == data);
+	CHECK(dst.getMessageId() == XMID_MtData2);
+	CHECK(dst.getDataSize() == 2000);
+	CHECK(dst.isChecksumOk());
+	CHECK(src.empty());
+
+	// the checksum is still updated automatically after a move
+	dst.setDataByte(1, 10);
+	CHECK(dst.isChecksumOk());
+
+	XsMessage& self = dst;
+	dst = std::move(self);
+	CHECK(dst.getDataSize() == 2000);
+	CHECK(dst.isChecksumOk());
+}
+
+void testMoveIntoContainer()
+{
+	std::deque<XsMessage> messages;
+	XsMessage msg = makeMessage(XMID_MtData2, 50);
+	uint8_t const* data = msg.getMessageStart();
+	messages.push_back(std::move(msg));
+	CHECK(messages.back().getMessageStart() == data);
+	CHECK(msg.empty());
+}
+
+void testFindMessage()
+{
+	// a short, an extended and a corrupted message, the checksum check must match XsMessage::isChecksumOk
+	XsMessage a = makeMessage(XMID_MtData2, 100);
+	XsMessage b = makeMessage(XMID_MtData2, 1000);
+	XsMessage c = makeMessage(XMID_MtData2, 20);
+
+	XsByteArray raw;
+	raw.append(a.rawMessage());
+	raw.append(b.rawMessage());
+	XsSize corrupt = raw.size() + 10;
+	raw.append(c.rawMessage());
+	raw[corrupt] ^= 0x40;
+
+	ProtocolHandler handler;
+	MessageLocation location = handler.findMessage(raw);
+	CHECK(location.m_startPos == 0);
+	CHECK(location.m_size == (int) a.getTotalMessageSize());
+
+	XsByteArray rest(raw.data() + a.getTotalMessageSize(), raw.size() - a.getTotalMessageSize(), XSDF_None);
+	location = handler.findMessage(rest);
+	CHECK(location.m_startPos == 0);
+	CHECK(location.m_size == (int) b.getTotalMessageSize());
+	XsMessage converted = handler.convertToMessage(location, rest);
+	CHECK(converted.getDataSize() == 1000);
+	CHECK(converted.isChecksumOk());
+
+	XsSize offset = a.getTotalMessageSize() + b.getTotalMessageSize();
+	XsByteArray last(raw.data() + offset, raw.size() - offset, XSDF_None);
+	location = handler.findMessage(last);
+	CHECK(location.m_startPos == -1);
+	CHECK(location.m_checksumFailures == 1);
+}
+}
+
+int main()
+{
+	testMoveConstruct();
+	testMoveAssign();
+	testMoveIntoContainer();
+	testFindMessage();
+	return testResult("test_xsmessage");
+}
@@ -0,0 +1,82 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+
+#ifndef TESTSUPPORT_H
+#define TESTSUPPORT_H
+
+#include <xstypes/xstime.h>
+#include <algorithm>
+#include <vector>
+#include <stdio.h>
+
+/*! \file
+	\brief Minimal support for the standalone test and benchmark programs in this directory
+	\details A test program uses CHECK for its assertions and returns testResult() from main. A benchmark prints
+	its measurements with printf and returns 0.
+*/
+
+//! \brief The number of failed CHECKs in the program
+extern int gTestFailures;
+
+//! \brief Report a failure when \a cond is false and continue with the test
+#define CHECK(cond) \
+	do { \
+		if (!(cond)) { \
+			++gTestFailures; \
+			fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+		} \
+	} while (0)
+
+/*! \brief Print the result of the test program
+	\returns The exit code of the test program
+*/
+inline int testResult(char const* name)
+{
+	if (gTestFailures)
+		printf("%s: %d failures\n", name, gTestFailures);
+	else
+		printf("%s: OK\n", name);
+	return gTestFailures ? 1 : 0;
+}
+
+/*! \brief Returns percentile \a p (0..100) of \a samples, sorting them */
+template <typename T>
+T percentile(std::vector<T>& samples, double p)
+{
+	if (samples.empty())
+		return T();
+	std::sort(samples.begin(), samples.end());
+	size_t index = (size_t)((samples.size() - 1) * p / 100.0 + 0.5);
+	return samples[index];
+}
+
+#endif
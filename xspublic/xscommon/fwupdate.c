@@ -111,13 +111,52 @@ const char* ackToString(uint8_t command)
 }
 
 
+/*!	\brief Read \a length bytes at \a offset in the xff, from m_xffImage when it is set
+	\returns The number of bytes that was actually read
+*/
+static uint32_t readXffData(FwUpdate* thisPtr, uint8_t* buffer, uint32_t offset, uint32_t length)
+{
+	if (!thisPtr->m_xffImage)
+		return thisPtr->m_readXffData(buffer, offset, length);
+
+	if (offset >= thisPtr->m_xffImageSize)
+		return 0;
+	if (length > thisPtr->m_xffImageSize - offset)
+		length = thisPtr->m_xffImageSize - offset;
+	memcpy(buffer, thisPtr->m_xffImage + offset, length);
+	return length;
+}
+
+
+/*!	\brief Send the message in the tx buffer to the module
+*/
+static void sendMessage(FwUpdate* thisPtr)
+{
+	if (thisPtr->m_sendXbusMessageCtx)
+		thisPtr->m_sendXbusMessageCtx(thisPtr->m_context, thisPtr->m_txBuffer);
+	else
+		thisPtr->m_sendXbusMessage(thisPtr->m_txBuffer);
+}
+
+
+/*!	\brief Notify the host that the firmware update has finished with \a result
+*/
+static void notifyReady(FwUpdate* thisPtr, FWU_Result result)
+{
+	if (thisPtr->m_readyHandlerCtx)
+		thisPtr->m_readyHandlerCtx(thisPtr->m_context, result);
+	else
+		thisPtr->m_readyHandler(result);
+}
+
+
 /*!	\brief Read a uint32_t from the current position in the xff
 */
 uint32_t readUint32(FwUpdate* thisPtr)
 {
 	uint32_t result;
 	uint8_t buffer[4];
-	uint32_t n = thisPtr->m_readXffData(buffer, thisPtr->m_readIndex, 4);
+	uint32_t n = readXffData(thisPtr, buffer, thisPtr->m_readIndex, 4);
 	thisPtr->m_readIndex += n;
 	if (n == 4)
 		result = (uint32_t)buffer[0] << 24 | (uint32_t)buffer[1] << 16 | (uint32_t)buffer[2] << 8 | buffer[3];
@@ -136,7 +175,7 @@ uint16_t readUint16(FwUpdate* thisPtr)
 {
 	uint32_t result;
 	uint8_t buffer[2];
-	uint32_t n = thisPtr->m_readXffData(buffer, thisPtr->m_readIndex, 2);
+	uint32_t n = readXffData(thisPtr, buffer, thisPtr->m_readIndex, 2);
 	thisPtr->m_readIndex += n;
 	if (n == 2)
 		result = (uint32_t)buffer[0] << 8 | buffer[1];
@@ -155,7 +194,7 @@ uint8_t readUint8(FwUpdate* thisPtr)
 {
 	uint8_t result;
 	uint8_t buffer[1];
-	uint32_t n = thisPtr->m_readXffData(buffer, thisPtr->m_readIndex, 1);
+	uint32_t n = readXffData(thisPtr, buffer, thisPtr->m_readIndex, 1);
 	thisPtr->m_readIndex += n;
 	if (n == 1)
 		result = buffer[0];
@@ -227,7 +266,7 @@ static void sendReady(FwUpdate* thisPtr)
 	Xbus_message(thisPtr->m_txBuffer, 0xFF, XMID_FIRMWARE_UPDATE, 1);
 	Xbus_getPointerToPayload(thisPtr->m_txBuffer)[0] = FWUP_READY;
 	Xbus_insertChecksum(thisPtr->m_txBuffer);
-	thisPtr->m_sendXbusMessage(thisPtr->m_txBuffer);
+	sendMessage(thisPtr);
 }
 
 
@@ -239,13 +278,13 @@ static void sendHeader(FwUpdate* thisPtr)
 	Xbus_message(thisPtr->m_txBuffer, 0xFF, XMID_FIRMWARE_UPDATE, 1 + thisPtr->m_xffHeader.m_addressLength + 2);
 	uint8_t* payload = Xbus_getPointerToPayload(thisPtr->m_txBuffer);
 	payload[0] = FWUP_HEADER;
-	n = thisPtr->m_readXffData(&payload[1], thisPtr->m_readIndex, thisPtr->m_xffHeader.m_addressLength);
+	n = readXffData(thisPtr, &payload[1], thisPtr->m_readIndex, thisPtr->m_xffHeader.m_addressLength);
 	thisPtr->m_readIndex += n;
 	if (n == thisPtr->m_xffHeader.m_addressLength)
 	{
 		memcpy(&payload[1 + thisPtr->m_xffHeader.m_addressLength], (uint8_t*)&thisPtr->m_nofSlicesPerPage, 2);
 		Xbus_insertChecksum(thisPtr->m_txBuffer);
-		thisPtr->m_sendXbusMessage(thisPtr->m_txBuffer);
+		sendMessage(thisPtr);
 	}
 	else
 		thisPtr->m_endOfFile = 1;
@@ -262,18 +301,34 @@ static void sendSlice(FwUpdate* thisPtr)
 	uint8_t* payload = Xbus_getPointerToPayload(thisPtr->m_txBuffer);
 
 	payload[0] = FWUP_PAGESLICE;
-	n = thisPtr->m_readXffData(&payload[1], thisPtr->m_readIndex, thisPtr->m_xffHeader.m_sliceSize);
+	n = readXffData(thisPtr, &payload[1], thisPtr->m_readIndex, thisPtr->m_xffHeader.m_sliceSize);
 	thisPtr->m_readIndex += n;
 	if (n == thisPtr->m_xffHeader.m_sliceSize)
 	{
 		Xbus_insertChecksum(thisPtr->m_txBuffer);
-		thisPtr->m_sendXbusMessage(thisPtr->m_txBuffer);
+		sendMessage(thisPtr);
+		thisPtr->m_bytesSent += n;
 	}
 	else
 		thisPtr->m_endOfFile = 1;
 }
 
 
+/*!	\brief Send the next slices of the current page until m_sliceWindow slices await their FWUP_READY
+*/
+static void sendSlices(FwUpdate* thisPtr)
+{
+	uint32_t window = thisPtr->m_sliceWindow ? thisPtr->m_sliceWindow : 1;
+	while (thisPtr->m_sliceCounter < thisPtr->m_nofSlicesPerPage && thisPtr->m_slicesInFlight < window)
+	{
+		LOG("Fwu: Send slice %d\n", thisPtr->m_sliceCounter);
+		sendSlice(thisPtr);
+		thisPtr->m_sliceCounter++;
+		thisPtr->m_slicesInFlight++;
+	}
+}
+
+
 /*!	\brief Send a FWUP_OTHER command
 */
 static void sendOther(FwUpdate* thisPtr)
@@ -284,7 +339,7 @@ static void sendOther(FwUpdate* thisPtr)
 	payload[1] = thisPtr->m_xffHeader.m_chipId;
 	LOG("Fwu: Send FWUP_OTHER\n");
 	Xbus_insertChecksum(thisPtr->m_txBuffer);
-	thisPtr->m_sendXbusMessage(thisPtr->m_txBuffer);
+	sendMessage(thisPtr);
 }
 
 
@@ -297,7 +352,7 @@ static void sendFinished(FwUpdate* thisPtr)
 	payload[0] = FWUP_FINISHED;
 	LOG("Fwu: Send FWUP_FINISHED\n");
 	Xbus_insertChecksum(thisPtr->m_txBuffer);
-	thisPtr->m_sendXbusMessage(thisPtr->m_txBuffer);
+	sendMessage(thisPtr);
 }
 
 
@@ -321,6 +376,13 @@ void FwUpdate_init(FwUpdate* thisPtr)
 {
 	LOG("Fwu: init()\n");
 	thisPtr->m_state = STATE_Idle;
+	thisPtr->m_xffImage = NULL;
+	thisPtr->m_xffImageSize = 0;
+	thisPtr->m_sliceWindow = 1;
+	thisPtr->m_context = NULL;
+	thisPtr->m_sendXbusMessageCtx = NULL;
+	thisPtr->m_readyHandlerCtx = NULL;
+	thisPtr->m_bytesSent = 0;
 }
 
 
@@ -333,12 +395,13 @@ void FwUpdate_start(FwUpdate* thisPtr)
 		LOG("Fwu: start() --> Send FWUP_READY\n");
 		thisPtr->m_readIndex = 0;
 		thisPtr->m_endOfFile = 0;
+		thisPtr->m_bytesSent = 0;
 		thisPtr->m_state = STATE_Start;
 		sendReady(thisPtr);
 	}
 	else
 	{
-		thisPtr->m_readyHandler(FWU_Failed);
+		notifyReady(thisPtr, FWU_Failed);
 		LOG("Fwu: start() failed\n");
 	}
 }
@@ -391,7 +454,7 @@ void FwUpdate_handleXbus(FwUpdate* thisPtr, uint8_t const* xbusMessage)
 			else
 			{
 				LOG("Fwu: Got %s in STATE_WaitReady --> Failed\n", ackToString(ack));
-				thisPtr->m_readyHandler(FWU_Failed);
+				notifyReady(thisPtr, FWU_Failed);
 				thisPtr->m_state = STATE_Idle;
 			}
 			break;
@@ -401,15 +464,16 @@ void FwUpdate_handleXbus(FwUpdate* thisPtr, uint8_t const* xbusMessage)
 		{
 			if (ack == FWUP_READY)
 			{
-				LOG("Fwu: FWUP_READY in STATE_WaitHeaderResult --> Send first slice\n");
-				sendSlice(thisPtr);
-				thisPtr->m_sliceCounter = 1;
+				LOG("Fwu: FWUP_READY in STATE_WaitHeaderResult --> Send first slices\n");
+				thisPtr->m_sliceCounter = 0;
+				thisPtr->m_slicesInFlight = 0;
+				sendSlices(thisPtr);
 				thisPtr->m_state = STATE_WaitSliceReady;
 			}
 			else
 			{
 				LOG("Fwu: Got %s in STATE_WaitHeaderResult --> Failed\n", ackToString(ack));
-				thisPtr->m_readyHandler(FWU_Failed);
+				notifyReady(thisPtr, FWU_Failed);
 				thisPtr->m_state = STATE_Idle;
 			}
 			break;
@@ -419,13 +483,14 @@ void FwUpdate_handleXbus(FwUpdate* thisPtr, uint8_t const* xbusMessage)
 		{
 			if (ack == FWUP_READY)
 			{
+				if (thisPtr->m_slicesInFlight > 0)
+					thisPtr->m_slicesInFlight--;
 				if (thisPtr->m_sliceCounter < thisPtr->m_nofSlicesPerPage)
 				{
-					LOG("Fwu: FWUP_READY in STATE_WaitSliceReady --> Send slice %d\n", thisPtr->m_sliceCounter);
-					sendSlice(thisPtr);
-					thisPtr->m_sliceCounter++;
+					LOG("Fwu: FWUP_READY in STATE_WaitSliceReady --> Send more slices\n");
+					sendSlices(thisPtr);
 				}
-				else
+				else if (thisPtr->m_slicesInFlight == 0)
 				{
 					LOG("Fwu: All slices sent --> STATE_WaitPageOk\n");
 					thisPtr->m_state = STATE_WaitPageOk;
@@ -434,7 +499,7 @@ void FwUpdate_handleXbus(FwUpdate* thisPtr, uint8_t const* xbusMessage)
 			else
 			{
 				LOG("Fwu: Got %s in STATE_WaitSliceReady --> Failed\n", ackToString(ack));
-				thisPtr->m_readyHandler(FWU_Failed);
+				notifyReady(thisPtr, FWU_Failed);
 				thisPtr->m_state = STATE_Idle;
 			}
 			break;
@@ -450,7 +515,7 @@ void FwUpdate_handleXbus(FwUpdate* thisPtr, uint8_t const* xbusMessage)
 			else
 			{
 				LOG("Fwu: Got %s in STATE_WaitPageOk --> Failed\n", ackToString(ack));
-				thisPtr->m_readyHandler(FWU_Failed);
+				notifyReady(thisPtr, FWU_Failed);
 				thisPtr->m_state = STATE_Idle;
 			}
 			break;
@@ -474,7 +539,7 @@ void FwUpdate_handleXbus(FwUpdate* thisPtr, uint8_t const* xbusMessage)
 					{
 						LOG("Fwu: End of file --> Firmware update done\n");
 						sendFinished(thisPtr);
-						thisPtr->m_readyHandler(FWU_Success);
+						notifyReady(thisPtr, FWU_Success);
 						thisPtr->m_state = STATE_Idle;
 					}
 					else
@@ -487,7 +552,7 @@ void FwUpdate_handleXbus(FwUpdate* thisPtr, uint8_t const* xbusMessage)
 			else
 			{
 				LOG("Fwu: Got %s in STATE_WaitPageReady --> Failed\n", ackToString(ack));
-				thisPtr->m_readyHandler(FWU_Failed);
+				notifyReady(thisPtr, FWU_Failed);
 				thisPtr->m_state = STATE_Idle;
 			}
 			break;
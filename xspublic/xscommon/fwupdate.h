@@ -86,7 +86,7 @@ typedef enum
 
 /*!	\brief FwUpdate object definition
 */
-typedef struct
+typedef struct FwUpdate
 {
 	/*	External dependencies. Host should fill in these members */
 
@@ -113,6 +113,38 @@ typedef struct
 	*/
 	uint8_t* m_txBuffer;
 
+	/*	Optional settings. FwUpdate_init sets their defaults, the host may change them after calling FwUpdate_init */
+
+	/*!	\brief The complete xff file in memory. When set, the xff data is read from here instead of through
+		m_readXffData, which makes it possible to share a single copy between multiple FwUpdate instances
+	*/
+	uint8_t const* m_xffImage;
+
+	/*!	\brief The size of m_xffImage in bytes
+	*/
+	uint32_t m_xffImageSize;
+
+	/*!	\brief The maximum number of page slices that are sent before their FWUP_READY is received.
+		The default of 1 waits for each slice to be acknowledged. Larger values are only allowed when the receive
+		buffer of the bootloader can hold that many slices.
+	*/
+	uint8_t m_sliceWindow;
+
+	/*!	\brief Host defined pointer that is passed to m_sendXbusMessageCtx and m_readyHandlerCtx
+	*/
+	void* m_context;
+
+	/*!	\brief Alternative for m_sendXbusMessage that receives m_context, used instead of it when set
+	*/
+	void (*m_sendXbusMessageCtx)(void* context, uint8_t const* xbusMessage);
+
+	/*!	\brief Alternative for m_readyHandler that receives m_context, used instead of it when set
+	*/
+	void (*m_readyHandlerCtx)(void* context, FWU_Result result);
+
+	/*	Statistics, reset by FwUpdate_start */
+	uint32_t m_bytesSent;			/*!< The number of firmware bytes that were sent in page slices*/
+
 	/*	State variables for internal use (the user must not touch these) */
 	FWU_State m_state;				/*!< Internal state member of FwUpdate*/
 	XffHeader m_xffHeader;			/*!< Internal state member of FwUpdate*/
@@ -121,6 +153,7 @@ typedef struct
 	uint32_t m_pageCounter;			/*!< Internal state member of FwUpdate*/
 	uint32_t m_sliceCounter;		/*!< Internal state member of FwUpdate*/
 	uint32_t m_readIndex;			/*!< Internal state member of FwUpdate*/
+	uint32_t m_slicesInFlight;		/*!< Internal state member of FwUpdate*/
 	uint8_t m_endOfFile;			/*!< Internal state member of FwUpdate*/
 } FwUpdate;
 
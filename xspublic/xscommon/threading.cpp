@@ -34,6 +34,7 @@
 #include <signal.h>
 #include <time.h>
 #include <xstypes/xstime.h>
+#include <algorithm>
 
 #ifdef __GNUC__
 	#include <sys/time.h>
@@ -68,6 +69,7 @@ StandardThread::StandardThread()
 	, m_finished(false)
 #endif
 	, m_name(NULL)
+	, m_realTime()
 {
 #ifndef _WIN32
 	pthread_attr_init(&m_attr);
@@ -243,6 +245,68 @@ bool StandardThread::setPriority(XsThreadPriority pri)
 	return true;
 }
 
+/*! \brief Pin the thread to a processor and/or give it a real-time priority
+	\details The settings are remembered and applied again every time the thread starts, after initFunction() has
+	run, so they take precedence over the priority set by setPriority(). Real-time priorities usually require
+	elevated privileges, CAP_SYS_NICE or an rtprio limit on Linux. On Windows any real-time priority maps to
+	THREAD_PRIORITY_TIME_CRITICAL.
+	\param settings The settings to apply
+	\returns A combination of ThreadRealTimeResult flags, TRR_Failed without changing anything when the processor
+	number cannot be represented in an affinity mask
+*/
+int StandardThread::setRealTimeSettings(ThreadRealTimeSettings const& settings)
+{
+#ifdef _WIN32
+	if (settings.m_cpu >= (int)(sizeof(DWORD_PTR) * 8))
+		return TRR_Failed;
+#elif defined(__linux__)
+	if (settings.m_cpu >= CPU_SETSIZE)
+		return TRR_Failed;
+#endif
+
+	xsens::Lock lock(&m_realTimeMutex);
+	m_realTime = settings;
+	if (!isAlive())
+		return TRR_Pending;
+	return applyRealTimeSettings(m_thread, settings);
+}
+
+/*! \brief Apply \a settings to \a thread
+	\param thread The handle of the thread, which is either m_thread or the calling thread
+	\param settings The settings to apply, the processor number has been checked by setRealTimeSettings()
+	\returns A combination of ThreadRealTimeResult flags
+*/
+int StandardThread::applyRealTimeSettings(XsThread thread, ThreadRealTimeSettings const& settings)
+{
+	int rv = TRR_None;
+#ifdef _WIN32
+	if (settings.m_cpu >= 0)
+		rv |= (::SetThreadAffinityMask(thread, ((DWORD_PTR) 1) << settings.m_cpu) != 0) ? TRR_Pinned : TRR_Failed;
+	if (settings.m_priority > 0)
+		rv |= ::SetThreadPriority(thread, THREAD_PRIORITY_TIME_CRITICAL) ? TRR_RealTime : TRR_Failed;
+#elif defined(__linux__)
+	if (settings.m_cpu >= 0)
+	{
+		cpu_set_t cpus;
+		CPU_ZERO(&cpus);
+		CPU_SET(settings.m_cpu, &cpus);
+		rv |= (pthread_setaffinity_np(thread, sizeof(cpus), &cpus) == 0) ? TRR_Pinned : TRR_Failed;
+	}
+	if (settings.m_priority > 0)
+	{
+		int policy = settings.m_roundRobin ? SCHED_RR : SCHED_FIFO;
+		struct sched_param param;
+		param.sched_priority = std::min(std::max(settings.m_priority, sched_get_priority_min(policy)), sched_get_priority_max(policy));
+		rv |= (pthread_setschedparam(thread, policy, &param) == 0) ? TRR_RealTime : TRR_Failed;
+	}
+#else
+	(void) thread;
+	if (settings.m_cpu >= 0 || settings.m_priority > 0)
+		rv |= TRR_Failed;
+#endif
+	return rv;
+}
+
 /*! \brief Starts the thread
 	\param name The name of the thread as shown in the debugger, may be NULL in which case the system determines the name.
 	\returns True if successful
@@ -386,6 +450,17 @@ XSENS_THREAD_RETURN StandardThread::threadInit(void* obj)
 void StandardThread::threadMain(void)
 {
 	initFunction();
+	{
+		// holding the lock while applying prevents overwriting newer settings applied by setRealTimeSettings()
+		xsens::Lock lock(&m_realTimeMutex);
+		ThreadRealTimeSettings settings = m_realTime;
+		if (settings.m_cpu >= 0 || settings.m_priority > 0)
+#ifdef _WIN32
+			applyRealTimeSettings(::GetCurrentThread(), settings);
+#else
+			applyRealTimeSettings(pthread_self(), settings);
+#endif
+	}
 	do
 	{
 		int32_t rv = innerFunction();
@@ -42,6 +42,32 @@
 
 namespace xsens
 {
+/*! \brief Real-time scheduling settings for a StandardThread */
+struct ThreadRealTimeSettings
+{
+	int m_cpu;				//!< The processor to pin the thread to, -1 to leave the affinity unchanged
+	int m_priority;			//!< The real-time priority (1-99 on Linux), 0 to keep the normal scheduling
+	bool m_roundRobin;		//!< Use SCHED_RR instead of SCHED_FIFO
+
+	//! \brief Constructor, initializes to settings that change nothing
+	ThreadRealTimeSettings(int cpu = -1, int priority = 0, bool roundRobin = false)
+		: m_cpu(cpu)
+		, m_priority(priority)
+		, m_roundRobin(roundRobin)
+	{
+	}
+};
+
+/*! \brief Flags describing the result of StandardThread::setRealTimeSettings */
+enum ThreadRealTimeResult
+{
+	TRR_None		= 0,	//!< Nothing was applied
+	TRR_Pinned		= 1,	//!< The thread was pinned to the requested processor
+	TRR_RealTime	= 2,	//!< The real-time priority was applied
+	TRR_Pending		= 4,	//!< The thread is not running, the settings will be applied when it starts
+	TRR_Failed		= 8		//!< At least one of the requested settings could not be applied
+};
+
 /*!	\class StandardThread
 	\brief A class for a standard thread that has to perform the same action repeatedly.
 	\details The class has three virtual functions, of which the innerFunction is the most important.
@@ -72,7 +98,10 @@ private:
 private:
 #endif
 	char* m_name;
+	ThreadRealTimeSettings m_realTime;	//!< The settings applied when the thread starts, guarded by m_realTimeMutex
+	xsens::Mutex m_realTimeMutex;		//!< Serializes changing m_realTime with applying it
 	static XSENS_THREAD_RETURN threadInit(void* obj);
+	static int applyRealTimeSettings(XsThread thread, ThreadRealTimeSettings const& settings);
 	void threadMain(void);
 protected:
 	//! Virtual initialization function
@@ -102,6 +131,7 @@ public:
 	bool isAlive(void) volatile const noexcept;
 	bool isRunning(void) volatile const noexcept;
 	bool setPriority(XsThreadPriority pri);
+	int setRealTimeSettings(ThreadRealTimeSettings const& settings);
 	bool isTerminating() volatile const noexcept;
 
 	//! \returns The thread ID
@@ -39,13 +39,10 @@
 	#include <typeinfo>
 #endif
 
-#include <vector>
+#include <deque>
+#include <unordered_map>
 #include <xstypes/xsexception.h>
 #include "threading.h"
-#include <atomic>
-
-// Enable this if you want to disable multithreading
-//#define ADD_TASK_EXECUTE_NOW
 
 namespace xsens
 {
@@ -53,8 +50,6 @@ namespace xsens
 /////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////
 
-typedef std::map<unsigned int, std::shared_ptr<PooledTask>> TaskSet;
-typedef std::set<PooledThread*> ThreadSet;
 typedef std::vector<std::shared_ptr<PooledTask>> TaskList;
 
 /*! \brief Returns the number of processor cores in the current system
@@ -93,22 +88,37 @@ unsigned int ThreadPoolTask::needToWaitFor()
 /////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////
 
+/*! \brief The scheduling states of a PooledTask
+*/
+enum PooledTaskState
+{
+	PTS_Delayed,		//!< The task is waiting for one or more tasks to complete
+	PTS_Queued,			//!< The task is in a work queue
+	PTS_Executing,		//!< The task is being executed by a thread
+	PTS_Done			//!< The task completed or was canceled
+};
+
 /*! \brief A class that contains a task and some administrative stuff
+	\details Tasks that wait for this task are stored as continuations in m_dependentTasks and are released
+	when the task completes, so waiting tasks do not occupy the work queues.
 */
 class PooledTask
 {
 public:
 	ThreadPoolTask* m_task;		//!< The task that is to be executed
 	unsigned int m_id;			//!< The id that was assigned to the task by the ThreadPool
-	std::vector<std::shared_ptr<PooledTask>> m_dependentTasks;	//!< A list of tasks that are waiting for this task to complete
-	XsThreadId m_threadId;
-	volatile std::atomic<bool> m_canceling;
+	XsThreadId m_threadId;		//!< The thread that is executing the task or 0 if it is not executing
+	volatile std::atomic<bool> m_canceling;		//!< Set when the task was told to cancel itself
+	std::atomic<int> m_state;					//!< The PooledTaskState of the task
+	std::atomic<int> m_pendingDependencies;		//!< The number of tasks that need to complete before this task can be queued
 
 	PooledTask()
 		: m_task(nullptr)
 		, m_id(0)
 		, m_threadId(0)
 		, m_canceling(false)
+		, m_state(PTS_Delayed)
+		, m_pendingDependencies(0)
 		, m_completed(false)
 		, m_completedMutex()
 		, m_completedCondition(m_completedMutex)
@@ -135,18 +145,37 @@ public:
 		return m_completed;
 	}
 
-	void signalCompleted() noexcept
+	/*! \brief Add \a task as a continuation of this task
+		\returns False if this task has already completed, in which case \a task was not added
+	*/
+	bool addContinuation(std::shared_ptr<PooledTask> const& task)
+	{
+		Lock locker(&m_completedMutex);
+		if (m_completed)
+			return false;
+		m_dependentTasks.push_back(task);
+		return true;
+	}
+
+	/*! \brief Mark the task as completed and wake up any waiting threads
+		\returns The continuations of the task, which the caller should release
+	*/
+	TaskList signalCompleted() noexcept
 	{
+		TaskList dependents;
 		Lock locker(&m_completedMutex);
 		if (!m_completed)
 		{
 			m_completed = true;
+			dependents.swap(m_dependentTasks);
 			locker.unlock();
 			m_completedCondition.broadcast();
 		}
+		return dependents;
 	}
 
 private:
+	TaskList m_dependentTasks;	//!< A list of tasks that are waiting for this task to complete
 	volatile std::atomic_bool m_completed;
 	Mutex m_completedMutex;
 	WaitCondition m_completedCondition;
@@ -172,38 +201,169 @@ unsigned int ThreadPoolTask::taskId() const
 /////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////
 
+/*! \brief The work queue of a single PooledThread
+	\details The owning thread takes tasks from the front, other threads steal from the back.
+	The lock is only contended when a thread steals or a task is added from outside the pool.
+*/
+class ThreadPool::WorkQueue
+{
+public:
+	/*! \brief Add \a task to the back of the queue */
+	void push(std::shared_ptr<PooledTask> const& task)
+	{
+		Lock locker(&m_mutex);
+		m_tasks.push_back(task);
+	}
+
+	/*! \brief Remove and return the first task (\a front true) or last task (\a front false) or nullptr if the queue is empty */
+	std::shared_ptr<PooledTask> pop(bool front)
+	{
+		Lock locker(&m_mutex);
+		if (m_tasks.empty())
+			return std::shared_ptr<PooledTask>();
+		std::shared_ptr<PooledTask> task;
+		if (front)
+		{
+			task = m_tasks.front();
+			m_tasks.pop_front();
+		}
+		else
+		{
+			task = m_tasks.back();
+			m_tasks.pop_back();
+		}
+		return task;
+	}
+
+	/*! \brief Remove all tasks from the queue */
+	void clear()
+	{
+		Lock locker(&m_mutex);
+		m_tasks.clear();
+	}
+
+private:
+	Mutex m_mutex;
+	std::deque<std::shared_ptr<PooledTask>> m_tasks;
+};
+
+/*! \brief The tasks of a ThreadPool that have not completed yet, indexed by their id
+	\details The index is split into shards by id so that adding and completing tasks from different
+	threads rarely contends on the same lock.
+*/
+class ThreadPool::Registry
+{
+public:
+	/*! \brief Add \a task to the registry */
+	void insert(std::shared_ptr<PooledTask> const& task)
+	{
+		Shard& shard = m_shards[task->m_id % RegistryShardCount];
+		Lock locker(&shard.m_mutex);
+		shard.m_tasks[task->m_id] = task;
+	}
+
+	/*! \brief Remove the task with \a id from the registry */
+	void erase(TaskId id)
+	{
+		Shard& shard = m_shards[id % RegistryShardCount];
+		Lock locker(&shard.m_mutex);
+		shard.m_tasks.erase(id);
+	}
+
+	/*! \brief Return the task with \a id or nullptr if it is not in the registry */
+	std::shared_ptr<PooledTask> find(TaskId id)
+	{
+		Shard& shard = m_shards[id % RegistryShardCount];
+		Lock locker(&shard.m_mutex);
+		auto it = shard.m_tasks.find(id);
+		if (it == shard.m_tasks.end())
+			return std::shared_ptr<PooledTask>();
+		return it->second;
+	}
+
+	/*! \brief Return the number of tasks in the registry */
+	unsigned int size()
+	{
+		unsigned int total = 0;
+		for (auto& shard : m_shards)
+		{
+			Lock locker(&shard.m_mutex);
+			total += (unsigned int) shard.m_tasks.size();
+		}
+		return total;
+	}
+
+	/*! \brief Remove all tasks from the registry */
+	void clear()
+	{
+		for (auto& shard : m_shards)
+		{
+			std::unordered_map<TaskId, std::shared_ptr<PooledTask>> tmp;
+			Lock locker(&shard.m_mutex);
+			tmp.swap(shard.m_tasks);
+		}
+	}
+
+private:
+	struct Shard
+	{
+		Mutex m_mutex;
+		std::unordered_map<TaskId, std::shared_ptr<PooledTask>> m_tasks;
+	};
+	Shard m_shards[RegistryShardCount];
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////////////////
+
 /*! \brief A class that contains a thread that runs in a ThreadPool to execute tasks
-	\details These threads are created by the ThreadPool.
+	\details These threads are created by the ThreadPool. Each thread owns the work queue with the same index.
 */
 class PooledThread : public StandardThread
 {
 public:
-	PooledThread(ThreadPool* pool);
+	PooledThread(ThreadPool* pool, unsigned int queue);
 	~PooledThread();
 	bool isIdle() const;
 	bool isBusy() const;
 	unsigned int executedCount() const;
 	unsigned int completedCount() const;
 	unsigned int failedCount() const;
+	unsigned int stolenCount() const;
+	static PooledThread* current(ThreadPool* pool);
+	unsigned int queue() const;
 
 protected:
 	ThreadPool* m_pool;			//!< The pool that contains this thread
+	unsigned int m_queue;		//!< The index of the work queue owned by this thread
 	std::shared_ptr<PooledTask> m_task;			//!< The task that is currently being executed or NULL if the thread is idle
+	volatile std::atomic_bool m_busy;	//!< True while the thread is executing a task
 	unsigned int m_executed;	//!< The number of tasks that this thread has executed s o far, including incomplete tasks
 	unsigned int m_completed;	//!< The number of tasks that this thread has completed so far, excluding incomplete tasks
 	unsigned int m_failed;		//!< The number of tasks that this thread has failed to complete so far due to an exception
+	unsigned int m_stolen;		//!< The number of tasks that this thread has taken from the queues of other threads
 
+	void initFunction(void) override;
 	int32_t innerFunction(void) override;
 };
 
+namespace
+{
+	thread_local PooledThread* gCurrentPooledThread = nullptr;
+}
+
 /*! \brief Constructor */
-PooledThread::PooledThread(ThreadPool* pool)
+PooledThread::PooledThread(ThreadPool* pool, unsigned int queue)
 	: StandardThread()
 	, m_pool(pool)
+	, m_queue(queue)
 	, m_task(nullptr)
+	, m_busy(false)
 	, m_executed(0)
 	, m_completed(0)
 	, m_failed(0)
+	, m_stolen(0)
 {
 }
 
@@ -214,18 +374,54 @@ PooledThread::~PooledThread()
 	m_pool = nullptr;
 }
 
+/*! \brief Return the PooledThread of \a pool that is calling this function or nullptr if the caller is not a thread of \a pool
+*/
+PooledThread* PooledThread::current(ThreadPool* pool)
+{
+	if (gCurrentPooledThread && gCurrentPooledThread->m_pool == pool)
+		return gCurrentPooledThread;
+	return nullptr;
+}
+
+/*! \brief Return the index of the work queue owned by this thread */
+unsigned int PooledThread::queue() const
+{
+	return m_queue;
+}
+
+/*! \brief Registers the thread as the current pooled thread */
+void PooledThread::initFunction(void)
+{
+	gCurrentPooledThread = this;
+}
+
 /*! \brief The inner function of the pooled thread.
 
 	The function will do tasks until the ThreadPool no longer supplies any tasks, at which point
-	it will return with a sleep time of 1ms.
+	it will wait until new work is added.
 */
 int32_t PooledThread::innerFunction(void)
 {
-	if (!m_task)
-		m_task = m_pool->getNextTask();
-
-	while (m_task && !isTerminating())
+	while (!isTerminating())
 	{
+		// mark the thread busy before checking for work, so ThreadPool::suspend can't miss a task that is being started
+		m_busy = true;
+		bool stolen = false;
+		++m_pool->m_searching;
+		m_task = m_pool->getNextTask(m_queue, stolen);
+		--m_pool->m_searching;
+		if (!m_task)
+		{
+			m_busy = false;
+			break;
+		}
+
+		// there is more work and nobody else is looking for it, so get another thread to help
+		if (m_pool->m_queued && m_pool->m_searching == 0)
+			m_pool->wakeWorkers(false);
+		if (stolen)
+			++m_stolen;
+
 		m_task->m_threadId = getThreadId();
 		bool complete = false;
 		try
@@ -272,19 +468,22 @@ int32_t PooledThread::innerFunction(void)
 		else
 		{
 			m_task->m_threadId = 0;
-			m_pool->reportTaskPaused(m_task);
+			m_pool->reportTaskPaused(m_task, m_queue);
 		}
-
-		m_task = m_pool->getNextTask();
+		m_task.reset();
+		m_busy = false;
 	}
-	return 1;
+
+	if (!isTerminating())
+		m_pool->waitForWork();
+	return 0;
 }
 
 /*! \brief Return whether the thread is currently executing a task (false) or not (true)
 */
 bool PooledThread::isIdle() const
 {
-	return (m_task == nullptr);
+	return !m_busy;
 }
 
 /*! \brief Return whether the thread is currently executing a task (true) or not (false)
@@ -315,22 +514,47 @@ unsigned int PooledThread::failedCount() const
 	return m_failed;
 }
 
+/*! \brief Return the number of tasks that the thread took from the queues of other threads
+*/
+unsigned int PooledThread::stolenCount() const
+{
+	return m_stolen;
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////
 
 /*! \class ThreadPool
 	\brief This class creates and maintains a number of threads that can execute finite-length tasks
+	\details Each thread has its own work queue. Tasks added by a pooled thread go to the queue of that
+	thread, tasks added from outside the pool are distributed over the queues. A thread that runs out of
+	work steals tasks from the back of the queues of the other threads and sleeps when there is no work
+	at all.
+
+	A task that has to wait for other tasks is not queued until those tasks have completed, it is stored
+	as a continuation of the tasks it waits for instead.
 	\note See the test cases for examples on how to use the class
 */
 
 /*! \brief Construct a threadpool with a number of threads equal to the number of cores on the PC
 */
 ThreadPool::ThreadPool()
-	: m_nextId(1)
+	: m_queueCount(0)
+	, m_activeCount(0)
+	, m_nextQueue(0)
+	, m_registry(new Registry)
+	, m_wake(m_wakeMutex)
+	, m_sleeping(0)
+	, m_searching(0)
+	, m_waking(false)
+	, m_queued(0)
+	, m_nextId(1)
 	, m_suspended(false)
 	, m_terminating(false)
 {
+	for (auto& queue : m_queues)
+		queue = nullptr;
 	setPoolSize(0);
 }
 
@@ -341,21 +565,28 @@ ThreadPool::~ThreadPool()
 	m_terminating = true;
 	suspend(true);
 
-	// all threads should now be idle
-	m_tasks.clear();
-	m_tasksSearch.clear();
-	m_executing.clear();
-	m_delaying.clear();
-
 	try
 	{
-		for (ThreadSet::iterator it = m_threads.begin(); it != m_threads.end(); ++it)
-			delete *it;
+		for (auto thread : m_threads)
+			thread->signalStopThread();
+		wakeWorkers(true);
+		for (auto thread : m_threads)
+			delete thread;
 	}
 	catch (...)
 	{
 		// nothing much we can do about this...
 	}
+	m_threads.clear();
+
+	// all threads are now gone
+	for (auto& queue : m_queues)
+	{
+		delete queue.load();
+		queue = nullptr;
+	}
+	m_registry->clear();
+	delete m_registry;
 }
 
 /*! \brief Add a task to be executed by the threadpool
@@ -365,50 +596,126 @@ ThreadPool::~ThreadPool()
 	\returns The id of the task that was added or 0 if the task could not be added for some reason.
 */
 ThreadPool::TaskId ThreadPool::addTask(ThreadPoolTask* task, ThreadPool::TaskId afterId)
+{
+	std::vector<TaskId> afterIds;
+	if (afterId)
+		afterIds.push_back(afterId);
+	return addTask(task, afterIds);
+}
+
+/*! \brief Add a task to be executed by the threadpool after a number of other tasks have completed
+	\details The task is registered as a continuation of each task in \a afterIds and will be queued when the
+	last of them completes. Ids of tasks that do not exist (anymore) are ignored.
+	\param task The task object whose exec() function will be called
+	\param afterIds The ids of the tasks that should complete before the task is started
+
+	\returns The id of the task that was added or 0 if the task could not be added for some reason.
+*/
+ThreadPool::TaskId ThreadPool::addTask(ThreadPoolTask* task, std::vector<ThreadPool::TaskId> const& afterIds)
 {
 	assert(!m_terminating);
 	std::shared_ptr<PooledTask> tmp = std::make_shared<PooledTask>();
 	tmp->m_task = task;
-	Lock safety(&m_safe);
-	tmp->m_id = m_nextId;
 	task->m_container = tmp.get();
 
 	// determine next ID
-	if (!++m_nextId)
-		m_nextId = 1;
+	TaskId id = m_nextId++;
+	if (!id)
+		id = m_nextId++;
+	tmp->m_id = id;
 
-#ifndef ADD_TASK_EXECUTE_NOW
-	if (afterId)
+	// hold one dependency ourselves so the task can't be queued while the continuations are being added
+	tmp->m_pendingDependencies = 1;
+	m_registry->insert(tmp);
+
+	for (auto afterId : afterIds)
 	{
 		std::shared_ptr<PooledTask> after = findTask(afterId);
-		if (after)
-		{
-			after->m_dependentTasks.push_back(tmp);
-			m_delaying[tmp->m_id] = tmp;
-			return tmp->m_id;
-		}
+		if (!after)
+			continue;
+		++tmp->m_pendingDependencies;
+		if (!after->addContinuation(tmp))
+			--tmp->m_pendingDependencies;
 	}
+	releaseDependency(tmp);
 
-	m_tasks.push_back(tmp);
-	m_tasksSearch[tmp->m_id] = tmp;
-#else
-	task->exec();
-	task->signalCompleted();
-#endif
+	return id;
+}
+
+/*! \brief Called when one of the tasks that \a task waits for has completed, queues \a task when it was the last one
+*/
+void ThreadPool::releaseDependency(std::shared_ptr<PooledTask> const& task)
+{
+	if (--task->m_pendingDependencies)
+		return;
+
+	int expected = PTS_Delayed;
+	if (task->m_state.compare_exchange_strong(expected, PTS_Queued))
+	{
+		PooledThread* self = PooledThread::current(this);
+		enqueue(task, self ? (int) self->queue() : -1);
+	}
+}
+
+/*! \brief Add \a task to work queue \a queue or to the next queue in a round-robin fashion if \a queue is negative
+*/
+void ThreadPool::enqueue(std::shared_ptr<PooledTask> const& task, int queue)
+{
+	unsigned int active = m_activeCount;
+	if (queue < 0 || (unsigned int) queue >= m_queueCount)
+		queue = (int) (m_nextQueue++ % active);
+
+	m_queues[queue].load()->push(task);
+	++m_queued;
+
+	// a thread that is looking for work will find the task, otherwise wake one up
+	if (m_searching == 0)
+		wakeWorkers(false);
+}
+
+/*! \brief Wake up one sleeping thread, or all sleeping threads when \a all is true
+	\details A single thread is not signalled again until the previously signalled thread has woken up, so
+	adding many tasks while a thread is waking up does not cost a system call per task.
+*/
+void ThreadPool::wakeWorkers(bool all)
+{
+	if (m_sleeping == 0)
+		return;
+	if (m_waking.exchange(true) && !all)
+		return;
 
-	return tmp->m_id;
+	Lock locker(&m_wakeMutex);
+	if (all)
+		m_wake.broadcast();
+	else
+		m_wake.signal();
+}
+
+/*! \brief Called by PooledThread when it ran out of work, waits until work is added
+	\details The wait is bounded so the threads will recheck the queues periodically, but this should not
+	be necessary for normal operation.
+*/
+void ThreadPool::waitForWork()
+{
+	Lock locker(&m_wakeMutex);
+	++m_sleeping;
+	m_waking = false;
+	if (m_queued == 0 || m_suspended)
+		m_wake.wait(100);
+	m_waking = false;
+	--m_sleeping;
 }
 
 /*! \brief Return the number of tasks that are currently in the queue or being executed
 */
 unsigned int ThreadPool::count()
 {
-	Lock safety(&m_safe);
-	return (unsigned int)(m_tasks.size() + m_delaying.size() + m_executing.size());
+	return m_registry->size();
 }
 
 /*! \brief Set the number of threads in the ThreadPool
 	\param poolsize When 0 or less two threads will be created for each processor core in the system (with a minimum of 4 threads), otherwise the desired number of threads will be created
+	\note Tasks left in the queues of removed threads are still executed since the remaining threads steal from all queues
 */
 void ThreadPool::setPoolSize(unsigned int poolsize)
 {
@@ -418,31 +725,36 @@ void ThreadPool::setPoolSize(unsigned int poolsize)
 		//poolsize = ::std::max(4, pc*2);
 		poolsize = 12;	// fixed count to prevent thread starvation on low-core PCs and overthreading on high-core PCs
 	}
+	if (poolsize > MaxPoolSize)
+		poolsize = MaxPoolSize;
 
-	bool wasSuspended = m_suspended;
-	suspend(poolsize < m_threads.size());
 	Lock safety(&m_safe);
 
 	// reduce size if pool is too large
 	if (poolsize < m_threads.size())
 	{
+		m_activeCount = poolsize;
+		for (unsigned int i = poolsize; i < m_threads.size(); ++i)
+			m_threads[i]->signalStopThread();
+		wakeWorkers(true);
 		while (poolsize < m_threads.size())
 		{
-			auto it = m_threads.begin();
-			auto thread = *it;
-			safety.unlock();
-			thread->stopThread();
-			safety.lock();
-			delete thread;
-			m_threads.erase(it);
+			delete m_threads.back();
+			m_threads.pop_back();
 		}
 	}
 
 	// increase size if pool is too small
 	for (unsigned int i = (unsigned int) m_threads.size(); i < poolsize; ++i)
 	{
-		PooledThread* t = new PooledThread(this);
-		m_threads.insert(t);
+		if (i >= m_queueCount)
+		{
+			m_queues[i] = new WorkQueue;
+			m_queueCount = i + 1;
+		}
+
+		PooledThread* t = new PooledThread(this, i);
+		m_threads.push_back(t);
 #ifdef XSENS_DEBUG
 		char bufje[64];
 		sprintf(bufje, "Pooled Thread %p", t);
@@ -451,14 +763,13 @@ void ThreadPool::setPoolSize(unsigned int poolsize)
 #endif
 		if (!t->startThread(bufje))
 		{
-			m_threads.erase(m_threads.find(t));
+			m_threads.pop_back();
 			delete t;
+			m_activeCount = (unsigned int) m_threads.size();
 			throw XsException(XRV_ERROR, "Could not start thread for ThreadPool");
 		}
 	}
-
-	if (!wasSuspended)
-		resume();
+	m_activeCount = poolsize;
 }
 
 /*! \brief Return the number of threads in the pool */
@@ -471,34 +782,18 @@ unsigned int ThreadPool::poolSize() const
 */
 std::shared_ptr<PooledTask> ThreadPool::findTask(ThreadPool::TaskId id)
 {
-	Lock safety(&m_safe);
-	TaskSet::iterator it = m_executing.find(id);
-	if (it != m_executing.end())
-		return it->second;
-
-	it = m_delaying.find(id);
-	if (it != m_delaying.end())
-		return it->second;
-
-	it = m_tasksSearch.find(id);
-	if (it != m_tasksSearch.end())
-		return it->second;
-
-	for (auto const& tsk : m_tasks)
-		if (tsk->m_id == id)
-			return tsk;
-
-	return std::shared_ptr<PooledTask>();
+	if (!id)
+		return std::shared_ptr<PooledTask>();
+	return m_registry->find(id);
 }
 
 /*! \brief Find an XsThread with the specified \a id
 */
 XsThreadId ThreadPool::taskThreadId(TaskId id)
 {
-	Lock safety(&m_safe);
-	TaskSet::iterator it = m_executing.find(id);
-	if (it != m_executing.end())
-		return it->second->m_threadId;
+	std::shared_ptr<PooledTask> task = findTask(id);
+	if (task && task->m_state == PTS_Executing)
+		return task->m_threadId;
 	return 0;
 }
 
@@ -510,43 +805,28 @@ bool ThreadPool::doesTaskExist(ThreadPool::TaskId id)
 }
 
 /*! \brief Remove the task with the supplied \a id if it exists, waits for the task to be finished
+	\details A task that is not executing yet is completed immediately, which releases the tasks that wait for it.
+	A queued task is discarded by the thread that eventually takes it from its queue.
 */
 void ThreadPool::cancelTask(ThreadPool::TaskId id, bool wait) noexcept
 {
-	Lock safety(&m_safe);
-	TaskSet::iterator it = m_executing.find(id);
-	if (it != m_executing.end())
-	{
-		it->second->m_canceling = true;
-		safety.unlock();
-		if (wait)
-			waitForCompletion(id);
+	std::shared_ptr<PooledTask> task = findTask(id);
+	if (!task)
 		return;
-	}
-
-	it = m_delaying.find(id);
-	if (it != m_delaying.end())
-	{
-		reportTaskComplete(it->second);
-		m_delaying.erase(it);
-	}
 
-	it = m_tasksSearch.find(id);
-	if (it != m_tasksSearch.end())
+	task->m_canceling = true;
+	int state = task->m_state;
+	while (state == PTS_Delayed || state == PTS_Queued)
 	{
-		reportTaskComplete(it->second);
-		m_tasksSearch.erase(it);
-	}
-
-	for (auto tskIt = m_tasks.begin(); tskIt != m_tasks.end(); ++tskIt)
-	{
-		if ((*tskIt)->m_id == id)
+		if (task->m_state.compare_exchange_weak(state, PTS_Done))
 		{
-			reportTaskComplete(*tskIt);
-			m_tasks.erase(tskIt);
+			reportTaskComplete(task);
 			return;
 		}
 	}
+
+	if (state == PTS_Executing && wait)
+		task->waitForCompletion();
 }
 
 /*! \brief Wait for the task with the given ID to complete
@@ -559,81 +839,82 @@ void ThreadPool::waitForCompletion(ThreadPool::TaskId id)
 }
 
 /*! \brief Called by PooledThread to notify the ThreadPool that a task was completed
-	\note After this call, the supplied \a task is invalid
+	\details Removes the task from the registry and releases its continuations
 */
-void ThreadPool::reportTaskComplete(std::shared_ptr<PooledTask> task)
+void ThreadPool::reportTaskComplete(std::shared_ptr<PooledTask> const& task)
 {
-	Lock safety(&m_safe);
-
-	// remove task from 'executing' list
-	TaskSet::iterator it = m_executing.find(task->m_id);
-	if (it != m_executing.end())
-		m_executing.erase(it);
+	task->m_state = PTS_Done;
+	m_registry->erase(task->m_id);
 
 	// notify dependent tasks that their dependency has been fulfilled
-	for (TaskList::iterator dep = task->m_dependentTasks.begin(); dep != task->m_dependentTasks.end(); ++dep)
-	{
-		it = m_delaying.find((*dep)->m_id);
-		if (it != m_delaying.end())
-		{
-			m_tasks.push_back(it->second);
-			m_tasksSearch[it->second->m_id] = it->second;
-			m_delaying.erase(it);
-		}
-	}
-	task->signalCompleted();
+	TaskList dependents = task->signalCompleted();
+	for (auto const& dep : dependents)
+		releaseDependency(dep);
 }
 
 /*! \brief Return the next task that should be run and mark it as executing
+	\details The task is taken from the front of queue \a queue or, when that is empty, stolen from the back of one of the other queues.
+	Tasks that were canceled while queued are discarded.
+	\param queue The queue owned by the calling thread
+	\param stolen Set to true when the task was taken from another queue
 */
-std::shared_ptr<PooledTask> ThreadPool::getNextTask()
+std::shared_ptr<PooledTask> ThreadPool::getNextTask(unsigned int queue, bool& stolen)
 {
-	Lock safety(&m_safe);
-	if (!m_suspended && !m_tasks.empty())
+	if (m_suspended || m_queued == 0)
+		return std::shared_ptr<PooledTask>();
+
+	unsigned int queueCount = m_queueCount;
+	for (unsigned int i = 0; i < queueCount; ++i)
 	{
-		std::shared_ptr<PooledTask> tmp = m_tasks.front();
-		m_tasks.pop_front();
-		m_tasksSearch.erase(tmp->m_id);
-		m_executing[tmp->m_id] = tmp;
-		return tmp;
+		WorkQueue* q = m_queues[(queue + i) % queueCount];
+		while (true)
+		{
+			std::shared_ptr<PooledTask> task = q->pop(i == 0);
+			if (!task)
+				break;
+			--m_queued;
+
+			int expected = PTS_Queued;
+			if (task->m_state.compare_exchange_strong(expected, PTS_Executing))
+			{
+				stolen = (i != 0);
+				return task;
+			}
+		}
 	}
 
 	return std::shared_ptr<PooledTask>();
 }
 
 /*! \brief Called by PooledThread to notify the ThreadPool that its running task has to wait for something
-	\details This function can be called when the task failed to run to completion. It will be rescheduled
-	at the end of the queue and its exec function will be called again.
+	\details This function can be called when the task failed to run to completion. If the task needs to wait for
+	another task, it is added as a continuation of that task, otherwise it is rescheduled at the end of the queue
+	of the calling thread. In both cases its exec function will be called again.
 	To notify the threadpool, a task should return 'false' from its exec() function.
 	\param task The task that is to be paused
+	\param queue The queue owned by the calling thread
 	\note The task itself is responsible for maintaining its state between the exec calls
 	\note After calling this function the PooledThread should consider the supplied \a task as invalid since it's possible that it has been picked up, executed and deleted by another thread during the function return
 */
-void ThreadPool::reportTaskPaused(std::shared_ptr<PooledTask> task)
+void ThreadPool::reportTaskPaused(std::shared_ptr<PooledTask> const& task, unsigned int queue)
 {
-	Lock safety(&m_safe);
-
-	// remove task from 'executing' list
-	TaskSet::iterator it = m_executing.find(task->m_id);
-	if (it != m_executing.end())
-		m_executing.erase(it);
-
-	// add task back into either the delaying list if it should wait for something
 	unsigned int waitForId = task->m_task->needToWaitFor();
-	if (waitForId)
+	if (waitForId && waitForId != task->m_id)
 	{
 		std::shared_ptr<PooledTask> after = findTask(waitForId);
 		if (after)
 		{
-			after->m_dependentTasks.push_back(task);
-			m_delaying[task->m_id] = task;
+			task->m_pendingDependencies = 1;
+			task->m_state = PTS_Delayed;
+			if (!after->addContinuation(task))
+				releaseDependency(task);
 			return;
 		}
 	}
 
-	// add task into ready queue
-	m_tasks.push_back(task);
-	m_tasksSearch[task->m_id] = task;
+	// add task back into the ready queue
+	task->m_state = PTS_Queued;
+	enqueue(task, (int) queue);
 }
 
 /*! \brief Suspend execution of tasks, any currently executing tasks will run to completion,
@@ -643,15 +924,13 @@ void ThreadPool::reportTaskPaused(std::shared_ptr<PooledTask> task)
 */
 void ThreadPool::suspend(bool wait) noexcept
 {
-	Lock safety(&m_safe);
 	m_suspended = true;
 
 	if (wait)
 	{
-		safety.unlock();
-
-		for (ThreadSet::const_iterator it = m_threads.begin(); it != m_threads.end(); ++it)
-			while ((*it)->isBusy())
+		Lock safety(&m_safe);
+		for (auto thread : m_threads)
+			while (thread->isBusy())
 				xsYield();
 	}
 }
@@ -661,18 +940,16 @@ void ThreadPool::suspend(bool wait) noexcept
 */
 void ThreadPool::resume()
 {
-	Lock safety(&m_safe);
 	m_suspended = false;
+	wakeWorkers(true);
 }
 
 /*! \brief Return the number of tasks executed (including paused) by the given thread
 */
 unsigned int ThreadPool::executedCount(unsigned int thread) const
 {
-	unsigned int i = 0;
-	for (ThreadSet::const_iterator it = m_threads.begin(); it != m_threads.end(); ++it, ++i)
-		if (i == thread)
-			return (*it)->executedCount();
+	if (thread < m_threads.size())
+		return m_threads[thread]->executedCount();
 	return 0;
 }
 
@@ -680,10 +957,8 @@ unsigned int ThreadPool::executedCount(unsigned int thread) const
 */
 unsigned int ThreadPool::completedCount(unsigned int thread) const
 {
-	unsigned int i = 0;
-	for (ThreadSet::const_iterator it = m_threads.begin(); it != m_threads.end(); ++it, ++i)
-		if (i == thread)
-			return (*it)->completedCount();
+	if (thread < m_threads.size())
+		return m_threads[thread]->completedCount();
 	return 0;
 }
 
@@ -691,10 +966,17 @@ unsigned int ThreadPool::completedCount(unsigned int thread) const
 */
 unsigned int ThreadPool::failedCount(unsigned int thread) const
 {
-	unsigned int i = 0;
-	for (ThreadSet::const_iterator it = m_threads.begin(); it != m_threads.end(); ++it, ++i)
-		if (i == thread)
-			return (*it)->failedCount();
+	if (thread < m_threads.size())
+		return m_threads[thread]->failedCount();
+	return 0;
+}
+
+/*! \brief Return the number of tasks that the given thread took from the queues of other threads
+*/
+unsigned int ThreadPool::stolenCount(unsigned int thread) const
+{
+	if (thread < m_threads.size())
+		return m_threads[thread]->stolenCount();
 	return 0;
 }
 
@@ -769,6 +1051,8 @@ void ThreadPool::setPool(ThreadPool* pool)
 	\note If you want a thread outside the ThreadPool to wait for multiple tasks to complete, create a
 	TaskCompletionWaiter, schedule it and wait for the TaskCompletionWaiter to complete through
 	the ThreadPool::waitForCompletion function.
+	\note A task that only needs to wait for multiple tasks before it starts can also be added with
+	ThreadPool::addTask(ThreadPoolTask*, std::vector<TaskId> const&), which does not need a separate waiter task.
 */
 
 /*! \brief Constructor, sets up an empty waiter */
@@ -35,11 +35,10 @@
 
 #include "xsens_mutex.h"
 
-#include <map>
-#include <set>
-#include <deque>
+#include <vector>
 #include <list>
 #include <memory>
+#include <atomic>
 
 namespace xsens
 {
@@ -68,21 +67,37 @@ class ThreadPool
 {
 public:
 	typedef unsigned int TaskId;			//!< A type definition of a task ID
+	static const unsigned int MaxPoolSize = 256;	//!< The maximum number of threads in a pool
 
 private:
-	void reportTaskComplete(std::shared_ptr<PooledTask>);
-	void reportTaskPaused(std::shared_ptr<PooledTask>);
-	std::shared_ptr<PooledTask> getNextTask();
+	class WorkQueue;
+	class Registry;
+	static const unsigned int RegistryShardCount = 16;
+
+	void reportTaskComplete(std::shared_ptr<PooledTask> const& task);
+	void reportTaskPaused(std::shared_ptr<PooledTask> const& task, unsigned int queue);
+	std::shared_ptr<PooledTask> getNextTask(unsigned int queue, bool& stolen);
+	void enqueue(std::shared_ptr<PooledTask> const& task, int queue = -1);
+	void releaseDependency(std::shared_ptr<PooledTask> const& task);
+	void waitForWork();
+	void wakeWorkers(bool all);
 	friend class PooledThread;
 
-	std::set<PooledThread*> m_threads;
-	std::deque<std::shared_ptr<PooledTask>> m_tasks;
-	std::map<TaskId, std::shared_ptr<PooledTask>> m_tasksSearch;
-	std::map<TaskId, std::shared_ptr<PooledTask>> m_executing;
-	std::map<TaskId, std::shared_ptr<PooledTask>> m_delaying;
+	std::vector<PooledThread*> m_threads;
+	std::atomic<WorkQueue*> m_queues[MaxPoolSize];
+	volatile std::atomic<unsigned int> m_queueCount;
+	volatile std::atomic<unsigned int> m_activeCount;
+	std::atomic<unsigned int> m_nextQueue;
+	Registry* m_registry;
 	Mutex m_safe;
-	TaskId m_nextId;
-	bool m_suspended;
+	Mutex m_wakeMutex;
+	WaitCondition m_wake;
+	volatile std::atomic_int m_sleeping;
+	volatile std::atomic_int m_searching;
+	volatile std::atomic_bool m_waking;
+	volatile std::atomic_int m_queued;
+	std::atomic<TaskId> m_nextId;
+	volatile std::atomic_bool m_suspended;
 	volatile std::atomic_bool m_terminating;
 
 	std::shared_ptr<PooledTask> findTask(TaskId id);
@@ -93,6 +108,7 @@ protected:
 
 public:
 	TaskId addTask(ThreadPoolTask* task, TaskId afterId = 0);
+	TaskId addTask(ThreadPoolTask* task, std::vector<TaskId> const& afterIds);
 	unsigned int count();
 	void setPoolSize(unsigned int poolsize);
 	unsigned int poolSize() const;
@@ -104,6 +120,7 @@ public:
 	unsigned int executedCount(unsigned int thread) const;
 	unsigned int completedCount(unsigned int thread) const;
 	unsigned int failedCount(unsigned int thread) const;
+	unsigned int stolenCount(unsigned int thread) const;
 	XsThreadId taskThreadId(TaskId id);
 
 	static ThreadPool* instance() noexcept;
@@ -32,15 +32,119 @@
 
 #include "callbackmanagerxda.h"
 #include <xscommon/xsens_mutex.h>
+#include <xstypes/xsdatapacket.h>
+#include <xstypes/xsdatapacketptrarray.h>
+#include <vector>
+#include <memory>
+#include <atomic>
 
 using namespace xsens;
 
+/*! \brief The storage for the filtered packets that are passed to a handler with a data identifier filter */
+struct FilteredPacketStorage
+{
+	XsDataPacket m_packet;					//!< The projection of a single packet
+	std::vector<XsDataPacket> m_packets;	//!< The projections of a packet array
+	XsDataPacketPtrArray m_ptrs;			//!< The pointers into m_packets that are passed to the handler
+};
+
 /*! \brief Linked list item that contains a registered XsCallback handler for CallbackManagerXda
 */
 struct CallbackHandlerXdaItem
 {
+	CallbackHandlerXdaItem() : m_handler(NULL), m_next(NULL), m_storageInUse(false) {}
+
 	XsCallbackPlainC* m_handler;	//!< The callback handler
 	CallbackHandlerXdaItem* m_next;	//!< The next item in the list or NULL if this is the last item
+	std::vector<XsDataIdentifier> m_filter;	//!< The data identifiers delivered to the data callbacks of this handler, empty to deliver complete packets
+	FilteredPacketStorage m_storage;	//!< The storage for filtered packets, reused between dispatches
+	std::atomic_bool m_storageInUse;	//!< Set while a dispatch uses m_storage
+};
+
+/*! \brief Provides the filtered packets for a single dispatch to a handler
+	\details The storage of the handler item is reused while it is not in use, so dispatching a stream of packets
+	to a filtered handler does not allocate memory once the storage has been filled. Concurrent dispatches from
+	other threads and nested dispatches from within the handler fall back to temporary storage.
+	Unfiltered handlers receive the original packets.
+*/
+class FilteredDispatch
+{
+public:
+	//! \brief Prepare a dispatch to \a item
+	explicit FilteredDispatch(CallbackHandlerXdaItem* item)
+		: m_item(item)
+		, m_claimed(false)
+	{
+	}
+
+	//! \brief Release the storage of the handler item
+	~FilteredDispatch()
+	{
+		if (m_claimed)
+			m_item->m_storageInUse.store(false, std::memory_order_release);
+	}
+
+	/*! \brief Returns \a packet or, when the handler has a data identifier filter, a projection of \a packet
+		\param packet The packet to filter
+		\returns The packet that should be passed to the handler, valid until this object is destroyed
+	*/
+	XsDataPacket const* filter(XsDataPacket const* packet)
+	{
+		if (m_item->m_filter.empty() || !packet)
+			return packet;
+
+		FilteredPacketStorage& st = storage();
+		st.m_packet.copySelection(*packet, m_item->m_filter.data(), m_item->m_filter.size());
+		return &st.m_packet;
+	}
+
+	/*! \brief Returns \a packets or, when the handler has a data identifier filter, projections of \a packets
+		\param packets The packets to filter
+		\returns The packet array that should be passed to the handler, valid until this object is destroyed
+	*/
+	XsDataPacketPtrArray const* filter(XsDataPacketPtrArray const* packets)
+	{
+		if (m_item->m_filter.empty() || !packets)
+			return packets;
+
+		FilteredPacketStorage& st = storage();
+		if (st.m_packets.size() < packets->size())
+			st.m_packets.resize(packets->size());
+		st.m_ptrs.resize(packets->size());
+		for (XsSize i = 0; i < packets->size(); ++i)
+		{
+			XsDataPacket const* src = (*packets)[i];
+			if (src)
+			{
+				st.m_packets[i].copySelection(*src, m_item->m_filter.data(), m_item->m_filter.size());
+				st.m_ptrs[i] = &st.m_packets[i];
+			}
+			else
+				st.m_ptrs[i] = nullptr;
+		}
+		return &st.m_ptrs;
+	}
+
+private:
+	//! \brief Claim the storage of the handler item or create temporary storage when it is in use
+	FilteredPacketStorage& storage()
+	{
+		if (m_claimed)
+			return m_item->m_storage;
+		if (m_temporary)
+			return *m_temporary;
+		if (!m_item->m_storageInUse.exchange(true, std::memory_order_acquire))
+		{
+			m_claimed = true;
+			return m_item->m_storage;
+		}
+		m_temporary.reset(new FilteredPacketStorage);
+		return *m_temporary;
+	}
+
+	CallbackHandlerXdaItem* m_item;
+	bool m_claimed;
+	std::unique_ptr<FilteredPacketStorage> m_temporary;
 };
 
 /*! \brief Linked list item that contains a chained CallbackManagerXda
@@ -208,6 +312,50 @@ void CallbackManagerXda::removeCallbackHandler(XsCallbackPlainC* cb, bool chain)
 	}
 }
 
+/*! \brief Restrict the data delivered to a handler to the items in \a ids
+	\details After this call the data callbacks (onDataAvailable, onLiveDataAvailable, onBufferedDataAvailable,
+	onRecordedDataAvailable and their 'All' counterparts) of \a cb receive packets that only contain the items listed
+	in \a ids. Items are matched using XDI_FullTypeMask, so the data format of an identifier is ignored. Other handlers,
+	the device itself and any log file still receive the complete packets.
+	\param cb The handler to set the filter for, it must have been added with addCallbackHandler()
+	\param ids The data identifiers to deliver, may be NULL when \a count is 0
+	\param count The number of items in \a ids, supply 0 to remove the filter
+	\param chain When set to true (default) the filter is applied to chained managers as well
+	\note If \a cb is not found in the list or if \a cb is NULL, the list is not changed, but
+			chaining is still done.
+*/
+void CallbackManagerXda::setCallbackHandlerFilter(XsCallbackPlainC* cb, XsDataIdentifier const* ids, XsSize count, bool chain)
+{
+	if (!cb)
+		return;
+
+	LockReadWrite locky(m_callbackMutex, LS_Write);
+
+	if (chain)
+	{
+		CallbackManagerItem* current = m_managerList;
+		while (current)
+		{
+			current->m_manager->setCallbackHandlerFilter(cb, ids, count, true);
+			current = current->m_next;
+		}
+	}
+
+	CallbackHandlerXdaItem* current = m_handlerList;
+	while (current)
+	{
+		if (current->m_handler == cb)
+		{
+			if (count)
+				current->m_filter.assign(ids, ids + count);
+			else
+				current->m_filter.clear();
+			return;
+		}
+		current = current->m_next;
+	}
+}
+
 /*! \brief Clear the chained manager list
 */
 void CallbackManagerXda::clearChainedManagers()
@@ -310,6 +458,8 @@ void CallbackManagerXda::copyCallbackHandlersFrom(CallbackManagerXda* cm, bool c
 	while (current)
 	{
 		addCallbackHandler(current->m_handler, chain);
+		if (!current->m_filter.empty())
+			setCallbackHandlerFilter(current->m_handler, current->m_filter.data(), current->m_filter.size(), chain);
 		current = current->m_next;
 	}
 }
@@ -335,7 +485,10 @@ void CallbackManagerXda::onLiveDataAvailable(XsDevice* dev, const XsDataPacket*
 	while (current)
 	{
 		if (current->m_handler->m_onLiveDataAvailable)
-			current->m_handler->m_onLiveDataAvailable(current->m_handler, dev, packet);
+		{
+			FilteredDispatch dispatch(current);
+			current->m_handler->m_onLiveDataAvailable(current->m_handler, dev, dispatch.filter(packet));
+		}
 		current = current->m_next;
 	}
 }
@@ -348,7 +501,10 @@ void CallbackManagerXda::onAllLiveDataAvailable(XsDevicePtrArray* devs, const Xs
 	while (current)
 	{
 		if (current->m_handler->m_onAllLiveDataAvailable)
-			current->m_handler->m_onAllLiveDataAvailable(current->m_handler, devs, packets);
+		{
+			FilteredDispatch dispatch(current);
+			current->m_handler->m_onAllLiveDataAvailable(current->m_handler, devs, dispatch.filter(packets));
+		}
 		current = current->m_next;
 	}
 }
@@ -428,7 +584,10 @@ void CallbackManagerXda::onBufferedDataAvailable(XsDevice* dev, const XsDataPack
 	while (current)
 	{
 		if (current->m_handler->m_onBufferedDataAvailable)
-			current->m_handler->m_onBufferedDataAvailable(current->m_handler, dev, data);
+		{
+			FilteredDispatch dispatch(current);
+			current->m_handler->m_onBufferedDataAvailable(current->m_handler, dev, dispatch.filter(data));
+		}
 		current = current->m_next;
 	}
 }
@@ -441,7 +600,10 @@ void CallbackManagerXda::onAllBufferedDataAvailable(XsDevicePtrArray* devs, cons
 	while (current)
 	{
 		if (current->m_handler->m_onAllBufferedDataAvailable)
-			current->m_handler->m_onAllBufferedDataAvailable(current->m_handler, devs, packets);
+		{
+			FilteredDispatch dispatch(current);
+			current->m_handler->m_onAllBufferedDataAvailable(current->m_handler, devs, dispatch.filter(packets));
+		}
 		current = current->m_next;
 	}
 }
@@ -545,7 +707,10 @@ void CallbackManagerXda::onDataAvailable(XsDevice* dev, const XsDataPacket* pack
 	while (current)
 	{
 		if (current->m_handler->m_onDataAvailable)
-			current->m_handler->m_onDataAvailable(current->m_handler, dev, packet);
+		{
+			FilteredDispatch dispatch(current);
+			current->m_handler->m_onDataAvailable(current->m_handler, dev, dispatch.filter(packet));
+		}
 		current = current->m_next;
 	}
 }
@@ -558,7 +723,10 @@ void CallbackManagerXda::onAllDataAvailable(XsDevicePtrArray* devs, const XsData
 	while (current)
 	{
 		if (current->m_handler->m_onAllDataAvailable)
-			current->m_handler->m_onAllDataAvailable(current->m_handler, devs, packets);
+		{
+			FilteredDispatch dispatch(current);
+			current->m_handler->m_onAllDataAvailable(current->m_handler, devs, dispatch.filter(packets));
+		}
 		current = current->m_next;
 	}
 }
@@ -571,7 +739,10 @@ void CallbackManagerXda::onRecordedDataAvailable(XsDevice* dev, const XsDataPack
 	while (current)
 	{
 		if (current->m_handler->m_onRecordedDataAvailable)
-			current->m_handler->m_onRecordedDataAvailable(current->m_handler, dev, packet);
+		{
+			FilteredDispatch dispatch(current);
+			current->m_handler->m_onRecordedDataAvailable(current->m_handler, dev, dispatch.filter(packet));
+		}
 		current = current->m_next;
 	}
 }
@@ -584,7 +755,10 @@ void CallbackManagerXda::onAllRecordedDataAvailable(XsDevicePtrArray* devs, cons
 	while (current)
 	{
 		if (current->m_handler->m_onAllRecordedDataAvailable)
-			current->m_handler->m_onAllRecordedDataAvailable(current->m_handler, devs, packets);
+		{
+			FilteredDispatch dispatch(current);
+			current->m_handler->m_onAllRecordedDataAvailable(current->m_handler, devs, dispatch.filter(packets));
+		}
 		current = current->m_next;
 	}
 }
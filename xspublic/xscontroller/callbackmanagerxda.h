@@ -34,6 +34,7 @@
 #define CALLBACKMANAGERXDA_H
 
 #include "xscallback.h"
+#include <xstypes/xsdataidentifier.h>
 
 struct CallbackHandlerXdaItem;
 struct CallbackManagerItem;
@@ -76,6 +77,7 @@ public:
 	void clearCallbackHandlers(bool chain = true);
 	void addCallbackHandler(XsCallbackPlainC* cb, bool chain = true);
 	void removeCallbackHandler(XsCallbackPlainC* cb, bool chain = true);
+	void setCallbackHandlerFilter(XsCallbackPlainC* cb, XsDataIdentifier const* ids, XsSize count, bool chain = true);
 
 	void clearChainedManagers();
 	void addChainedManager(CallbackManagerXda* cm);
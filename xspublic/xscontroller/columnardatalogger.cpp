@@ -0,0 +1,336 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+#include "columnardatalogger.h"
+#include "iointerfacefile.h"
+#include <xstypes/xsdatapacket.h>
+
+/*! \brief Constructor
+	\param chunkRecords The number of records per chunk
+*/
+ColumnarDataLogger::ColumnarDataLogger(XsSize chunkRecords)
+	: m_chunkRecords(chunkRecords ? chunkRecords : defaultChunkRecords)
+	, m_lastResult(XRV_OK)
+	, m_recordCount(0)
+	, m_writeOffset(0)
+{
+	m_pending.m_recordCount = 0;
+	m_pending.m_firstRecord = 0;
+}
+
+ColumnarDataLogger::~ColumnarDataLogger()
+{
+	try
+	{
+		close(false);
+	}
+	catch (...)
+	{
+	}
+}
+
+//! \returns The type of logger
+DataLogger::Type ColumnarDataLogger::loggerType()
+{
+	return Type::Columnar;
+}
+
+/*! \brief Create a columnar log file and start the background writer thread
+	\param filename The name of the file to create. It is recommended to use a fully qualified path+filename.
+	\returns True if successful
+	\see close
+*/
+bool ColumnarDataLogger::create(const XsString& filename)
+{
+	xsens::Lock locky(&m_mutex);
+	if (m_ioInterfaceFile)
+	{
+		m_lastResult = XRV_ALREADYOPEN;
+		return false;
+	}
+
+	m_ioInterfaceFile = std::shared_ptr<IoInterfaceFile>(new IoInterfaceFile);
+	m_lastResult = m_ioInterfaceFile->create(filename);
+	if (m_lastResult == XRV_OK)
+	{
+		uint8_t header[ColumnarFormat::fileHeaderSize];
+		ColumnarFormat::writeFileHeader(header);
+		m_lastResult = m_ioInterfaceFile->writeData(XsByteArray(header, sizeof(header), XSDF_None), nullptr);
+		if (m_lastResult != XRV_OK)
+			m_ioInterfaceFile->closeAndDelete();
+	}
+	if (m_lastResult != XRV_OK)
+	{
+		m_ioInterfaceFile.reset();
+		return false;
+	}
+
+	m_writeOffset = ColumnarFormat::fileHeaderSize;
+	m_recordCount = 0;
+	m_pending.m_records.clear();
+	m_pending.m_recordCount = 0;
+	m_pending.m_firstRecord = 0;
+	m_index.clear();
+	m_queuedEvent.reset();
+	startThread("ColumnarDataLogger");
+	return true;
+}
+
+/*! \brief Closes the file
+*/
+void ColumnarDataLogger::close()
+{
+	close(false);
+}
+
+/*! \brief Closes and if requested deletes the file
+	\details Unless the file is deleted, the records that were not written yet are written and the chunk index is
+	appended to the file.
+	\param deleteFile If set to true then deletes the file
+*/
+void ColumnarDataLogger::close(bool deleteFile)
+{
+	{
+		xsens::Lock locky(&m_mutex);
+		if (!m_ioInterfaceFile)
+			return;
+		if (deleteFile)
+			m_queue.clear();
+		else if (m_pending.m_recordCount)
+			queuePending();
+	}
+
+	stopThread();
+
+	if (deleteFile)
+		m_ioInterfaceFile->closeAndDelete();
+	else
+	{
+		writeQueued();
+
+		xsens::Lock locky(&m_writeMutex);
+		std::vector<uint8_t> index;
+		ColumnarFormat::writeIndex(m_index, m_writeOffset, index);
+		XsResultValue result = m_ioInterfaceFile->writeData(XsByteArray(index.data(), index.size(), XSDF_None), nullptr);
+		if (result != XRV_OK)
+		{
+			xsens::Lock resultLock(&m_mutex);
+			m_lastResult = result;
+		}
+		m_ioInterfaceFile->close();
+	}
+
+	xsens::Lock locky(&m_mutex);
+	m_ioInterfaceFile.reset();
+	m_queue.clear();
+	m_pending.m_records.clear();
+	m_pending.m_recordCount = 0;
+}
+
+/*! \returns The name of the file that we're logging to (if any)
+*/
+XsString ColumnarDataLogger::filename() const
+{
+	xsens::Lock locky(&m_mutex);
+	if (!m_ioInterfaceFile)
+		return XsString();
+	return m_ioInterfaceFile->getFileName();
+}
+
+/*! \returns The result of the last operation, including failures of the background writer thread
+*/
+XsResultValue ColumnarDataLogger::lastResult() const
+{
+	xsens::Lock locky(&m_mutex);
+	return m_lastResult;
+}
+
+/*! \brief Write a message to the logging stream
+	\details The message is copied into the current chunk, the chunk is written by the background thread.
+*/
+bool ColumnarDataLogger::writeMessage(const XsMessage& message)
+{
+	return append(ColumnarFormat::RT_Message, message.getMessageStart(), message.getTotalMessageSize());
+}
+
+/*! \brief Write precomposed raw data to the file stream
+	\details Data that consists of exactly one valid message is logged as that message, so MtData2 messages that are
+	logged this way are still stored per column.
+*/
+bool ColumnarDataLogger::writeRaw(const XsByteArray& raw)
+{
+	if (raw.size() >= XS_LEN_MSGHEADERCS && raw[0] == XS_PREAMBLE)
+	{
+		XsMessage message(raw.data(), raw.size());
+		if (message.getTotalMessageSize() == raw.size() && message.isChecksumOk())
+			return append(ColumnarFormat::RT_Message, raw.data(), raw.size());
+	}
+	return append(ColumnarFormat::RT_Raw, raw.data(), raw.size());
+}
+
+/*! \brief Write a data packet to the logging stream */
+bool ColumnarDataLogger::writeDataPacket(const XsDataPacket& packet)
+{
+	return writeMessage(packet.toMessage());
+}
+
+/*! \brief Add a record to the current chunk and hand the chunk to the background thread when it is full */
+bool ColumnarDataLogger::append(ColumnarFormat::RecordType type, uint8_t const* data, XsSize size)
+{
+	xsens::Lock locky(&m_mutex);
+	if (!m_ioInterfaceFile)
+	{
+		m_lastResult = XRV_NOFILEOPEN;
+		return false;
+	}
+	if (m_lastResult != XRV_OK)
+		return false;
+
+	if (m_pending.m_recordCount == 0)
+		m_pending.m_firstRecord = m_recordCount;
+	ColumnarFormat::appendRecord(m_pending.m_records, type, data, size);
+	++m_pending.m_recordCount;
+	++m_recordCount;
+
+	if (m_pending.m_recordCount >= m_chunkRecords)
+		queuePending();
+	return true;
+}
+
+/*! \brief Move the current chunk to the queue of the background thread
+	\details When the queue is full, this waits until the background thread has written a chunk.
+	\note m_mutex must be locked exactly once by the caller
+*/
+void ColumnarDataLogger::queuePending()
+{
+	while (m_queue.size() >= maxQueuedChunks && isAlive() && !isTerminating())
+	{
+		m_writtenEvent.reset();
+		m_mutex.releaseMutex();
+		m_writtenEvent.wait();
+		m_mutex.claimMutex();
+	}
+
+	m_queue.push_back(PendingChunk());
+	std::swap(m_queue.back(), m_pending);
+
+	if (!m_spareBuffers.empty())
+	{
+		std::swap(m_pending.m_records, m_spareBuffers.back());
+		m_spareBuffers.pop_back();
+	}
+	m_pending.m_records.clear();
+	m_pending.m_recordCount = 0;
+	m_queuedEvent.set();
+}
+
+/*! \brief Write all queued chunks to the file */
+void ColumnarDataLogger::writeQueued()
+{
+	xsens::Lock writeLock(&m_writeMutex);
+	xsens::Lock locky(&m_mutex);
+	while (!m_queue.empty())
+	{
+		PendingChunk chunk;
+		std::swap(chunk, m_queue.front());
+		m_queue.pop_front();
+		locky.unlock();
+
+		writeChunk(chunk);
+
+		locky.lock();
+		if (m_spareBuffers.size() < maxQueuedChunks)
+			m_spareBuffers.push_back(std::move(chunk.m_records));
+		m_writtenEvent.set();
+	}
+}
+
+/*! \brief Encode, compress and write a chunk
+	\note m_writeMutex must be locked by the caller
+*/
+void ColumnarDataLogger::writeChunk(PendingChunk const& chunk)
+{
+	ColumnarFormat::encodeChunk(chunk.m_records, chunk.m_recordCount, m_body);
+	ColumnarFormat::compress(m_body.data(), m_body.size(), m_stored);
+
+	ColumnarFormat::ChunkHeader header;
+	header.m_recordCount = (uint32_t) chunk.m_recordCount;
+	header.m_bodySize = (uint32_t) m_body.size();
+	header.m_flags = ColumnarFormat::chunkCompressed;
+	header.m_firstRecord = chunk.m_firstRecord;
+	std::vector<uint8_t> const* stored = &m_stored;
+	if (m_stored.size() >= m_body.size())
+	{
+		header.m_flags = 0;
+		stored = &m_body;
+	}
+	header.m_storedSize = (uint32_t) stored->size();
+	header.m_crc = ColumnarFormat::crc32(stored->data(), stored->size());
+
+	uint8_t headerData[ColumnarFormat::chunkHeaderSize];
+	ColumnarFormat::writeChunkHeader(header, headerData);
+	XsResultValue result = m_ioInterfaceFile->writeData(XsByteArray(headerData, sizeof(headerData), XSDF_None), nullptr);
+	if (result == XRV_OK)
+		result = m_ioInterfaceFile->writeData(XsByteArray(const_cast<uint8_t*>(stored->data()), stored->size(), XSDF_None), nullptr);
+
+	if (result != XRV_OK)
+	{
+		xsens::Lock locky(&m_mutex);
+		m_lastResult = result;
+		return;
+	}
+
+	ColumnarFormat::IndexEntry entry;
+	entry.m_offset = m_writeOffset;
+	entry.m_firstRecord = chunk.m_firstRecord;
+	entry.m_recordCount = (uint32_t) chunk.m_recordCount;
+	m_index.push_back(entry);
+	m_writeOffset += sizeof(headerData) + stored->size();
+}
+
+/*! \brief Write the queued chunks when the logging thread signals that a chunk is available */
+int32_t ColumnarDataLogger::innerFunction()
+{
+	if (!m_queuedEvent.wait())
+		return 1;
+
+	// reset before taking chunks from the queue, so a chunk that is queued after the last check sets the event again
+	m_queuedEvent.reset();
+	writeQueued();
+	return 0;
+}
+
+/*! \brief Wake up the background thread so it notices that it should stop */
+void ColumnarDataLogger::signalStopThread(void)
+{
+	StandardThread::signalStopThread();
+	m_queuedEvent.set();
+}
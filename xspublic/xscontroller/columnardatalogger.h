@@ -0,0 +1,116 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+#ifndef COLUMNARDATALOGGER_H
+#define COLUMNARDATALOGGER_H
+
+#include "datalogger.h"
+#include "columnarformat.h"
+#include <xscommon/threading.h>
+#include <xstypes/xsresultvalue.h>
+#include <deque>
+#include <memory>
+#include <vector>
+
+class IoInterfaceFile;
+
+/*! \class ColumnarDataLogger
+	\brief A data logger that writes the compact columnar format described by ColumnarFormat
+	\details Messages are collected into chunks of chunkRecords() records. Full chunks are encoded, compressed and
+	written by a background thread, so the thread that logs the data only copies the message bytes. When the
+	background thread falls more than maxQueuedChunks chunks behind, the logging thread waits for it.
+	Use ColumnarLogReader to read the file.
+*/
+class ColumnarDataLogger : public DataLogger, protected xsens::StandardThread
+{
+public:
+	//! \brief The default for chunkRecords()
+	static const XsSize defaultChunkRecords = 4096;
+	//! \brief The maximum number of full chunks that can wait for the background thread
+	static const XsSize maxQueuedChunks = 4;
+
+	explicit ColumnarDataLogger(XsSize chunkRecords = defaultChunkRecords);
+	~ColumnarDataLogger() override;
+
+	bool writeMessage(const XsMessage& message) override;
+	bool writeRaw(const XsByteArray& message) override;
+	bool writeDataPacket(const XsDataPacket& packet) override;
+
+	Type loggerType() override;
+
+	bool create(const XsString& filename);
+	void close() override;
+	void close(bool deleteFile);
+	XsString filename() const;
+	XsResultValue lastResult() const;
+
+	//! \returns The number of records per chunk
+	inline XsSize chunkRecords() const
+	{
+		return m_chunkRecords;
+	}
+
+protected:
+	int32_t innerFunction() override;
+	void signalStopThread(void) override;
+
+private:
+	//! \brief A full chunk that waits to be written
+	struct PendingChunk
+	{
+		std::vector<uint8_t> m_records;		//!< The records, see ColumnarFormat::appendRecord
+		XsSize m_recordCount;				//!< The number of records
+		uint64_t m_firstRecord;				//!< The index of the first record in the file
+	};
+
+	bool append(ColumnarFormat::RecordType type, uint8_t const* data, XsSize size);
+	void queuePending();
+	void writeChunk(PendingChunk const& chunk);
+	void writeQueued();
+
+	XsSize m_chunkRecords;
+	std::shared_ptr<IoInterfaceFile> m_ioInterfaceFile;
+	mutable xsens::Mutex m_mutex;					//!< Guards the members below
+	XsResultValue m_lastResult;
+	PendingChunk m_pending;							//!< The chunk that is being filled
+	uint64_t m_recordCount;							//!< The number of records that were written
+	std::deque<PendingChunk> m_queue;				//!< The full chunks that wait for the background thread
+	std::vector<ColumnarFormat::IndexEntry> m_index;	//!< The chunks that were written, written as index on close
+	uint64_t m_writeOffset;							//!< The file offset of the next chunk
+	xsens::Mutex m_writeMutex;						//!< Serializes writing chunks to the file
+	xsens::WaitEvent m_queuedEvent;					//!< Set when a chunk was added to m_queue
+	xsens::WaitEvent m_writtenEvent;				//!< Set when a chunk was taken from m_queue and written
+	std::vector<uint8_t> m_body;					//!< Scratch buffer for the encoded chunk body
+	std::vector<uint8_t> m_stored;					//!< Scratch buffer for the compressed chunk body
+	std::vector<std::vector<uint8_t>> m_spareBuffers;	//!< Record buffers of written chunks, kept to reuse their memory
+};
+
+#endif
@@ -0,0 +1,1001 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+#include "columnarformat.h"
+#include <xstypes/xsdataidentifier.h>
+#include <xstypes/xsmessage.h>
+#include <xstypes/xsxbusmessageid.h>
+#include <string.h>
+#include <map>
+#include <string>
+
+namespace
+{
+//! \brief The magic text at the start of the file
+static const char fileMagic[8] = { 'X', 'S', 'C', 'O', 'L', 'L', 'O', 'G' };
+
+//! \brief The stream kinds in a chunk body
+enum StreamKind {
+	SK_Layout = 0,		//!< MtData2 messages with a fixed layout, stored per column
+	SK_Opaque = 1		//!< Records that are stored as-is
+};
+
+//! \brief The per-column transformations
+enum ColumnMode {
+	CM_Raw = 0,			//!< The values themselves
+	CM_Delta = 1,		//!< The difference with the previous value
+	CM_Xor = 2			//!< The XOR with the previous value
+};
+
+//! \brief The maximum number of streams in a chunk, the stream index column stores 16 bit indices
+static const XsSize maxStreamCount = 0xFFFF;
+
+inline void store16(uint8_t* dest, uint16_t value)
+{
+	dest[0] = (uint8_t) value;
+	dest[1] = (uint8_t)(value >> 8);
+}
+
+inline void store32(uint8_t* dest, uint32_t value)
+{
+	for (int i = 0; i < 4; ++i)
+		dest[i] = (uint8_t)(value >> (8 * i));
+}
+
+inline void store64(uint8_t* dest, uint64_t value)
+{
+	for (int i = 0; i < 8; ++i)
+		dest[i] = (uint8_t)(value >> (8 * i));
+}
+
+inline uint16_t load16(uint8_t const* src)
+{
+	return (uint16_t)(src[0] | (src[1] << 8));
+}
+
+inline uint32_t load32(uint8_t const* src)
+{
+	uint32_t value = 0;
+	for (int i = 3; i >= 0; --i)
+		value = (value << 8) | src[i];
+	return value;
+}
+
+inline uint64_t load64(uint8_t const* src)
+{
+	uint64_t value = 0;
+	for (int i = 7; i >= 0; --i)
+		value = (value << 8) | src[i];
+	return value;
+}
+
+inline void append16(std::vector<uint8_t>& dest, uint16_t value)
+{
+	XsSize pos = dest.size();
+	dest.resize(pos + 2);
+	store16(&dest[pos], value);
+}
+
+inline void append32(std::vector<uint8_t>& dest, uint32_t value)
+{
+	XsSize pos = dest.size();
+	dest.resize(pos + 4);
+	store32(&dest[pos], value);
+}
+
+//! \brief A reader for a chunk body that checks each access against the end of the body
+class BodyReader
+{
+public:
+	BodyReader(uint8_t const* data, XsSize size) : m_data(data), m_size(size), m_pos(0) {}
+
+	inline bool has(XsSize count) const
+	{
+		return m_size - m_pos >= count;
+	}
+
+	inline uint8_t const* take(XsSize count)
+	{
+		uint8_t const* p = m_data + m_pos;
+		m_pos += count;
+		return p;
+	}
+
+	inline XsSize remaining() const
+	{
+		return m_size - m_pos;
+	}
+
+	inline bool atEnd() const
+	{
+		return m_pos == m_size;
+	}
+
+private:
+	uint8_t const* m_data;
+	XsSize m_size;
+	XsSize m_pos;
+};
+
+//! \brief A data item in an MtData2 layout
+struct LayoutItem
+{
+	uint16_t m_id;			//!< The data identifier
+	uint8_t m_size;			//!< The size of the item data
+	uint8_t m_wordSize;		//!< The size of the words the item data is split into
+};
+
+//! \brief A stream of records in a chunk
+struct Stream
+{
+	StreamKind m_kind;
+	uint8_t m_busId;							//!< The bus id of the messages in a layout stream
+	std::vector<LayoutItem> m_items;			//!< The items of a layout stream
+	XsSize m_payloadSize;						//!< The size of the MtData2 payload of a layout stream
+	std::vector<uint8_t const*> m_records;		//!< The records in the stream, the payloads of a layout stream
+	std::vector<XsSize> m_sizes;				//!< The sizes of the records of an opaque stream
+	std::vector<uint8_t> m_types;				//!< The types of the records of an opaque stream
+};
+
+/*! \brief Determine the size of the words that the data of an item is split into
+	\details Doubles are split into 8 byte words, so the slowly changing exponent and high mantissa bytes end up
+	in the same byte planes. Everything else is split into the largest word that divides the item size.
+*/
+uint8_t wordSize(uint16_t id, uint8_t size)
+{
+	switch (id & XDI_SubFormatMask)
+	{
+	case XDI_SubFormatDouble:
+		if (size % 8 == 0)
+			return 8;
+		break;
+	case XDI_SubFormatFp1632:
+		if (size % 6 == 0)
+			return 2;
+		break;
+	default:
+		break;
+	}
+	if (size % 4 == 0)
+		return 4;
+	if (size % 2 == 0)
+		return 2;
+	return 1;
+}
+
+/*! \brief Check whether \a raw is a canonical MtData2 message and return its bus id and payload
+	\details Only messages that are reproduced byte for byte by composeMtData2 are accepted: the extended length
+	field must be used if and only if the payload does not fit in a short message and the checksum must be valid.
+*/
+bool parseMtData2(uint8_t const* raw, XsSize size, uint8_t& busId, uint8_t const*& payload, XsSize& payloadSize)
+{
+	if (size < XS_LEN_MSGHEADERCS || raw[0] != XS_PREAMBLE || raw[2] != XMID_MtData2)
+		return false;
+
+	XsSize headerSize = XS_LEN_MSGHEADER;
+	payloadSize = raw[3];
+	if (raw[3] == XS_EXTLENCODE)
+	{
+		if (size < XS_LEN_MSGEXTHEADERCS)
+			return false;
+		headerSize = XS_LEN_MSGEXTHEADER;
+		payloadSize = ((XsSize) raw[4] << 8) | raw[5];
+		if (payloadSize <= XS_MAXSHORTDATALEN)
+			return false;
+	}
+	if (headerSize + payloadSize + XS_LEN_CHECKSUM != size)
+		return false;
+
+	uint8_t sum = 0;
+	for (XsSize i = 1; i < size; ++i)
+		sum += raw[i];
+	if (sum != 0)
+		return false;
+
+	busId = raw[1];
+	payload = raw + headerSize;
+	return true;
+}
+
+/*! \brief Split an MtData2 payload into its items
+	\returns false if the items do not exactly cover the payload
+*/
+bool parseLayout(uint8_t const* payload, XsSize payloadSize, std::vector<LayoutItem>& items)
+{
+	items.clear();
+	XsSize offset = 0;
+	while (offset < payloadSize)
+	{
+		if (payloadSize - offset < 3)
+			return false;
+		LayoutItem item;
+		item.m_id = (uint16_t)((payload[offset] << 8) | payload[offset + 1]);
+		item.m_size = payload[offset + 2];
+		item.m_wordSize = wordSize(item.m_id, item.m_size);
+		offset += 3 + item.m_size;
+		if (offset > payloadSize)
+			return false;
+		items.push_back(item);
+	}
+	return true;
+}
+
+//! \returns true if \a payload has exactly the layout of \a stream
+bool matchesLayout(Stream const& stream, uint8_t busId, uint8_t const* payload, XsSize payloadSize)
+{
+	if (stream.m_kind != SK_Layout || stream.m_busId != busId || stream.m_payloadSize != payloadSize)
+		return false;
+
+	XsSize offset = 0;
+	for (auto const& item : stream.m_items)
+	{
+		if (payload[offset] != (uint8_t)(item.m_id >> 8) || payload[offset + 1] != (uint8_t) item.m_id || payload[offset + 2] != item.m_size)
+			return false;
+		offset += 3 + item.m_size;
+	}
+	return true;
+}
+
+//! \returns The key under which the layout of \a payload is stored
+std::string layoutKey(uint8_t busId, uint8_t const* payload, XsSize payloadSize)
+{
+	std::string key(1, (char) busId);
+	XsSize offset = 0;
+	while (offset + 3 <= payloadSize)
+	{
+		key.append((char const*) payload + offset, 3);
+		offset += 3 + payload[offset + 2];
+	}
+	return key;
+}
+
+inline uint64_t readWord(uint8_t const* src, int size)
+{
+	uint64_t value = 0;
+	for (int i = 0; i < size; ++i)
+		value = (value << 8) | src[i];
+	return value;
+}
+
+inline void writeWord(uint8_t* dest, uint64_t value, int size)
+{
+	for (int i = size - 1; i >= 0; --i)
+	{
+		dest[i] = (uint8_t) value;
+		value >>= 8;
+	}
+}
+
+inline int zeroBytes(uint64_t value, int size)
+{
+	int count = 0;
+	for (int i = 0; i < size; ++i)
+		count += ((value >> (8 * i)) & 0xFF) == 0;
+	return count;
+}
+
+/*! \brief Transform one column of a layout stream and append its mode and byte planes to \a body
+	\param stream The stream
+	\param offset The offset of the column in the payloads
+	\param size The word size of the column
+	\param values Scratch space for the values of the column
+	\param body The body to append to
+*/
+void encodeColumn(Stream const& stream, XsSize offset, int size, std::vector<uint64_t>& values, std::vector<uint8_t>& body)
+{
+	XsSize count = stream.m_records.size();
+	uint64_t mask = (size == 8) ? ~(uint64_t)0 : (((uint64_t)1 << (8 * size)) - 1);
+
+	values.resize(count);
+	int zeros[3] = { 0, 0, 0 };
+	uint64_t previous = 0;
+	for (XsSize i = 0; i < count; ++i)
+	{
+		uint64_t value = readWord(stream.m_records[i] + offset, size);
+		values[i] = value;
+		zeros[CM_Raw] += zeroBytes(value, size);
+		zeros[CM_Delta] += zeroBytes((value - previous) & mask, size);
+		zeros[CM_Xor] += zeroBytes(value ^ previous, size);
+		previous = value;
+	}
+
+	ColumnMode mode = CM_Raw;
+	if (zeros[CM_Delta] > zeros[mode])
+		mode = CM_Delta;
+	if (zeros[CM_Xor] > zeros[mode])
+		mode = CM_Xor;
+
+	if (mode != CM_Raw)
+	{
+		previous = 0;
+		for (XsSize i = 0; i < count; ++i)
+		{
+			uint64_t value = values[i];
+			values[i] = (mode == CM_Delta) ? ((value - previous) & mask) : (value ^ previous);
+			previous = value;
+		}
+	}
+
+	XsSize pos = body.size();
+	body.resize(pos + 1 + count * (XsSize) size);
+	body[pos++] = (uint8_t) mode;
+	for (int plane = 0; plane < size; ++plane)
+	{
+		int shift = 8 * (size - 1 - plane);
+		uint8_t* dest = &body[pos + (XsSize) plane * count];
+		for (XsSize i = 0; i < count; ++i)
+			dest[i] = (uint8_t)(values[i] >> shift);
+	}
+}
+
+/*! \brief Read one column of a layout stream from \a reader and write its values into the payloads in \a samples
+	\returns false if the body is corrupt
+*/
+bool decodeColumn(BodyReader& reader, XsSize count, XsSize offset, int size, uint8_t* samples, XsSize payloadSize)
+{
+	if (!reader.has(1 + count * (XsSize) size))
+		return false;
+	int mode = *reader.take(1);
+	if (mode > CM_Xor)
+		return false;
+	uint8_t const* planes = reader.take(count * (XsSize) size);
+
+	uint64_t mask = (size == 8) ? ~(uint64_t)0 : (((uint64_t)1 << (8 * size)) - 1);
+	uint64_t previous = 0;
+	for (XsSize i = 0; i < count; ++i)
+	{
+		uint64_t value = 0;
+		for (int plane = 0; plane < size; ++plane)
+			value = (value << 8) | planes[(XsSize) plane * count + i];
+		if (mode == CM_Delta)
+			value = (value + previous) & mask;
+		else if (mode == CM_Xor)
+			value ^= previous;
+		previous = value;
+		writeWord(samples + i * payloadSize + offset, value, size);
+	}
+	return true;
+}
+
+//! \brief Append the MtData2 message with \a busId and \a payload to \a records
+void composeMtData2(std::vector<uint8_t>& records, uint8_t busId, uint8_t const* payload, XsSize payloadSize)
+{
+	XsSize headerSize = (payloadSize > XS_MAXSHORTDATALEN) ? XS_LEN_MSGEXTHEADER : XS_LEN_MSGHEADER;
+	XsSize size = headerSize + payloadSize + XS_LEN_CHECKSUM;
+
+	XsSize pos = records.size();
+	records.resize(pos + 5 + size);
+	uint8_t* dest = &records[pos];
+	dest[0] = ColumnarFormat::RT_Message;
+	store32(dest + 1, (uint32_t) size);
+	dest += 5;
+
+	dest[0] = XS_PREAMBLE;
+	dest[1] = busId;
+	dest[2] = XMID_MtData2;
+	if (headerSize == XS_LEN_MSGEXTHEADER)
+	{
+		dest[3] = XS_EXTLENCODE;
+		dest[4] = (uint8_t)(payloadSize >> 8);
+		dest[5] = (uint8_t) payloadSize;
+	}
+	else
+		dest[3] = (uint8_t) payloadSize;
+	memcpy(dest + headerSize, payload, payloadSize);
+
+	uint8_t sum = 0;
+	for (XsSize i = 1; i < size - 1; ++i)
+		sum += dest[i];
+	dest[size - 1] = (uint8_t)(0 - sum);
+}
+
+//! \brief The number of bits of the hash table of the compressor
+static const int hashBits = 12;
+//! \brief The minimum length of a match
+static const XsSize minMatch = 4;
+//! \brief The number of bytes at the end of the input that are always written as literals
+static const XsSize lastLiterals = 5;
+
+inline uint32_t read32(uint8_t const* src)
+{
+	uint32_t value;
+	memcpy(&value, src, 4);
+	return value;
+}
+
+inline uint32_t hash4(uint32_t value)
+{
+	return (value * 2654435761u) >> (32 - hashBits);
+}
+
+inline void appendLength(std::vector<uint8_t>& dest, XsSize length)
+{
+	while (length >= 255)
+	{
+		dest.push_back(255);
+		length -= 255;
+	}
+	dest.push_back((uint8_t) length);
+}
+
+//! \brief Append a sequence of literals followed by a match, when \a matchLength is 0 only literals are written
+void appendSequence(std::vector<uint8_t>& dest, uint8_t const* literals, XsSize literalCount, XsSize offset, XsSize matchLength)
+{
+	XsSize matchCode = matchLength ? matchLength - minMatch : 0;
+	dest.push_back((uint8_t)(((literalCount < 15 ? literalCount : 15) << 4) | (matchCode < 15 ? matchCode : 15)));
+	if (literalCount >= 15)
+		appendLength(dest, literalCount - 15);
+	dest.insert(dest.end(), literals, literals + literalCount);
+	if (!matchLength)
+		return;
+	append16(dest, (uint16_t) offset);
+	if (matchCode >= 15)
+		appendLength(dest, matchCode - 15);
+}
+
+inline bool readLength(uint8_t const* src, XsSize size, XsSize& pos, XsSize& length)
+{
+	uint8_t byte;
+	do
+	{
+		if (pos >= size)
+			return false;
+		byte = src[pos++];
+		length += byte;
+	} while (byte == 255);
+	return true;
+}
+
+//! \brief Make the CRC-32 lookup table
+struct CrcTable
+{
+	uint32_t m_table[256];
+
+	CrcTable()
+	{
+		for (uint32_t i = 0; i < 256; ++i)
+		{
+			uint32_t c = i;
+			for (int k = 0; k < 8; ++k)
+				c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+			m_table[i] = c;
+		}
+	}
+};
+}
+
+/*! \brief Write the file header to \a dest, which must have room for fileHeaderSize bytes */
+void ColumnarFormat::writeFileHeader(uint8_t* dest)
+{
+	memcpy(dest, fileMagic, sizeof(fileMagic));
+	store32(dest + 8, version);
+	store32(dest + 12, 0);
+}
+
+/*! \brief Read the file header from \a src
+	\param src The first fileHeaderSize bytes of the file
+	\param fileVersion Receives the format version of the file
+	\returns true if \a src is a file header of a version that can be read
+*/
+bool ColumnarFormat::readFileHeader(uint8_t const* src, uint32_t& fileVersion)
+{
+	if (memcmp(src, fileMagic, sizeof(fileMagic)) != 0)
+		return false;
+	fileVersion = load32(src + 8);
+	return fileVersion >= 1 && fileVersion <= version;
+}
+
+/*! \brief Write \a header to \a dest, which must have room for chunkHeaderSize bytes */
+void ColumnarFormat::writeChunkHeader(ChunkHeader const& header, uint8_t* dest)
+{
+	store32(dest, chunkMagic);
+	store32(dest + 4, header.m_recordCount);
+	store32(dest + 8, header.m_bodySize);
+	store32(dest + 12, header.m_storedSize);
+	store32(dest + 16, header.m_crc);
+	store32(dest + 20, header.m_flags);
+	store64(dest + 24, header.m_firstRecord);
+}
+
+/*! \brief Read a chunk header from \a src
+	\returns false if \a src does not contain a chunk header
+*/
+bool ColumnarFormat::readChunkHeader(uint8_t const* src, ChunkHeader& header)
+{
+	if (load32(src) != chunkMagic)
+		return false;
+	header.m_recordCount = load32(src + 4);
+	header.m_bodySize = load32(src + 8);
+	header.m_storedSize = load32(src + 12);
+	header.m_crc = load32(src + 16);
+	header.m_flags = load32(src + 20);
+	header.m_firstRecord = load64(src + 24);
+	return (header.m_flags & chunkCompressed) || header.m_storedSize == header.m_bodySize;
+}
+
+/*! \brief Append the chunk index and the footer to \a dest
+	\param index The chunks in the file
+	\param indexOffset The file offset at which the index will be written
+	\param dest The buffer to append to
+*/
+void ColumnarFormat::writeIndex(std::vector<IndexEntry> const& index, uint64_t indexOffset, std::vector<uint8_t>& dest)
+{
+	XsSize pos = dest.size();
+	dest.resize(pos + 8 + index.size() * indexEntrySize + footerSize);
+	uint8_t* p = &dest[pos];
+
+	store32(p, indexMagic);
+	store32(p + 4, (uint32_t) index.size());
+	p += 8;
+	for (auto const& entry : index)
+	{
+		store64(p, entry.m_offset);
+		store64(p + 8, entry.m_firstRecord);
+		store32(p + 16, entry.m_recordCount);
+		store32(p + 20, 0);
+		p += indexEntrySize;
+	}
+
+	store64(p, indexOffset);
+	store32(p + 8, (uint32_t) index.size());
+	store32(p + 12, footerMagic);
+}
+
+/*! \brief Read the footer from \a src
+	\param src The last footerSize bytes of the file
+	\param indexOffset Receives the file offset of the index
+	\param chunkCount Receives the number of chunks in the index
+	\returns false if \a src is not a footer
+*/
+bool ColumnarFormat::readFooter(uint8_t const* src, uint64_t& indexOffset, uint32_t& chunkCount)
+{
+	if (load32(src + 12) != footerMagic)
+		return false;
+	indexOffset = load64(src);
+	chunkCount = load32(src + 8);
+	return true;
+}
+
+/*! \brief Read the chunk index from \a src
+	\param src The index, starting at the offset found by readFooter
+	\param size The number of bytes available at \a src
+	\param chunkCount The number of chunks found by readFooter
+	\param index Receives the index entries
+	\returns false if \a src does not contain a valid index
+*/
+bool ColumnarFormat::readIndex(uint8_t const* src, XsSize size, uint32_t chunkCount, std::vector<IndexEntry>& index)
+{
+	if (size < 8 + (XsSize) chunkCount * indexEntrySize || load32(src) != indexMagic || load32(src + 4) != chunkCount)
+		return false;
+
+	index.resize(chunkCount);
+	src += 8;
+	for (auto& entry : index)
+	{
+		entry.m_offset = load64(src);
+		entry.m_firstRecord = load64(src + 8);
+		entry.m_recordCount = load32(src + 16);
+		src += indexEntrySize;
+	}
+	return true;
+}
+
+/*! \brief Append a record to a buffer of records as used by encodeChunk and decodeChunk */
+void ColumnarFormat::appendRecord(std::vector<uint8_t>& records, RecordType type, uint8_t const* data, XsSize size)
+{
+	XsSize pos = records.size();
+	records.resize(pos + 5 + size);
+	records[pos] = (uint8_t) type;
+	store32(&records[pos + 1], (uint32_t) size);
+	if (size)
+		memcpy(&records[pos + 5], data, size);
+}
+
+/*! \brief Get the record at \a offset in a buffer of records
+	\param records The buffer of records
+	\param offset The offset of the record, 0 for the first record
+	\param type Receives the type of the record
+	\param data Receives a pointer to the data of the record
+	\param size Receives the size of the data of the record
+	\returns The offset of the next record
+*/
+XsSize ColumnarFormat::nextRecord(std::vector<uint8_t> const& records, XsSize offset, RecordType& type, uint8_t const*& data, XsSize& size)
+{
+	type = (RecordType) records[offset];
+	size = load32(&records[offset + 1]);
+	data = records.data() + offset + 5;
+	return offset + 5 + size;
+}
+
+/*! \brief Encode a buffer of records into an uncompressed chunk body
+	\param records The records, as created by appendRecord
+	\param recordCount The number of records in \a records
+	\param body Receives the chunk body
+*/
+void ColumnarFormat::encodeChunk(std::vector<uint8_t> const& records, XsSize recordCount, std::vector<uint8_t>& body)
+{
+	std::vector<Stream> streams;
+	std::map<std::string, uint16_t> layouts;
+	std::vector<uint16_t> order(recordCount);
+	std::vector<LayoutItem> items;
+	int opaque = -1;
+	int last = -1;
+
+	XsSize offset = 0;
+	for (XsSize r = 0; r < recordCount; ++r)
+	{
+		RecordType type;
+		uint8_t const* data;
+		XsSize size;
+		offset = nextRecord(records, offset, type, data, size);
+
+		uint8_t busId;
+		uint8_t const* payload;
+		XsSize payloadSize;
+		int index = -1;
+		if (type == RT_Message && parseMtData2(data, size, busId, payload, payloadSize))
+		{
+			if (last >= 0 && matchesLayout(streams[(XsSize) last], busId, payload, payloadSize))
+				index = last;
+			else if (parseLayout(payload, payloadSize, items))
+			{
+				std::string key = layoutKey(busId, payload, payloadSize);
+				auto it = layouts.find(key);
+				if (it != layouts.end())
+					index = it->second;
+				else if (streams.size() < maxStreamCount - 1)
+				{
+					index = (int) streams.size();
+					layouts[key] = (uint16_t) index;
+					streams.push_back(Stream());
+					Stream& stream = streams.back();
+					stream.m_kind = SK_Layout;
+					stream.m_busId = busId;
+					stream.m_items = items;
+					stream.m_payloadSize = payloadSize;
+				}
+			}
+			if (index >= 0)
+			{
+				streams[(XsSize) index].m_records.push_back(payload);
+				last = index;
+			}
+		}
+
+		if (index < 0)
+		{
+			if (opaque < 0)
+			{
+				opaque = (int) streams.size();
+				streams.push_back(Stream());
+				streams.back().m_kind = SK_Opaque;
+				streams.back().m_busId = 0;
+				streams.back().m_payloadSize = 0;
+			}
+			index = opaque;
+			Stream& stream = streams[(XsSize) index];
+			stream.m_records.push_back(data);
+			stream.m_sizes.push_back(size);
+			stream.m_types.push_back((uint8_t) type);
+		}
+		order[r] = (uint16_t) index;
+	}
+
+	body.clear();
+	body.reserve(records.size());
+	append16(body, (uint16_t) streams.size());
+
+	std::vector<uint64_t> values;
+	for (auto const& stream : streams)
+	{
+		body.push_back((uint8_t) stream.m_kind);
+		if (stream.m_kind == SK_Layout)
+		{
+			body.push_back(stream.m_busId);
+			append16(body, (uint16_t) stream.m_items.size());
+			for (auto const& item : stream.m_items)
+			{
+				append16(body, item.m_id);
+				body.push_back(item.m_size);
+			}
+			append32(body, (uint32_t) stream.m_records.size());
+
+			XsSize itemOffset = 0;
+			for (auto const& item : stream.m_items)
+			{
+				itemOffset += 3;
+				for (XsSize w = 0; w < item.m_size; w += item.m_wordSize)
+					encodeColumn(stream, itemOffset + w, item.m_wordSize, values, body);
+				itemOffset += item.m_size;
+			}
+		}
+		else
+		{
+			append32(body, (uint32_t) stream.m_records.size());
+			for (XsSize i = 0; i < stream.m_records.size(); ++i)
+			{
+				body.push_back(stream.m_types[i]);
+				append32(body, (uint32_t) stream.m_sizes[i]);
+			}
+			for (XsSize i = 0; i < stream.m_records.size(); ++i)
+				body.insert(body.end(), stream.m_records[i], stream.m_records[i] + stream.m_sizes[i]);
+		}
+	}
+
+	XsSize pos = body.size();
+	body.resize(pos + 2 * recordCount);
+	for (XsSize r = 0; r < recordCount; ++r)
+	{
+		body[pos + r] = (uint8_t)(order[r] >> 8);
+		body[pos + recordCount + r] = (uint8_t) order[r];
+	}
+}
+
+/*! \brief Decode an uncompressed chunk body into a buffer of records
+	\param body The chunk body
+	\param size The size of the chunk body
+	\param recordCount The number of records in the chunk
+	\param records Receives the records, as read by nextRecord
+	\returns false if the body is corrupt
+*/
+bool ColumnarFormat::decodeChunk(uint8_t const* body, XsSize size, XsSize recordCount, std::vector<uint8_t>& records)
+{
+	//! \brief A decoded stream
+	struct DecodedStream
+	{
+		StreamKind m_kind;
+		uint8_t m_busId;
+		XsSize m_payloadSize;
+		XsSize m_count;
+		XsSize m_next;
+		std::vector<uint8_t> m_samples;			//!< The payloads of a layout stream
+		uint8_t const* m_headers;				//!< The record types and sizes of an opaque stream
+		uint8_t const* m_data;					//!< The next record data of an opaque stream
+	};
+
+	records.clear();
+	// the body ends with 2 bytes per record, this bounds the record counts before anything is allocated
+	if (recordCount > size / 2)
+		return false;
+	BodyReader reader(body, size);
+	if (!reader.has(2))
+		return false;
+	XsSize streamCount = load16(reader.take(2));
+
+	std::vector<DecodedStream> streams(streamCount);
+	for (auto& stream : streams)
+	{
+		if (!reader.has(1))
+			return false;
+		stream.m_kind = (StreamKind) *reader.take(1);
+		stream.m_next = 0;
+		if (stream.m_kind == SK_Layout)
+		{
+			if (!reader.has(3))
+				return false;
+			stream.m_busId = *reader.take(1);
+			XsSize itemCount = load16(reader.take(2));
+			if (!reader.has(itemCount * 3 + 4))
+				return false;
+
+			std::vector<LayoutItem> items(itemCount);
+			stream.m_payloadSize = 0;
+			XsSize columnCount = 0;
+			for (auto& item : items)
+			{
+				uint8_t const* p = reader.take(3);
+				item.m_id = load16(p);
+				item.m_size = p[2];
+				item.m_wordSize = wordSize(item.m_id, item.m_size);
+				stream.m_payloadSize += 3 + item.m_size;
+				columnCount += item.m_size / item.m_wordSize;
+			}
+			stream.m_count = load32(reader.take(4));
+			if (stream.m_count > recordCount)
+				return false;
+
+			// each column is a mode byte followed by its values, check that they are present before allocating
+			uint64_t columnBytes = columnCount + (uint64_t) stream.m_count * (stream.m_payloadSize - 3 * itemCount);
+			if (columnBytes > reader.remaining())
+				return false;
+
+			stream.m_samples.resize(stream.m_count * stream.m_payloadSize);
+			XsSize itemOffset = 0;
+			for (auto const& item : items)
+			{
+				for (XsSize i = 0; i < stream.m_count; ++i)
+				{
+					uint8_t* header = &stream.m_samples[i * stream.m_payloadSize + itemOffset];
+					header[0] = (uint8_t)(item.m_id >> 8);
+					header[1] = (uint8_t) item.m_id;
+					header[2] = item.m_size;
+				}
+				itemOffset += 3;
+				for (XsSize w = 0; w < item.m_size; w += item.m_wordSize)
+					if (!decodeColumn(reader, stream.m_count, itemOffset + w, item.m_wordSize, stream.m_samples.data(), stream.m_payloadSize))
+						return false;
+				itemOffset += item.m_size;
+			}
+		}
+		else if (stream.m_kind == SK_Opaque)
+		{
+			if (!reader.has(4))
+				return false;
+			stream.m_count = load32(reader.take(4));
+			if (stream.m_count > recordCount || !reader.has(stream.m_count * 5))
+				return false;
+			stream.m_headers = reader.take(stream.m_count * 5);
+			XsSize dataSize = 0;
+			for (XsSize i = 0; i < stream.m_count; ++i)
+				dataSize += load32(stream.m_headers + i * 5 + 1);
+			if (!reader.has(dataSize))
+				return false;
+			stream.m_data = reader.take(dataSize);
+		}
+		else
+			return false;
+	}
+
+	if (!reader.has(2 * recordCount))
+		return false;
+	uint8_t const* order = reader.take(2 * recordCount);
+	if (!reader.atEnd())
+		return false;
+
+	for (XsSize r = 0; r < recordCount; ++r)
+	{
+		XsSize index = ((XsSize) order[r] << 8) | order[recordCount + r];
+		if (index >= streamCount)
+			return false;
+		DecodedStream& stream = streams[index];
+		if (stream.m_next >= stream.m_count)
+			return false;
+
+		if (stream.m_kind == SK_Layout)
+			composeMtData2(records, stream.m_busId, stream.m_samples.data() + stream.m_next * stream.m_payloadSize, stream.m_payloadSize);
+		else
+		{
+			uint8_t const* header = stream.m_headers + stream.m_next * 5;
+			XsSize recordSize = load32(header + 1);
+			appendRecord(records, (RecordType) header[0], stream.m_data, recordSize);
+			stream.m_data += recordSize;
+		}
+		++stream.m_next;
+	}
+	return true;
+}
+
+/*! \brief Compute the CRC-32 (IEEE 802.3) of \a data
+	\param data The data
+	\param size The size of the data
+	\param crc The CRC of the preceding data, to compute the CRC of data in several parts
+	\returns The CRC of the data
+*/
+uint32_t ColumnarFormat::crc32(uint8_t const* data, XsSize size, uint32_t crc)
+{
+	static const CrcTable table;
+	crc = ~crc;
+	for (XsSize i = 0; i < size; ++i)
+		crc = table.m_table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	return ~crc;
+}
+
+/*! \brief Compress \a src with a byte oriented LZ77 compressor
+	\details The output is a sequence of tokens. The high nibble of a token holds the number of literals and the low
+	nibble the match length minus 4, a value of 15 is followed by extra length bytes. The literals follow the token,
+	followed by a 2 byte match offset and the extra match length bytes. The last token has no match.
+	\param src The data to compress
+	\param size The size of the data
+	\param dest Receives the compressed data
+*/
+void ColumnarFormat::compress(uint8_t const* src, XsSize size, std::vector<uint8_t>& dest)
+{
+	dest.clear();
+	dest.reserve(size / 2 + 16);
+
+	std::vector<int64_t> table((XsSize) 1 << hashBits, -1);
+	XsSize anchor = 0;
+	XsSize pos = 0;
+	XsSize limit = (size > minMatch + lastLiterals) ? size - lastLiterals - minMatch : 0;
+
+	while (pos < limit)
+	{
+		uint32_t sequence = read32(src + pos);
+		uint32_t h = hash4(sequence);
+		int64_t ref = table[h];
+		table[h] = (int64_t) pos;
+
+		if (ref < 0 || pos - (XsSize) ref > 0xFFFF || read32(src + ref) != sequence)
+		{
+			// skip faster through data that does not compress
+			pos += 1 + ((pos - anchor) >> 6);
+			continue;
+		}
+
+		XsSize length = minMatch;
+		XsSize maxLength = size - lastLiterals - pos;
+		while (length < maxLength && src[(XsSize) ref + length] == src[pos + length])
+			++length;
+
+		appendSequence(dest, src + anchor, pos - anchor, pos - (XsSize) ref, length);
+		pos += length;
+		anchor = pos;
+	}
+	appendSequence(dest, src + anchor, size - anchor, 0, 0);
+}
+
+/*! \brief Decompress data that was compressed with compress()
+	\param src The compressed data
+	\param size The size of the compressed data
+	\param dest The destination buffer
+	\param destSize The size of the decompressed data
+	\returns true if the data decompressed to exactly \a destSize bytes
+*/
+bool ColumnarFormat::decompress(uint8_t const* src, XsSize size, uint8_t* dest, XsSize destSize)
+{
+	XsSize in = 0;
+	XsSize out = 0;
+	while (in < size)
+	{
+		uint8_t token = src[in++];
+		XsSize literals = token >> 4;
+		if (literals == 15 && !readLength(src, size, in, literals))
+			return false;
+		if (size - in < literals || destSize - out < literals)
+			return false;
+		memcpy(dest + out, src + in, literals);
+		in += literals;
+		out += literals;
+		if (in == size)
+			break;
+
+		if (size - in < 2)
+			return false;
+		XsSize offset = load16(src + in);
+		in += 2;
+		XsSize length = token & 0x0F;
+		if (length == 15 && !readLength(src, size, in, length))
+			return false;
+		length += minMatch;
+		if (offset == 0 || offset > out || destSize - out < length)
+			return false;
+
+		uint8_t* d = dest + out;
+		uint8_t const* s = d - offset;
+		if (offset >= length)
+			memcpy(d, s, length);
+		else
+			for (XsSize i = 0; i < length; ++i)
+				d[i] = s[i];
+		out += length;
+	}
+	return out == destSize;
+}
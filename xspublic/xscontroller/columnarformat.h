@@ -0,0 +1,122 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+#ifndef COLUMNARFORMAT_H
+#define COLUMNARFORMAT_H
+
+#include <xstypes/xstypesconfig.h>
+#include <xstypes/xstypedefs.h>
+#include <vector>
+
+/*! \class ColumnarFormat
+	\brief The building blocks of the columnar recording format written by ColumnarDataLogger
+	\details A columnar log file starts with a file header, followed by a sequence of chunks and ends with an
+	index of the chunks and a footer. All multi-byte numbers in the file structure are little-endian.
+
+	Each chunk holds a number of consecutive records. A record is either a complete xbus message or a block of
+	raw data that was passed to DataLogger::writeRaw. In the chunk body, MtData2 messages with the same bus id and
+	the same sequence of data identifiers and sizes are grouped into a stream. Each stream stores its samples per
+	column: a column is one 1, 2, 4 or 8 byte word of an item, stored as byte planes (most significant byte first)
+	after a per-chunk transformation that turns slowly changing values into zero bytes: the value itself, the
+	difference with the previous sample or the XOR with the previous sample, whichever yields the most zero bytes.
+	All other records are stored as-is in a separate stream. The order of the records is kept in a stream index
+	column. The chunk body is then compressed with a small LZ77 compressor and protected by a CRC-32.
+
+	The index and footer are written when the file is closed. When they are missing, for example because the
+	application was terminated, the chunks can still be read sequentially.
+*/
+class ColumnarFormat
+{
+public:
+	//! \brief The types of records in a chunk
+	enum RecordType {
+		RT_Message = 0,		//!< A complete xbus message including its checksum
+		RT_Raw = 1			//!< A block of raw data
+	};
+
+	//! \brief The size of the file header
+	static const XsSize fileHeaderSize = 16;
+	//! \brief The size of a chunk header
+	static const XsSize chunkHeaderSize = 32;
+	//! \brief The size of an entry in the chunk index
+	static const XsSize indexEntrySize = 24;
+	//! \brief The size of the footer
+	static const XsSize footerSize = 16;
+	//! \brief The version of the format that is written
+	static const uint32_t version = 1;
+	//! \brief The magic number at the start of each chunk
+	static const uint32_t chunkMagic = 0x48434358;		// "XCCH"
+	//! \brief The magic number at the start of the index
+	static const uint32_t indexMagic = 0x58494358;		// "XCIX"
+	//! \brief The magic number at the end of the footer
+	static const uint32_t footerMagic = 0x54464358;		// "XCFT"
+	//! \brief The flag in ChunkHeader::m_flags that indicates that the body is compressed
+	static const uint32_t chunkCompressed = 1;
+
+	//! \brief The header that precedes each chunk
+	struct ChunkHeader
+	{
+		uint32_t m_recordCount;		//!< The number of records in the chunk
+		uint32_t m_bodySize;		//!< The size of the decompressed body
+		uint32_t m_storedSize;		//!< The size of the body as stored in the file
+		uint32_t m_crc;				//!< The CRC-32 of the stored body
+		uint32_t m_flags;			//!< A combination of flags such as chunkCompressed
+		uint64_t m_firstRecord;		//!< The index of the first record in the chunk
+	};
+
+	//! \brief An entry in the chunk index
+	struct IndexEntry
+	{
+		uint64_t m_offset;			//!< The file offset of the chunk header
+		uint64_t m_firstRecord;		//!< The index of the first record in the chunk
+		uint32_t m_recordCount;		//!< The number of records in the chunk
+	};
+
+	static void writeFileHeader(uint8_t* dest);
+	static bool readFileHeader(uint8_t const* src, uint32_t& fileVersion);
+	static void writeChunkHeader(ChunkHeader const& header, uint8_t* dest);
+	static bool readChunkHeader(uint8_t const* src, ChunkHeader& header);
+	static void writeIndex(std::vector<IndexEntry> const& index, uint64_t indexOffset, std::vector<uint8_t>& dest);
+	static bool readFooter(uint8_t const* src, uint64_t& indexOffset, uint32_t& chunkCount);
+	static bool readIndex(uint8_t const* src, XsSize size, uint32_t chunkCount, std::vector<IndexEntry>& index);
+
+	static void appendRecord(std::vector<uint8_t>& records, RecordType type, uint8_t const* data, XsSize size);
+	static XsSize nextRecord(std::vector<uint8_t> const& records, XsSize offset, RecordType& type, uint8_t const*& data, XsSize& size);
+
+	static void encodeChunk(std::vector<uint8_t> const& records, XsSize recordCount, std::vector<uint8_t>& body);
+	static bool decodeChunk(uint8_t const* body, XsSize size, XsSize recordCount, std::vector<uint8_t>& records);
+
+	static uint32_t crc32(uint8_t const* data, XsSize size, uint32_t crc = 0);
+	static void compress(uint8_t const* src, XsSize size, std::vector<uint8_t>& dest);
+	static bool decompress(uint8_t const* src, XsSize size, uint8_t* dest, XsSize destSize);
+};
+
+#endif
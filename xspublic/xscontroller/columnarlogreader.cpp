@@ -0,0 +1,365 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+#include "columnarlogreader.h"
+#include "iointerfacefile.h"
+#include <xstypes/xsdatapacket.h>
+#include <algorithm>
+
+namespace
+{
+//! \brief Read exactly \a size bytes at \a offset from \a file into \a data
+XsResultValue readExact(IoInterfaceFile& file, uint64_t offset, XsSize size, XsByteArray& data)
+{
+	XsResultValue result = file.setReadPosition((XsFilePos) offset);
+	if (result != XRV_OK)
+		return result;
+	result = file.readData((XsFilePos) size, data);
+	if (result == XRV_OK && data.size() != size)
+		result = XRV_ENDOFFILE;
+	return result;
+}
+}
+
+/*! \brief Constructor */
+ColumnarLogReader::ColumnarLogReader()
+	: m_lastResult(XRV_OK)
+	, m_dataEnd(0)
+	, m_hasIndex(false)
+	, m_nextChunk(0)
+	, m_recordOffset(0)
+{
+}
+
+ColumnarLogReader::~ColumnarLogReader()
+{
+	try
+	{
+		close();
+	}
+	catch (...)
+	{
+	}
+}
+
+/*! \brief Open a columnar log file for reading
+	\details The chunk index is read from the end of the file if it is present.
+	\param filename The name of the file to open
+	\returns true if the file was opened and starts with a valid file header
+*/
+bool ColumnarLogReader::open(const XsString& filename)
+{
+	if (m_ioInterfaceFile)
+	{
+		m_lastResult = XRV_ALREADYOPEN;
+		return false;
+	}
+
+	m_ioInterfaceFile = std::shared_ptr<IoInterfaceFile>(new IoInterfaceFile);
+	m_lastResult = m_ioInterfaceFile->open(filename, false, true);
+
+	XsByteArray data;
+	uint32_t fileVersion = 0;
+	if (m_lastResult == XRV_OK)
+		m_lastResult = readExact(*m_ioInterfaceFile, 0, ColumnarFormat::fileHeaderSize, data);
+	if (m_lastResult == XRV_OK && !ColumnarFormat::readFileHeader(data.data(), fileVersion))
+		m_lastResult = XRV_DATACORRUPT;
+	if (m_lastResult != XRV_OK)
+	{
+		m_ioInterfaceFile.reset();
+		return false;
+	}
+
+	uint64_t fileSize = (uint64_t) m_ioInterfaceFile->getFileSize();
+	m_dataEnd = fileSize;
+	m_hasIndex = false;
+	m_index.clear();
+	if (fileSize >= ColumnarFormat::fileHeaderSize + ColumnarFormat::footerSize &&
+		readExact(*m_ioInterfaceFile, fileSize - ColumnarFormat::footerSize, ColumnarFormat::footerSize, data) == XRV_OK)
+	{
+		uint64_t indexOffset;
+		uint32_t chunkCount;
+		if (ColumnarFormat::readFooter(data.data(), indexOffset, chunkCount) &&
+			indexOffset >= ColumnarFormat::fileHeaderSize && indexOffset < fileSize - ColumnarFormat::footerSize)
+		{
+			XsSize indexSize = (XsSize)(fileSize - ColumnarFormat::footerSize - indexOffset);
+			if (readExact(*m_ioInterfaceFile, indexOffset, indexSize, data) == XRV_OK &&
+				ColumnarFormat::readIndex(data.data(), indexSize, chunkCount, m_index))
+			{
+				m_hasIndex = true;
+				m_dataEnd = indexOffset;
+			}
+			else
+				m_index.clear();
+		}
+	}
+
+	m_nextChunk = ColumnarFormat::fileHeaderSize;
+	m_records.clear();
+	m_recordOffset = 0;
+	return true;
+}
+
+/*! \brief Close the file */
+void ColumnarLogReader::close()
+{
+	if (m_ioInterfaceFile)
+	{
+		m_ioInterfaceFile->close();
+		m_ioInterfaceFile.reset();
+	}
+	m_index.clear();
+	m_hasIndex = false;
+	m_records.clear();
+	m_recordOffset = 0;
+}
+
+//! \returns true if a file is open
+bool ColumnarLogReader::isOpen() const
+{
+	return m_ioInterfaceFile != nullptr;
+}
+
+//! \returns The result of the last operation, XRV_ENDOFFILE after the last record was read
+XsResultValue ColumnarLogReader::lastResult() const
+{
+	return m_lastResult;
+}
+
+/*! \brief Build the chunk index from the chunk headers when the file has no index
+	\details The scan stops at the first chunk that is incomplete or has an invalid header.
+	\returns true if the chunk index is available
+*/
+bool ColumnarLogReader::scanIndex()
+{
+	if (m_hasIndex)
+		return true;
+	if (!m_ioInterfaceFile)
+	{
+		m_lastResult = XRV_NOFILEOPEN;
+		return false;
+	}
+
+	m_index.clear();
+	XsByteArray data;
+	uint64_t offset = ColumnarFormat::fileHeaderSize;
+	while (offset + ColumnarFormat::chunkHeaderSize <= m_dataEnd &&
+		readExact(*m_ioInterfaceFile, offset, ColumnarFormat::chunkHeaderSize, data) == XRV_OK)
+	{
+		ColumnarFormat::ChunkHeader header;
+		if (!ColumnarFormat::readChunkHeader(data.data(), header))
+			break;
+		uint64_t next = offset + ColumnarFormat::chunkHeaderSize + header.m_storedSize;
+		if (next > m_dataEnd)
+			break;
+
+		ColumnarFormat::IndexEntry entry;
+		entry.m_offset = offset;
+		entry.m_firstRecord = header.m_firstRecord;
+		entry.m_recordCount = header.m_recordCount;
+		m_index.push_back(entry);
+		offset = next;
+	}
+	m_dataEnd = offset;
+	m_hasIndex = true;
+	return true;
+}
+
+/*! \returns The number of records in the file
+	\note If the file has no index, this scans the chunk headers
+*/
+uint64_t ColumnarLogReader::recordCount()
+{
+	if (!scanIndex() || m_index.empty())
+		return 0;
+	return m_index.back().m_firstRecord + m_index.back().m_recordCount;
+}
+
+/*! \brief Move the read position to \a record
+	\param record The index of the record to read next, recordCount() moves to the end of the file
+	\returns true if successful
+*/
+bool ColumnarLogReader::seek(uint64_t record)
+{
+	if (!scanIndex())
+		return false;
+
+	auto it = std::upper_bound(m_index.begin(), m_index.end(), record,
+		[](uint64_t r, ColumnarFormat::IndexEntry const& entry) { return r < entry.m_firstRecord; });
+	if (it == m_index.begin() || record >= (it - 1)->m_firstRecord + (it - 1)->m_recordCount)
+	{
+		if (record != recordCount())
+		{
+			m_lastResult = XRV_NOTFOUND;
+			return false;
+		}
+		m_records.clear();
+		m_recordOffset = 0;
+		m_nextChunk = m_dataEnd;
+		m_lastResult = XRV_OK;
+		return true;
+	}
+
+	--it;
+	if (!loadChunk(it->m_offset))
+		return false;
+
+	ColumnarFormat::RecordType type;
+	uint8_t const* data;
+	XsSize size;
+	for (uint64_t skip = record - it->m_firstRecord; skip > 0; --skip)
+		m_recordOffset = ColumnarFormat::nextRecord(m_records, m_recordOffset, type, data, size);
+	return true;
+}
+
+/*! \brief Read, verify and decode the chunk at \a offset
+	\returns false at the end of the data or if the chunk is corrupt, see lastResult()
+*/
+bool ColumnarLogReader::loadChunk(uint64_t offset)
+{
+	m_records.clear();
+	m_recordOffset = 0;
+	if (!m_ioInterfaceFile)
+	{
+		m_lastResult = XRV_NOFILEOPEN;
+		return false;
+	}
+	if (offset + ColumnarFormat::chunkHeaderSize > m_dataEnd)
+	{
+		m_lastResult = XRV_ENDOFFILE;
+		return false;
+	}
+
+	XsByteArray data;
+	m_lastResult = readExact(*m_ioInterfaceFile, offset, ColumnarFormat::chunkHeaderSize, data);
+	if (m_lastResult != XRV_OK)
+		return false;
+
+	ColumnarFormat::ChunkHeader header;
+	if (!ColumnarFormat::readChunkHeader(data.data(), header))
+	{
+		m_lastResult = XRV_DATACORRUPT;
+		return false;
+	}
+
+	m_lastResult = readExact(*m_ioInterfaceFile, offset + ColumnarFormat::chunkHeaderSize, header.m_storedSize, data);
+	if (m_lastResult != XRV_OK)
+		return false;
+	if (ColumnarFormat::crc32(data.data(), data.size()) != header.m_crc)
+	{
+		m_lastResult = XRV_DATACORRUPT;
+		return false;
+	}
+
+	uint8_t const* body = data.data();
+	if (header.m_flags & ColumnarFormat::chunkCompressed)
+	{
+		m_body.resize(header.m_bodySize);
+		if (!ColumnarFormat::decompress(data.data(), data.size(), m_body.data(), m_body.size()))
+		{
+			m_lastResult = XRV_DATACORRUPT;
+			return false;
+		}
+		body = m_body.data();
+	}
+
+	if (!ColumnarFormat::decodeChunk(body, header.m_bodySize, header.m_recordCount, m_records))
+	{
+		m_records.clear();
+		m_lastResult = XRV_DATACORRUPT;
+		return false;
+	}
+	m_nextChunk = offset + ColumnarFormat::chunkHeaderSize + header.m_storedSize;
+	return true;
+}
+
+/*! \brief Get the next record, loading the next chunk when needed
+	\details The returned data stays valid until the next chunk is loaded
+*/
+bool ColumnarLogReader::nextRecord(ColumnarFormat::RecordType& type, uint8_t const*& data, XsSize& size)
+{
+	while (m_recordOffset >= m_records.size())
+		if (!loadChunk(m_nextChunk))
+			return false;
+
+	m_recordOffset = ColumnarFormat::nextRecord(m_records, m_recordOffset, type, data, size);
+	return true;
+}
+
+/*! \brief Read the next record
+	\param type Receives the type of the record
+	\param data Receives the message or raw data as it was passed to the logger
+	\returns false at the end of the file or if the file is corrupt, see lastResult()
+*/
+bool ColumnarLogReader::readRecord(ColumnarFormat::RecordType& type, XsByteArray& data)
+{
+	uint8_t const* src;
+	XsSize size;
+	if (!nextRecord(type, src, size))
+		return false;
+	data.assign(size, src);
+	return true;
+}
+
+/*! \brief Read the next message, skipping raw data records
+	\param message Receives the message
+	\returns false at the end of the file or if the file is corrupt, see lastResult()
+*/
+bool ColumnarLogReader::readMessage(XsMessage& message)
+{
+	ColumnarFormat::RecordType type;
+	uint8_t const* data;
+	XsSize size;
+	do
+	{
+		if (!nextRecord(type, data, size))
+			return false;
+	} while (type != ColumnarFormat::RT_Message);
+
+	message.loadFromString(data, size);
+	return true;
+}
+
+/*! \brief Read the next MtData2 message as a data packet, skipping all other records
+	\param packet Receives the data packet
+	\returns false at the end of the file or if the file is corrupt, see lastResult()
+*/
+bool ColumnarLogReader::readDataPacket(XsDataPacket& packet)
+{
+	do
+	{
+		if (!readMessage(m_message))
+			return false;
+	} while (m_message.getMessageId() != XMID_MtData2);
+
+	packet.setMessage(m_message);
+	return true;
+}
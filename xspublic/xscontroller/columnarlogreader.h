@@ -0,0 +1,91 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+#ifndef COLUMNARLOGREADER_H
+#define COLUMNARLOGREADER_H
+
+#include "columnarformat.h"
+#include <xstypes/xsmessage.h>
+#include <xstypes/xsresultvalue.h>
+#include <memory>
+#include <vector>
+
+class IoInterfaceFile;
+struct XsDataPacket;
+
+/*! \class ColumnarLogReader
+	\brief Reads the records of a file written by ColumnarDataLogger
+	\details The records are read chunk by chunk, each chunk is checked against its CRC before it is decoded.
+	Files without an index, for example because the logger was not closed, can be read sequentially, seeking
+	then scans the chunk headers first.
+*/
+class ColumnarLogReader
+{
+public:
+	ColumnarLogReader();
+	~ColumnarLogReader();
+
+	bool open(const XsString& filename);
+	void close();
+	bool isOpen() const;
+	XsResultValue lastResult() const;
+
+	//! \returns true if the file has a valid chunk index
+	inline bool hasIndex() const
+	{
+		return m_hasIndex;
+	}
+
+	uint64_t recordCount();
+	bool seek(uint64_t record);
+
+	bool readRecord(ColumnarFormat::RecordType& type, XsByteArray& data);
+	bool readMessage(XsMessage& message);
+	bool readDataPacket(XsDataPacket& packet);
+
+private:
+	bool scanIndex();
+	bool loadChunk(uint64_t offset);
+	bool nextRecord(ColumnarFormat::RecordType& type, uint8_t const*& data, XsSize& size);
+
+	std::shared_ptr<IoInterfaceFile> m_ioInterfaceFile;
+	XsResultValue m_lastResult;
+	uint64_t m_dataEnd;								//!< The file offset at which the chunks end
+	bool m_hasIndex;								//!< True if m_index holds all chunks in the file
+	std::vector<ColumnarFormat::IndexEntry> m_index;	//!< The chunks in the file
+	uint64_t m_nextChunk;							//!< The file offset of the chunk after the loaded chunk
+	std::vector<uint8_t> m_records;					//!< The records of the loaded chunk
+	XsSize m_recordOffset;							//!< The offset of the next record in m_records
+	std::vector<uint8_t> m_body;					//!< Scratch buffer for the decompressed chunk body
+	XsMessage m_message;							//!< Scratch message for readDataPacket
+};
+
+#endif
@@ -258,6 +258,49 @@ std::shared_ptr<ReplyObject> Communicator::addReplyObject(XsXbusMessageId mid, X
 	return m_replyMonitor->addReplyObject(new MidAndDataReplyObject(mid, offset, size, data));
 }
 
+/*! \brief Apply the thread settings of \a profile to the threads of this communicator
+	\details The default implementation does nothing, since the communicator has no threads of its own.
+	\param profile The profile to apply
+	\param coreIndex The index of the next processor to assign in RealTimeProfile::m_cores
+	\param report Receives the results
+*/
+void Communicator::applyRealTimeProfile(RealTimeProfile const& profile, XsSize& coreIndex, RealTimeProfileReport& report)
+{
+	(void) profile;
+	(void) coreIndex;
+	(void) report;
+}
+
+/*! \brief Start writing the data received by this communicator to a raw capture file
+	\details The default implementation does nothing, since the communicator does not receive a raw data stream.
+	\param filename The name of the capture file
+	\returns XRV_UNSUPPORTED
+	\sa DataParser::startRawCapture
+*/
+XsResultValue Communicator::startRawCapture(const XsString& filename)
+{
+	(void) filename;
+	return XRV_UNSUPPORTED;
+}
+
+/*! \brief Stop the raw capture that was started with startRawCapture
+	\returns XRV_UNSUPPORTED
+*/
+XsResultValue Communicator::stopRawCapture()
+{
+	return XRV_UNSUPPORTED;
+}
+
+/*! \brief Use \a cache to answer the static initialization queries of the connected device
+	\details The default implementation does nothing, communicators that talk to a live device override this.
+	\param cache The cache to use, may be shared by multiple communicators. An empty pointer disables caching.
+	\sa DeviceDescriptorCache
+*/
+void Communicator::setDescriptorCache(std::shared_ptr<DeviceDescriptorCache> cache)
+{
+	(void) cache;
+}
+
 /*! \brief Add a custom ReplyObject
 	\param[in] obj The reply object to add
 	\returns a shared pointer to the supplied reply object
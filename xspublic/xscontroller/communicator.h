@@ -44,6 +44,7 @@
 #include "serialinterface.h"
 #include <xstypes/xsresultvalue.h>
 #include <xstypes/xstimestamp.h>
+#include "realtimeprofile.h"
 
 #include <memory>
 #include <vector>
@@ -52,6 +53,7 @@ struct XsByteArray;
 struct XsString;
 struct XsMessage;
 struct XsDeviceConfiguration;
+class DeviceDescriptorCache;
 namespace xsens
 {
 class ReplyMonitor;
@@ -294,6 +296,10 @@ public:
 		\param handler an \ref IProtocolHandler
 	*/
 	virtual void addProtocolHandler(IProtocolHandler* handler);
+	virtual void applyRealTimeProfile(RealTimeProfile const& profile, XsSize& coreIndex, RealTimeProfileReport& report);
+	virtual XsResultValue startRawCapture(const XsString& filename);
+	virtual XsResultValue stopRawCapture();
+	virtual void setDescriptorCache(std::shared_ptr<DeviceDescriptorCache> cache);
 	void removeProtocolHandler(XsProtocolType type);
 	bool hasProtocol(XsProtocolType type) const;
 
@@ -56,7 +56,8 @@ public:
 	//! \brief The types of logger a derived class can be
 	enum class Type {
 		Mtb,
-		Csv
+		Csv,
+		Columnar
 	};
 
 	//! \returns The type of logger of the derived class
@@ -32,8 +32,226 @@
 
 #include "datapacketcache.h"
 #include <xstypes/xsdatapacket.h>
+#include <xstypes/xstimestamp.h>
+#include <string.h>
 
-std::pair<DataPacketCache::iterator, bool> DataPacketCache::insert(int64_t id, XsDataPacket const& p)
+/*! \brief Constructor
+	\param maxSlots The maximum number of packet ids that the cache may span
+*/
+DataPacketCache::DataPacketCache(XsSize maxSlots)
+	: m_head(0)
+	, m_base(0)
+	, m_span(0)
+	, m_count(0)
+	, m_maxSlots(maxSlots ? maxSlots : 1)
 {
-	return insert(std::make_pair(id, new XsDataPacket(p)));
+	memset(&m_statistics, 0, sizeof(m_statistics));
+}
+
+/*! \brief Destructor, deletes all contained packets */
+DataPacketCache::~DataPacketCache()
+{
+	try
+	{
+		clear();
+	}
+	catch (...)
+	{
+	}
+}
+
+/*! \brief Set the maximum number of packet ids that the cache may span
+	\details When the cache currently spans more packet ids, the oldest packets are evicted.
+	\param maxSlots The new limit, 0 is interpreted as 1
+*/
+void DataPacketCache::setMaxSlots(XsSize maxSlots)
+{
+	m_maxSlots = maxSlots ? maxSlots : 1;
+	if (m_span > m_maxSlots)
+		evictBefore(lastPacketId() - (int64_t) m_maxSlots + 1);
+}
+
+/*! \brief Returns true if a packet with \a id can be inserted without exceeding maxSlots()
+	\param id The packet id to check
+	\returns true if the packet fits
+*/
+bool DataPacketCache::fits(int64_t id) const
+{
+	if (!m_count)
+		return true;
+	if (id < m_base)
+		return (XsSize)(m_base - id) + m_span <= m_maxSlots;
+	return (XsSize)(id - m_base) < m_maxSlots;
+}
+
+/*! \brief Find the packet with \a id
+	\param id The packet id to look for
+	\returns The packet or NULL if it is not in the cache
+*/
+XsDataPacket* DataPacketCache::find(int64_t id) const
+{
+	if (!m_count || id < m_base || id > lastPacketId())
+		return nullptr;
+	return slot(id).m_packet;
+}
+
+/*! \brief Insert \a pack with \a id into the cache
+	\details The cache takes ownership of \a pack when the function succeeds. Packet ids that are skipped
+	between the current newest packet and \a id become gap slots.
+	\param id The packet id of \a pack
+	\param pack The packet to insert
+	\returns false if a packet with \a id is already present or if it does not fit in the cache, the caller
+	keeps ownership of \a pack in that case
+*/
+bool DataPacketCache::insert(int64_t id, XsDataPacket* pack)
+{
+	if (!fits(id))
+		return false;
+
+	if (!m_count)
+	{
+		reserveSpan(1);
+		m_base = id;
+		m_span = 1;
+	}
+	else if (id > lastPacketId())
+	{
+		XsSize span = (XsSize)(id - m_base) + 1;
+		reserveSpan(span);
+		int64_t firstGap = lastPacketId() + 1;
+		m_span = span;
+		markGaps(firstGap, id - 1);
+	}
+	else if (id < m_base)
+	{
+		XsSize grow = (XsSize)(m_base - id);
+		reserveSpan(m_span + grow);
+		int64_t lastGap = m_base - 1;
+		m_head = (m_head + m_slots.size() - grow) & (m_slots.size() - 1);
+		m_base = id;
+		m_span += grow;
+		markGaps(id + 1, lastGap);
+	}
+	else
+	{
+		Slot& s = slot(id);
+		if (s.m_packet)
+			return false;
+		closeGap(s, true);
+	}
+
+	Slot& s = slot(id);
+	s.m_packet = pack;
+	s.m_gapStart = 0;
+	++m_count;
+	return true;
+}
+
+/*! \brief Remove and delete the oldest packet in the cache
+	\details Gap slots that directly follow the packet are released as well, so the next oldest packet
+	becomes the front of the cache.
+*/
+void DataPacketCache::popFront()
+{
+	dropFront(false);
+}
+
+/*! \brief Remove and delete all packets with an id lower than \a id, counting them as evicted
+	\param id The first packet id to keep
+*/
+void DataPacketCache::evictBefore(int64_t id)
+{
+	while (m_count && m_base < id)
+		dropFront(true);
+}
+
+/*! \brief Remove and delete all packets with an id lower than \a id
+	\param id The first packet id to keep
+*/
+void DataPacketCache::eraseBefore(int64_t id)
+{
+	while (m_count && m_base < id)
+		dropFront(false);
+}
+
+/*! \brief Remove and delete all packets in the cache
+	\note The statistics are not reset
+*/
+void DataPacketCache::clear()
+{
+	while (m_count)
+		dropFront(false);
+	m_head = 0;
+	m_span = 0;
+}
+
+/*! \brief Make sure the ring can hold \a span consecutive packet ids, keeping the current contents */
+void DataPacketCache::reserveSpan(XsSize span)
+{
+	if (span <= m_slots.size())
+		return;
+
+	XsSize cap = m_slots.empty() ? 64 : m_slots.size();
+	while (cap < span)
+		cap *= 2;
+
+	std::vector<Slot> slots(cap);
+	for (XsSize i = 0; i < m_span; ++i)
+		slots[i] = m_slots[(m_head + i) & (m_slots.size() - 1)];
+	m_slots.swap(slots);
+	m_head = 0;
+}
+
+/*! \brief Turn the slots for \a first up to and including \a last into gaps */
+void DataPacketCache::markGaps(int64_t first, int64_t last)
+{
+	if (first > last)
+		return;
+
+	int64_t now = XsTimeStamp::nowMs();
+	for (int64_t i = first; i <= last; ++i)
+	{
+		Slot& s = slot(i);
+		s.m_packet = nullptr;
+		s.m_gapStart = now;
+	}
+}
+
+/*! \brief Update the gap statistics for gap slot \a s which is either \a filled or released */
+void DataPacketCache::closeGap(Slot& s, bool filled)
+{
+	uint64_t held = (uint64_t)(XsTimeStamp::nowMs() - s.m_gapStart);
+	if (filled)
+		++m_statistics.m_gapsFilled;
+	else
+		++m_statistics.m_gapsReleased;
+	m_statistics.m_totalGapHoldMs += held;
+	if (held > m_statistics.m_maxGapHoldMs)
+		m_statistics.m_maxGapHoldMs = held;
+}
+
+/*! \brief Remove and delete the oldest packet and the gaps that follow it
+	\param evicted When true the packet is counted as evicted
+*/
+void DataPacketCache::dropFront(bool evicted)
+{
+	Slot& front = slot(m_base);
+	delete front.m_packet;
+	front.m_packet = nullptr;
+	--m_count;
+	if (evicted)
+		++m_statistics.m_evictedPackets;
+
+	do
+	{
+		m_head = (m_head + 1) & (m_slots.size() - 1);
+		++m_base;
+		--m_span;
+		if (!m_count)
+			break;
+		Slot& s = slot(m_base);
+		if (s.m_packet)
+			break;
+		closeGap(s, false);
+	} while (m_span);
 }
@@ -34,26 +34,122 @@
 #define DATAPACKETCACHE_H
 
 #include <xstypes/pstdint.h>
-#include <map>
+#include <xstypes/xstypedefs.h>
+#include <vector>
 struct XsDataPacket;
 
+/*! \struct DataPacketCacheStatistics
+	\brief Counters describing how a DataPacketCache was used
+*/
+struct DataPacketCacheStatistics
+{
+	uint64_t m_gapsFilled;			//!< The number of gap slots that were filled by a (retransmitted) packet
+	uint64_t m_gapsReleased;		//!< The number of gap slots that were dropped without receiving a packet
+	uint64_t m_totalGapHoldMs;		//!< The total time in ms that gap slots were held before being filled or released
+	uint64_t m_maxGapHoldMs;		//!< The longest time in ms that a single gap slot was held
+	uint64_t m_evictedPackets;		//!< The number of packets that were removed because the cache limit was reached
+};
+
 /*! \class DataPacketCache
-	\brief A cache of data packets
+	\brief A cache of data packets, ordered by packet id
+	\details The cache is a ring buffer that is indexed by the packet id relative to the oldest packet in the
+	cache. Packet ids are usually consecutive, so insertion, lookup and removal at the front are O(1). Packet ids
+	between the oldest and the newest packet that have not been received yet are kept as gap slots, these are
+	the packets that are still awaiting retransmission. The cache never spans more than maxSlots() packet ids.
+	The cache owns the packets that are stored in it.
 */
-class DataPacketCache : public std::map<int64_t, XsDataPacket*>
+class DataPacketCache
 {
 public:
+	//! \brief The default for maxSlots()
+	static const XsSize defaultMaxSlots = 65536;
+
+	DataPacketCache(XsSize maxSlots = defaultMaxSlots);
+	~DataPacketCache();
+
+	//! \returns true if the cache contains no packets
+	inline bool empty() const
+	{
+		return m_count == 0;
+	}
+
+	//! \returns The number of packets in the cache, this excludes gap slots
+	inline XsSize size() const
+	{
+		return m_count;
+	}
+
+	//! \returns The packet id of the oldest packet in the cache, only valid when the cache is not empty
+	inline int64_t firstPacketId() const
+	{
+		return m_base;
+	}
+
+	//! \returns The packet id of the newest packet in the cache, only valid when the cache is not empty
+	inline int64_t lastPacketId() const
+	{
+		return m_base + (int64_t) m_span - 1;
+	}
+
+	//! \returns The oldest packet in the cache or NULL if the cache is empty
+	inline XsDataPacket* front() const
+	{
+		return m_count ? slot(m_base).m_packet : nullptr;
+	}
+
+	//! \returns The maximum number of packet ids that the cache may span
+	inline XsSize maxSlots() const
+	{
+		return m_maxSlots;
+	}
+
+	//! \returns The usage counters of the cache
+	inline DataPacketCacheStatistics const& statistics() const
+	{
+		return m_statistics;
+	}
+
+	void setMaxSlots(XsSize maxSlots);
+	bool fits(int64_t id) const;
+	XsDataPacket* find(int64_t id) const;
+	bool insert(int64_t id, XsDataPacket* pack);
+	void popFront();
+	void evictBefore(int64_t id);
+	void eraseBefore(int64_t id);
+	void clear();
+
+private:
+	//! \brief A single entry in the ring, either a packet or a gap
+	struct Slot
+	{
+		XsDataPacket* m_packet;		//!< The packet in this slot or NULL if this slot is a gap
+		int64_t m_gapStart;			//!< The time in ms at which this slot became a gap
+	};
+
+	//! \returns The slot for packet \a id, \a id must be within the current span
+	inline Slot& slot(int64_t id)
+	{
+		return m_slots[(m_head + (XsSize)(id - m_base)) & (m_slots.size() - 1)];
+	}
+
+	//! \returns The slot for packet \a id, \a id must be within the current span
+	inline Slot const& slot(int64_t id) const
+	{
+		return m_slots[(m_head + (XsSize)(id - m_base)) & (m_slots.size() - 1)];
+	}
 
-	//! \brief A map typed of integer values and data packets
-	typedef std::map<int64_t, XsDataPacket*> Base;
-	using Base::insert;
+	void reserveSpan(XsSize span);
+	void markGaps(int64_t first, int64_t last);
+	void closeGap(Slot& s, bool filled);
+	void dropFront(bool evicted);
 
-	/*! \brief Inserts a data packet
-		\param id The ID of data packet
-		\param p The data packet to insert
-		\returns A pair of iterator and boolean value
-	*/
-	std::pair<iterator, bool> insert(int64_t id, XsDataPacket const& p);
+	std::vector<Slot> m_slots;		//!< The ring storage, its size is always 0 or a power of 2
+	XsSize m_head;					//!< The index in m_slots of the slot for m_base
+	int64_t m_base;					//!< The packet id of the oldest packet in the cache
+	XsSize m_span;					//!< The number of packet ids from the oldest to the newest packet, including gaps
+	XsSize m_count;					//!< The number of packets in the cache
+	XsSize m_maxSlots;				//!< The maximum value of m_span
+	DataPacketCacheStatistics m_statistics;	//!< The usage counters
 };
 
 #endif
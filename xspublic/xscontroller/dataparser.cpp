@@ -33,6 +33,11 @@
 #include "dataparser.h"
 #include "xscontrollerconfig.h"
 #include <xstypes/xsmessage.h>
+#include "metrics.h"
+#include "latencytracer.h"
+#include <xstypes/xstime.h>
+#include "portscheduler.h"
+#include "rawcapture.h"
 
 
 /*!	\class DataParser
@@ -40,11 +45,18 @@
 */
 
 /*! \brief Default constructor
+	\details When PortScheduler::isEnabled() is true, no parser thread is started and the data is parsed directly
+	on the PortScheduler worker that read it.
 */
 DataParser::DataParser()
+	: m_sharedScheduling(PortScheduler::isEnabled())
+	, m_pool(receiveBufferCount, receiveBufferSize)
+	, m_droppedBytes(0)
+	, m_rawCaptureActive(false)
 {
-	JLDEBUGG("Starting DataParser " << this);
-	startThread();
+	JLDEBUGG("Starting DataParser " << this << (m_sharedScheduling ? " without thread" : ""));
+	if (!m_sharedScheduling)
+		startThread();
 }
 
 DataParser::~DataParser()
@@ -59,18 +71,105 @@ DataParser::~DataParser()
 	}
 }
 
-/*! \brief Adds the raw data to an array
+/*! \brief Adds a copy of the raw data to the data that is to be parsed
+	\details This is used by parsers that have their data pushed to them, see receivesPushedData(). When all
+	receive buffers are in use, the function waits until the parser thread releases one. When the parser thread
+	is stopped the data is discarded and counted in droppedByteCount().
 	\param arr The reference to a byte array to which the data will be added
 */
 void DataParser::addRawData(const XsByteArray& arr)
 {
-	xsens::Lock locky(&m_incomingMutex);
-	m_incoming.push(arr);
-	locky.unlock();
+	if (arr.empty())
+		return;
+
+	xsens::Lock locky(&m_pushMutex);
+	if (m_sharedScheduling)
+	{
+		captureRawData(arr);
+		DeviceMetrics* metrics = parserMetrics();
+		if (metrics)
+			metrics->m_bytesRead->add(arr.size());
+
+		XSLATENCY_BEGIN(XsTime_monotonicUs());
+		parseBlock(arr);
+		XSLATENCY_END();
+		return;
+	}
+
+	// nobody would parse the data anymore
+	if (isTerminating() || !isAlive())
+	{
+		dropData(arr.size());
+		return;
+	}
+
+	ReceiveBuffer* buffer = acquireReceiveBuffer();
+	while (!buffer)
+	{
+		// reset before trying again, so a buffer that is released after the last attempt sets the event again
+		m_releasedEvent.reset();
+		if (isTerminating() || !isAlive())
+			break;
+		buffer = m_pool.acquire();
+		if (!buffer && !m_releasedEvent.wait())
+			break;
+	}
+	if (!buffer)
+	{
+		dropData(arr.size());
+		return;
+	}
+	buffer->m_data = arr;
+	submitReceiveBuffer(buffer);
+}
+
+/*! \brief Get an empty receive buffer to read data into
+	\details The buffer should be passed back with submitReceiveBuffer(). This function and submitReceiveBuffer() should
+	only be called by the thread that reads the data.
+	\returns The buffer or nullptr if all buffers are in use, in which case the caller should try again later
+*/
+ReceiveBuffer* DataParser::acquireReceiveBuffer()
+{
+	ReceiveBuffer* buffer = m_pool.acquire();
+	if (!buffer)
+	{
+		DeviceMetrics* metrics = parserMetrics();
+		if (metrics)
+			metrics->m_receivePoolExhausted->add(1);
+	}
+	return buffer;
+}
+
+/*! \brief Hand a filled receive buffer to the parser
+	\details Ownership of the buffer passes to the parser, which returns it to the pool after the data has been
+	extracted. With shared scheduling the data is parsed immediately by the calling thread.
+	\param buffer The buffer obtained from acquireReceiveBuffer(), containing the read data
+*/
+void DataParser::submitReceiveBuffer(ReceiveBuffer* buffer)
+{
+	captureRawData(buffer->m_data);
+	DeviceMetrics* metrics = parserMetrics();
+	if (metrics)
+		metrics->m_bytesRead->add(buffer->m_data.size());
+
+	if (m_sharedScheduling)
+	{
+		XSLATENCY_BEGIN(XsTime_monotonicUs());
+		parseBlock(buffer->m_data);
+		XSLATENCY_END();
+		m_pool.release(buffer);
+		return;
+	}
+
+	buffer->m_queued = XSLATENCY_NOW();
+	m_pool.submit(buffer);
+	if (metrics)
+		metrics->m_incomingQueueDepth->set((int64_t) m_pool.pending());
 	m_newDataEvent.set();
 }
 
 /*! \brief The inner thread function
+	\details Parses the submitted receive buffers one by one and returns them to the pool
 */
 int32_t DataParser::innerFunction()
 {
@@ -78,40 +177,59 @@ int32_t DataParser::innerFunction()
 	if (!m_newDataEvent.wait())
 		return 1;	// no new data available (so we are keeping up easily), give other threads a little more breathing room
 
-	// get new data
-	XsByteArray raw;
-	xsens::Lock lockIncoming(&m_incomingMutex);
-	while (!m_incoming.empty() && !isTerminating())
+	// reset before checking the pool, so a buffer that is submitted after the last check sets the event again
+	m_newDataEvent.reset();
+
+	// a thread that waits in addRawData is woken for a batch of released buffers instead of for every buffer
+	const XsSize releaseBatch = receiveBufferCount / 4;
+	XsSize released = 0;
+	ReceiveBuffer* buffer;
+	while (!isTerminating() && (buffer = m_pool.receive()) != nullptr)
 	{
-		raw.append(m_incoming.front());
-		m_incoming.pop();
-		lockIncoming.unlock();
+		XSLATENCY_BEGIN(buffer->m_queued);
 
-		JLTRACEG("raw size: " << raw.size());
+		DeviceMetrics* metrics = parserMetrics();
+		if (metrics)
+			metrics->m_incomingQueueDepth->set((int64_t) m_pool.pending());
+
+		JLTRACEG("raw size: " << buffer->m_data.size());
 
 		// process data
-		if (!raw.empty() && !isTerminating())
+		parseBlock(buffer->m_data);
+		m_pool.release(buffer);
+		if (++released % releaseBatch == 0)
+			m_releasedEvent.set();
+		XSLATENCY_END();
+	}
+	if (released % releaseBatch)
+		m_releasedEvent.set();
+	return 0;	// we handled all our data, but more can be waiting
+}
+
+/*! \brief Extract the messages from \a raw and handle them
+	\param raw The newly received data
+*/
+void DataParser::parseBlock(const XsByteArray& raw)
+{
+	if (raw.empty() || isTerminating())
+		return;
+
+	// reuse the message list to avoid allocating it for every block
+	std::deque<XsMessage>& msgs = m_messages;
+	XsResultValue res = processBufferedData(raw, msgs);
+	XSLATENCY_MARK(LM_Extracted);
+	JLTRACEG("Parse result " << res << ": " << msgs.size() << " messages");
+
+	if (res != XRV_TIMEOUT && res != XRV_TIMEOUTNODATA && !isTerminating())
+	{
+		for (XsMessage const& msg : msgs)
 		{
-			std::deque<XsMessage> msgs;
-			XsResultValue res = processBufferedData(raw, msgs);
-			JLTRACEG("Parse result " << res << ": " << msgs.size() << " messages");
-
-			if (res != XRV_TIMEOUT && res != XRV_TIMEOUTNODATA && !isTerminating())
-			{
-				for (XsMessage const& msg : msgs)
-				{
-					handleMessage(msg);
-					if (isTerminating())
-						break;
-				}
-			}
-			raw.clear();
+			handleMessage(msg);
+			if (isTerminating())
+				break;
 		}
-
-		lockIncoming.lock();
 	}
-	m_newDataEvent.reset();
-	return 0;	// we handled all our data, but more can be waiting
+	msgs.clear();
 }
 
 /*! \brief Initializes the thread
@@ -124,20 +242,38 @@ void DataParser::initFunction()
 	xsNameThisThread(m_parserType);
 }
 
+/*! \brief Count \a size received bytes as discarded without parsing
+*/
+void DataParser::dropData(XsSize size)
+{
+	if (!size)
+		return;
+	if (m_droppedBytes.fetch_add(size, std::memory_order_relaxed) == 0)
+		JLALERTG("DataParser " << this << " discards received data because the parser is stopped");
+	DeviceMetrics* metrics = parserMetrics();
+	if (metrics)
+		metrics->m_bytesDropped->add(size);
+}
+
 /*! \brief Clears the data queue
+	\details The data that was submitted but not parsed yet is counted in droppedByteCount()
+	\note This should only be called when the parser thread is not running
 */
 void DataParser::clear()
 {
-	xsens::Lock lockIncoming(&m_incomingMutex);
-
-	while (!m_incoming.empty())
-		m_incoming.pop();
+	ReceiveBuffer* buffer;
+	while ((buffer = m_pool.receive()) != nullptr)
+	{
+		dropData(buffer->m_data.size());
+		m_pool.release(buffer);
+	}
 }
 
 void DataParser::signalStopThread(void)
 {
 	StandardThread::signalStopThread();
 	m_newDataEvent.terminate();
+	m_releasedEvent.terminate();
 }
 
 /*! \brief Terminates the thread
@@ -147,4 +283,66 @@ void DataParser::terminate()
 	JLDEBUGG("Thread " << this << " type: " << m_parserType);
 	stopThread();
 	clear();
+	stopRawCapture();
+}
+
+/*! \brief Start writing all received data to a raw capture file
+	\details Every block of data that is handed to the parser is written with its time of arrival, so the capture can
+	be replayed with the original chunking and timing by a ReplayStreamInterface. Capturing can be started and stopped
+	while data is being received.
+	\param filename The name of the capture file, an existing file is overwritten
+	\returns XRV_OK if successful, XRV_ALREADYOPEN if a capture is already active
+	\sa RawCaptureWriter
+*/
+XsResultValue DataParser::startRawCapture(const XsString& filename)
+{
+	if (std::atomic_load(&m_rawCapture))
+		return XRV_ALREADYOPEN;
+
+	std::shared_ptr<RawCaptureWriter> capture = std::make_shared<RawCaptureWriter>();
+	XsResultValue result = capture->create(filename);
+	if (result != XRV_OK)
+		return result;
+
+	std::shared_ptr<RawCaptureWriter> expected;
+	if (!std::atomic_compare_exchange_strong(&m_rawCapture, &expected, capture))
+	{
+		capture->close();
+		return XRV_ALREADYOPEN;
+	}
+	m_rawCaptureActive = true;
+	JLDEBUGG("Started raw capture to " << filename);
+	return XRV_OK;
+}
+
+/*! \brief Stop the active raw capture and close its file
+	\returns XRV_OK if the capture file was written successfully, XRV_NOFILEOPEN if no capture was active
+*/
+XsResultValue DataParser::stopRawCapture()
+{
+	m_rawCaptureActive = false;
+	std::shared_ptr<RawCaptureWriter> capture = std::atomic_exchange(&m_rawCapture, std::shared_ptr<RawCaptureWriter>());
+	if (!capture)
+		return XRV_NOFILEOPEN;
+	JLDEBUGG("Stopped raw capture after " << capture->chunkCount() << " chunks");
+	return capture->close();
+}
+
+//! \returns true if a raw capture is active
+bool DataParser::isCapturingRaw() const
+{
+	return m_rawCaptureActive.load(std::memory_order_relaxed);
+}
+
+/*! \brief Write \a raw to the active raw capture, if any
+	\param raw The received data
+*/
+void DataParser::captureRawData(const XsByteArray& raw)
+{
+	if (!m_rawCaptureActive.load(std::memory_order_relaxed))
+		return;
+
+	std::shared_ptr<RawCaptureWriter> capture = std::atomic_load(&m_rawCapture);
+	if (capture)
+		capture->write(XsTime_monotonicUs(), raw.data(), raw.size());
 }
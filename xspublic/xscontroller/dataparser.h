@@ -37,9 +37,14 @@
 #include <xstypes/xsresultvalue.h>
 #include <xscommon/threading.h>
 #include <xstypes/xsbytearray.h>
-#include <queue>
+#include <xstypes/xsmessage.h>
+#include <xstypes/xsstring.h>
+#include "receivebufferpool.h"
+#include <atomic>
+#include <memory>
 
-struct XsMessage;
+class DeviceMetrics;
+class RawCaptureWriter;
 
 class DataParser : protected xsens::StandardThread
 {
@@ -64,24 +69,75 @@ public:
 	virtual void handleMessage(const XsMessage& message) = 0;
 
 	void addRawData(const XsByteArray& arr);
+	ReceiveBuffer* acquireReceiveBuffer();
+	void submitReceiveBuffer(ReceiveBuffer* buffer);
 	void clear();
 	void terminate();
 
+	XsResultValue startRawCapture(const XsString& filename);
+	XsResultValue stopRawCapture();
+	bool isCapturingRaw() const;
+
+	//! \returns true if the data is parsed by the thread that adds it instead of by the parser thread
+	inline bool usesSharedScheduling() const
+	{
+		return m_sharedScheduling;
+	}
+
+	//! \returns The pool of buffers that is used to pass the read data to the parser thread
+	inline ReceiveBufferPool const& receiveBufferPool() const
+	{
+		return m_pool;
+	}
+
+	//! \returns The number of received bytes that were discarded without parsing because the parser was stopped
+	inline uint64_t droppedByteCount() const
+	{
+		return m_droppedBytes.load(std::memory_order_relaxed);
+	}
+
+	//! \returns true if the data is supplied through addRawData instead of being read by readDataToBuffer
+	virtual bool receivesPushedData() const
+	{
+		return false;
+	}
+
 	//! \returns The parser type
 	virtual const char* parserType() const
 	{
 		return "DataParser";
 	}
 
+	//! \returns The metrics to update with the received data or nullptr if the data should not be counted
+	virtual DeviceMetrics* parserMetrics() const
+	{
+		return nullptr;
+	}
+
 protected:
 	void initFunction() override;
 	int32_t innerFunction() override;
 	void signalStopThread(void) override;
 
 private:
-	xsens::Mutex m_incomingMutex;
-	std::queue<XsByteArray> m_incoming;
+	//! \brief The number of buffers in the receive pool
+	static const XsSize receiveBufferCount = 32;
+	//! \brief The number of bytes reserved in each receive buffer, matching the largest read of SerialCommunicator
+	static const XsSize receiveBufferSize = 8192;
+
+	void parseBlock(const XsByteArray& raw);
+	void captureRawData(const XsByteArray& raw);
+	void dropData(XsSize size);
+
+	bool m_sharedScheduling;
+	ReceiveBufferPool m_pool;			//!< The buffers that are passed from the reading thread to the parser thread
+	xsens::Mutex m_pushMutex;			//!< Serializes the threads that call addRawData
+	std::deque<XsMessage> m_messages;	//!< The messages extracted by parseBlock, kept to reuse its memory
 	xsens::WaitEvent m_newDataEvent;
+	xsens::WaitEvent m_releasedEvent;	//!< Set by the parser thread when it returns a buffer to the pool, waited on by addRawData
+	std::atomic<uint64_t> m_droppedBytes;	//!< The number of bytes discarded without parsing, see droppedByteCount()
+	std::shared_ptr<RawCaptureWriter> m_rawCapture;	//!< The active raw capture, only accessed with the std::atomic_ functions
+	std::atomic<bool> m_rawCaptureActive;			//!< True when m_rawCapture is set, checked before accessing it
 	char m_parserType[128];
 };
 
@@ -32,11 +32,13 @@
 
 #include "datapoller.h"
 #include "dataparser.h"
+#include "receivebufferpool.h"
 
 /*! \brief Create a DataPoller with a \a parser */
 
 DataPoller::DataPoller(DataParser& parser)
 	: m_parser(parser)
+	, m_buffer(nullptr)
 {
 	JLDEBUGG("Starting DataPoller " << this << " for parser " << &parser);
 	m_yieldOnZeroSleep = false;
@@ -87,14 +89,36 @@ void DataPoller::cleanup()
 */
 int32_t DataPoller::innerFunction(void)
 {
-	m_readbuffer.assign(0, NULL);
+	return pollOnce();
+}
 
-	if (m_parser.readDataToBuffer(m_readbuffer) != XRV_OK)
+/*! \brief Read the available data and hand it to the parser
+	\details This is called repeatedly by the poller thread, or by the PortScheduler when the thread is not used.
+	The data is read directly into a buffer from the receive pool of the parser, which is handed over to the parser
+	without copying it. When the pool is exhausted no data is read until the parser has released a buffer.
+	\returns The number of ms to wait before the next call
+*/
+int32_t DataPoller::pollOnce()
+{
+	if (m_parser.receivesPushedData())
+		return conjureUpWaitTime(XsByteArray());
+
+	if (!m_buffer)
+	{
+		m_buffer = m_parser.acquireReceiveBuffer();
+		if (!m_buffer)
+			return 1;
+	}
+
+	if (m_parser.readDataToBuffer(m_buffer->m_data) != XRV_OK)
 		return 1;
 
-	int32_t retval = conjureUpWaitTime(m_readbuffer);
-	if (m_readbuffer.size())
-		m_parser.addRawData(m_readbuffer);
+	int32_t retval = conjureUpWaitTime(m_buffer->m_data);
+	if (m_buffer->m_data.size())
+	{
+		m_parser.submitReceiveBuffer(m_buffer);
+		m_buffer = nullptr;
+	}
 
 	return retval;
 }
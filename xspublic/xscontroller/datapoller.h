@@ -40,6 +40,7 @@ struct XsMessage;
 class DataParser;
 class ParseMessageThread;
 struct XsByteArray;
+struct ReceiveBuffer;
 
 /*! \brief A class implementing some basic data poller behavior
 */
@@ -49,6 +50,8 @@ public:
 	virtual ~DataPoller();
 	explicit DataPoller(DataParser& parser);
 
+	virtual int32_t pollOnce();
+
 protected:
 	virtual int32_t conjureUpWaitTime(const XsByteArray& bytes) const;
 	void initFunction() override;
@@ -58,7 +61,7 @@ protected:
 
 private:
 	DataParser& m_parser;
-	XsByteArray m_readbuffer;
+	ReceiveBuffer* m_buffer;	//!< The receive buffer that is being filled, owned by the receive pool of m_parser
 };
 
 #endif
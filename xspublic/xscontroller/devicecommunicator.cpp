@@ -50,6 +50,8 @@
 */
 DeviceCommunicator::DeviceCommunicator(RxChannelId rxChannels)
 	: m_gotoConfigTimeout(m_defaultGotoConfigTimeout)
+	, m_descriptorDeviceId(0)
+	, m_knownInConfig(false)
 	, m_nextRxChannelId(0)
 #ifdef LOG_COMMUNICATOR_RX_TX_TIMESTAMPED
 	, m_logStart(XsTimeStamp::now())
@@ -70,12 +72,38 @@ DeviceCommunicator::~DeviceCommunicator()
 }
 
 /*! \brief Write a message and await the reply
+	\details When a descriptor cache is set, static requests of a known device are answered from the cache without
+	communicating with the device, see setDescriptorCache.
 	\param msg The message to send
 	\param rcv The message to receive
 	\param timeout The timeout in ms
 	\returns True if successful
 */
 bool DeviceCommunicator::doTransaction(const XsMessage& msg, XsMessage& rcv, uint32_t timeout)
+{
+	if (!m_descriptorCache)
+		return doLiveTransaction(msg, rcv, timeout);
+
+	if (replyFromDescriptors(msg, rcv))
+	{
+		setLastResult(XRV_OK);
+		return true;
+	}
+
+	if (!doLiveTransaction(msg, rcv, timeout))
+		return false;
+
+	updateDescriptors(msg, rcv);
+	return true;
+}
+
+/*! \brief Write a message to the device and await its reply
+	\param msg The message to send
+	\param rcv The message to receive
+	\param timeout The timeout in ms
+	\returns True if successful
+*/
+bool DeviceCommunicator::doLiveTransaction(const XsMessage& msg, XsMessage& rcv, uint32_t timeout)
 {
 	XsXbusMessageId expected = static_cast<XsXbusMessageId>(msg.getMessageId() + 1);
 
@@ -113,6 +141,147 @@ void DeviceCommunicator::setKeepAlive(bool enable)
 	(void)enable;
 }
 
+/*! \brief Use \a cache to answer the static initialization queries of the connected device
+	\details When the device id has been read, the firmware revision is always requested from the device. If it
+	matches the cached revision, the product code, hardware version, configuration, output configuration and filter
+	profile requests are answered from the cache and repeating the last output configuration is acknowledged without
+	sending it. Otherwise the cached replies are discarded and replaced by the replies the device gives.
+
+	With a cache, gotoConfig is also skipped when the device is known to be in config mode already.
+	\param cache The cache to use, an empty pointer disables caching
+*/
+void DeviceCommunicator::setDescriptorCache(std::shared_ptr<DeviceDescriptorCache> cache)
+{
+	resetDescriptorState();
+	m_descriptorCache = cache;
+}
+
+/*! \brief Forget the cached replies and the known state of the device
+	\details Call this when the communication stream is (re)opened, since a different device may be connected.
+*/
+void DeviceCommunicator::resetDescriptorState()
+{
+	m_knownInConfig = false;
+	xsens::Lock locky(&m_descriptorMutex);
+	m_descriptors.clear();
+	m_descriptorDeviceId = 0;
+}
+
+/*! \brief Validate the cached replies of \a deviceId against the firmware revision of the device
+	\param deviceId The id of the connected device
+*/
+void DeviceCommunicator::beginDescriptorSession(uint64_t deviceId)
+{
+	{
+		xsens::Lock locky(&m_descriptorMutex);
+		m_descriptors.clear();
+		m_descriptorDeviceId = 0;
+	}
+
+	DeviceDescriptorCache::Descriptors cached;
+	bool found = m_descriptorCache->load(deviceId, cached);
+
+	XsMessage snd(XMID_ReqFirmwareRevision), rcv;
+	snd.setBusId(XS_BID_MASTER);
+	if (!doLiveTransaction(snd, rcv, defaultTimeout()))
+		return;
+
+	xsens::Lock locky(&m_descriptorMutex);
+	m_descriptorDeviceId = deviceId;
+	auto fw = cached.find(XMID_ReqFirmwareRevision);
+	if (found && fw != cached.end() && fw->second == rcv)
+	{
+		m_descriptors.swap(cached);
+		m_descriptorCache->countHit();
+		return;
+	}
+
+	m_descriptors[XMID_ReqFirmwareRevision] = rcv;
+	m_descriptorCache->countMiss();
+	m_descriptorCache->store(deviceId, m_descriptors);
+}
+
+/*! \brief Answer \a msg from the cached replies of the connected device
+	\param msg The message that would be sent
+	\param rcv The cached reply
+	\returns True if \a msg was answered, false if it needs to be sent to the device
+*/
+bool DeviceCommunicator::replyFromDescriptors(const XsMessage& msg, XsMessage& rcv)
+{
+	uint8_t mid = msg.getMessageId();
+	if (msg.getBusId() != XS_BID_MASTER)
+		return false;
+
+	xsens::Lock locky(&m_descriptorMutex);
+	if (!m_descriptorDeviceId)
+		return false;
+
+	if (msg.getDataSize() == 0)
+	{
+		if (!DeviceDescriptorCache::isDescriptorRequest(mid))
+			return false;
+	}
+	else
+	{
+		// only the exact same request as the last one that was acknowledged can be skipped
+		auto request = m_descriptors.find(DeviceDescriptorCache::setRequestKey + mid);
+		if (!DeviceDescriptorCache::isRepeatableSet(mid) || request == m_descriptors.end() || !(request->second == msg))
+			return false;
+	}
+
+	auto reply = m_descriptors.find(mid);
+	if (reply == m_descriptors.end())
+		return false;
+
+	rcv = reply->second;
+	m_descriptorCache->countServed();
+	return true;
+}
+
+/*! \brief Update the cached replies of the connected device after a successful transaction
+	\param msg The message that was sent
+	\param rcv The reply of the device
+*/
+void DeviceCommunicator::updateDescriptors(const XsMessage& msg, const XsMessage& rcv)
+{
+	uint8_t mid = msg.getMessageId();
+	if (mid == XMID_GotoConfig)
+		return;
+
+	xsens::Lock locky(&m_descriptorMutex);
+	if (!m_descriptorDeviceId)
+		return;
+
+	if (mid == XMID_Reset || mid == XMID_RestoreFactoryDef)
+	{
+		m_descriptors.clear();
+		m_descriptorCache->remove(m_descriptorDeviceId);
+		m_descriptorDeviceId = 0;
+		return;
+	}
+
+	bool master = (msg.getBusId() == XS_BID_MASTER);
+	if (msg.getDataSize() == 0)
+	{
+		if (!master || !DeviceDescriptorCache::isDescriptorRequest(mid) || m_descriptors.count(mid))
+			return;
+		m_descriptors[mid] = rcv;
+	}
+	else
+	{
+		// a setting changed, the configuration contains the settings of all devices on the bus
+		m_descriptors.erase(mid);
+		m_descriptors.erase(DeviceDescriptorCache::setRequestKey + mid);
+		m_descriptors.erase(XMID_ReqConfiguration);
+		if (master && DeviceDescriptorCache::isRepeatableSet(mid))
+		{
+			m_descriptors[DeviceDescriptorCache::setRequestKey + mid] = msg;
+			m_descriptors[mid] = rcv;
+		}
+	}
+	m_descriptorCache->store(m_descriptorDeviceId, m_descriptors);
+}
+
 /*! \brief Set the timeout for the gotoConfig function.
 
 	\details The goto config function will try to put the device in config mode, but if the communication
@@ -151,6 +320,9 @@ XsResultValue DeviceCommunicator::getDeviceId()
 			deviceId = rcv_did.getDataLongLong();
 	}
 
+	if (m_descriptorCache)
+		beginDescriptorSession(deviceId);
+
 	XsMessage rcv_pdc;
 	XsString productCode;
 	snd.setMessageId(XMID_ReqProductCode);
@@ -179,6 +351,9 @@ XsResultValue DeviceCommunicator::getDeviceId()
 */
 XsResultValue DeviceCommunicator::gotoConfig(bool)
 {
+	if (m_descriptorCache && m_knownInConfig)
+		return setAndReturnLastResult(XRV_OK);
+
 	XsMessage snd(XMID_GotoConfig), rcv;
 	snd.setBusId(XS_BID_MASTER);
 
@@ -189,6 +364,7 @@ XsResultValue DeviceCommunicator::gotoConfig(bool)
 		return setAndReturnLastResult(rcv.toResultValue());
 	}
 	JLDEBUGG("Received gotoConfig ACK");
+	m_knownInConfig = true;
 	return setAndReturnLastResult(XRV_OK);
 }
 
@@ -197,6 +373,7 @@ XsResultValue DeviceCommunicator::gotoConfig(bool)
 XsResultValue DeviceCommunicator::gotoMeasurement()
 {
 	JLDEBUGG("");
+	m_knownInConfig = false;
 	XsMessage snd(XMID_GotoMeasurement);
 	snd.setBusId(XS_BID_MASTER);
 
@@ -222,6 +399,16 @@ bool DeviceCommunicator::writeMessage(const XsMessage& message)
 		return false;
 	}
 	JLTRACEG("did: " << masterDeviceId() << " writing message " << message.toHexString(10));
+	switch (message.getMessageId())
+	{
+		case XMID_GotoMeasurement:
+		case XMID_Reset:
+		case XMID_RestoreFactoryDef:
+			m_knownInConfig = false;
+			break;
+		default:
+			break;
+	}
 	setLastResult(writeRawData(raw));
 	if (lastResult() == XRV_OK)
 	{
@@ -297,6 +484,8 @@ void DeviceCommunicator::handleMessage(const XsMessage& message)
 #ifdef LOG_COMMUNICATOR_RX_TX
 	logRxStream(message);
 #endif
+	if (message.getMessageId() == XMID_Wakeup || message.getMessageId() == XMID_MtData2 || message.getMessageId() == XMID_MtData)
+		m_knownInConfig = false;
 	Communicator::handleMessage(message);
 }
 
@@ -35,6 +35,7 @@
 
 #include "communicator.h"
 #include "messageextractor.h"
+#include "devicedescriptorcache.h"
 
 #ifdef LOG_COMMUNICATOR_RX_TX
 	#include <xstypes/xsfile.h>
@@ -69,6 +70,7 @@ public:
 	virtual bool doTransaction(const XsMessage& msg, XsMessage& rcv, uint32_t timeout) override;
 
 	void setKeepAlive(bool enable) override;
+	void setDescriptorCache(std::shared_ptr<DeviceDescriptorCache> cache) override;
 
 	// file stuff
 	void closeLogFile() override;
@@ -109,6 +111,7 @@ protected:
 	RxChannelId addRxChannel();
 	XsSize messageExtractorCount() const;
 	MessageExtractor& messageExtractor(RxChannelId = 0);
+	void resetDescriptorState();
 
 #ifdef LOG_COMMUNICATOR_RX_TX
 	void logTxStream(XsMessage const& msg);
@@ -118,8 +121,19 @@ protected:
 private:
 	static const uint32_t m_defaultGotoConfigTimeout = 200;	// 1500 just after powerup, 100ms is not enough sometimes during tests
 
+	bool doLiveTransaction(const XsMessage& msg, XsMessage& rcv, uint32_t timeout);
+	void beginDescriptorSession(uint64_t deviceId);
+	bool replyFromDescriptors(const XsMessage& msg, XsMessage& rcv);
+	void updateDescriptors(const XsMessage& msg, const XsMessage& rcv);
+
 	uint32_t m_gotoConfigTimeout;
 
+	std::shared_ptr<DeviceDescriptorCache> m_descriptorCache;	//!< The cache of initialization replies, may be empty
+	xsens::Mutex m_descriptorMutex;								//!< Protects m_descriptors and m_descriptorDeviceId
+	DeviceDescriptorCache::Descriptors m_descriptors;			//!< The cached replies of the connected device
+	uint64_t m_descriptorDeviceId;								//!< The device id of m_descriptors, 0 when the replies may not be used
+	volatile std::atomic_bool m_knownInConfig;					//!< True when the device is known to be in config mode
+
 	RxChannelId m_nextRxChannelId;
 	std::vector<MessageExtractor> m_messageExtractors;
 
@@ -0,0 +1,232 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+
+#include "devicedescriptorcache.h"
+#include "iointerfacefile.h"
+#include <xstypes/xsxbusmessageid.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+namespace
+{
+//! \brief The magic bytes at the start of a cache file
+const char magic[8] = { 'X', 'S', 'D', 'E', 'V', 'D', 'S', 'C' };
+//! \brief The maximum size of a cache file, anything larger is considered corrupt
+const XsFilePos maxFileSize = 1024 * 1024;
+
+inline void putLe32(std::vector<uint8_t>& dest, uint32_t value)
+{
+	for (int i = 0; i < 4; ++i)
+		dest.push_back((uint8_t)(value >> (8 * i)));
+}
+
+inline void putLe64(std::vector<uint8_t>& dest, uint64_t value)
+{
+	for (int i = 0; i < 8; ++i)
+		dest.push_back((uint8_t)(value >> (8 * i)));
+}
+
+inline uint32_t getLe32(uint8_t const* src)
+{
+	return (uint32_t)src[0] | ((uint32_t)src[1] << 8) | ((uint32_t)src[2] << 16) | ((uint32_t)src[3] << 24);
+}
+
+inline uint64_t getLe64(uint8_t const* src)
+{
+	return (uint64_t)getLe32(src) | ((uint64_t)getLe32(src + 4) << 32);
+}
+}
+
+/*! \brief Constructor
+	\param directory The existing directory in which the cache files are stored
+*/
+DeviceDescriptorCache::DeviceDescriptorCache(const XsString& directory)
+	: m_directory(directory)
+	, m_hitCount(0)
+	, m_missCount(0)
+	, m_servedCount(0)
+{
+}
+
+/*! \returns True if the reply to the request \a messageId without data only changes with the firmware or settings
+	\param messageId The message id of the request
+*/
+bool DeviceDescriptorCache::isDescriptorRequest(uint8_t messageId)
+{
+	switch (messageId)
+	{
+		case XMID_ReqProductCode:
+		case XMID_ReqHardwareVersion:
+		case XMID_ReqFirmwareRevision:
+		case XMID_ReqConfiguration:
+		case XMID_ReqOutputConfiguration:
+		case XMID_ReqAvailableFilterProfiles:
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+/*! \returns True if repeating the last acknowledged set request with id \a messageId does not change the device
+	\param messageId The message id of the set request
+*/
+bool DeviceDescriptorCache::isRepeatableSet(uint8_t messageId)
+{
+	return messageId == XMID_SetOutputConfiguration || messageId == XMID_SetStringOutputType;
+}
+
+/*! \brief Load the stored messages of a device
+	\param deviceId The id of the device as reported by ReqDid
+	\param descriptors Receives the stored messages, it is cleared when nothing valid was found
+	\returns True if a valid entry was found
+*/
+bool DeviceDescriptorCache::load(uint64_t deviceId, Descriptors& descriptors)
+{
+	descriptors.clear();
+
+	xsens::Lock locky(&m_mutex);
+	IoInterfaceFile file;
+	if (file.open(fileName(deviceId), false, true) != XRV_OK)
+		return false;
+
+	XsFilePos size = file.getFileSize();
+	if (size < (XsFilePos) headerSize || size > maxFileSize)
+		return false;
+
+	std::vector<uint8_t> data((size_t) size);
+	XsFilePos length = 0;
+	if (file.readData(size, data.data(), length) != XRV_OK || length != size)
+		return false;
+
+	if (memcmp(data.data(), magic, sizeof(magic)) != 0 || getLe32(&data[8]) != version || getLe64(&data[16]) != deviceId)
+		return false;
+
+	uint32_t count = getLe32(&data[12]);
+	size_t offset = headerSize;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		if (offset + 6 > data.size())
+			break;
+		uint16_t key = (uint16_t)(data[offset] | (data[offset + 1] << 8));
+		uint32_t messageSize = getLe32(&data[offset + 2]);
+		offset += 6;
+		if (messageSize > data.size() - offset)
+			break;
+
+		XsMessage msg(&data[offset], messageSize);
+		if (msg.getTotalMessageSize() != messageSize || !msg.isChecksumOk())
+			break;
+		descriptors[key] = msg;
+		offset += messageSize;
+	}
+
+	if (descriptors.size() != count || offset != data.size())
+	{
+		descriptors.clear();
+		return false;
+	}
+	return true;
+}
+
+/*! \brief Replace the stored messages of a device
+	\details The entry is written to a temporary file first, which then replaces the existing entry.
+	\param deviceId The id of the device as reported by ReqDid
+	\param descriptors The messages to store
+	\returns XRV_OK if the entry was written
+*/
+XsResultValue DeviceDescriptorCache::store(uint64_t deviceId, Descriptors const& descriptors)
+{
+	std::vector<uint8_t> data(magic, magic + sizeof(magic));
+	putLe32(data, version);
+	putLe32(data, (uint32_t) descriptors.size());
+	putLe64(data, deviceId);
+	for (auto const& it : descriptors)
+	{
+		uint32_t messageSize = (uint32_t) it.second.getTotalMessageSize();
+		data.push_back((uint8_t) it.first);
+		data.push_back((uint8_t)(it.first >> 8));
+		putLe32(data, messageSize);
+		data.insert(data.end(), it.second.getMessageStart(), it.second.getMessageStart() + messageSize);
+	}
+
+	xsens::Lock locky(&m_mutex);
+	XsString name = fileName(deviceId);
+	XsString temporaryName = name;
+	temporaryName << ".tmp";
+
+	IoInterfaceFile file;
+	XsResultValue result = file.create(temporaryName);
+	if (result != XRV_OK)
+		return result;
+	result = file.writeData(XsByteArray(data.data(), data.size(), XSDF_None));
+	file.close();
+	if (result != XRV_OK)
+	{
+		::remove(temporaryName.c_str());
+		return result;
+	}
+
+#ifdef _WIN32
+	// rename does not replace an existing file on Windows
+	::remove(name.c_str());
+#endif
+	if (::rename(temporaryName.c_str(), name.c_str()) != 0)
+	{
+		::remove(temporaryName.c_str());
+		return XRV_OUTPUTCANNOTBEOPENED;
+	}
+	return XRV_OK;
+}
+
+/*! \brief Remove the entry of a device
+	\param deviceId The id of the device as reported by ReqDid
+*/
+void DeviceDescriptorCache::remove(uint64_t deviceId)
+{
+	xsens::Lock locky(&m_mutex);
+	::remove(fileName(deviceId).c_str());
+}
+
+/*! \returns The name of the cache file of the device with id \a deviceId */
+XsString DeviceDescriptorCache::fileName(uint64_t deviceId) const
+{
+	char name[32];
+	sprintf(name, "%016llX.xdd", (unsigned long long) deviceId);
+
+	XsString result = m_directory;
+	if (!result.empty() && !result.endsWith("/") && !result.endsWith("\\"))
+		result << "/";
+	result << name;
+	return result;
+}
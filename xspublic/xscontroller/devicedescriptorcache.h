@@ -0,0 +1,138 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+
+#ifndef DEVICEDESCRIPTORCACHE_H
+#define DEVICEDESCRIPTORCACHE_H
+
+#include <xstypes/xsmessage.h>
+#include <xstypes/xsstring.h>
+#include <xstypes/xsresultvalue.h>
+#include <xscommon/xsens_mutex.h>
+#include <atomic>
+#include <map>
+
+/*! \brief An on-disk cache of the static replies a device gives while it is being initialized
+	\details Opening a port queries the product code, hardware and firmware versions, the device configuration,
+	the output configuration and the available filter profiles, each with a separate transaction. These replies
+	only change when the firmware or the settings of the device change, so they are stored per device id in
+	\a directory. The next time the device is opened the replies are only used when the firmware revision,
+	which is always read from the device, is identical to the cached one.
+
+	Besides the replies to requests, the last SetOutputConfiguration and SetStringOutputType requests are stored
+	with their acknowledgements, so sending the same configuration again does not need a round trip. Any other
+	message that changes settings removes the affected replies, a reset or restore of the factory defaults
+	removes the entire entry.
+
+	\note Settings that are changed by other software while the device is not opened through this cache are not
+	detected, remove the cache file of the device in that case.
+
+	Each device is stored in its own file named after the device id, which is replaced atomically when it changes.
+	\sa DeviceCommunicator::setDescriptorCache
+*/
+class DeviceDescriptorCache
+{
+public:
+	//! \brief The size of the file header
+	static const XsSize headerSize = 24;
+	//! \brief The version of the file format that is written
+	static const uint32_t version = 1;
+	//! \brief Added to a message id to form the key of a stored set request
+	static const uint16_t setRequestKey = 0x100;
+
+	//! \brief The stored messages of one device, indexed by request message id or setRequestKey + message id
+	typedef std::map<uint16_t, XsMessage> Descriptors;
+
+	explicit DeviceDescriptorCache(const XsString& directory);
+
+	static bool isDescriptorRequest(uint8_t messageId);
+	static bool isRepeatableSet(uint8_t messageId);
+
+	bool load(uint64_t deviceId, Descriptors& descriptors);
+	XsResultValue store(uint64_t deviceId, Descriptors const& descriptors);
+	void remove(uint64_t deviceId);
+
+	//! \returns The directory that contains the cache files
+	inline XsString const& directory() const
+	{
+		return m_directory;
+	}
+
+	//! \returns The number of times the cached replies of a device were found valid
+	inline uint64_t hitCount() const
+	{
+		return m_hitCount.load(std::memory_order_relaxed);
+	}
+
+	//! \returns The number of times a device was not cached or its firmware revision did not match
+	inline uint64_t missCount() const
+	{
+		return m_missCount.load(std::memory_order_relaxed);
+	}
+
+	//! \returns The number of transactions that were answered from the cache
+	inline uint64_t servedCount() const
+	{
+		return m_servedCount.load(std::memory_order_relaxed);
+	}
+
+	//! \brief Count a device whose cached replies were found valid
+	inline void countHit()
+	{
+		m_hitCount.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	//! \brief Count a device that was not cached or whose firmware revision did not match
+	inline void countMiss()
+	{
+		m_missCount.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	//! \brief Count a transaction that was answered from the cache
+	inline void countServed()
+	{
+		m_servedCount.fetch_add(1, std::memory_order_relaxed);
+	}
+
+private:
+	DeviceDescriptorCache(DeviceDescriptorCache const&) = delete;
+	DeviceDescriptorCache& operator=(DeviceDescriptorCache const&) = delete;
+
+	XsString fileName(uint64_t deviceId) const;
+
+	xsens::Mutex m_mutex;				//!< Serializes the file access of communicators that share the cache
+	XsString m_directory;
+	std::atomic<uint64_t> m_hitCount;
+	std::atomic<uint64_t> m_missCount;
+	std::atomic<uint64_t> m_servedCount;
+};
+
+#endif
@@ -38,6 +38,7 @@
 #include "xsscanner.h"
 //#include "networkcommunicator.h"
 #include "deviceredetector.h"
+#include "socketstreaminterface.h"
 
 /*! \class DeviceRedetector
 	\brief A class which re-detects a device with a certain device Id
@@ -87,6 +88,10 @@ DeviceRedetector::DeviceRedetector(const XsPortInfo& portInfo)
 */
 bool DeviceRedetector::redetect(const XsDeviceId& deviceId, XsPortInfo& portInfo, bool skipDeviceIdCheck)
 {
+	// a device server has a fixed address, so there is nothing to scan for
+	if (SocketStreamInterface::isSocketUrl(portInfo.portName()))
+		return redetectNoScan(deviceId, portInfo, skipDeviceIdCheck);
+
 	FunctionPointer currentFunction;
 	currentFunction = m_detectFunctions[deviceId.deviceType(false)];
 
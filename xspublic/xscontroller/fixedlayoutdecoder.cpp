@@ -0,0 +1,444 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+#include "fixedlayoutdecoder.h"
+#include <xstypes/xsmessage.h>
+#include <algorithm>
+#include <stddef.h>
+#include <string.h>
+
+/*! \cond XS_INTERNAL */
+namespace
+{
+/*! \brief Read a big-endian unsigned value of \a N bytes from \a src */
+template <int N>
+inline uint64_t loadBigEndian(uint8_t const* src)
+{
+	uint64_t rv = 0;
+	for (int i = 0; i < N; ++i)
+		rv = (rv << 8) | src[i];
+	return rv;
+}
+
+/*! \brief Set the least significant mantissa bit of \a d to \a bit, like the XsMessage conversions do */
+inline double withLsb(double d, uint64_t bit)
+{
+	uint64_t bits;
+	memcpy(&bits, &d, sizeof(bits));
+	bits = (bits & ~1ULL) | (bit & 1);
+	memcpy(&d, &bits, sizeof(d));
+	return d;
+}
+
+//! \brief Reads an XDI_SubFormatFloat value
+struct FloatReader
+{
+	static const int size = 4;
+	static inline XsReal read(uint8_t const* src)
+	{
+		uint32_t bits = (uint32_t) loadBigEndian<4>(src);
+		float f;
+		memcpy(&f, &bits, sizeof(f));
+#ifdef XSENS_SINGLE_PRECISION
+		return f;
+#else
+		return withLsb((double) f, bits);
+#endif
+	}
+};
+
+//! \brief Reads an XDI_SubFormatDouble value
+struct DoubleReader
+{
+	static const int size = 8;
+	static inline XsReal read(uint8_t const* src)
+	{
+		uint64_t bits = loadBigEndian<8>(src);
+		double d;
+		memcpy(&d, &bits, sizeof(d));
+		return (XsReal) d;
+	}
+};
+
+//! \brief Reads an XDI_SubFormatFp1220 value
+struct Fp1220Reader
+{
+	static const int size = 4;
+	static inline XsReal read(uint8_t const* src)
+	{
+		int32_t fp = (int32_t)(uint32_t) loadBigEndian<4>(src);
+		return (XsReal) withLsb((double) fp / 1048576.0, (uint64_t) fp);
+	}
+};
+
+//! \brief Reads an XDI_SubFormatFp1632 value
+struct Fp1632Reader
+{
+	static const int size = 6;
+	static inline XsReal read(uint8_t const* src)
+	{
+		uint32_t frac = (uint32_t) loadBigEndian<4>(src);
+		int16_t whole = (int16_t) loadBigEndian<2>(src + 4);
+		int64_t fp = (int64_t)(((uint64_t)(int64_t) whole << 32) | frac);
+		return (XsReal) withLsb((double) fp / 4294967296.0, frac);
+	}
+};
+
+/*! \brief Decode \a N floating point values with reader \a R */
+template <typename R, int N>
+void decodeReals(uint8_t const* src, void* dest)
+{
+	XsReal* d = static_cast<XsReal*>(dest);
+	for (int i = 0; i < N; ++i, src += R::size)
+		d[i] = R::read(src);
+}
+
+/*! \brief Decode an unsigned integer of type \a T */
+template <typename T>
+void decodeUnsigned(uint8_t const* src, void* dest)
+{
+	*static_cast<T*>(dest) = (T) loadBigEndian<sizeof(T)>(src);
+}
+
+//! \brief The decode function type of FixedLayoutDecoder
+typedef void (*DecodeFunction)(uint8_t const* src, void* dest);
+
+/*! \brief Select the instantiation of decodeReals for \a count values read by \a R */
+template <typename R>
+DecodeFunction realDecoder(int count, XsSize& size)
+{
+	size = (XsSize)(count * R::size);
+	switch (count)
+	{
+		case 1: return &decodeReals<R, 1>;
+		case 2: return &decodeReals<R, 2>;
+		case 3: return &decodeReals<R, 3>;
+		case 4: return &decodeReals<R, 4>;
+		default: return nullptr;
+	}
+}
+
+//! \brief Describes how an item type maps onto a FixedLayoutFrame field
+struct ItemInfo
+{
+	XsDataIdentifier m_type;	//!< The identifier without format bits
+	uint32_t m_field;			//!< The FixedLayoutField
+	XsSize m_destOffset;		//!< The offset of the field in FixedLayoutFrame
+	int m_count;				//!< The number of floating point values, 0 for integer items
+	DecodeFunction m_integer;	//!< The decode function of integer items
+	XsSize m_integerSize;		//!< The payload size of integer items
+};
+
+#define XS_FLF_REAL(type, field, member, count)	{ type, field, offsetof(FixedLayoutFrame, member), count, nullptr, 0 }
+#define XS_FLF_UINT(type, field, member, T)		{ type, field, offsetof(FixedLayoutFrame, member), 0, &decodeUnsigned<T>, sizeof(T) }
+
+const ItemInfo itemInfo[] =
+{
+	XS_FLF_UINT(XDI_PacketCounter,		FLF_PacketCounter,		m_packetCounter, uint16_t),
+	XS_FLF_UINT(XDI_SampleTimeFine,		FLF_SampleTimeFine,		m_sampleTimeFine, uint32_t),
+	XS_FLF_UINT(XDI_SampleTimeCoarse,	FLF_SampleTimeCoarse,	m_sampleTimeCoarse, uint32_t),
+	XS_FLF_UINT(XDI_StatusByte,			FLF_StatusByte,			m_statusByte, uint8_t),
+	XS_FLF_UINT(XDI_StatusWord,			FLF_StatusWord,			m_statusWord, uint32_t),
+	XS_FLF_REAL(XDI_Temperature,		FLF_Temperature,		m_temperature, 1),
+	XS_FLF_UINT(XDI_BaroPressure,		FLF_BaroPressure,		m_baroPressure, uint32_t),
+	XS_FLF_REAL(XDI_Quaternion,			FLF_Quaternion,			m_quaternion, 4),
+	XS_FLF_REAL(XDI_EulerAngles,		FLF_EulerAngles,		m_eulerAngles, 3),
+	XS_FLF_REAL(XDI_Acceleration,		FLF_Acceleration,		m_acceleration, 3),
+	XS_FLF_REAL(XDI_FreeAcceleration,	FLF_FreeAcceleration,	m_freeAcceleration, 3),
+	XS_FLF_REAL(XDI_AccelerationHR,		FLF_AccelerationHR,		m_accelerationHR, 3),
+	XS_FLF_REAL(XDI_DeltaV,				FLF_DeltaV,				m_deltaV, 3),
+	XS_FLF_REAL(XDI_RateOfTurn,			FLF_RateOfTurn,			m_rateOfTurn, 3),
+	XS_FLF_REAL(XDI_RateOfTurnHR,		FLF_RateOfTurnHR,		m_rateOfTurnHR, 3),
+	XS_FLF_REAL(XDI_DeltaQ,				FLF_DeltaQ,				m_deltaQ, 4),
+	XS_FLF_REAL(XDI_MagneticField,		FLF_MagneticField,		m_magneticField, 3),
+	XS_FLF_REAL(XDI_VelocityXYZ,		FLF_VelocityXYZ,		m_velocity, 3),
+	XS_FLF_REAL(XDI_LatLon,				FLF_LatLon,				m_latLon, 2),
+	XS_FLF_REAL(XDI_AltitudeEllipsoid,	FLF_AltitudeEllipsoid,	m_altitudeEllipsoid, 1),
+	XS_FLF_REAL(XDI_PositionEcef,		FLF_PositionEcef,		m_positionEcef, 3),
+};
+
+#undef XS_FLF_REAL
+#undef XS_FLF_UINT
+
+/*! \brief Find the ItemInfo of \a id, ignoring its format bits
+	\returns The ItemInfo or null if the item has no FixedLayoutFrame field
+*/
+ItemInfo const* findItemInfo(XsDataIdentifier id)
+{
+	XsDataIdentifier type = (XsDataIdentifier)(id & XDI_FullTypeMask);
+	for (auto const& info : itemInfo)
+		if (info.m_type == type)
+			return &info;
+	return nullptr;
+}
+
+/*! \brief Select the decode function for item \a id
+	\param id The identifier including its format bits
+	\param info The ItemInfo of \a id
+	\param size Receives the expected payload size of the item
+	\returns The decode function or null if the format is not supported
+*/
+DecodeFunction selectDecoder(XsDataIdentifier id, ItemInfo const& info, XsSize& size)
+{
+	if (info.m_count == 0)
+	{
+		size = info.m_integerSize;
+		return info.m_integer;
+	}
+
+	switch (id & XDI_SubFormatMask)
+	{
+		case XDI_SubFormatFloat:	return realDecoder<FloatReader>(info.m_count, size);
+		case XDI_SubFormatDouble:	return realDecoder<DoubleReader>(info.m_count, size);
+		case XDI_SubFormatFp1220:	return realDecoder<Fp1220Reader>(info.m_count, size);
+		case XDI_SubFormatFp1632:	return realDecoder<Fp1632Reader>(info.m_count, size);
+		default:					return nullptr;
+	}
+}
+
+/*! \brief Returns the raw payload of \a msg and its size, or null when \a msg is not an MtData2 message */
+uint8_t const* payload(XsMessage const& msg, XsSize& size)
+{
+	if (msg.getMessageId() != XMID_MtData2 || msg.empty())
+		return nullptr;
+	size = msg.getDataSize();
+	return msg.getDataBuffer();
+}
+}
+/*! \endcond */
+
+/*! \brief Construct an unconfigured decoder, all frames will be decoded item by item */
+FixedLayoutDecoder::FixedLayoutDecoder()
+	: m_slotCount(0)
+	, m_frameSize(0)
+	, m_fields(0)
+	, m_fixedCount(0)
+	, m_genericCount(0)
+{
+}
+
+/*! \brief Construct a decoder for a device with output configuration \a config
+	\sa configure
+*/
+FixedLayoutDecoder::FixedLayoutDecoder(XsOutputConfigurationArray const& config)
+	: FixedLayoutDecoder()
+{
+	configure(config);
+}
+
+/*! \brief Prepare the decoder for frames produced with output configuration \a config
+	\details The items with the highest frequency are expected in every frame, as are items with frequency 0xFFFF,
+	which are sent along with every packet. Items with a lower frequency are only part of some frames, those frames
+	are decoded item by item. The learned layout is discarded, the statistics are kept.
+	\param config The output configuration as reported by the device
+*/
+void FixedLayoutDecoder::configure(XsOutputConfigurationArray const& config)
+{
+	m_slotCount = 0;
+	m_frameSize = 0;
+	m_fields = 0;
+
+	uint16_t highest = 0;
+	for (auto const& cfg : config)
+		if (cfg.m_frequency != 0xFFFF && cfg.m_frequency > highest && cfg.m_dataIdentifier != XDI_None)
+			highest = cfg.m_frequency;
+
+	for (auto const& cfg : config)
+	{
+		if (cfg.m_dataIdentifier == XDI_None || m_slotCount == XS_MAX_OUTPUTCONFIGURATIONS)
+			continue;
+		if (cfg.m_frequency != 0xFFFF && cfg.m_frequency != highest)
+			continue;
+
+		Slot& slot = m_slots[m_slotCount++];
+		slot.m_id = cfg.m_dataIdentifier;
+		slot.m_offset = 0;
+		slot.m_size = 0;
+		slot.m_field = FLF_None;
+		slot.m_destOffset = 0;
+		slot.m_decode = nullptr;
+
+		ItemInfo const* info = findItemInfo(slot.m_id);
+		if (info)
+		{
+			slot.m_decode = selectDecoder(slot.m_id, *info, slot.m_size);
+			if (slot.m_decode)
+			{
+				slot.m_field = info->m_field;
+				slot.m_destOffset = info->m_destOffset;
+			}
+			else
+				slot.m_size = 0;
+		}
+	}
+}
+
+/*! \brief Learn the item offsets from the payload \a data of \a size bytes
+	\details This succeeds when the payload contains each configured full rate item exactly once and nothing else,
+	and the supported items have their expected sizes. The previously learned layout is kept when it fails.
+	\returns true if the layout was learned
+*/
+bool FixedLayoutDecoder::lock(uint8_t const* data, XsSize size)
+{
+	if (m_slotCount == 0)
+		return false;
+
+	XsSize offsets[XS_MAX_OUTPUTCONFIGURATIONS];
+	XsSize sizes[XS_MAX_OUTPUTCONFIGURATIONS];
+	bool found[XS_MAX_OUTPUTCONFIGURATIONS] = {};
+	XsSize items = 0;
+	XsSize offset = 0;
+	while (offset + 3 <= size)
+	{
+		XsDataIdentifier id = (XsDataIdentifier) loadBigEndian<2>(data + offset);
+		XsSize itemSize = data[offset + 2];
+		if (offset + 3 + itemSize > size)
+			return false;
+
+		XsSize s = 0;
+		while (s < m_slotCount && (m_slots[s].m_id != id || found[s]))
+			++s;
+		if (s == m_slotCount)
+			return false;
+		if (m_slots[s].m_decode && m_slots[s].m_size != itemSize)
+			return false;
+
+		found[s] = true;
+		offsets[s] = offset;
+		sizes[s] = itemSize;
+		++items;
+		offset += 3 + itemSize;
+	}
+	if (offset != size || items != m_slotCount)
+		return false;
+
+	m_fields = 0;
+	for (XsSize s = 0; s < m_slotCount; ++s)
+	{
+		m_slots[s].m_offset = offsets[s];
+		m_slots[s].m_size = sizes[s];
+		m_fields |= m_slots[s].m_field;
+	}
+	std::sort(m_slots, m_slots + m_slotCount, [](Slot const& a, Slot const& b) { return a.m_offset < b.m_offset; });
+	m_frameSize = size;
+	return true;
+}
+
+/*! \brief Decode \a msg into \a frame
+	\details When the frame has the learned layout the items are decoded with the precomputed offsets and decode
+	functions. Otherwise the layout is learned from the frame if possible, which handles a device that was
+	reconfigured. If that fails the items are decoded one by one.
+	\param msg The MtData2 message to decode
+	\param frame Receives the decoded fields, m_present is set to the fields that were found
+	\returns How the frame was decoded
+*/
+FixedLayoutResult FixedLayoutDecoder::decode(XsMessage const& msg, FixedLayoutFrame& frame)
+{
+	XsSize size = 0;
+	uint8_t const* data = payload(msg, size);
+	if (!data)
+	{
+		frame.m_present = FLF_None;
+		return FLR_Invalid;
+	}
+
+	bool match = (m_frameSize != 0 && size == m_frameSize);
+	for (XsSize s = 0; match && s < m_slotCount; ++s)
+	{
+		Slot const& slot = m_slots[s];
+		uint8_t const* hdr = data + slot.m_offset;
+		match = hdr[0] == (uint8_t)(slot.m_id >> 8) && hdr[1] == (uint8_t) slot.m_id && hdr[2] == (uint8_t) slot.m_size;
+	}
+
+	if (!match && !lock(data, size))
+	{
+		++m_genericCount;
+		return decodeGeneric(data, size, frame);
+	}
+
+	char* dest = reinterpret_cast<char*>(&frame);
+	for (XsSize s = 0; s < m_slotCount; ++s)
+	{
+		Slot const& slot = m_slots[s];
+		if (slot.m_decode)
+			slot.m_decode(data + slot.m_offset + 3, dest + slot.m_destOffset);
+	}
+	frame.m_present = m_fields;
+	++m_fixedCount;
+	return FLR_Fixed;
+}
+
+/*! \brief Decode the payload \a data of \a size bytes item by item
+	\details Items without a FixedLayoutFrame field or with an unexpected size are skipped.
+	\returns FLR_Generic, or FLR_Invalid if the payload is corrupt
+*/
+FixedLayoutResult FixedLayoutDecoder::decodeGeneric(uint8_t const* data, XsSize size, FixedLayoutFrame& frame) const
+{
+	char* dest = reinterpret_cast<char*>(&frame);
+	uint32_t present = 0;
+	XsSize offset = 0;
+	while (offset + 3 <= size)	// same corruption rules as XsDataPacket_setMessage
+	{
+		XsDataIdentifier id = (XsDataIdentifier) loadBigEndian<2>(data + offset);
+		XsSize itemSize = data[offset + 2];
+		if (offset + 3 + itemSize > size)
+			break;
+
+		ItemInfo const* info = findItemInfo(id);
+		if (info)
+		{
+			XsSize expected = 0;
+			DecodeFunction decode = selectDecoder(id, *info, expected);
+			if (decode && expected == itemSize)
+			{
+				decode(data + offset + 3, dest + info->m_destOffset);
+				present |= info->m_field;
+			}
+		}
+		offset += 3 + itemSize;
+	}
+
+	if (offset < size)
+	{
+		frame.m_present = FLF_None;
+		return FLR_Invalid;
+	}
+	frame.m_present = present;
+	return FLR_Generic;
+}
+
+/*! \returns true if items of type \a id, ignoring format bits, can be decoded into a FixedLayoutFrame
+	\details Configured items that are not supported are skipped, they do not prevent fixed layout decoding.
+*/
+bool FixedLayoutDecoder::isSupported(XsDataIdentifier id)
+{
+	return findItemInfo(id) != nullptr;
+}
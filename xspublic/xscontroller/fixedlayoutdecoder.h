@@ -0,0 +1,180 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+#ifndef FIXEDLAYOUTDECODER_H
+#define FIXEDLAYOUTDECODER_H
+
+#include <xstypes/xstypedefs.h>
+#include <xstypes/xsdataidentifier.h>
+#include <xstypes/xsoutputconfigurationarray.h>
+
+struct XsMessage;
+
+/*! \brief The fields of a FixedLayoutFrame, used in FixedLayoutFrame::m_present */
+enum FixedLayoutField
+{
+	FLF_None				= 0,
+	FLF_PacketCounter		= 1 << 0,
+	FLF_SampleTimeFine		= 1 << 1,
+	FLF_SampleTimeCoarse	= 1 << 2,
+	FLF_StatusByte			= 1 << 3,
+	FLF_StatusWord			= 1 << 4,
+	FLF_Temperature			= 1 << 5,
+	FLF_BaroPressure		= 1 << 6,
+	FLF_Quaternion			= 1 << 7,
+	FLF_EulerAngles			= 1 << 8,
+	FLF_Acceleration		= 1 << 9,
+	FLF_FreeAcceleration	= 1 << 10,
+	FLF_AccelerationHR		= 1 << 11,
+	FLF_DeltaV				= 1 << 12,
+	FLF_RateOfTurn			= 1 << 13,
+	FLF_RateOfTurnHR		= 1 << 14,
+	FLF_DeltaQ				= 1 << 15,
+	FLF_MagneticField		= 1 << 16,
+	FLF_VelocityXYZ			= 1 << 17,
+	FLF_LatLon				= 1 << 18,
+	FLF_AltitudeEllipsoid	= 1 << 19,
+	FLF_PositionEcef		= 1 << 20
+};
+
+/*! \brief A decoded MtData2 frame as a plain struct
+	\details Only the fields whose FixedLayoutField bit is set in m_present contain data, the other fields are
+	left untouched by the decoder. Floating point values are converted exactly like XsDataPacket does.
+*/
+struct FixedLayoutFrame
+{
+	uint32_t m_present;				//!< The FixedLayoutField values of the fields that were decoded
+	uint16_t m_packetCounter;		//!< XDI_PacketCounter
+	uint8_t m_statusByte;			//!< XDI_StatusByte
+	uint32_t m_sampleTimeFine;		//!< XDI_SampleTimeFine
+	uint32_t m_sampleTimeCoarse;	//!< XDI_SampleTimeCoarse
+	uint32_t m_statusWord;			//!< XDI_StatusWord
+	uint32_t m_baroPressure;		//!< XDI_BaroPressure in Pa
+	XsReal m_temperature;			//!< XDI_Temperature
+	XsReal m_quaternion[4];			//!< XDI_Quaternion as w, x, y, z
+	XsReal m_eulerAngles[3];		//!< XDI_EulerAngles as roll, pitch, yaw
+	XsReal m_acceleration[3];		//!< XDI_Acceleration
+	XsReal m_freeAcceleration[3];	//!< XDI_FreeAcceleration
+	XsReal m_accelerationHR[3];		//!< XDI_AccelerationHR
+	XsReal m_deltaV[3];				//!< XDI_DeltaV
+	XsReal m_rateOfTurn[3];			//!< XDI_RateOfTurn
+	XsReal m_rateOfTurnHR[3];		//!< XDI_RateOfTurnHR
+	XsReal m_deltaQ[4];				//!< XDI_DeltaQ as w, x, y, z
+	XsReal m_magneticField[3];		//!< XDI_MagneticField
+	XsReal m_velocity[3];			//!< XDI_VelocityXYZ
+	XsReal m_latLon[2];				//!< XDI_LatLon
+	XsReal m_altitudeEllipsoid;		//!< XDI_AltitudeEllipsoid
+	XsReal m_positionEcef[3];		//!< XDI_PositionEcef
+
+	//! \returns true if \a field was decoded
+	inline bool contains(FixedLayoutField field) const
+	{
+		return (m_present & field) != 0;
+	}
+};
+
+/*! \brief The way a frame was decoded by FixedLayoutDecoder::decode */
+enum FixedLayoutResult
+{
+	FLR_Invalid,	//!< The message is not a valid MtData2 message, m_present is cleared
+	FLR_Generic,	//!< The frame did not match the fixed layout and was decoded item by item
+	FLR_Fixed		//!< The frame matched the fixed layout and was decoded with the precomputed offsets
+};
+
+/*! \class FixedLayoutDecoder
+	\brief Decodes MtData2 frames of a device with a fixed output configuration into a FixedLayoutFrame
+	\details A device that has been configured once produces frames with an identical layout. The decoder
+	selects a specialized decode function for each item in the output configuration up front. The offsets of
+	the items are learned from the first frame that contains exactly the configured full rate items. After that
+	each frame is verified by comparing its size and item headers and decoded in one pass without lookups.
+
+	Frames that do not match, for example because they contain an item that is output at a lower rate, are
+	decoded item by item like XsDataPacket_setMessage does. Items that have no FixedLayoutFrame field are skipped
+	in both cases, use XsDataPacket for those.
+
+	The decoder keeps state and is meant to be used by a single thread.
+*/
+class FixedLayoutDecoder
+{
+public:
+	FixedLayoutDecoder();
+	explicit FixedLayoutDecoder(XsOutputConfigurationArray const& config);
+
+	void configure(XsOutputConfigurationArray const& config);
+	FixedLayoutResult decode(XsMessage const& msg, FixedLayoutFrame& frame);
+
+	//! \returns true if the item offsets have been learned from a frame
+	inline bool isLocked() const
+	{
+		return m_frameSize != 0;
+	}
+
+	//! \returns The number of frames decoded with the fixed layout
+	inline uint64_t fixedCount() const
+	{
+		return m_fixedCount;
+	}
+
+	//! \returns The number of frames that fell back to the item by item decoder
+	inline uint64_t genericCount() const
+	{
+		return m_genericCount;
+	}
+
+	static bool isSupported(XsDataIdentifier id);
+
+private:
+	//! \brief Decodes the payload of an item at \a src to the frame field at \a dest
+	typedef void (*DecodeFunction)(uint8_t const* src, void* dest);
+
+	//! \brief A configured full rate item
+	struct Slot
+	{
+		XsDataIdentifier m_id;		//!< The identifier including format bits
+		XsSize m_offset;			//!< The offset of the item header in the payload, valid when locked
+		XsSize m_size;				//!< The payload size of the item, 0 if it has to be learned
+		uint32_t m_field;			//!< The FixedLayoutField of the item, FLF_None when it is skipped
+		XsSize m_destOffset;		//!< The offset of the field in FixedLayoutFrame
+		DecodeFunction m_decode;	//!< The decode function, null when the item is skipped
+	};
+
+	bool lock(uint8_t const* data, XsSize size);
+	FixedLayoutResult decodeGeneric(uint8_t const* data, XsSize size, FixedLayoutFrame& frame) const;
+
+	Slot m_slots[XS_MAX_OUTPUTCONFIGURATIONS];	//!< The configured full rate items in configuration order
+	XsSize m_slotCount;							//!< The number of used entries in m_slots
+	XsSize m_frameSize;							//!< The payload size of a fixed layout frame, 0 when not locked
+	uint32_t m_fields;							//!< The fields that a fixed layout frame fills
+	uint64_t m_fixedCount;						//!< The number of frames decoded with the fixed layout
+	uint64_t m_genericCount;					//!< The number of frames decoded item by item
+};
+
+#endif
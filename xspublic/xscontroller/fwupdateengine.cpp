@@ -0,0 +1,407 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+#include "fwupdateengine.h"
+#include "iointerfacefile.h"
+#include "serialinterface.h"
+#include "socketstreaminterface.h"
+#include "usbinterface.h"
+#include <xscommon/fwupdate.h>
+#include <xscommon/xbusparser.h>
+#include <xscommon/threading.h>
+#include <xscommon/xsens_mutex.h>
+#include <xstypes/xsbytearray.h>
+#include <xstypes/xstime.h>
+#include <atomic>
+
+/*! \brief Updates a single device in its own thread */
+class FwUpdateEngine::Worker : public xsens::StandardThread
+{
+public:
+	Worker(const XsPortInfo& portInfo, std::shared_ptr<StreamInterface> stream);
+	~Worker();
+
+	bool start(std::vector<uint8_t> const& xff, uint8_t sliceWindow, uint32_t replyTimeout);
+	void finishRun();
+
+	//! \returns True when the update has finished, successfully or not
+	inline bool isDone() const
+	{
+		return m_done;
+	}
+
+	FwUpdateDeviceReport report() const;
+
+protected:
+	void initFunction() override;
+	int32_t innerFunction() override;
+
+private:
+	//! \brief The size of the receive buffer, bootloader replies are only a few bytes
+	static const int rxBufferSize = 256;
+	//! \brief The time in ms that a single read waits for data
+	static const uint32_t pollTimeout = 10;
+
+	static void sendXbusMessage(void* context, uint8_t const* xbusMessage);
+	static void readyHandler(void* context, FWU_Result result);
+	void finish(FwUpdateDeviceStatus status);
+
+	XsPortInfo m_portInfo;
+	std::shared_ptr<StreamInterface> m_stream;
+	bool m_ownsStream;							//!< True when the stream was opened by the worker and must be closed by it
+	FwUpdate m_fwUpdate;
+	XbusParser m_parser;
+	uint8_t m_txBuffer[FWU_REQUIRED_TXBUFFER_SIZE];
+	unsigned char m_rxBuffer[rxBufferSize];
+	uint32_t m_replyTimeout;
+	int64_t m_startTime;
+	int64_t m_lastReplyTime;
+	mutable xsens::Mutex m_mutex;				//!< Protects m_report
+	FwUpdateDeviceReport m_report;
+	std::atomic_bool m_done;
+};
+
+/*! \brief Constructor
+	\param portInfo The port of the device
+	\param stream The opened stream of the device, or an empty pointer to let the worker open \a portInfo
+*/
+FwUpdateEngine::Worker::Worker(const XsPortInfo& portInfo, std::shared_ptr<StreamInterface> stream)
+	: m_portInfo(portInfo)
+	, m_stream(stream)
+	, m_ownsStream(!stream)
+	, m_replyTimeout(0)
+	, m_startTime(0)
+	, m_lastReplyTime(0)
+	, m_done(false)
+{
+	FwUpdate_init(&m_fwUpdate);
+	m_report.m_portName = portInfo.portName();
+	m_report.m_status = FUDS_Pending;
+	m_report.m_bytesSent = 0;
+	m_report.m_durationUs = 0;
+}
+
+FwUpdateEngine::Worker::~Worker()
+{
+	finishRun();
+}
+
+/*! \brief Open the port if needed and start sending \a xff to the device
+	\param xff The contents of the xff file, must stay valid until the update has finished
+	\param sliceWindow The number of slices that may await their acknowledgement
+	\param replyTimeout The time in ms to wait for a reply of the bootloader
+	\returns True if the update was started
+*/
+bool FwUpdateEngine::Worker::start(std::vector<uint8_t> const& xff, uint8_t sliceWindow, uint32_t replyTimeout)
+{
+	if (!m_stream)
+	{
+		if (SocketStreamInterface::isSocketUrl(m_portInfo.portName()))
+			m_stream = std::make_shared<SocketStreamInterface>();
+		else if (m_portInfo.isUsb())
+			m_stream = std::make_shared<UsbInterface>();
+		else
+			m_stream = std::make_shared<SerialInterface>();
+
+		if (m_stream->open(m_portInfo) != XRV_OK)
+		{
+			m_stream.reset();
+			finish(FUDS_PortError);
+			return false;
+		}
+	}
+	m_stream->setTimeout(pollTimeout);
+
+	FwUpdate_init(&m_fwUpdate);
+	m_fwUpdate.m_readXffData = nullptr;
+	m_fwUpdate.m_sendXbusMessage = nullptr;
+	m_fwUpdate.m_readyHandler = nullptr;
+	m_fwUpdate.m_txBuffer = m_txBuffer;
+	m_fwUpdate.m_xffImage = xff.data();
+	m_fwUpdate.m_xffImageSize = (uint32_t) xff.size();
+	m_fwUpdate.m_sliceWindow = sliceWindow;
+	m_fwUpdate.m_context = this;
+	m_fwUpdate.m_sendXbusMessageCtx = &Worker::sendXbusMessage;
+	m_fwUpdate.m_readyHandlerCtx = &Worker::readyHandler;
+	XbusParser_init(&m_parser, m_rxBuffer, rxBufferSize);
+
+	m_replyTimeout = replyTimeout;
+	m_startTime = XsTime_monotonicUs();
+	m_lastReplyTime = m_startTime;
+	{
+		xsens::Lock locky(&m_mutex);
+		m_report.m_status = FUDS_Running;
+	}
+	m_done = false;
+	if (!startThread("FwUpdateEngine"))
+	{
+		finish(FUDS_Failed);
+		return false;
+	}
+	return true;
+}
+
+/*! \brief Stop the thread and close the port if it was opened by the worker
+*/
+void FwUpdateEngine::Worker::finishRun()
+{
+	stopThread();
+	if (m_ownsStream && m_stream)
+	{
+		m_stream->close();
+		m_stream.reset();
+	}
+}
+
+//! \returns The current state and throughput of the update
+FwUpdateDeviceReport FwUpdateEngine::Worker::report() const
+{
+	xsens::Lock locky(&m_mutex);
+	return m_report;
+}
+
+/*! \brief Send the FWUP_READY that starts the update
+*/
+void FwUpdateEngine::Worker::initFunction()
+{
+	FwUpdate_start(&m_fwUpdate);
+}
+
+/*! \brief Pass the replies of the bootloader to the FwUpdate state machine
+	\returns 0, the read already waits for data
+*/
+int32_t FwUpdateEngine::Worker::innerFunction()
+{
+	if (m_done)
+		return 10;
+
+	XsByteArray data;
+	XsResultValue res = m_stream->readData(rxBufferSize, data);
+	if (res != XRV_OK && res != XRV_TIMEOUT && res != XRV_TIMEOUTNODATA)
+	{
+		finish(FUDS_PortError);
+		return 0;
+	}
+
+	for (XsSize i = 0; i < data.size() && !m_done; ++i)
+	{
+		int messageSize = 0;
+		Result parsed = XbusParser_insertByte(&m_parser, data[i], &messageSize);
+		if (parsed == RES_MessageReceived)
+		{
+			m_lastReplyTime = XsTime_monotonicUs();
+			FwUpdate_handleXbus(&m_fwUpdate, m_rxBuffer);
+			XbusParser_init(&m_parser, m_rxBuffer, rxBufferSize);
+		}
+		else if (parsed == RES_BufferOverflow)
+			XbusParser_init(&m_parser, m_rxBuffer, rxBufferSize);
+	}
+
+	if (m_done)
+		return 0;
+
+	int64_t now = XsTime_monotonicUs();
+	xsens::Lock locky(&m_mutex);
+	m_report.m_bytesSent = m_fwUpdate.m_bytesSent;
+	m_report.m_durationUs = now - m_startTime;
+	locky.unlock();
+
+	if (now - m_lastReplyTime > (int64_t) m_replyTimeout * 1000)
+		finish(FUDS_TimedOut);
+	return 0;
+}
+
+/*! \brief Write a message of the FwUpdate state machine to the device
+*/
+void FwUpdateEngine::Worker::sendXbusMessage(void* context, uint8_t const* xbusMessage)
+{
+	Worker* worker = static_cast<Worker*>(context);
+	if (worker->m_done)
+		return;
+
+	XsByteArray data(const_cast<uint8_t*>(xbusMessage), (XsSize) Xbus_getRawLength(xbusMessage), XSDF_None);
+	if (worker->m_stream->writeData(data) != XRV_OK)
+		worker->finish(FUDS_PortError);
+}
+
+/*! \brief Handle the end of the update as reported by the FwUpdate state machine
+*/
+void FwUpdateEngine::Worker::readyHandler(void* context, FWU_Result result)
+{
+	static_cast<Worker*>(context)->finish(result == FWU_Success ? FUDS_Succeeded : FUDS_Failed);
+}
+
+/*! \brief Record the end of the update and let the thread stop
+	\param status The final state of the update
+*/
+void FwUpdateEngine::Worker::finish(FwUpdateDeviceStatus status)
+{
+	xsens::Lock locky(&m_mutex);
+	if (m_done)
+		return;
+	m_report.m_status = status;
+	m_report.m_bytesSent = m_fwUpdate.m_bytesSent;
+	m_report.m_durationUs = m_startTime ? XsTime_monotonicUs() - m_startTime : 0;
+	m_done = true;
+	locky.unlock();
+	signalStopThread();
+}
+
+/*! \brief Constructor
+*/
+FwUpdateEngine::FwUpdateEngine()
+	: m_sliceWindow(1)
+	, m_replyTimeout(3000)
+{
+}
+
+/*! \brief Destructor, waits for running updates to stop
+*/
+FwUpdateEngine::~FwUpdateEngine()
+{
+	clearDevices();
+}
+
+/*! \brief Read the xff file that is sent to all devices into memory
+	\param filename The name of the xff file
+	\returns XRV_OK if the file was read
+*/
+XsResultValue FwUpdateEngine::loadXff(const XsString& filename)
+{
+	m_xff.clear();
+
+	IoInterfaceFile file;
+	XsResultValue res = file.open(filename, false, true);
+	if (res != XRV_OK)
+		return res;
+
+	XsFilePos size = file.getFileSize();
+	if (size <= 0 || size > (XsFilePos) UINT32_MAX)
+		return XRV_DATACORRUPT;
+
+	m_xff.resize((size_t) size);
+	XsFilePos length = 0;
+	res = file.readData(size, m_xff.data(), length);
+	if (res != XRV_OK || length != size)
+	{
+		m_xff.clear();
+		return res != XRV_OK ? res : XRV_ENDOFFILE;
+	}
+	return XRV_OK;
+}
+
+/*! \brief Use a copy of \a data as the xff file that is sent to all devices
+	\param data The contents of an xff file
+	\param size The size of \a data in bytes
+*/
+void FwUpdateEngine::setXff(uint8_t const* data, XsSize size)
+{
+	m_xff.assign(data, data + size);
+}
+
+/*! \brief Set the number of page slices that may be sent before their FWUP_READY is received
+	\details Only use a window larger than 1 when the bootloader of all devices can buffer that many slices.
+	\param window The number of slices, 1 (default) waits for each slice to be acknowledged
+	\sa FwUpdate::m_sliceWindow
+*/
+void FwUpdateEngine::setSliceWindow(uint8_t window)
+{
+	m_sliceWindow = window ? window : 1;
+}
+
+/*! \brief Set the time to wait for a reply of a bootloader before its update is considered failed
+	\param timeout The timeout in ms, 3000 by default
+*/
+void FwUpdateEngine::setReplyTimeout(uint32_t timeout)
+{
+	m_replyTimeout = timeout;
+}
+
+/*! \brief Add a device to update, its port is opened by run() and closed when its update has finished
+	\param portInfo The port of the device, with the baud rate of the bootloader for serial ports
+*/
+void FwUpdateEngine::addDevice(const XsPortInfo& portInfo)
+{
+	m_workers.emplace_back(new Worker(portInfo, std::shared_ptr<StreamInterface>()));
+}
+
+/*! \brief Add a device to update through a stream that is already open
+	\param name The name of the device in its report
+	\param stream The open stream of the device, it is not closed by the engine
+*/
+void FwUpdateEngine::addDevice(const XsString& name, std::shared_ptr<StreamInterface> stream)
+{
+	XsPortInfo portInfo;
+	portInfo.setPortName(name);
+	m_workers.emplace_back(new Worker(portInfo, stream));
+}
+
+/*! \brief Remove all devices, stopping updates that are still running
+*/
+void FwUpdateEngine::clearDevices()
+{
+	m_workers.clear();
+}
+
+/*! \brief Update all added devices concurrently and wait until they have finished
+	\returns XRV_OK if all devices were updated, XRV_NOFILEOPEN if no xff file was loaded, XRV_ERROR if the
+	update of a device failed, see reports() for the details
+*/
+XsResultValue FwUpdateEngine::run()
+{
+	if (m_xff.empty())
+		return XRV_NOFILEOPEN;
+
+	for (auto& worker : m_workers)
+		worker->start(m_xff, m_sliceWindow, m_replyTimeout);
+
+	bool ok = true;
+	for (auto& worker : m_workers)
+	{
+		while (!worker->isDone())
+			XsTime_msleep(5);
+		worker->finishRun();
+		ok = ok && worker->report().m_status == FUDS_Succeeded;
+	}
+	return ok ? XRV_OK : XRV_ERROR;
+}
+
+/*! \returns The state and throughput of each device, in the order in which they were added
+	\details This can be called from another thread while run() is busy to monitor the progress.
+*/
+std::vector<FwUpdateDeviceReport> FwUpdateEngine::reports() const
+{
+	std::vector<FwUpdateDeviceReport> result;
+	result.reserve(m_workers.size());
+	for (auto const& worker : m_workers)
+		result.push_back(worker->report());
+	return result;
+}
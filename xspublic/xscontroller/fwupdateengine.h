@@ -0,0 +1,117 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+#ifndef FWUPDATEENGINE_H
+#define FWUPDATEENGINE_H
+
+#include <xstypes/xsportinfo.h>
+#include <xstypes/xsresultvalue.h>
+#include <xstypes/xsstring.h>
+#include <memory>
+#include <vector>
+
+class StreamInterface;
+
+//! \brief The state of the firmware update of one device in a FwUpdateEngine
+enum FwUpdateDeviceStatus
+{
+	FUDS_Pending,		//!< The update has not started yet
+	FUDS_Running,		//!< The firmware is being sent
+	FUDS_Succeeded,		//!< The complete firmware was sent and acknowledged
+	FUDS_Failed,		//!< The bootloader refused a command
+	FUDS_TimedOut,		//!< The bootloader stopped replying
+	FUDS_PortError		//!< The port could not be opened or written
+};
+
+/*! \brief The result and throughput of the firmware update of one device */
+struct FwUpdateDeviceReport
+{
+	XsString m_portName;				//!< The name of the port of the device
+	FwUpdateDeviceStatus m_status;		//!< The state of the update
+	uint64_t m_bytesSent;				//!< The number of firmware bytes that were sent in page slices
+	int64_t m_durationUs;				//!< The time from starting the update until it finished in microseconds
+
+	//! \returns The number of firmware bytes per second, 0 if nothing was sent
+	inline double bytesPerSecond() const
+	{
+		return m_durationUs > 0 ? 1e6 * (double) m_bytesSent / (double) m_durationUs : 0.0;
+	}
+};
+
+/*! \brief Uploads one xff file to the bootloaders of multiple devices at the same time
+	\details The xff file is loaded into memory once and shared by all devices, each device is updated by the
+	FwUpdate state machine in its own thread, so a slow or failing device does not hold up the others.
+
+	By default each page slice waits for its FWUP_READY before the next is sent. When the bootloader can
+	buffer more slices, setSliceWindow() allows multiple slices to be in flight, which removes most of the
+	round trips from the upload.
+
+	The devices must already be in bootloader mode.
+	\sa FwUpdate
+*/
+class FwUpdateEngine
+{
+public:
+	FwUpdateEngine();
+	~FwUpdateEngine();
+
+	XsResultValue loadXff(const XsString& filename);
+	void setXff(uint8_t const* data, XsSize size);
+
+	//! \returns The size of the loaded xff file in bytes
+	inline XsSize xffSize() const
+	{
+		return m_xff.size();
+	}
+
+	void setSliceWindow(uint8_t window);
+	void setReplyTimeout(uint32_t timeout);
+
+	void addDevice(const XsPortInfo& portInfo);
+	void addDevice(const XsString& name, std::shared_ptr<StreamInterface> stream);
+	void clearDevices();
+
+	XsResultValue run();
+	std::vector<FwUpdateDeviceReport> reports() const;
+
+private:
+	FwUpdateEngine(FwUpdateEngine const&) = delete;
+	FwUpdateEngine& operator=(FwUpdateEngine const&) = delete;
+
+	class Worker;
+
+	std::vector<uint8_t> m_xff;						//!< The contents of the xff file
+	uint8_t m_sliceWindow;							//!< The number of slices that may await their acknowledgement
+	uint32_t m_replyTimeout;						//!< The time in ms to wait for a reply of the bootloader
+	std::vector<std::unique_ptr<Worker>> m_workers;	//!< The devices to update
+};
+
+#endif
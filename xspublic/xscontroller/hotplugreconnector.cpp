@@ -0,0 +1,527 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+
+#include "hotplugreconnector.h"
+#include "xscontrol_def.h"
+#include "xsdevice_def.h"
+#include "communicator.h"
+#include "xscontrollerconfig.h"
+#include "xsdevicestate.h"
+#include "xsdeviceptrarray.h"
+#include <xstypes/xstime.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifndef _WIN32
+	#include "udev.h"
+	#include <poll.h>
+#endif
+
+namespace
+{
+//! \brief The time in ms that the reconnector thread waits for a udev event before checking whether it must stop
+const int monitorPollTime = 100;
+//! \brief The number of times opening a returning port is attempted, the device node may not be accessible yet
+const int openAttempts = 50;
+//! \brief The time in ms between attempts to open a returning port
+const uint32_t openRetryInterval = 20;
+//! \brief The number of times the returning device is asked to go to config mode, it may still be starting up
+const int configAttempts = 3;
+//! \brief The time in ms to wait for the data poller to close the port after the connection was lost
+const int64_t portCloseTimeout = 500;
+}
+
+//! \brief Default constructor
+HotplugReconnector::LostDevice::LostDevice()
+	: m_device(nullptr)
+	, m_wasMeasuring(false)
+	, m_lostTime(0)
+{
+}
+
+//! \brief Copy constructor
+HotplugReconnector::LostDevice::LostDevice(LostDevice const& other)
+	: m_device(other.m_device)
+	, m_deviceId(other.m_deviceId)
+	, m_portInfo(other.m_portInfo)
+	, m_outputConfiguration(other.m_outputConfiguration)
+	, m_wasMeasuring(other.m_wasMeasuring)
+	, m_lostTime(other.m_lostTime)
+{
+}
+
+//! \brief Assignment operator, XsOutputConfigurationArray has no assignment operator of its own
+HotplugReconnector::LostDevice& HotplugReconnector::LostDevice::operator=(LostDevice const& other)
+{
+	if (this != &other)
+	{
+		m_device = other.m_device;
+		m_deviceId = other.m_deviceId;
+		m_portInfo = other.m_portInfo;
+		XsOutputConfigurationArray configuration(other.m_outputConfiguration);
+		m_outputConfiguration.swap(configuration);
+		m_wasMeasuring = other.m_wasMeasuring;
+		m_lostTime = other.m_lostTime;
+	}
+	return *this;
+}
+
+/*! \brief The thread that reconnects the devices whose port appeared
+	\details Reopening a port and waiting for the device to start up takes too long to do in the udev monitor
+	thread or in the thread of the application that called handleEvent()
+*/
+class HotplugReconnector::ReconnectWorker : public xsens::StandardThread
+{
+public:
+	//! \brief Constructor, \a owner supplies the jobs
+	ReconnectWorker(HotplugReconnector* owner)
+		: m_owner(owner)
+	{
+	}
+
+	//! \brief Stop the thread
+	~ReconnectWorker()
+	{
+		stopThread();
+	}
+
+protected:
+	//! \brief Run the queued reconnects when a job is added
+	int32_t innerFunction() override
+	{
+		if (!m_owner->m_jobEvent.wait())
+			return 1;
+
+		// reset before taking jobs from the queue, so a job that is queued after the last check sets the event again
+		m_owner->m_jobEvent.reset();
+		m_owner->runReconnects();
+		return 0;
+	}
+
+	//! \brief Wake up the thread so it notices that it should stop
+	void signalStopThread(void) override
+	{
+		StandardThread::signalStopThread();
+		m_owner->m_jobEvent.set();
+	}
+
+private:
+	HotplugReconnector* m_owner;
+};
+
+/*! \brief Constructor
+	\param control The control object whose devices must be reconnected
+*/
+HotplugReconnector::HotplugReconnector(XsControl* control)
+	: m_control(control)
+	, m_worker(new ReconnectWorker(this))
+	, m_started(false)
+	, m_udev(nullptr)
+	, m_context(nullptr)
+	, m_monitor(nullptr)
+	, m_monitorFd(-1)
+	, m_reconnectCount(0)
+	, m_failureCount(0)
+	, m_lastReconnectTime(0)
+	, m_lastOutageTime(0)
+{
+}
+
+/*! \brief Destructor, stops the reconnector */
+HotplugReconnector::~HotplugReconnector()
+{
+	try
+	{
+		stop();
+	}
+	catch (...)
+	{
+	}
+	delete m_worker;
+}
+
+/*! \brief Start tracking the connection loss of the devices of the control object
+	\param useUdev When true (default) the ports are monitored through udev, otherwise the application must
+	supply the hot-plug events to handleEvent()
+	\returns XRV_OK if the reconnector was started, XRV_UNSUPPORTED if \a useUdev is true and udev is not available
+	on this system, XRV_ALREADYOPEN if the reconnector was already started
+*/
+XsResultValue HotplugReconnector::start(bool useUdev)
+{
+	if (m_started)
+		return XRV_ALREADYOPEN;
+
+	m_jobEvent.reset();
+	if (!m_worker->startThread("HotplugReconnectWorker"))
+		return XRV_ERROR;
+
+	if (useUdev)
+	{
+		if (!openMonitor())
+		{
+			m_worker->stopThread();
+			return XRV_UNSUPPORTED;
+		}
+		if (!startThread("HotplugReconnector"))
+		{
+			closeMonitor();
+			m_worker->stopThread();
+			return XRV_ERROR;
+		}
+	}
+
+	m_control->addCallbackHandler(this);
+	m_started = true;
+	return XRV_OK;
+}
+
+/*! \brief Stop the reconnector and forget the devices that were waiting to be reconnected
+	\details A reconnect that is in progress is finished first, queued reconnects are dropped.
+*/
+void HotplugReconnector::stop()
+{
+	if (!m_started)
+		return;
+
+	m_control->removeCallbackHandler(this);
+	stopThread();
+	closeMonitor();
+	m_worker->stopThread();
+
+	xsens::Lock locky(&m_mutex);
+	m_jobs.clear();
+	m_lost.clear();
+	m_started = false;
+}
+
+//! \returns True if the reconnector was started
+bool HotplugReconnector::isStarted() const
+{
+	return m_started;
+}
+
+/*! \brief Handle a port that appeared or disappeared
+	\details When a port is removed, the master device that used it is remembered as lost. When a port is added
+	that matches a lost device, the device is queued for the worker thread of the reconnector, so this function
+	returns without waiting for the reconnect. The result shows up in reconnectCount() and failureCount().
+	\param event The event to handle
+*/
+void HotplugReconnector::handleEvent(HotplugEvent const& event)
+{
+	JLDEBUGG("Hotplug " << (event.m_action == HPA_Added ? "add " : "remove ") << event.m_portInfo);
+
+	if (event.m_action == HPA_Removed)
+	{
+		XsDevicePtrArray devices = m_control->mainDevices();
+		for (XsSize i = 0; i < devices.size(); ++i)
+		{
+			if (devices[i]->portInfo().portName() == event.m_portInfo.portName())
+				deviceLost(devices[i]);
+		}
+		return;
+	}
+
+	xsens::Lock locky(&m_mutex);
+	auto it = m_lost.begin();
+	while (it != m_lost.end() && !matches(*it, event.m_portInfo))
+		++it;
+	if (it == m_lost.end())
+		return;
+
+	ReconnectJob job;
+	job.m_lost = *it;
+	job.m_event = event;
+	m_lost.erase(it);
+	m_jobs.push_back(job);
+	m_jobEvent.set();
+}
+
+//! \brief Reconnect the queued devices, called from the worker thread
+void HotplugReconnector::runReconnects()
+{
+	xsens::Lock locky(&m_mutex);
+	while (!m_jobs.empty() && !m_worker->isTerminating())
+	{
+		ReconnectJob job = m_jobs.front();
+		m_jobs.pop_front();
+		locky.unlock();
+
+		finishReconnect(job, reconnect(job.m_lost, job.m_event.m_portInfo));
+
+		locky.lock();
+	}
+}
+
+/*! \brief Update the statistics after a reconnect attempt
+	\details When the attempt failed, the device is remembered as lost again, unless it was closed in the meantime.
+	\param job The device that was reconnected
+	\param reconnected The result of reconnect()
+*/
+void HotplugReconnector::finishReconnect(ReconnectJob const& job, bool reconnected)
+{
+	LostDevice const& lost = job.m_lost;
+	HotplugEvent const& event = job.m_event;
+	if (reconnected)
+	{
+		int64_t now = XsTime_monotonicUs();
+		m_lastReconnectTime.store(now - event.m_timeUs, std::memory_order_relaxed);
+		m_lastOutageTime.store(now - lost.m_lostTime, std::memory_order_relaxed);
+		m_reconnectCount.fetch_add(1, std::memory_order_relaxed);
+		JLDEBUGG("Reconnected " << lost.m_deviceId << " in " << (now - event.m_timeUs) << " us");
+		return;
+	}
+
+	m_failureCount.fetch_add(1, std::memory_order_relaxed);
+	JLALERTG("Reconnecting " << lost.m_deviceId << " on " << event.m_portInfo.portName() << " failed");
+
+	// keep waiting for the next time the device appears, unless the device was closed in the meantime
+	if (m_control->device(lost.m_deviceId) == lost.m_device)
+	{
+		xsens::Lock locky(&m_mutex);
+		m_lost.push_back(lost);
+	}
+}
+
+/*! \brief Remember a master device that lost its connection
+	\param dev The device that changed connectivity
+	\param newState The new connectivity state
+	\note This is typically called from the data poller thread of \a dev, so it does not communicate with the device
+*/
+void HotplugReconnector::onConnectivityChanged(XsDevice* dev, XsConnectivityState newState)
+{
+	if (newState == XCS_Disconnected && dev->isMasterDevice())
+		deviceLost(dev);
+}
+
+/*! \brief Add \a dev to the lost devices if it is not already in there
+	\details The output configuration is only remembered when it is cached by the device, so no communication is needed
+*/
+void HotplugReconnector::deviceLost(XsDevice* dev)
+{
+	LostDevice lost;
+	lost.m_device = dev;
+	lost.m_deviceId = dev->deviceId();
+	lost.m_portInfo = dev->portInfo();
+	lost.m_wasMeasuring = dev->isMeasuring();
+	if (dev->deviceState() == XDS_Measurement || dev->deviceState() == XDS_Recording)
+	{
+		XsOutputConfigurationArray configuration(dev->outputConfiguration());
+		lost.m_outputConfiguration.swap(configuration);
+	}
+	lost.m_lostTime = XsTime_monotonicUs();
+
+	xsens::Lock locky(&m_mutex);
+	for (auto const& it : m_lost)
+		if (it.m_device == dev)
+			return;
+	m_lost.push_back(lost);
+	JLDEBUGG("Lost " << lost.m_deviceId << " on " << lost.m_portInfo.portName());
+}
+
+/*! \returns True if the port \a portInfo belongs to the device \a lost
+	\details When the USB serial number contains a device id, it must match. Otherwise the port must have the
+	same vid/pid and port name.
+*/
+bool HotplugReconnector::matches(LostDevice const& lost, XsPortInfo const& portInfo) const
+{
+	if (portInfo.deviceId().isValid())
+		return portInfo.deviceId() == lost.m_deviceId;
+
+	uint16_t vid, pid, lostVid, lostPid;
+	portInfo.getVidPid(vid, pid);
+	lost.m_portInfo.getVidPid(lostVid, lostPid);
+	return vid == lostVid && pid == lostPid && portInfo.portName() == lost.m_portInfo.portName();
+}
+
+/*! \brief Reopen the port of a lost device and restore its state
+	\param lost The device to reconnect
+	\param portInfo The port that appeared
+	\returns True if the device was reconnected and is back in the state it was in when the connection was lost
+*/
+bool HotplugReconnector::reconnect(LostDevice const& lost, XsPortInfo const& portInfo)
+{
+	XsDevice* dev = m_control->device(lost.m_deviceId);
+	if (dev != lost.m_device || !dev->communicator())
+		return false;
+
+	Communicator* comm = dev->communicator();
+
+	// the data poller closes the port itself after it noticed the disconnect
+	int64_t waitUntil = XsTime_monotonicUs() + portCloseTimeout * 1000;
+	while (comm->isPortOpen() && XsTime_monotonicUs() < waitUntil)
+		XsTime_msleep(1);
+	if (comm->isPortOpen())
+		comm->closePort();
+
+	XsPortInfo port(portInfo);
+	port.setBaudrate(lost.m_portInfo.baudrate());
+
+	bool opened = false;
+	for (int attempt = 0; !opened && attempt < openAttempts; ++attempt)
+	{
+		if (attempt)
+			XsTime_msleep(openRetryInterval);
+		opened = comm->openPort(port, OPS_OpenPort);
+	}
+	if (!opened)
+		return false;
+
+	XsResultValue res = XRV_ERROR;
+	for (int attempt = 0; res != XRV_OK && attempt < configAttempts; ++attempt)
+		res = comm->gotoConfig();
+	if (res == XRV_OK)
+		res = comm->getDeviceId();
+	if (res != XRV_OK || comm->masterDeviceId() != lost.m_deviceId)
+	{
+		JLALERTG("Device on " << port.portName() << " is " << comm->masterDeviceId() << " instead of " << lost.m_deviceId);
+		comm->closePort();
+		return false;
+	}
+
+	// the device state still reflects the state before the connection was lost
+	if (!dev->gotoConfig())
+		return false;
+
+	if (!lost.m_outputConfiguration.empty() && dev->outputConfiguration() != lost.m_outputConfiguration)
+	{
+		XsOutputConfigurationArray config(lost.m_outputConfiguration);
+		if (!dev->setOutputConfiguration(config))
+			return false;
+	}
+
+	if (lost.m_wasMeasuring && !dev->gotoMeasurement())
+		return false;
+
+	dev->onConnectionRestored();
+	return true;
+}
+
+/*! \brief Handle the udev events
+	\returns 0
+*/
+int32_t HotplugReconnector::innerFunction()
+{
+#ifndef _WIN32
+	struct pollfd fds;
+	fds.fd = m_monitorFd;
+	fds.events = POLLIN;
+	fds.revents = 0;
+	if (poll(&fds, 1, monitorPollTime) <= 0 || !(fds.revents & POLLIN))
+		return 0;
+
+	udev_device* device = m_udev->monitor_receive_device(m_monitor);
+	if (!device)
+		return 0;
+
+	HotplugEvent event;
+	event.m_timeUs = XsTime_monotonicUs();
+
+	const char* action = m_udev->device_get_action(device);
+	const char* devnode = m_udev->device_get_devnode(device);
+	bool added = action && strcmp(action, "add") == 0;
+	bool removed = action && strcmp(action, "remove") == 0;
+	if ((added || removed) && devnode && strlen(devnode) < 256 && strncmp(devnode, "/dev/ttyS", 9) != 0)
+	{
+		event.m_action = added ? HPA_Added : HPA_Removed;
+		event.m_portInfo.setPortName(devnode);
+
+		// the sysfs attributes are only available while the device exists
+		udev_device* usbParentDevice = added ? m_udev->device_get_parent_with_subsystem_devtype(device, "usb", "usb_device") : nullptr;
+		if (usbParentDevice)
+		{
+			unsigned int vid = 0, pid = 0;
+			const char* vendor = m_udev->device_get_sysattr_value(usbParentDevice, "idVendor");
+			const char* product = m_udev->device_get_sysattr_value(usbParentDevice, "idProduct");
+			if (vendor && product)
+			{
+				sscanf(vendor, "%x", &vid);
+				sscanf(product, "%x", &pid);
+			}
+			event.m_portInfo.setVidPid((uint16_t) vid, (uint16_t) pid);
+
+			const char* deviceidstring = m_udev->device_get_sysattr_value(usbParentDevice, "serial");
+			if (deviceidstring)
+			{
+				int deviceId = 0;
+				sscanf(deviceidstring, "%08X", &deviceId);
+				event.m_portInfo.setDeviceId(deviceId);
+			}
+		}
+		handleEvent(event);
+	}
+	m_udev->device_unref(device);
+#endif
+	return 0;
+}
+
+/*! \brief Create the udev monitor for the tty subsystem
+	\returns True if the monitor is receiving events
+*/
+bool HotplugReconnector::openMonitor()
+{
+#ifdef _WIN32
+	return false;
+#else
+	m_udev = new Udev;
+	m_context = m_udev->unew();
+	if (m_context)
+		m_monitor = m_udev->monitor_new_from_netlink(m_context, "udev");
+	if (m_monitor &&
+		m_udev->monitor_filter_add_match_subsystem_devtype(m_monitor, "tty", NULL) >= 0 &&
+		m_udev->monitor_enable_receiving(m_monitor) >= 0)
+		m_monitorFd = m_udev->monitor_get_fd(m_monitor);
+
+	if (m_monitorFd >= 0)
+		return true;
+
+	closeMonitor();
+	return false;
+#endif
+}
+
+/*! \brief Release the udev monitor */
+void HotplugReconnector::closeMonitor()
+{
+#ifndef _WIN32
+	if (!m_udev)
+		return;
+	if (m_monitor)
+		m_udev->monitor_unref(m_monitor);
+	if (m_context)
+		m_udev->unref(m_context);
+	delete m_udev;
+#endif
+	m_udev = nullptr;
+	m_context = nullptr;
+	m_monitor = nullptr;
+	m_monitorFd = -1;
+}
@@ -0,0 +1,179 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+
+#ifndef HOTPLUGRECONNECTOR_H
+#define HOTPLUGRECONNECTOR_H
+
+#include "xscallback.h"
+#include <xstypes/xsportinfo.h>
+#include <xstypes/xsdeviceid.h>
+#include <xstypes/xsoutputconfigurationarray.h>
+#include <xstypes/xsresultvalue.h>
+#include <xscommon/xsens_mutex.h>
+#include <xscommon/threading.h>
+#include <atomic>
+#include <deque>
+#include <vector>
+
+struct XsControl;
+struct udev;
+struct udev_monitor;
+class Udev;
+
+//! \brief The kind of change reported by a HotplugEvent
+enum HotplugAction
+{
+	HPA_Added,		//!< A port appeared
+	HPA_Removed		//!< A port disappeared
+};
+
+/*! \brief A port that appeared or disappeared */
+struct HotplugEvent
+{
+	HotplugAction m_action;		//!< What happened to the port
+	XsPortInfo m_portInfo;		//!< The port name, vid/pid and, when the USB serial number contains it, the device id
+	int64_t m_timeUs;			//!< The time of the event from XsTime_monotonicUs()
+};
+
+/*! \brief Reopens the port of a master device that was unplugged as soon as the device is plugged back in
+	\details The reconnector listens to connectivity changes of the devices of an XsControl and to udev events
+	of the tty subsystem. When a master device loses its connection, its port, output configuration and
+	measurement state are remembered. When a port appears that belongs to the same device (identified by the
+	device id in the USB serial number, or by the same vid/pid on the same port name) the port is reopened
+	through the existing communicator, the device id is verified, the output configuration is restored if the
+	device forgot it and measurement is restarted if the device was measuring. The XsDevice object stays the
+	same, so the application only sees a XCS_Disconnected followed by a XCS_PluggedIn connectivity change.
+
+	Udev events are handled in the thread of the reconnector. The reconnect itself, which can take more than a
+	second while the device starts up, is done by a separate worker thread, so neither the udev monitor nor the
+	data path of other devices is blocked by it. Applications that receive hot-plug notifications in another way
+	can start the reconnector without udev and pass the events to handleEvent().
+	\note Only devices that were opened before start() was called report their connection loss directly, other
+	devices are detected through the udev remove event of their port.
+*/
+class HotplugReconnector : public XsCallback, protected xsens::StandardThread
+{
+public:
+	HotplugReconnector(XsControl* control);
+	~HotplugReconnector();
+
+	XsResultValue start(bool useUdev = true);
+	void stop();
+	bool isStarted() const;
+
+	void handleEvent(HotplugEvent const& event);
+
+	//! \returns The number of devices that were reconnected successfully
+	inline uint64_t reconnectCount() const
+	{
+		return m_reconnectCount.load(std::memory_order_relaxed);
+	}
+
+	//! \returns The number of reconnect attempts that failed
+	inline uint64_t failureCount() const
+	{
+		return m_failureCount.load(std::memory_order_relaxed);
+	}
+
+	//! \returns The time in microseconds from the last add event until its device was measuring again
+	inline int64_t lastReconnectTime() const
+	{
+		return m_lastReconnectTime.load(std::memory_order_relaxed);
+	}
+
+	//! \returns The time in microseconds that the last reconnected device was disconnected
+	inline int64_t lastOutageTime() const
+	{
+		return m_lastOutageTime.load(std::memory_order_relaxed);
+	}
+
+protected:
+	//! \brief The state of a master device that lost its connection
+	struct LostDevice
+	{
+		LostDevice();
+		LostDevice(LostDevice const& other);
+		LostDevice& operator=(LostDevice const& other);
+
+		XsDevice* m_device;								//!< The device, it is not owned by the reconnector
+		XsDeviceId m_deviceId;							//!< The id of the device
+		XsPortInfo m_portInfo;							//!< The port the device was connected to
+		XsOutputConfigurationArray m_outputConfiguration;	//!< The output configuration to restore, empty when the device was not measuring
+		bool m_wasMeasuring;							//!< True if measurement must be restarted
+		int64_t m_lostTime;								//!< The time the connection was lost from XsTime_monotonicUs()
+	};
+
+	void onConnectivityChanged(XsDevice* dev, XsConnectivityState newState) override;
+	int32_t innerFunction() override;
+
+	virtual bool reconnect(LostDevice const& lost, XsPortInfo const& portInfo);
+
+private:
+	HotplugReconnector(HotplugReconnector const&) = delete;
+	HotplugReconnector& operator=(HotplugReconnector const&) = delete;
+
+	class ReconnectWorker;
+
+	//! \brief A lost device whose port appeared, waiting for the worker thread
+	struct ReconnectJob
+	{
+		LostDevice m_lost;			//!< The device to reconnect
+		HotplugEvent m_event;		//!< The add event of its port
+	};
+
+	void deviceLost(XsDevice* dev);
+	void runReconnects();
+	void finishReconnect(ReconnectJob const& job, bool reconnected);
+	bool matches(LostDevice const& lost, XsPortInfo const& portInfo) const;
+	bool openMonitor();
+	void closeMonitor();
+
+	XsControl* m_control;
+	xsens::Mutex m_mutex;
+	std::vector<LostDevice> m_lost;		//!< The devices waiting for their port to return, protected by m_mutex
+	std::deque<ReconnectJob> m_jobs;	//!< The devices waiting for the worker thread, protected by m_mutex
+	xsens::WaitEvent m_jobEvent;		//!< Set when a job was added to m_jobs
+	ReconnectWorker* m_worker;			//!< The thread that reconnects the devices
+	bool m_started;
+
+	Udev* m_udev;						//!< The udev library, nullptr when udev is not used
+	struct udev* m_context;
+	struct udev_monitor* m_monitor;
+	int m_monitorFd;
+
+	std::atomic<uint64_t> m_reconnectCount;
+	std::atomic<uint64_t> m_failureCount;
+	std::atomic<int64_t> m_lastReconnectTime;
+	std::atomic<int64_t> m_lastOutageTime;
+};
+
+#endif
@@ -592,6 +592,37 @@ XsResultValue IoInterfaceFile::readData(XsFilePos maxLength, XsByteArray& data)
 	return m_lastResult = XRV_OK;
 }
 
+/*! \brief Read data from the file into a buffer owned by the caller
+	\details Unlike readData(XsFilePos, XsByteArray&), this does not (re)size a byte array, so a caller can keep
+	reading into the same fixed buffer.
+	\param maxLength The maximum number of bytes to read
+	\param destination The buffer to read into, it must have room for \a maxLength bytes
+	\param length Receives the number of bytes that were read
+	\returns XRV_OK if the data was read successfully, XRV_ENDOFFILE if no data was left
+*/
+XsResultValue IoInterfaceFile::readData(XsFilePos maxLength, uint8_t* destination, XsFilePos& length)
+{
+	length = 0;
+	if (!m_handle)
+		return m_lastResult = XRV_NOFILEOPEN;
+
+	if (maxLength == 0)
+		return m_lastResult = XRV_OK;
+
+	gotoRead();
+	length = m_handle->read(destination, 1, maxLength);
+	if (length <= 0)
+	{
+		length = 0;
+		if (m_handle->eof())
+			return (m_lastResult = XRV_ENDOFFILE);
+		return (m_lastResult = XRV_ERROR);
+	}
+
+	m_readPos += length;
+	return m_lastResult = XRV_OK;
+}
+
 /*! \brief This function will read blocks of data aligned to \a m_fileBlockSize
 	\details The Function will read as much data as is necessary to align to the block size + \a blockCount blocks.
 	So the given blockCount is an indication for the minimum amount of data read, unless the end of file is encountered.
@@ -828,3 +859,30 @@ XsResultValue IoInterfaceFile::flushFileBuffers()
 	return XRV_OK;
 #endif
 }
+
+/*! \brief Tell the operating system that the file will be read sequentially
+	\details This allows the operating system to read ahead more aggressively. It has no effect on Windows.
+*/
+void IoInterfaceFile::adviseSequentialAccess()
+{
+#if !defined(_WIN32) && !defined(__APPLE__)
+	if (m_handle)
+		(void) posix_fadvise(fileno(m_handle->handle()), 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+}
+
+/*! \brief Tell the operating system that a part of the file will be read soon
+	\details The operating system can then start reading it in the background. It has no effect on Windows.
+	\param start The offset of the data that will be read
+	\param length The number of bytes that will be read
+*/
+void IoInterfaceFile::adviseWillNeed(XsFilePos start, XsFilePos length)
+{
+#if !defined(_WIN32) && !defined(__APPLE__)
+	if (m_handle)
+		(void) posix_fadvise(fileno(m_handle->handle()), (off_t) start, (off_t) length, POSIX_FADV_WILLNEED);
+#else
+	(void) start;
+	(void) length;
+#endif
+}
@@ -77,6 +77,7 @@ public:
 	XsResultValue getLastResult() const override;
 	XsResultValue writeData(const XsByteArray& data, XsFilePos* written = nullptr) override;
 	XsResultValue readData(XsFilePos maxLength, XsByteArray& data) override;
+	XsResultValue readData(XsFilePos maxLength, uint8_t* destination, XsFilePos& length);
 	XsResultValue readDataBlocks(XsFilePos blockCount, XsByteArray& data);
 	XsResultValue readTerminatedData(XsFilePos maxLength, unsigned char terminator, XsByteArray& bdata);
 
@@ -99,6 +100,8 @@ public:
 	XsResultValue setWritePosition(XsFilePos pos = -1);
 	XsResultValue reserve(XsFilePos minSize);
 	XsResultValue flushFileBuffers();
+	void adviseSequentialAccess();
+	void adviseWillNeed(XsFilePos start, XsFilePos length);
 
 	//! \brief The default file block size
 	static const XsFilePos m_fileBlockSize = 4096;
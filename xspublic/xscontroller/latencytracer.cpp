@@ -0,0 +1,243 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+
+#include "latencytracer.h"
+#include "metrics.h"
+#include <xstypes/xstime.h>
+#include <xscommon/xsens_mutex.h>
+#include <atomic>
+#include <sstream>
+#include <vector>
+#include <stdio.h>
+
+/*! \cond XS_INTERNAL */
+namespace
+{
+/*! \brief The marks of the block that is being processed by the current thread */
+struct ThreadTrace
+{
+	bool m_active;				//!< Whether a block is being traced
+	int64_t m_marks[LM_Count];	//!< The timestamps of the marks in us
+};
+
+/*! \brief A packet stored for export */
+struct TraceSample
+{
+	uint64_t m_deviceId;		//!< The id of the device that produced the packet
+	int64_t m_packetId;			//!< The packet id
+	int64_t m_marks[LM_Count];	//!< The timestamps of the marks in us
+};
+
+thread_local ThreadTrace g_trace = {false, {0}};
+std::atomic<bool> g_enabled(false);
+std::atomic<unsigned int> g_sampleInterval(0);
+std::atomic<unsigned int> g_sampleCounter(0);
+
+xsens::Mutex g_samplesMutex;
+std::vector<TraceSample> g_samples;
+XsSize g_sampleHead = 0;
+
+//! \brief The names of the stages, the stage i runs from mark i to mark i+1, the last one is the total
+char const* const g_stageNames[LM_Count] =
+{
+	"queue",
+	"extract",
+	"dispatch",
+	"process",
+	"callback",
+	"total"
+};
+}
+/*! \endcond */
+
+/*! \brief Enable or disable recording at the trace points
+	\param enabled true to start recording
+*/
+void LatencyTracer::setEnabled(bool enabled)
+{
+	g_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+//! \returns true if the trace points are recording
+bool LatencyTracer::isEnabled()
+{
+	return g_enabled.load(std::memory_order_relaxed);
+}
+
+/*! \brief Set how often a packet is stored for export
+	\param interval Store every \a interval-th packet, 0 disables storing packets
+*/
+void LatencyTracer::setSampleInterval(unsigned int interval)
+{
+	g_sampleInterval.store(interval, std::memory_order_relaxed);
+}
+
+//! \returns The interval at which packets are stored for export, 0 if disabled
+unsigned int LatencyTracer::sampleInterval()
+{
+	return g_sampleInterval.load(std::memory_order_relaxed);
+}
+
+/*! \brief Start tracing a block of data on the current thread
+	\param queued The monotonic time at which the block was queued in us
+*/
+void LatencyTracer::begin(int64_t queued)
+{
+	if (!isEnabled())
+		return;
+	g_trace.m_active = true;
+	g_trace.m_marks[LM_Queued] = queued;
+	g_trace.m_marks[LM_Dequeued] = XsTime_monotonicUs();
+	for (int i = LM_Extracted; i < LM_Count; ++i)
+		g_trace.m_marks[i] = 0;
+}
+
+/*! \brief Record the current time for mark \a m of the block being traced on the current thread
+	\param m The mark to record
+*/
+void LatencyTracer::mark(LatencyMark m)
+{
+	if (g_trace.m_active)
+		g_trace.m_marks[m] = XsTime_monotonicUs();
+}
+
+/*! \brief Finish tracing a packet
+	\details Records LM_Done and adds the latency of each stage to the histograms in \a metrics. Stages of which
+	the marks were not recorded are skipped.
+	\param metrics The metrics of the device that produced the packet
+	\param deviceId The id of the device that produced the packet
+	\param packetId The id of the packet
+*/
+void LatencyTracer::finish(DeviceMetrics& metrics, XsDeviceId const& deviceId, int64_t packetId)
+{
+	if (!g_trace.m_active)
+		return;
+
+	int64_t* marks = g_trace.m_marks;
+	marks[LM_Done] = XsTime_monotonicUs();
+	for (int i = 0; i < LM_Done; ++i)
+		if (marks[i] && marks[i + 1] >= marks[i])
+			metrics.latencyHistogram(i)->observe((uint64_t)(marks[i + 1] - marks[i]));
+	metrics.latencyHistogram(LM_Done)->observe((uint64_t)(marks[LM_Done] - marks[LM_Queued]));
+
+	unsigned int interval = sampleInterval();
+	if (interval && (g_sampleCounter.fetch_add(1, std::memory_order_relaxed) % interval) == 0)
+	{
+		TraceSample sample;
+		sample.m_deviceId = deviceId.toInt();
+		sample.m_packetId = packetId;
+		for (int i = 0; i < LM_Count; ++i)
+			sample.m_marks[i] = marks[i];
+
+		xsens::Lock lock(&g_samplesMutex);
+		if (g_samples.size() < maxSamples)
+			g_samples.push_back(sample);
+		else
+		{
+			g_samples[g_sampleHead] = sample;
+			g_sampleHead = (g_sampleHead + 1) % maxSamples;
+		}
+	}
+
+	marks[LM_Handled] = marks[LM_Callback] = 0;
+}
+
+/*! \brief Stop tracing the block on the current thread */
+void LatencyTracer::end()
+{
+	g_trace.m_active = false;
+}
+
+/*! \brief Return the sampled packets in the Chrome/Perfetto trace event JSON format
+	\details Each stage of a packet is a complete event, grouped per device. The result can be loaded in
+	chrome://tracing or ui.perfetto.dev.
+	\returns The trace as a JSON document
+*/
+std::string LatencyTracer::chromeTrace()
+{
+	std::ostringstream os;
+	os << "{\"traceEvents\":[";
+	bool first = true;
+
+	xsens::Lock lock(&g_samplesMutex);
+	for (XsSize n = 0; n < g_samples.size(); ++n)
+	{
+		TraceSample const& s = g_samples[(g_sampleHead + n) % g_samples.size()];
+		for (int i = 0; i < LM_Done; ++i)
+		{
+			if (!s.m_marks[i] || !s.m_marks[i + 1] || s.m_marks[i + 1] < s.m_marks[i])
+				continue;
+			if (!first)
+				os << ",";
+			first = false;
+			os << "\n{\"name\":\"" << g_stageNames[i] << "\",\"cat\":\"xda\",\"ph\":\"X\""
+				<< ",\"ts\":" << s.m_marks[i]
+				<< ",\"dur\":" << (s.m_marks[i + 1] - s.m_marks[i])
+				<< ",\"pid\":1,\"tid\":" << s.m_deviceId
+				<< ",\"args\":{\"packetId\":" << s.m_packetId << "}}";
+		}
+	}
+	os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+	return os.str();
+}
+
+/*! \brief Write chromeTrace() to \a filename
+	\param filename The name of the file to write
+	\returns true if the file was written successfully
+*/
+bool LatencyTracer::writeChromeTrace(XsString const& filename)
+{
+	std::string trace = chromeTrace();
+	FILE* fp = fopen(filename.c_str(), "wb");
+	if (!fp)
+		return false;
+	bool ok = fwrite(trace.data(), 1, trace.size(), fp) == trace.size();
+	return (fclose(fp) == 0) && ok;
+}
+
+/*! \brief Remove all packets that were stored for export */
+void LatencyTracer::clearSamples()
+{
+	xsens::Lock lock(&g_samplesMutex);
+	g_samples.clear();
+	g_sampleHead = 0;
+}
+
+/*! \returns The name of stage \a stage, where stage LM_Done is the total latency
+	\param stage The stage, the stage i runs from mark i to mark i+1
+*/
+char const* LatencyTracer::stageName(int stage)
+{
+	if (stage < 0 || stage >= LM_Count)
+		return "unknown";
+	return g_stageNames[stage];
+}
@@ -0,0 +1,108 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+
+#ifndef LATENCYTRACER_H
+#define LATENCYTRACER_H
+
+#include <xstypes/xsdeviceid.h>
+#include <xstypes/xsstring.h>
+#include <string>
+
+class DeviceMetrics;
+
+/*! \brief The points in the receive pipeline where a timestamp is taken
+	\details The latency of a stage is the difference between two consecutive marks.
+*/
+enum LatencyMark
+{
+	LM_Queued = 0,		//!< The read data was added to the DataParser queue
+	LM_Dequeued,		//!< The DataParser took the data from its queue
+	LM_Extracted,		//!< The messages were extracted from the data
+	LM_Handled,			//!< XsDevice started handling the data packet
+	LM_Callback,		//!< XsDevice started the live data callbacks
+	LM_Done,			//!< The live data callbacks returned
+
+	LM_Count			//!< The number of marks
+};
+
+/*! \brief Timestamp collection and aggregation for the receive pipeline
+	\details Trace points store monotonic timestamps in a thread-local record while the DataParser thread
+	processes a block of data. When a packet has been delivered, the stage latencies are added to the histograms
+	in the DeviceMetrics of the device, and every sampleInterval()-th packet is stored for export in the
+	Chrome/Perfetto trace event format.
+
+	The trace points are only compiled in when XSENS_LATENCY_TRACING is defined, and they only record when
+	tracing has been enabled with setEnabled().
+*/
+class LatencyTracer
+{
+public:
+	//! \brief The maximum number of sampled packets that is kept for export
+	static const XsSize maxSamples = 16384;
+
+	static void setEnabled(bool enabled);
+	static bool isEnabled();
+	static void setSampleInterval(unsigned int interval);
+	static unsigned int sampleInterval();
+
+	static void begin(int64_t queued);
+	static void mark(LatencyMark m);
+	static void finish(DeviceMetrics& metrics, XsDeviceId const& deviceId, int64_t packetId);
+	static void end();
+
+	static std::string chromeTrace();
+	static bool writeChromeTrace(XsString const& filename);
+	static void clearSamples();
+
+	static char const* stageName(int stage);
+};
+
+#ifdef XSENS_LATENCY_TRACING
+	//! \brief Start tracing a block of data that was queued at monotonic time \a queued
+	#define XSLATENCY_BEGIN(queued)					LatencyTracer::begin(queued)
+	//! \brief Record LatencyMark \a m for the current block
+	#define XSLATENCY_MARK(m)						LatencyTracer::mark(m)
+	//! \brief Record the latencies of packet \a packetId of device \a deviceId into \a metrics
+	#define XSLATENCY_FINISH(metrics, deviceId, packetId)	LatencyTracer::finish(metrics, deviceId, packetId)
+	//! \brief Stop tracing the current block
+	#define XSLATENCY_END()							LatencyTracer::end()
+	//! \brief Return the current monotonic time when tracing is compiled in
+	#define XSLATENCY_NOW()							XsTime_monotonicUs()
+#else
+	#define XSLATENCY_BEGIN(queued)					((void) 0)
+	#define XSLATENCY_MARK(m)						((void) 0)
+	#define XSLATENCY_FINISH(metrics, deviceId, packetId)	((void) 0)
+	#define XSLATENCY_END()							((void) 0)
+	#define XSLATENCY_NOW()							0
+#endif
+
+#endif
@@ -0,0 +1,207 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+
+#include "latestvaluetable.h"
+#include <xstypes/xsdatapacket.h>
+#include <string.h>
+
+/*! \brief Copy the values to \a dest
+	\param dest The destination for the values
+	\param count The maximum number of values to write to \a dest
+	\returns The number of values written to \a dest
+*/
+XsSize LatestValue::toDoubles(double* dest, XsSize count) const
+{
+	XsSize n = m_count < count ? m_count : count;
+	for (XsSize i = 0; i < n; ++i)
+		dest[i] = m_values[i];
+	return n;
+}
+
+/*! \brief Return the value as an unsigned integer
+	\details This is only meaningful for items that contain a single integer value, such as the packet counter
+	or status word.
+	\returns The value or 0 if the item does not have exactly one value
+*/
+uint64_t LatestValue::toUnsigned() const
+{
+	if (m_count != 1)
+		return 0;
+	return (uint64_t) m_values[0];
+}
+
+/*! \brief Constructor, creates an empty table */
+LatestValueTable::LatestValueTable()
+	: m_count(0)
+{
+	for (auto& entry : m_entries)
+	{
+		entry.m_sequence.store(0, std::memory_order_relaxed);
+		entry.m_key.store(XDI_None, std::memory_order_relaxed);
+		for (auto& word : entry.m_words)
+			word.store(0, std::memory_order_relaxed);
+	}
+}
+
+/*! \brief Start tracking the newest value of \a id
+	\param id The identifier to track, the format bits are ignored
+	\returns false if the table is full, true if \a id is tracked
+*/
+bool LatestValueTable::watch(XsDataIdentifier id)
+{
+	xsens::Lock lock(&m_writeMutex);
+	uint32_t key = (uint32_t)(id & XDI_FullTypeMask);
+	uint32_t count = m_count.load(std::memory_order_relaxed);
+	for (uint32_t i = 0; i < count; ++i)
+		if (m_entries[i].m_key.load(std::memory_order_relaxed) == key)
+			return true;
+
+	if (count == maxEntries)
+		return false;
+
+	Entry& entry = m_entries[count];
+	write(entry, XDI_None, 0, 0, nullptr, 0);
+	entry.m_key.store(key, std::memory_order_relaxed);
+	m_count.store(count + 1, std::memory_order_release);
+	return true;
+}
+
+/*! \brief Stop tracking all identifiers */
+void LatestValueTable::clear()
+{
+	xsens::Lock lock(&m_writeMutex);
+	uint32_t count = m_count.load(std::memory_order_relaxed);
+	m_count.store(0, std::memory_order_release);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		Entry& entry = m_entries[i];
+		uint32_t seq = entry.m_sequence.load(std::memory_order_relaxed);
+		entry.m_sequence.store(seq + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		entry.m_key.store(XDI_None, std::memory_order_relaxed);
+		entry.m_sequence.store(seq + 2, std::memory_order_release);
+	}
+}
+
+/*! \brief Update the table with the items in \a pack that are being watched
+	\details Only the watched items are retrieved from \a pack, in a single pass with XsDataPacket_getValues.
+	\param pack The packet to take the values from
+*/
+void LatestValueTable::update(XsDataPacket const& pack)
+{
+	if (empty())
+		return;
+
+	xsens::Lock lock(&m_writeMutex);
+	uint32_t count = m_count.load(std::memory_order_relaxed);
+	if (!count)
+		return;
+
+	for (uint32_t i = 0; i < count; ++i)
+		m_requests[i] = XsDataPacketValueRequest(static_cast<XsDataIdentifier>(m_entries[i].m_key.load(std::memory_order_relaxed)), m_values[i], LatestValue::maxValues);
+	if (!XsDataPacket_getValues(&pack, m_requests, count))
+		return;
+
+	int64_t packetId = pack.packetId();
+	int64_t toa = pack.timeOfArrival().msTime();
+	for (uint32_t i = 0; i < count; ++i)
+		if (m_requests[i].m_found)
+			write(m_entries[i], m_requests[i].m_id, packetId, toa, m_values[i], m_requests[i].m_found);
+}
+
+/*! \brief Read the newest value of \a id
+	\details This function does not block and does not allocate memory. It retries when the value is updated
+	while it is being copied.
+	\param id The identifier to read, the format bits are ignored
+	\param value Receives the value
+	\returns false if \a id is not being watched or no value has been received for it yet
+*/
+bool LatestValueTable::read(XsDataIdentifier id, LatestValue& value) const
+{
+	uint32_t key = (uint32_t)(id & XDI_FullTypeMask);
+	uint32_t count = m_count.load(std::memory_order_acquire);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		Entry const& entry = m_entries[i];
+		if (entry.m_key.load(std::memory_order_relaxed) != key)
+			continue;
+
+		uint64_t words[3 + payloadWords];
+		for (;;)
+		{
+			uint32_t seq = entry.m_sequence.load(std::memory_order_acquire);
+			if (seq & 1)
+				continue;
+
+			uint32_t entryKey = entry.m_key.load(std::memory_order_relaxed);
+			for (XsSize w = 0; w < 3 + payloadWords; ++w)
+				words[w] = entry.m_words[w].load(std::memory_order_relaxed);
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (entry.m_sequence.load(std::memory_order_relaxed) != seq)
+				continue;
+			if (entryKey != key)
+				return false;
+			break;
+		}
+
+		value.m_id = static_cast<XsDataIdentifier>(words[0] >> 32);
+		value.m_count = (XsSize)(words[0] & 0xFFFFFFFF);
+		if (value.m_id == XDI_None)
+			return false;
+		value.m_packetId = (int64_t) words[1];
+		value.m_toa = (int64_t) words[2];
+		memcpy(value.m_values, &words[3], value.m_count * sizeof(double));
+		return true;
+	}
+	return false;
+}
+
+/*! \brief Write the values of a single item into \a entry using the sequence lock */
+void LatestValueTable::write(Entry& entry, XsDataIdentifier id, int64_t packetId, int64_t toa, double const* values, XsSize count)
+{
+	uint64_t payload[payloadWords] = {};
+	if (count)
+		memcpy(payload, values, count * sizeof(double));
+
+	uint32_t seq = entry.m_sequence.load(std::memory_order_relaxed);
+	entry.m_sequence.store(seq + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	entry.m_words[0].store(((uint64_t) id << 32) | (uint64_t) count, std::memory_order_relaxed);
+	entry.m_words[1].store((uint64_t) packetId, std::memory_order_relaxed);
+	entry.m_words[2].store((uint64_t) toa, std::memory_order_relaxed);
+	for (XsSize w = 0; w < count; ++w)
+		entry.m_words[3 + w].store(payload[w], std::memory_order_relaxed);
+
+	entry.m_sequence.store(seq + 2, std::memory_order_release);
+}
@@ -0,0 +1,113 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+
+#ifndef LATESTVALUETABLE_H
+#define LATESTVALUETABLE_H
+
+#include <xstypes/xsdataidentifier.h>
+#include <xstypes/xsdatapacketvaluerequest.h>
+#include <xscommon/xsens_mutex.h>
+#include <atomic>
+
+struct XsDataPacket;
+
+/*! \brief A snapshot of the newest value of a single data item, filled by LatestValueTable::read
+	\details The numeric values of the item are stored as doubles, as XsDataPacket_getValues returns them.
+*/
+struct LatestValue
+{
+	//! \brief The maximum number of values of an item that can be tracked
+	static const XsSize maxValues = 16;
+
+	XsDataIdentifier m_id;		//!< The identifier of the item, without format bits
+	int64_t m_packetId;			//!< The packet id of the packet the item came from
+	int64_t m_toa;				//!< The time of arrival of the packet the item came from in ms
+	XsSize m_count;				//!< The number of valid values in m_values
+	double m_values[maxValues];	//!< The values of the item
+
+	XsSize toDoubles(double* dest, XsSize count) const;
+	uint64_t toUnsigned() const;
+};
+
+/*! \class LatestValueTable
+	\brief Keeps the newest value of a small set of data identifiers so polling threads can read them lock-free
+	\details The table is written by the thread that processes the device data and read with a sequence lock,
+	readers retry when the value was updated while they were copying it. Readers never block the writer and
+	never allocate memory. Identifiers are compared on their type, the format bits are ignored. Only items with
+	numeric values are tracked, at most LatestValue::maxValues values per item.
+*/
+class LatestValueTable
+{
+public:
+	//! \brief The maximum number of identifiers that can be watched
+	static const XsSize maxEntries = 32;
+
+	LatestValueTable();
+
+	bool watch(XsDataIdentifier id);
+	void clear();
+	void update(XsDataPacket const& pack);
+	bool read(XsDataIdentifier id, LatestValue& value) const;
+
+	//! \returns true if no identifiers are being watched
+	inline bool empty() const
+	{
+		return m_count.load(std::memory_order_acquire) == 0;
+	}
+
+private:
+	//! \brief The number of 64-bit words in the data of an entry
+	static const XsSize payloadWords = LatestValue::maxValues;
+
+	/*! \brief A single sequence locked entry
+		\details m_words contains the identifier and value count, the packet id, the time of arrival and the bit
+		patterns of the values.
+		The data is stored in relaxed atomics so concurrent reads are well-defined, consistency is guaranteed by
+		m_sequence, which is odd while the entry is being written.
+	*/
+	struct Entry
+	{
+		std::atomic<uint32_t> m_sequence;			//!< The sequence counter of the entry
+		std::atomic<uint32_t> m_key;				//!< The watched identifier without format bits
+		std::atomic<uint64_t> m_words[3 + payloadWords];	//!< The data of the entry
+	};
+
+	void write(Entry& entry, XsDataIdentifier id, int64_t packetId, int64_t toa, double const* values, XsSize count);
+
+	Entry m_entries[maxEntries];		//!< The entries, only the first m_count are in use
+	std::atomic<uint32_t> m_count;		//!< The number of entries in use
+	xsens::Mutex m_writeMutex;			//!< Serializes update() with watch() and clear()
+	XsDataPacketValueRequest m_requests[maxEntries];			//!< Scratch requests for the watched items, only accessed by the writer
+	double m_values[maxEntries][LatestValue::maxValues];		//!< Scratch storage for m_requests
+};
+
+#endif
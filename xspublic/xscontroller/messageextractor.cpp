@@ -78,7 +78,9 @@ XsResultValue MessageExtractor::processNewData(XsDevice* devicePtr, XsByteArray
 #endif
 
 	XsSize popped = 0;
+	XsSize skipped = 0;
 	messages.clear();
+	DeviceMetrics* metrics = devicePtr ? &devicePtr->metrics() : nullptr;
 
 	while (true)
 	{
@@ -88,6 +90,8 @@ XsResultValue MessageExtractor::processNewData(XsDevice* devicePtr, XsByteArray
 
 		XsProtocolType type;
 		MessageLocation location = m_protocolManager->findMessage(type, raw);
+		if (metrics && location.m_checksumFailures)
+			metrics->m_checksumFailures->add((uint64_t) location.m_checksumFailures);
 		assert(location.m_startPos == -1 || location.m_incompletePos == -1 || location.m_incompletePos < location.m_startPos);
 
 		if (location.isValid())
@@ -114,6 +118,7 @@ XsResultValue MessageExtractor::processNewData(XsDevice* devicePtr, XsByteArray
 						{
 							JLALERTG("Skipping " << location.m_incompletePos << " bytes from the input buffer");
 							popped += (XsSize)(ptrdiff_t) location.m_incompletePos;
+							skipped += (XsSize)(ptrdiff_t) location.m_incompletePos;
 						}
 
 						break;
@@ -131,12 +136,14 @@ XsResultValue MessageExtractor::processNewData(XsDevice* devicePtr, XsByteArray
 							<< " " << std::setw(2) << (int)message.getMessageStart()[3]
 							<< " " << std::setw(2) << (int)message.getMessageStart()[4]
 							<< std::dec << std::setfill(' '));
+						skipped += (XsSize)(ptrdiff_t) location.m_startPos;
 					}
 				}
 				else if (location.m_startPos > 0)
 				{
 					// We are going to skip something but we are not going to skip an incomplete but potentially valid message
 					JLALERTG("Skipping " << location.m_startPos << " bytes from the input buffer");
+					skipped += (XsSize)(ptrdiff_t) location.m_startPos;
 				}
 
 				if (m_retryTimeout)
@@ -147,7 +154,7 @@ XsResultValue MessageExtractor::processNewData(XsDevice* devicePtr, XsByteArray
 
 				// message is valid, remove data from cache
 				popped += (XsSize)(ptrdiff_t)(location.m_size + location.m_startPos);
-				messages.push_back(message);
+				messages.push_back(std::move(message));
 			}
 			else
 			{
@@ -161,13 +168,27 @@ XsResultValue MessageExtractor::processNewData(XsDevice* devicePtr, XsByteArray
 		{
 			int bestPosition = location.m_incompletePos >= 0 ? location.m_incompletePos : location.m_startPos;
 			if (bestPosition < 0)
+			{
+				skipped += m_buffer.size() - popped;
 				popped = m_buffer.size();
+			}
 			else
+			{
+				skipped += (XsSize)(ptrdiff_t)bestPosition;
 				popped += (XsSize)(ptrdiff_t)bestPosition;
+			}
 			break;
 		}
 	}
 
+	if (metrics)
+	{
+		if (!messages.empty())
+			metrics->m_framesFound->add(messages.size());
+		if (skipped)
+			metrics->m_bytesSkipped->add(skipped);
+	}
+
 	if (popped > 0)
 		m_buffer.pop_front(popped);
 	if (messages.empty())
@@ -56,6 +56,9 @@ public:
 	*/
 	int m_incompleteSize;
 
+	//! The number of complete messages with an invalid checksum that were encountered before m_startPos
+	int m_checksumFailures;
+
 	/*! \brief Constructor, initializes by default to an invalid message
 		\param start The offset of the first byte of the message
 		\param size The size of the message
@@ -68,6 +71,7 @@ public:
 		, m_size(size)
 		, m_incompletePos(incompletePos)
 		, m_incompleteSize(incompleteSize)
+		, m_checksumFailures(0)
 	{}
 
 	/*! \brief Returns whether the stored message information describes a valid message
@@ -0,0 +1,325 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+
+#include "metrics.h"
+#include "latencytracer.h"
+#include <sstream>
+
+/*! \brief Constructor
+	\param name The name of the metric, it should only contain letters, digits and underscores
+	\param help A one line description of the metric
+*/
+Metric::Metric(char const* name, char const* help)
+	: m_name(name)
+	, m_help(help)
+{
+}
+
+/*! \brief Write the HELP and TYPE lines of the metric to \a os */
+void Metric::writeHeader(std::ostream& os, char const* type) const
+{
+	os << "# HELP " << m_name << " " << m_help << "\n";
+	os << "# TYPE " << m_name << " " << type << "\n";
+}
+
+/*! \brief Write a single sample line to \a os, combining \a labels and \a extraLabel */
+void Metric::writeSample(std::ostream& os, std::string const& name, std::string const& labels, std::string const& extraLabel, uint64_t value)
+{
+	os << name;
+	if (!labels.empty() || !extraLabel.empty())
+	{
+		os << "{" << labels;
+		if (!labels.empty() && !extraLabel.empty())
+			os << ",";
+		os << extraLabel << "}";
+	}
+	os << " " << value << "\n";
+}
+
+/*! \brief Constructor
+	\copydetails Metric::Metric
+*/
+MetricCounter::MetricCounter(char const* name, char const* help)
+	: Metric(name, help)
+{
+	reset();
+}
+
+/*! \returns The stripe of the calling thread
+	\details Threads are assigned stripes round-robin on their first use of any counter.
+*/
+int MetricCounter::threadStripe()
+{
+	static std::atomic<int> nextStripe(0);
+	static thread_local int stripe = nextStripe.fetch_add(1, std::memory_order_relaxed) % stripeCount;
+	return stripe;
+}
+
+/*! \returns The current value of the counter */
+uint64_t MetricCounter::value() const
+{
+	uint64_t total = 0;
+	for (auto const& stripe : m_stripes)
+		total += stripe.m_value.load(std::memory_order_relaxed);
+	return total;
+}
+
+/*! \copydoc Metric::expose */
+void MetricCounter::expose(std::ostream& os, std::string const& labels) const
+{
+	writeHeader(os, "counter");
+	writeSample(os, name(), labels, std::string(), value());
+}
+
+/*! \copydoc Metric::reset */
+void MetricCounter::reset()
+{
+	for (auto& stripe : m_stripes)
+		stripe.m_value.store(0, std::memory_order_relaxed);
+}
+
+/*! \brief Constructor
+	\copydetails Metric::Metric
+*/
+MetricGauge::MetricGauge(char const* name, char const* help)
+	: Metric(name, help)
+	, m_value(0)
+	, m_maximum(0)
+{
+}
+
+/*! \brief Set the gauge to \a value and update the maximum */
+void MetricGauge::set(int64_t value)
+{
+	m_value.store(value, std::memory_order_relaxed);
+	int64_t max = m_maximum.load(std::memory_order_relaxed);
+	while (value > max && !m_maximum.compare_exchange_weak(max, value, std::memory_order_relaxed))
+	{
+	}
+}
+
+/*! \copydoc Metric::expose
+	\details The maximum is written as a separate gauge with a _max suffix.
+*/
+void MetricGauge::expose(std::ostream& os, std::string const& labels) const
+{
+	writeHeader(os, "gauge");
+	os << name();
+	if (!labels.empty())
+		os << "{" << labels << "}";
+	os << " " << value() << "\n";
+	os << "# TYPE " << name() << "_max gauge\n";
+	os << name() << "_max";
+	if (!labels.empty())
+		os << "{" << labels << "}";
+	os << " " << maximum() << "\n";
+}
+
+/*! \copydoc Metric::reset */
+void MetricGauge::reset()
+{
+	m_value.store(0, std::memory_order_relaxed);
+	m_maximum.store(0, std::memory_order_relaxed);
+}
+
+/*! \brief Constructor
+	\copydetails Metric::Metric
+*/
+MetricHistogram::MetricHistogram(char const* name, char const* help)
+	: Metric(name, help)
+{
+	reset();
+}
+
+/*! \brief Add \a value to the distribution */
+void MetricHistogram::observe(uint64_t value)
+{
+	int index = 0;
+	while (index < bucketCount - 1 && value > (1ULL << index))
+		++index;
+	m_buckets[index].fetch_add(1, std::memory_order_relaxed);
+	m_count.fetch_add(1, std::memory_order_relaxed);
+	m_sum.fetch_add(value, std::memory_order_relaxed);
+}
+
+/*! \copydoc Metric::expose
+	\details The buckets are written cumulatively, followed by the sum and the count.
+*/
+void MetricHistogram::expose(std::ostream& os, std::string const& labels) const
+{
+	writeHeader(os, "histogram");
+	std::string bucketName = name() + "_bucket";
+	uint64_t cumulative = 0;
+	for (int i = 0; i < bucketCount; ++i)
+	{
+		cumulative += bucket(i);
+		std::ostringstream le;
+		le << "le=\"";
+		if (i == bucketCount - 1)
+			le << "+Inf";
+		else
+			le << (1ULL << i);
+		le << "\"";
+		writeSample(os, bucketName, labels, le.str(), cumulative);
+	}
+	writeSample(os, name() + "_sum", labels, std::string(), sum());
+	writeSample(os, name() + "_count", labels, std::string(), count());
+}
+
+/*! \copydoc Metric::reset */
+void MetricHistogram::reset()
+{
+	for (auto& b : m_buckets)
+		b.store(0, std::memory_order_relaxed);
+	m_count.store(0, std::memory_order_relaxed);
+	m_sum.store(0, std::memory_order_relaxed);
+}
+
+/*! \brief Constructor, creates an empty registry */
+MetricsRegistry::MetricsRegistry()
+{
+}
+
+/*! \brief Destructor */
+MetricsRegistry::~MetricsRegistry()
+{
+}
+
+/*! \brief Return the metric called \a name, creating it when it does not exist yet
+	\returns The metric or nullptr if a metric with the same name but a different type exists
+*/
+template <typename T>
+T* MetricsRegistry::findOrCreate(char const* name, char const* help)
+{
+	xsens::Lock lock(&m_mutex);
+	for (auto const& metric : m_metrics)
+		if (metric->name() == name)
+			return dynamic_cast<T*>(metric.get());
+
+	T* metric = new T(name, help);
+	m_metrics.push_back(std::unique_ptr<Metric>(metric));
+	return metric;
+}
+
+/*! \brief Return the counter called \a name, creating it when it does not exist yet
+	\param name The name of the counter
+	\param help The description to use when the counter is created
+	\returns The counter or nullptr if \a name is in use by a metric of a different type
+*/
+MetricCounter* MetricsRegistry::counter(char const* name, char const* help)
+{
+	return findOrCreate<MetricCounter>(name, help);
+}
+
+/*! \brief Return the gauge called \a name, creating it when it does not exist yet
+	\copydetails MetricsRegistry::counter
+*/
+MetricGauge* MetricsRegistry::gauge(char const* name, char const* help)
+{
+	return findOrCreate<MetricGauge>(name, help);
+}
+
+/*! \brief Return the histogram called \a name, creating it when it does not exist yet
+	\copydetails MetricsRegistry::counter
+*/
+MetricHistogram* MetricsRegistry::histogram(char const* name, char const* help)
+{
+	return findOrCreate<MetricHistogram>(name, help);
+}
+
+/*! \brief Find the metric called \a name
+	\returns The metric or nullptr if it does not exist
+*/
+Metric const* MetricsRegistry::find(char const* name) const
+{
+	xsens::Lock lock(&m_mutex);
+	for (auto const& metric : m_metrics)
+		if (metric->name() == name)
+			return metric.get();
+	return nullptr;
+}
+
+/*! \brief Write all metrics in the plain-text exposition format
+	\param labels Labels to add to each sample, for example device="038000A1", without braces
+	\returns The text representation of all metrics
+*/
+std::string MetricsRegistry::exposition(std::string const& labels) const
+{
+	std::ostringstream os;
+	xsens::Lock lock(&m_mutex);
+	for (auto const& metric : m_metrics)
+		metric->expose(os, labels);
+	return os.str();
+}
+
+/*! \brief Reset all metrics to their initial state */
+void MetricsRegistry::reset()
+{
+	xsens::Lock lock(&m_mutex);
+	for (auto const& metric : m_metrics)
+		metric->reset();
+}
+
+/*! \brief Constructor, registers the receive pipeline metrics */
+DeviceMetrics::DeviceMetrics()
+{
+	m_bytesRead = counter("xsens_bytes_read_total", "Bytes read from the port or file");
+	m_framesFound = counter("xsens_frames_found_total", "Complete messages extracted from the read data");
+	m_checksumFailures = counter("xsens_checksum_failures_total", "Complete messages that had an invalid checksum");
+	m_bytesSkipped = counter("xsens_bytes_skipped_total", "Bytes discarded because they did not form a valid message");
+	m_packetsMissed = counter("xsens_packets_missed_total", "Packets detected as missing from the packet counter sequence");
+	m_incomingQueueDepth = gauge("xsens_incoming_queue_depth", "Read blocks waiting to be parsed");
+	m_receivePoolExhausted = counter("xsens_receive_pool_exhausted_total", "Times no receive buffer was available for new data");
+	m_bytesDropped = counter("xsens_bytes_dropped_total", "Received bytes discarded without parsing because the parser was stopped");
+	m_callbackDuration = histogram("xsens_callback_duration_us", "Time spent in the live data callbacks per packet in microseconds");
+	for (auto& h : m_latency)
+		h.store(nullptr, std::memory_order_relaxed);
+}
+
+/*! \brief Return the latency histogram of stage \a stage, creating it on first use
+	\details The histograms are only created when latency tracing is used, so they do not clutter the exposition
+	otherwise.
+	\param stage The stage, see LatencyTracer::stageName
+	\returns The histogram
+*/
+MetricHistogram* DeviceMetrics::latencyHistogram(int stage)
+{
+	MetricHistogram* h = m_latency[stage].load(std::memory_order_acquire);
+	if (h)
+		return h;
+
+	std::string name = std::string("xsens_latency_") + LatencyTracer::stageName(stage) + "_us";
+	std::string help = std::string("Latency of the ") + LatencyTracer::stageName(stage) + " stage of the receive pipeline in microseconds";
+	h = histogram(name.c_str(), help.c_str());
+	m_latency[stage].store(h, std::memory_order_release);
+	return h;
+}
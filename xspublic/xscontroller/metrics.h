@@ -0,0 +1,244 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <xstypes/xstypesconfig.h>
+#include <xscommon/xsens_mutex.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <ostream>
+
+/*! \brief Base class of the metrics in a MetricsRegistry */
+class Metric
+{
+public:
+	Metric(char const* name, char const* help);
+	virtual ~Metric() {}
+
+	//! \returns The name of the metric as used in the exposition format
+	inline std::string const& name() const
+	{
+		return m_name;
+	}
+
+	//! \returns The description of the metric
+	inline std::string const& help() const
+	{
+		return m_help;
+	}
+
+	/*! \brief Write the metric to \a os in the plain-text exposition format
+		\param os The stream to write to
+		\param labels The labels to add to each sample, without braces, may be empty
+	*/
+	virtual void expose(std::ostream& os, std::string const& labels) const = 0;
+
+	//! \brief Reset the metric to its initial state
+	virtual void reset() = 0;
+
+protected:
+	void writeHeader(std::ostream& os, char const* type) const;
+	static void writeSample(std::ostream& os, std::string const& name, std::string const& labels, std::string const& extraLabel, uint64_t value);
+
+private:
+	std::string m_name;
+	std::string m_help;
+};
+
+/*! \brief A monotonically increasing counter that can be incremented from multiple threads without contention
+	\details The counter is split over a number of cache line sized stripes, each thread increments its own stripe.
+*/
+class MetricCounter : public Metric
+{
+public:
+	MetricCounter(char const* name, char const* help);
+
+	/*! \brief Increment the counter
+		\param count The amount to add
+	*/
+	inline void add(uint64_t count = 1)
+	{
+		m_stripes[threadStripe()].m_value.fetch_add(count, std::memory_order_relaxed);
+	}
+
+	uint64_t value() const;
+	void expose(std::ostream& os, std::string const& labels) const override;
+	void reset() override;
+
+private:
+	//! \brief The number of stripes of a counter
+	static const int stripeCount = 8;
+
+	//! \brief A single stripe, padded to prevent false sharing
+	struct Stripe
+	{
+		std::atomic<uint64_t> m_value;		//!< The part of the counter value owned by this stripe
+		char m_padding[64 - sizeof(std::atomic<uint64_t>)];	//!< Padding to fill the cache line
+	};
+
+	static int threadStripe();
+
+	Stripe m_stripes[stripeCount];
+};
+
+/*! \brief A value that can go up and down, such as a queue depth, that also tracks its maximum */
+class MetricGauge : public Metric
+{
+public:
+	MetricGauge(char const* name, char const* help);
+
+	void set(int64_t value);
+
+	//! \returns The current value of the gauge
+	inline int64_t value() const
+	{
+		return m_value.load(std::memory_order_relaxed);
+	}
+
+	//! \returns The highest value of the gauge since it was created or reset
+	inline int64_t maximum() const
+	{
+		return m_maximum.load(std::memory_order_relaxed);
+	}
+
+	void expose(std::ostream& os, std::string const& labels) const override;
+	void reset() override;
+
+private:
+	std::atomic<int64_t> m_value;
+	std::atomic<int64_t> m_maximum;
+};
+
+/*! \brief A distribution of observed values with power of two bucket boundaries
+	\details Bucket i counts the observations that are at most 2^i, the last bucket counts everything larger.
+	Durations are recorded in microseconds.
+*/
+class MetricHistogram : public Metric
+{
+public:
+	//! \brief The number of buckets, including the overflow bucket
+	static const int bucketCount = 26;
+
+	MetricHistogram(char const* name, char const* help);
+
+	void observe(uint64_t value);
+
+	//! \returns The number of observations
+	inline uint64_t count() const
+	{
+		return m_count.load(std::memory_order_relaxed);
+	}
+
+	//! \returns The sum of all observed values
+	inline uint64_t sum() const
+	{
+		return m_sum.load(std::memory_order_relaxed);
+	}
+
+	/*! \returns The number of observations in bucket \a index, not cumulative
+		\param index The bucket index, at most bucketCount-1
+	*/
+	inline uint64_t bucket(int index) const
+	{
+		return m_buckets[index].load(std::memory_order_relaxed);
+	}
+
+	void expose(std::ostream& os, std::string const& labels) const override;
+	void reset() override;
+
+private:
+	std::atomic<uint64_t> m_buckets[bucketCount];
+	std::atomic<uint64_t> m_count;
+	std::atomic<uint64_t> m_sum;
+};
+
+/*! \brief A named collection of metrics
+	\details Creating metrics is protected by a mutex, updating and reading them is lock-free. Metrics are never
+	removed, so the returned pointers stay valid for the lifetime of the registry.
+*/
+class MetricsRegistry
+{
+public:
+	MetricsRegistry();
+	virtual ~MetricsRegistry();
+
+	MetricCounter* counter(char const* name, char const* help);
+	MetricGauge* gauge(char const* name, char const* help);
+	MetricHistogram* histogram(char const* name, char const* help);
+	Metric const* find(char const* name) const;
+
+	std::string exposition(std::string const& labels = std::string()) const;
+	void reset();
+
+private:
+	MetricsRegistry(MetricsRegistry const&) = delete;
+	MetricsRegistry& operator=(MetricsRegistry const&) = delete;
+
+	template <typename T>
+	T* findOrCreate(char const* name, char const* help);
+
+	mutable xsens::Mutex m_mutex;
+	std::vector<std::unique_ptr<Metric>> m_metrics;
+};
+
+/*! \brief The metrics of the receive pipeline of a device
+	\details The members point into the registry itself, so they can be updated without a lookup.
+*/
+class DeviceMetrics : public MetricsRegistry
+{
+public:
+	DeviceMetrics();
+
+	MetricHistogram* latencyHistogram(int stage);
+
+	MetricCounter* m_bytesRead;				//!< The number of bytes read from the port or file
+	MetricCounter* m_framesFound;			//!< The number of complete messages that were extracted
+	MetricCounter* m_checksumFailures;		//!< The number of complete messages that had an invalid checksum
+	MetricCounter* m_bytesSkipped;			//!< The number of bytes that were discarded because they did not form a message
+	MetricCounter* m_packetsMissed;			//!< The number of packets that were detected as missing in the packet counter sequence
+	MetricGauge* m_incomingQueueDepth;		//!< The number of read blocks waiting to be parsed
+	MetricCounter* m_receivePoolExhausted;	//!< The number of times no receive buffer was available for new data
+	MetricCounter* m_bytesDropped;			//!< The number of received bytes that were discarded without parsing because the parser was stopped
+	MetricHistogram* m_callbackDuration;	//!< The time spent in the live data callbacks per packet in microseconds
+
+private:
+	//! \brief The number of latency stages, see LatencyTracer
+	static const int latencyStageCount = 6;
+
+	std::atomic<MetricHistogram*> m_latency[latencyStageCount];	//!< The latency histograms, created on first use
+};
+
+#endif
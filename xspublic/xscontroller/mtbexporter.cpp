@@ -0,0 +1,661 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+#include "mtbexporter.h"
+#include "iointerfacefile.h"
+#include "mtbfilereader.h"
+#include "mtdata2items.h"
+#include <xstypes/xsmessage.h>
+#include <xscommon/xsens_threadpool.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <stdio.h>
+#include <string.h>
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <dirent.h>
+#endif
+
+/*! \cond XS_INTERNAL */
+namespace
+{
+//! \brief The number of bytes that is read from the input file at once
+static const XsSize readBlockSize = 4 * 1024 * 1024;
+//! \brief The magic text at the start of a binary export
+static const char binaryMagic[8] = { 'X', 'S', 'E', 'X', 'P', 'O', 'R', 'T' };
+//! \brief The largest value that is formatted by formatFixed, larger values are formatted by snprintf
+static const double maxFixedValue = 1e18;
+
+//! \brief Write the decimal digits of \a value to \a dest, zero padded to at least \a minDigits digits
+inline char* formatUnsigned(char* dest, uint64_t value, int minDigits = 1)
+{
+	char digits[24];
+	int count = 0;
+	do
+	{
+		digits[count++] = (char)('0' + value % 10);
+		value /= 10;
+	} while (value);
+	while (count < minDigits)
+		digits[count++] = '0';
+	while (count)
+		*dest++ = digits[--count];
+	return dest;
+}
+
+/*! \brief Write \a value to \a dest with \a decimals decimals
+	\details Values are rounded to an integer number of units of 10^-decimals, which is exact for all values that
+	are not too large. NaN is written as an empty field.
+	\param dest The destination, which must have room for at least 32 characters
+	\param value The value to write
+	\param decimals The number of decimals
+	\param scale 10^decimals
+	\returns The end of the written text
+*/
+char* formatFixed(char* dest, double value, int decimals, double scale)
+{
+	if (std::isnan(value))
+		return dest;
+
+	double magnitude = std::fabs(value) * scale + 0.5;
+	if (!(magnitude < maxFixedValue))
+		return dest + snprintf(dest, 32, "%.*g", 17, value);
+
+	uint64_t units = (uint64_t) magnitude;
+	if (units && value < 0)
+		*dest++ = '-';
+
+	uint64_t unitScale = (uint64_t) scale;
+	dest = formatUnsigned(dest, units / unitScale);
+	if (decimals)
+	{
+		*dest++ = '.';
+		dest = formatUnsigned(dest, units % unitScale, decimals);
+	}
+	return dest;
+}
+
+//! \brief A column group in the output, one per exported item
+struct ExportColumn
+{
+	XsDataIdentifier m_id;		//!< The data identifier of the item, without format bits
+	XsSize m_first;				//!< The index of the first value of the item in a row
+	XsSize m_components;		//!< The number of values of the item
+	bool m_integer;				//!< True if the item is an integer
+};
+
+//! \brief The columns of an export and how to format them
+struct ExportLayout
+{
+	std::vector<ExportColumn> m_columns;	//!< The exported items
+	std::vector<std::string> m_names;		//!< The names of the columns
+	XsSize m_width;							//!< The number of values in a row
+	MtbExportFormat m_format;				//!< The output format
+	int m_decimals;							//!< The number of decimals in CSV output
+	double m_scale;							//!< 10^m_decimals
+
+	//! \returns The column group of the item with \a id or nullptr if the item is not exported
+	inline ExportColumn const* find(XsDataIdentifier id) const
+	{
+		XsDataIdentifier type = (XsDataIdentifier)(id & XDI_FullTypeMask);
+		for (auto const& column : m_columns)
+			if (column.m_id == type)
+				return &column;
+		return nullptr;
+	}
+};
+
+//! \brief A run of consecutive messages that is formatted by one task
+struct ExportChunk
+{
+	std::vector<uint8_t> m_input;		//!< The messages, back to back
+	std::vector<uint32_t> m_offsets;	//!< The offset of each message in m_input
+	std::vector<char> m_output;			//!< The formatted rows
+	std::atomic<bool> m_claimed;		//!< Set by the thread that formats the chunk
+	xsens::WaitEvent m_done;			//!< Set when m_output is complete
+
+	ExportChunk() : m_claimed(false) {}
+};
+
+/*! \brief Decode the values of the exported items in \a msg into \a row
+	\details Values of items that are not present are set to NaN.
+*/
+void decodeRow(ExportLayout const& layout, XsMessage const& msg, double* row)
+{
+	std::fill(row, row + layout.m_width, std::numeric_limits<double>::quiet_NaN());
+
+	XsSize sz = msg.getDataSize();
+	uint8_t const* data = msg.getDataBuffer();
+	XsSize offset = 0;
+	while (offset + 3 <= sz)
+	{
+		XsDataIdentifier id = static_cast<XsDataIdentifier>((data[offset] << 8) | data[offset + 1]);
+		XsSize itemSize = data[offset + 2];
+		if (offset + 3 + itemSize > sz)
+			break;
+
+		ExportColumn const* column = layout.find(id);
+		if (column)
+		{
+			if (column->m_integer)
+			{
+				if (itemSize == MtData2Items::integerItemSize(id))
+				{
+					uint64_t v = 0;
+					for (XsSize i = 0; i < itemSize; ++i)
+						v = (v << 8) | data[offset + 3 + i];
+					row[column->m_first] = (double) v;
+				}
+			}
+			else
+			{
+				XsSize valueSize = XsMessage_getFPValueSize(id);
+				XsSize n = valueSize ? std::min<XsSize>(itemSize / valueSize, column->m_components) : 0;
+				XsMessage_getDataFPValuesById(&msg, id, row + column->m_first, offset + 3, n);
+			}
+		}
+		offset += 3 + itemSize;
+	}
+}
+
+//! \brief Append \a row to \a output in the format of \a layout
+void formatRow(ExportLayout const& layout, double const* row, std::vector<char>& output)
+{
+	XsSize pos = output.size();
+	if (layout.m_format == MtbExportFormat::Binary)
+	{
+		output.resize(pos + layout.m_width * 8);
+		for (XsSize i = 0; i < layout.m_width; ++i)
+		{
+			uint64_t bits;
+			memcpy(&bits, &row[i], 8);
+			for (int b = 0; b < 8; ++b)
+				output[pos++] = (char)(bits >> (8 * b));
+		}
+		return;
+	}
+
+	output.resize(pos + layout.m_width * 32 + 1);
+	char* dest = &output[pos];
+	for (auto const& column : layout.m_columns)
+	{
+		for (XsSize c = 0; c < column.m_components; ++c)
+		{
+			if (column.m_first + c)
+				*dest++ = ',';
+			double value = row[column.m_first + c];
+			if (column.m_integer && !std::isnan(value))
+				dest = formatUnsigned(dest, (uint64_t) value);
+			else
+				dest = formatFixed(dest, value, layout.m_decimals, layout.m_scale);
+		}
+	}
+	*dest++ = '\n';
+	output.resize((XsSize)(dest - output.data()));
+}
+
+//! \brief Decode and format all messages in \a chunk
+void formatChunk(ExportLayout const& layout, ExportChunk& chunk)
+{
+	XsMessage msg;
+	std::vector<double> row(layout.m_width);
+	XsSize count = chunk.m_offsets.size();
+	chunk.m_output.reserve(count * (layout.m_format == MtbExportFormat::Binary ? layout.m_width * 8 : layout.m_width * 12 + 1));
+	for (XsSize i = 0; i < count; ++i)
+	{
+		XsSize begin = chunk.m_offsets[i];
+		XsSize end = (i + 1 < count) ? chunk.m_offsets[i + 1] : chunk.m_input.size();
+		msg.loadFromString(chunk.m_input.data() + begin, end - begin);
+		decodeRow(layout, msg, row.data());
+		formatRow(layout, row.data(), chunk.m_output);
+	}
+}
+
+//! \brief Format \a chunk unless another thread already claimed it
+void runChunk(ExportLayout const& layout, ExportChunk& chunk)
+{
+	if (chunk.m_claimed.exchange(true))
+		return;
+	formatChunk(layout, chunk);
+	chunk.m_done.set();
+}
+
+//! \brief A thread pool task that formats an ExportChunk
+class ExportChunkTask : public xsens::ThreadPoolTask
+{
+public:
+	//! \brief Constructor
+	ExportChunkTask(std::shared_ptr<ExportLayout const> const& layout, std::shared_ptr<ExportChunk> const& chunk)
+		: m_layout(layout), m_chunk(chunk) {}
+
+	bool exec() override
+	{
+		runChunk(*m_layout, *m_chunk);
+		return true;
+	}
+
+private:
+	std::shared_ptr<ExportLayout const> m_layout;
+	std::shared_ptr<ExportChunk> m_chunk;
+};
+
+/*! \brief Add the exportable items of an MtData2 message that \a layout does not contain yet to \a layout
+	\details New columns are appended, so the columns are in order of first appearance. An item that occurs with
+	different sizes gets the number of components of its first occurrence.
+	\param layout The layout to extend
+	\param msg The MtData2 message, including header and checksum
+	\param msgSize The size of \a msg
+	\param items The items to export, empty for all numeric items
+*/
+void addItems(ExportLayout& layout, uint8_t const* msg, XsSize msgSize, std::vector<XsDataIdentifier> const& items)
+{
+	XsSize headerSize = (msg[3] == XS_EXTLENCODE) ? XS_LEN_MSGEXTHEADER : XS_LEN_MSGHEADER;
+	if (msgSize < headerSize + XS_LEN_CHECKSUM)
+		return;
+	uint8_t const* data = msg + headerSize;
+	XsSize sz = msgSize - headerSize - XS_LEN_CHECKSUM;
+	XsSize offset = 0;
+	while (offset + 3 <= sz)
+	{
+		XsDataIdentifier id = static_cast<XsDataIdentifier>((data[offset] << 8) | data[offset + 1]);
+		XsSize itemSize = data[offset + 2];
+		offset += 3 + itemSize;
+		if (offset > sz)
+			break;
+
+		XsDataIdentifier type = (XsDataIdentifier)(id & XDI_FullTypeMask);
+		if (layout.find(id))
+			continue;
+		if (!items.empty() && std::find_if(items.begin(), items.end(), [type](XsDataIdentifier i) { return (i & XDI_FullTypeMask) == type; }) == items.end())
+			continue;
+
+		ExportColumn column;
+		column.m_id = type;
+		column.m_first = layout.m_width;
+		column.m_integer = false;
+		if (itemSize && itemSize == MtData2Items::integerItemSize(id))
+		{
+			column.m_integer = true;
+			column.m_components = 1;
+		}
+		else if (MtData2Items::isRealItem(id) && XsMessage_getFPValueSize(id))
+			column.m_components = itemSize / XsMessage_getFPValueSize(id);
+		else
+			continue;
+
+		if (!column.m_components)
+			continue;
+		for (XsSize c = 0; c < column.m_components; ++c)
+			layout.m_names.push_back(MtData2Items::componentName(id, c));
+		layout.m_columns.push_back(column);
+		layout.m_width += column.m_components;
+	}
+}
+
+/*! \brief Create the layout of an export from the union of the items of all MtData2 messages in a file
+	\details This reads the file once, only looking at the item headers.
+	\param in The reader, which must have been opened and is closed on return
+	\param items The items to export, empty for all numeric items
+	\param format The output format
+	\param decimals The number of decimals in CSV output
+	\returns The layout, or nullptr if the file could not be read
+*/
+std::shared_ptr<ExportLayout> createLayout(MtbFileReader& in, std::vector<XsDataIdentifier> const& items, MtbExportFormat format, int decimals)
+{
+	std::shared_ptr<ExportLayout> layout = std::make_shared<ExportLayout>();
+	layout->m_width = 0;
+	layout->m_format = format;
+	layout->m_decimals = decimals;
+	layout->m_scale = std::pow(10.0, decimals);
+
+	uint8_t const* data;
+	XsSize msgSize;
+	while (in.readFrame(data, msgSize))
+		if (data[2] == XMID_MtData2)
+			addItems(*layout, data, msgSize, items);
+	bool ok = (in.lastResult() == XRV_ENDOFFILE);
+	in.close();
+	return ok ? layout : nullptr;
+}
+
+//! \brief Return the header of an export with \a layout
+std::vector<char> formatHeader(ExportLayout const& layout)
+{
+	std::vector<char> header;
+	if (layout.m_format == MtbExportFormat::Binary)
+	{
+		header.insert(header.end(), binaryMagic, binaryMagic + sizeof(binaryMagic));
+		uint32_t fields[2] = { 1, (uint32_t) layout.m_width };
+		for (uint32_t field : fields)
+			for (int b = 0; b < 4; ++b)
+				header.push_back((char)(field >> (8 * b)));
+		for (auto const& name : layout.m_names)
+			header.insert(header.end(), name.c_str(), name.c_str() + name.size() + 1);
+		// align the rows to 8 bytes
+		while (header.size() % 8)
+			header.push_back(0);
+		return header;
+	}
+
+	for (XsSize i = 0; i < layout.m_names.size(); ++i)
+	{
+		if (i)
+			header.push_back(',');
+		header.insert(header.end(), layout.m_names[i].begin(), layout.m_names[i].end());
+	}
+	header.push_back('\n');
+	return header;
+}
+
+/*! \brief The shared state of a directory export
+	\details Files are claimed one at a time by the calling thread and by thread pool tasks, as in a column export
+	of the retained data.
+*/
+struct DirectoryExportJob
+{
+	MtbExporter const* m_exporter;				//!< The exporter with the export settings
+	std::vector<XsString> m_inputs;				//!< The input files
+	std::vector<XsString> m_outputs;			//!< The output files
+	std::atomic<XsSize> m_next;					//!< The index of the next file to claim
+	std::atomic<XsSize> m_remaining;			//!< The number of files that have not been completed
+	xsens::Mutex m_mutex;						//!< Guards m_statistics and m_result
+	MtbExportStatistics m_statistics;			//!< The combined statistics of the exported files
+	XsResultValue m_result;						//!< The first error that occurred
+	xsens::WaitEvent m_done;					//!< Set when m_remaining reaches 0
+
+	//! \brief Claim and export files until none are left
+	void run()
+	{
+		while (true)
+		{
+			XsSize index = m_next++;
+			if (index >= m_inputs.size())
+				return;
+
+			MtbExportStatistics statistics;
+			XsResultValue result = m_exporter->exportFile(m_inputs[index], m_outputs[index], &statistics);
+			{
+				xsens::Lock lock(&m_mutex);
+				m_statistics.m_files += statistics.m_files;
+				m_statistics.m_bytesRead += statistics.m_bytesRead;
+				m_statistics.m_bytesWritten += statistics.m_bytesWritten;
+				m_statistics.m_rows += statistics.m_rows;
+				if (result != XRV_OK && m_result == XRV_OK)
+					m_result = result;
+			}
+			if (--m_remaining == 0)
+				m_done.set();
+		}
+	}
+};
+
+//! \brief A thread pool task that helps with a DirectoryExportJob
+class DirectoryExportTask : public xsens::ThreadPoolTask
+{
+public:
+	//! \brief Constructor
+	explicit DirectoryExportTask(std::shared_ptr<DirectoryExportJob> const& job) : m_job(job) {}
+
+	bool exec() override
+	{
+		m_job->run();
+		return true;
+	}
+
+private:
+	std::shared_ptr<DirectoryExportJob> m_job;
+};
+
+//! \returns true if \a name ends with ".mtb", ignoring case
+bool isLogFileName(std::string const& name)
+{
+	if (name.size() < 4)
+		return false;
+	std::string ext = name.substr(name.size() - 4);
+	std::transform(ext.begin(), ext.end(), ext.begin(), [](char c) { return (char) tolower(c); });
+	return ext == ".mtb";
+}
+}
+/*! \endcond */
+
+/*! \brief Constructor */
+MtbExporter::MtbExporter()
+	: m_format(MtbExportFormat::Csv)
+	, m_decimals(defaultDecimals)
+	, m_chunkMessages(defaultChunkMessages)
+{
+}
+
+/*! \brief Set the number of decimals of floating point values in CSV output
+	\param decimals The number of decimals, clamped to the range 0..12
+*/
+void MtbExporter::setDecimals(int decimals)
+{
+	m_decimals = std::max(0, std::min(decimals, 12));
+}
+
+/*! \brief Set the number of messages that are formatted by one task
+	\param count The number of messages, at least 1
+*/
+void MtbExporter::setChunkMessages(XsSize count)
+{
+	m_chunkMessages = count ? count : 1;
+}
+
+/*! \brief Export the MtData2 messages in \a input to \a output
+	\details Messages with an invalid checksum are skipped, as when the file is loaded by a device. The file is read
+	twice, first to collect the exported items from the item headers, then to export the messages.
+	\param input The name of the mtb file to export
+	\param output The name of the file to create
+	\param statistics When not null, receives the amount of work done
+	\returns XRV_OK if successful
+*/
+XsResultValue MtbExporter::exportFile(XsString const& input, XsString const& output, MtbExportStatistics* statistics) const
+{
+	auto start = std::chrono::steady_clock::now();
+	MtbExportStatistics stats;
+
+	MtbFileReader in(readBlockSize);
+	if (!in.open(input))
+		return in.lastResult();
+	std::shared_ptr<ExportLayout const> layout = createLayout(in, m_items, m_format, m_decimals);
+	if (!layout)
+		return in.lastResult();
+	if (!in.open(input))
+		return in.lastResult();
+
+	XsResultValue result;
+	IoInterfaceFile out;
+	result = out.create(output);
+	if (result != XRV_OK)
+		return result;
+
+	xsens::ThreadPool* pool = xsens::ThreadPool::instance();
+	XsSize maxInFlight = 2 * (XsSize) pool->poolSize() + 2;
+	std::deque<std::shared_ptr<ExportChunk>> inFlight;
+
+	// write the oldest chunk, formatting it here if no task has started on it yet
+	auto writeFront = [&]()
+	{
+		std::shared_ptr<ExportChunk> chunk = inFlight.front();
+		inFlight.pop_front();
+		runChunk(*layout, *chunk);
+		chunk->m_done.wait();
+		if (result == XRV_OK && !chunk->m_output.empty())
+			result = out.writeData(XsByteArray((uint8_t*) chunk->m_output.data(), chunk->m_output.size(), XSDF_None), nullptr);
+		stats.m_bytesWritten += chunk->m_output.size();
+		stats.m_rows += chunk->m_offsets.size();
+	};
+
+	std::shared_ptr<ExportChunk> chunk = std::make_shared<ExportChunk>();
+	auto dispatch = [&]()
+	{
+		inFlight.push_back(chunk);
+		pool->addTask(new ExportChunkTask(layout, chunk));
+		chunk = std::make_shared<ExportChunk>();
+		while (inFlight.size() > maxInFlight)
+			writeFront();
+	};
+
+	std::vector<char> header = formatHeader(*layout);
+	result = out.writeData(XsByteArray((uint8_t*) header.data(), header.size(), XSDF_None), nullptr);
+	stats.m_bytesWritten += header.size();
+
+	uint8_t const* data;
+	XsSize msgSize;
+	while (result == XRV_OK && in.readFrame(data, msgSize))
+	{
+		if (data[2] != XMID_MtData2)
+			continue;
+		chunk->m_offsets.push_back((uint32_t) chunk->m_input.size());
+		chunk->m_input.insert(chunk->m_input.end(), data, data + msgSize);
+		if (chunk->m_offsets.size() >= m_chunkMessages)
+			dispatch();
+	}
+	if (result == XRV_OK && in.lastResult() != XRV_ENDOFFILE)
+		result = in.lastResult();
+	stats.m_bytesRead = (uint64_t) in.fileSize();
+
+	if (!chunk->m_offsets.empty())
+		dispatch();
+	while (!inFlight.empty())
+		writeFront();
+
+	in.close();
+	XsResultValue closeResult = out.close();
+	if (result == XRV_OK)
+		result = closeResult;
+
+	stats.m_files = 1;
+	stats.m_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	if (statistics)
+		*statistics = stats;
+	return result;
+}
+
+/*! \brief Export all mtb files in \a inputDirectory to \a outputDirectory
+	\details Files are exported concurrently. The output files get the name of the input file with the extension
+	replaced by .csv or .bin, depending on the format.
+	\param inputDirectory The directory with the mtb files
+	\param outputDirectory The directory in which the exported files are created, it must exist
+	\param statistics When not null, receives the combined amount of work done
+	\returns XRV_OK if all files were exported successfully, otherwise the first error that occurred
+*/
+XsResultValue MtbExporter::exportDirectory(XsString const& inputDirectory, XsString const& outputDirectory, MtbExportStatistics* statistics) const
+{
+	auto start = std::chrono::steady_clock::now();
+	std::shared_ptr<DirectoryExportJob> job = std::make_shared<DirectoryExportJob>();
+	job->m_exporter = this;
+	job->m_inputs = findLogFiles(inputDirectory);
+	job->m_next = 0;
+	job->m_remaining = job->m_inputs.size();
+	job->m_result = XRV_OK;
+
+	std::string outDir = outputDirectory.toStdString();
+	if (!outDir.empty() && outDir.back() != '/' && outDir.back() != '\\')
+		outDir += '/';
+	for (auto const& in : job->m_inputs)
+	{
+		std::string name = in.toStdString();
+		std::size_t slash = name.find_last_of("/\\");
+		if (slash != std::string::npos)
+			name = name.substr(slash + 1);
+		name = name.substr(0, name.size() - 4) + (m_format == MtbExportFormat::Binary ? ".bin" : ".csv");
+		job->m_outputs.push_back(XsString(outDir + name));
+	}
+
+	if (!job->m_inputs.empty())
+	{
+		xsens::ThreadPool* pool = xsens::ThreadPool::instance();
+		XsSize helpers = std::min<XsSize>(job->m_inputs.size() - 1, pool->poolSize());
+		for (XsSize i = 0; i < helpers; ++i)
+			pool->addTask(new DirectoryExportTask(job));
+		job->run();
+		job->m_done.wait();
+	}
+
+	if (statistics)
+	{
+		xsens::Lock lock(&job->m_mutex);
+		*statistics = job->m_statistics;
+		statistics->m_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+	xsens::Lock lock(&job->m_mutex);
+	return job->m_result;
+}
+
+/*! \brief Return the mtb files in \a directory, sorted by name
+	\param directory The directory to search, subdirectories are not searched
+	\returns The full names of the files
+*/
+std::vector<XsString> MtbExporter::findLogFiles(XsString const& directory)
+{
+	std::string dir = directory.toStdString();
+	if (!dir.empty() && dir.back() != '/' && dir.back() != '\\')
+		dir += '/';
+
+	std::vector<std::string> names;
+#ifdef _WIN32
+	WIN32_FIND_DATAA findData;
+	HANDLE handle = FindFirstFileA((dir + "*.mtb").c_str(), &findData);
+	if (handle != INVALID_HANDLE_VALUE)
+	{
+		do
+		{
+			if (!(findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) && isLogFileName(findData.cFileName))
+				names.push_back(findData.cFileName);
+		} while (FindNextFileA(handle, &findData));
+		FindClose(handle);
+	}
+#else
+	DIR* d = opendir(dir.empty() ? "." : dir.c_str());
+	if (d)
+	{
+		struct dirent* entry;
+		while ((entry = readdir(d)) != nullptr)
+			if (entry->d_type != DT_DIR && isLogFileName(entry->d_name))
+				names.push_back(entry->d_name);
+		closedir(d);
+	}
+#endif
+
+	std::sort(names.begin(), names.end());
+	std::vector<XsString> files;
+	for (auto const& name : names)
+		files.push_back(XsString(dir + name));
+	return files;
+}
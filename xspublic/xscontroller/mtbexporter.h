@@ -0,0 +1,140 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+#ifndef MTBEXPORTER_H
+#define MTBEXPORTER_H
+
+#include <xstypes/xsdataidentifier.h>
+#include <xstypes/xsresultvalue.h>
+#include <xstypes/xsstring.h>
+#include <vector>
+
+/*! \brief The output formats of MtbExporter */
+enum class MtbExportFormat
+{
+	Csv,		//!< Comma separated text with a header line, missing values are left empty
+	Binary		//!< A header with the column names followed by rows of little-endian doubles, missing values are NaN
+};
+
+/*! \brief The amount of work done by an MtbExporter */
+struct MtbExportStatistics
+{
+	uint64_t m_files;			//!< The number of files that were exported
+	uint64_t m_bytesRead;		//!< The number of bytes read from the input files
+	uint64_t m_bytesWritten;	//!< The number of bytes written to the output files
+	uint64_t m_rows;			//!< The number of rows that were written
+	double m_seconds;			//!< The wall clock duration of the export
+
+	MtbExportStatistics() : m_files(0), m_bytesRead(0), m_bytesWritten(0), m_rows(0), m_seconds(0) {}
+
+	//! \returns The input throughput in MB/s
+	inline double megabytesPerSecond() const
+	{
+		return m_seconds > 0 ? m_bytesRead / (1e6 * m_seconds) : 0;
+	}
+};
+
+/*! \class MtbExporter
+	\brief Exports the MtData2 messages in mtb files to CSV or binary files without creating devices
+	\details The file is read in large blocks and split into messages by the calling thread. The messages are
+	grouped into chunks that are decoded and formatted into per-chunk buffers by the thread pool. The calling
+	thread writes the buffers in file order and helps with the chunks that have not been started yet, so the
+	output is the same as a sequential export.
+
+	Each MtData2 message becomes one row. The columns are the union of the numeric items of all MtData2 messages in
+	the file, in order of first appearance, optionally limited to the items set with setItems(). Items that a row
+	does not contain are left empty in CSV output and NaN in binary output.
+
+	The exporter is not thread-safe, but multiple exporters can run at the same time.
+*/
+class MtbExporter
+{
+public:
+	//! \brief The default for chunkMessages()
+	static const XsSize defaultChunkMessages = 4096;
+	//! \brief The default for decimals()
+	static const int defaultDecimals = 6;
+
+	MtbExporter();
+
+	//! \returns The output format
+	inline MtbExportFormat format() const
+	{
+		return m_format;
+	}
+
+	//! \brief Set the output format to \a format
+	inline void setFormat(MtbExportFormat format)
+	{
+		m_format = format;
+	}
+
+	//! \returns The number of decimals of floating point values in CSV output
+	inline int decimals() const
+	{
+		return m_decimals;
+	}
+
+	void setDecimals(int decimals);
+
+	//! \returns The number of messages that are formatted by one task
+	inline XsSize chunkMessages() const
+	{
+		return m_chunkMessages;
+	}
+
+	void setChunkMessages(XsSize count);
+
+	//! \returns The items to export, empty to export all numeric items
+	inline std::vector<XsDataIdentifier> const& items() const
+	{
+		return m_items;
+	}
+
+	//! \brief Limit the export to \a items, the order of the columns follows the order in which they occur in each file
+	inline void setItems(std::vector<XsDataIdentifier> const& items)
+	{
+		m_items = items;
+	}
+
+	XsResultValue exportFile(XsString const& input, XsString const& output, MtbExportStatistics* statistics = nullptr) const;
+	XsResultValue exportDirectory(XsString const& inputDirectory, XsString const& outputDirectory, MtbExportStatistics* statistics = nullptr) const;
+
+	static std::vector<XsString> findLogFiles(XsString const& directory);
+
+private:
+	MtbExportFormat m_format;
+	int m_decimals;
+	XsSize m_chunkMessages;
+	std::vector<XsDataIdentifier> m_items;
+};
+
+#endif
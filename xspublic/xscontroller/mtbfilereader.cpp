@@ -0,0 +1,265 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+#include "mtbfilereader.h"
+#include "iointerfacefile.h"
+#include <xstypes/xsdatapacket.h>
+#include <xstypes/xsbusid.h>
+#include <string.h>
+
+/*! \brief Constructor
+	\param blockSize The number of bytes that is read from the file at once
+*/
+MtbFileReader::MtbFileReader(XsSize blockSize)
+	: m_blockSize(blockSize ? blockSize : defaultBlockSize)
+	, m_lastResult(XRV_OK)
+	, m_begin(0)
+	, m_end(0)
+	, m_bufferPosition(0)
+	, m_framePosition(-1)
+	, m_endOfFile(false)
+	, m_bytesSkipped(0)
+{
+}
+
+MtbFileReader::~MtbFileReader()
+{
+	try
+	{
+		close();
+	}
+	catch (...)
+	{
+	}
+}
+
+/*! \brief Open an mtb file for reading
+	\param filename The name of the file to open
+	\returns true if successful
+*/
+bool MtbFileReader::open(const XsString& filename)
+{
+	if (m_ioInterfaceFile)
+	{
+		m_lastResult = XRV_ALREADYOPEN;
+		return false;
+	}
+
+	m_ioInterfaceFile = std::shared_ptr<IoInterfaceFile>(new IoInterfaceFile);
+	m_lastResult = m_ioInterfaceFile->open(filename, false, true);
+	if (m_lastResult != XRV_OK)
+	{
+		m_ioInterfaceFile.reset();
+		return false;
+	}
+	m_ioInterfaceFile->adviseSequentialAccess();
+
+	m_buffer.resize(m_blockSize + XS_MAXMSGLEN);
+	m_begin = 0;
+	m_end = 0;
+	m_bufferPosition = 0;
+	m_framePosition = -1;
+	m_endOfFile = false;
+	m_bytesSkipped = 0;
+	m_configuration.clear();
+	return true;
+}
+
+/*! \brief Close the file and release the read buffer */
+void MtbFileReader::close()
+{
+	if (m_ioInterfaceFile)
+	{
+		m_ioInterfaceFile->close();
+		m_ioInterfaceFile.reset();
+	}
+	std::vector<uint8_t>().swap(m_buffer);
+	m_begin = 0;
+	m_end = 0;
+}
+
+//! \returns true if a file is open
+bool MtbFileReader::isOpen() const
+{
+	return m_ioInterfaceFile != nullptr;
+}
+
+//! \returns The result of the last operation, XRV_ENDOFFILE after the last frame was read
+XsResultValue MtbFileReader::lastResult() const
+{
+	return m_lastResult;
+}
+
+//! \returns The size of the open file
+XsFilePos MtbFileReader::fileSize() const
+{
+	return m_ioInterfaceFile ? m_ioInterfaceFile->getFileSize() : 0;
+}
+
+/*! \brief Move the unprocessed data to the start of the buffer and read the next block behind it
+	\returns false if no data could be read
+*/
+bool MtbFileReader::refill()
+{
+	if (m_endOfFile)
+		return false;
+
+	if (m_begin)
+	{
+		memmove(m_buffer.data(), m_buffer.data() + m_begin, m_end - m_begin);
+		m_bufferPosition += (XsFilePos) m_begin;
+		m_end -= m_begin;
+		m_begin = 0;
+	}
+
+	XsFilePos length = 0;
+	XsResultValue result = m_ioInterfaceFile->readData((XsFilePos) (m_buffer.size() - m_end), m_buffer.data() + m_end, length);
+	if (result != XRV_OK || length == 0)
+	{
+		m_endOfFile = true;
+		if (result != XRV_OK && result != XRV_ENDOFFILE)
+			m_lastResult = result;
+		return false;
+	}
+	m_end += (XsSize) length;
+
+	// let the operating system fetch the next block while this one is processed
+	m_ioInterfaceFile->adviseWillNeed(m_bufferPosition + (XsFilePos) m_end, (XsFilePos) m_blockSize);
+	return true;
+}
+
+/*! \brief Read the next complete message from the file without copying it
+	\param data Receives a pointer to the message, including the preamble and checksum. It stays valid until the
+	next call to a read function.
+	\param size Receives the size of the message
+	\returns false at the end of the file or when reading failed, see lastResult()
+*/
+bool MtbFileReader::readFrame(uint8_t const*& data, XsSize& size)
+{
+	if (!m_ioInterfaceFile)
+	{
+		m_lastResult = XRV_NOFILEOPEN;
+		return false;
+	}
+
+	while (true)
+	{
+		XsSize available = m_end - m_begin;
+		uint8_t const* p = m_buffer.data() + m_begin;
+		if (available < XS_LEN_MSGHEADERCS || (p[3] == XS_EXTLENCODE && available < XS_LEN_MSGEXTHEADERCS))
+		{
+			if (refill())
+				continue;
+			if (m_lastResult == XRV_OK)
+				m_lastResult = XRV_ENDOFFILE;
+			m_bytesSkipped += available;
+			m_begin = m_end;
+			return false;
+		}
+
+		if (p[0] != XS_PREAMBLE)
+		{
+			uint8_t const* next = (uint8_t const*) memchr(p + 1, XS_PREAMBLE, available - 1);
+			XsSize skip = next ? (XsSize)(next - p) : available;
+			m_bytesSkipped += skip;
+			m_begin += skip;
+			continue;
+		}
+
+		XsSize msgSize = XS_LEN_MSGHEADERCS + p[3];
+		if (p[3] == XS_EXTLENCODE)
+			msgSize = XS_LEN_MSGEXTHEADERCS + ((XsSize) p[4] << 8) + p[5];
+
+		bool valid = (p[1] != 0 || p[2] != 0) && msgSize <= XS_MAXMSGLEN;
+		if (valid && msgSize > available)
+		{
+			if (refill())
+				continue;
+			valid = false;
+		}
+		if (valid)
+		{
+			uint8_t sum = 0;
+			for (XsSize i = 1; i < msgSize; ++i)
+				sum += p[i];
+			valid = (sum == 0);
+		}
+		if (!valid)
+		{
+			++m_bytesSkipped;
+			++m_begin;
+			continue;
+		}
+
+		data = p;
+		size = msgSize;
+		m_framePosition = m_bufferPosition + (XsFilePos) m_begin;
+		m_begin += msgSize;
+		return true;
+	}
+}
+
+/*! \brief Read the next message from the file
+	\param message Receives the message
+	\returns false at the end of the file or when reading failed, see lastResult()
+*/
+bool MtbFileReader::readMessage(XsMessage& message)
+{
+	uint8_t const* data;
+	XsSize size;
+	if (!readFrame(data, size))
+		return false;
+	message.loadFromString(data, size);
+	if (message.getMessageId() == XMID_Configuration)
+		m_configuration.readFromMessage(message);
+	return true;
+}
+
+/*! \brief Read the next data packet from the file, skipping all other messages
+	\details The device id of the packet is taken from the last configuration message in the file, based on the
+	bus id of the message.
+	\param packet Receives the data packet
+	\returns false at the end of the file or when reading failed, see lastResult()
+*/
+bool MtbFileReader::readDataPacket(XsDataPacket& packet)
+{
+	do
+	{
+		if (!readMessage(m_message))
+			return false;
+	} while (m_message.getMessageId() != XMID_MtData2);
+
+	packet.setMessage(m_message);
+	XsSize busId = m_message.getBusId();
+	if (!m_configuration.empty() && (busId == XS_BID_MASTER || (busId && busId <= m_configuration.numberOfDevices())))
+		packet.setDeviceId(m_configuration.deviceInfo(busId).m_deviceId);
+	return true;
+}
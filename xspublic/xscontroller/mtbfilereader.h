@@ -0,0 +1,113 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+#ifndef MTBFILEREADER_H
+#define MTBFILEREADER_H
+
+#include "xsdeviceconfiguration.h"
+#include <xstypes/xsmessage.h>
+#include <xstypes/xsresultvalue.h>
+#include <xstypes/xsfilepos.h>
+#include <memory>
+#include <vector>
+
+class IoInterfaceFile;
+struct XsDataPacket;
+
+/*! \class MtbFileReader
+	\brief A pull-based reader for mtb files that does not need a device
+	\details The file is read sequentially in blocks of blockSize() bytes into a fixed buffer, so the memory use does
+	not depend on the size of the file. Frames are split off the buffer in file order, data that does not form a
+	message with a valid checksum is skipped, as when the file is loaded by a device.
+
+	The configuration messages in the file are used to set the device id of the data packets.
+*/
+class MtbFileReader
+{
+public:
+	//! \brief The default for blockSize()
+	static const XsSize defaultBlockSize = 1024 * 1024;
+
+	explicit MtbFileReader(XsSize blockSize = defaultBlockSize);
+	~MtbFileReader();
+
+	bool open(const XsString& filename);
+	void close();
+	bool isOpen() const;
+	XsResultValue lastResult() const;
+	XsFilePos fileSize() const;
+
+	//! \returns The number of bytes that are read from the file at once
+	inline XsSize blockSize() const
+	{
+		return m_blockSize;
+	}
+
+	//! \returns The file offset of the frame that was returned last
+	inline XsFilePos framePosition() const
+	{
+		return m_framePosition;
+	}
+
+	//! \returns The number of bytes that were skipped because they did not form a valid message
+	inline uint64_t bytesSkipped() const
+	{
+		return m_bytesSkipped;
+	}
+
+	//! \returns The last configuration that was read from the file, empty if none was read yet
+	inline XsDeviceConfiguration const& configuration() const
+	{
+		return m_configuration;
+	}
+
+	bool readFrame(uint8_t const*& data, XsSize& size);
+	bool readMessage(XsMessage& message);
+	bool readDataPacket(XsDataPacket& packet);
+
+private:
+	bool refill();
+
+	XsSize m_blockSize;
+	std::shared_ptr<IoInterfaceFile> m_ioInterfaceFile;
+	XsResultValue m_lastResult;
+	std::vector<uint8_t> m_buffer;		//!< The read buffer, blockSize() bytes plus room for one incomplete message
+	XsSize m_begin;						//!< The offset of the first unprocessed byte in m_buffer
+	XsSize m_end;						//!< The offset of the end of the data in m_buffer
+	XsFilePos m_bufferPosition;			//!< The file offset of the start of m_buffer
+	XsFilePos m_framePosition;
+	bool m_endOfFile;					//!< True when all data of the file has been read into m_buffer
+	uint64_t m_bytesSkipped;
+	XsDeviceConfiguration m_configuration;
+	XsMessage m_message;				//!< Scratch message for readDataPacket
+};
+
+#endif
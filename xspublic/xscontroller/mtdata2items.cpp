@@ -0,0 +1,198 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+#include "mtdata2items.h"
+#include <stdio.h>
+
+/*! \returns The payload size of integer item \a id, 0 if \a id is not a scalar integer item */
+XsSize MtData2Items::integerItemSize(XsDataIdentifier id)
+{
+	switch (id & XDI_FullTypeMask)
+	{
+		case XDI_PacketCounter8:
+		case XDI_GnssAge:
+		case XDI_PressureAge:
+		case XDI_StatusByte:
+		case XDI_Rssi:
+			return 1;
+		case XDI_PacketCounter:
+		case XDI_AnalogIn1:
+		case XDI_AnalogIn2:
+		case XDI_LocationId:
+			return 2;
+		case XDI_Itow:
+		case XDI_SampleTimeFine:
+		case XDI_SampleTimeCoarse:
+		case XDI_PacketCounter32:
+		case XDI_BaroPressure:
+		case XDI_GnssPvtPulse:
+		case XDI_StatusWord:
+		case XDI_DeviceId:
+			return 4;
+		case XDI_SampleTime64:
+			return 8;
+		default:
+			return 0;
+	}
+}
+
+/*! \returns true if \a id is an item that consists of floating point values in the format of its format bits */
+bool MtData2Items::isRealItem(XsDataIdentifier id)
+{
+	switch (id & XDI_FullTypeMask)
+	{
+		case XDI_Temperature:
+		case XDI_Quaternion:
+		case XDI_RotationMatrix:
+		case XDI_EulerAngles:
+		case XDI_QuaternionStd:
+		case XDI_EulerAnglesStd:
+		case XDI_DeltaV:
+		case XDI_Acceleration:
+		case XDI_FreeAcceleration:
+		case XDI_AccelerationHR:
+		case XDI_AltitudeMsl:
+		case XDI_AltitudeEllipsoid:
+		case XDI_PositionEcef:
+		case XDI_LatLon:
+		case XDI_HeavePosition:
+		case XDI_HeavePeriod:
+		case XDI_RateOfTurn:
+		case XDI_RateOfTurnHR:
+		case XDI_DeltaQ:
+		case XDI_RawDeltaQ:
+		case XDI_RawDeltaV:
+		case XDI_MagneticField:
+		case XDI_MagneticFieldCorrected:
+		case XDI_VelocityXYZ:
+			return true;
+		default:
+			return false;
+	}
+}
+
+/*! \brief Return a readable name for a component of an item, for use as a column header
+	\details The names follow the column names of the MT Manager export where possible. Unknown items are named
+	after their data identifier.
+	\param id The data identifier of the item
+	\param component The index of the component in the item
+	\returns The name of the component
+*/
+std::string MtData2Items::componentName(XsDataIdentifier id, XsSize component)
+{
+	static char const* const xyz[] = { "X", "Y", "Z" };
+	char const* prefix = nullptr;
+	char const* const* suffixes = xyz;
+	XsSize suffixCount = 3;
+
+	switch (id & XDI_FullTypeMask)
+	{
+		case XDI_PacketCounter:
+		case XDI_PacketCounter8:
+		case XDI_PacketCounter32:		return "PacketCounter";
+		case XDI_SampleTimeFine:		return "SampleTimeFine";
+		case XDI_SampleTimeCoarse:		return "SampleTimeCoarse";
+		case XDI_SampleTime64:			return "SampleTime64";
+		case XDI_Itow:					return "Itow";
+		case XDI_GnssAge:				return "GnssAge";
+		case XDI_PressureAge:			return "PressureAge";
+		case XDI_GnssPvtPulse:			return "GnssPvtPulse";
+		case XDI_BaroPressure:			return "Pressure";
+		case XDI_StatusByte:			return "StatusByte";
+		case XDI_StatusWord:			return "StatusWord";
+		case XDI_Rssi:					return "RSSI";
+		case XDI_DeviceId:				return "DeviceId";
+		case XDI_LocationId:			return "LocationId";
+		case XDI_AnalogIn1:				return "AnalogIn1";
+		case XDI_AnalogIn2:				return "AnalogIn2";
+		case XDI_Temperature:			return "Temperature";
+		case XDI_AltitudeMsl:			return "AltitudeMsl";
+		case XDI_AltitudeEllipsoid:		return "Altitude";
+		case XDI_HeavePosition:			return "Heave";
+		case XDI_HeavePeriod:			return "HeavePeriod";
+
+		case XDI_Quaternion:
+		case XDI_DeltaQ:
+		case XDI_RawDeltaQ:
+		{
+			static char const* const q[] = { "q0", "q1", "q2", "q3" };
+			prefix = ((id & XDI_FullTypeMask) == XDI_Quaternion) ? "Quat" : "dq";
+			suffixes = q;
+			suffixCount = 4;
+			break;
+		}
+		case XDI_EulerAngles:
+		case XDI_EulerAnglesStd:
+		{
+			static char const* const euler[] = { "Roll", "Pitch", "Yaw" };
+			static char const* const eulerStd[] = { "RollStd", "PitchStd", "YawStd" };
+			if (component < 3)
+				return ((id & XDI_FullTypeMask) == XDI_EulerAngles) ? euler[component] : eulerStd[component];
+			break;
+		}
+		case XDI_LatLon:
+		{
+			static char const* const latLon[] = { "Latitude", "Longitude" };
+			if (component < 2)
+				return latLon[component];
+			break;
+		}
+		case XDI_RotationMatrix:
+		{
+			static char const* const mat[] = { "a", "b", "c", "d", "e", "f", "g", "h", "i" };
+			prefix = "Mat";
+			suffixes = mat;
+			suffixCount = 9;
+			break;
+		}
+		case XDI_QuaternionStd:			prefix = "QuatStd"; break;
+		case XDI_DeltaV:
+		case XDI_RawDeltaV:				prefix = "dv"; break;
+		case XDI_Acceleration:			prefix = "Acc"; break;
+		case XDI_FreeAcceleration:		prefix = "FreeAcc"; break;
+		case XDI_AccelerationHR:		prefix = "AccHR"; break;
+		case XDI_RateOfTurn:			prefix = "Gyr"; break;
+		case XDI_RateOfTurnHR:			prefix = "GyrHR"; break;
+		case XDI_MagneticField:			prefix = "Mag"; break;
+		case XDI_MagneticFieldCorrected:	prefix = "MagCorr"; break;
+		case XDI_PositionEcef:			prefix = "Pos"; break;
+		case XDI_VelocityXYZ:			prefix = "Vel"; break;
+		default:
+			break;
+	}
+
+	char name[32];
+	if (prefix && component < suffixCount)
+		snprintf(name, sizeof(name), "%s_%s", prefix, suffixes[component]);
+	else
+		snprintf(name, sizeof(name), "0x%04X_%u", (unsigned) id, (unsigned) component);
+	return name;
+}
@@ -79,11 +79,11 @@ void MtThread::setDoGotoConfig(bool doit)
 	m_doGotoConfig = doit;
 }
 
-/*! \brief The inner thread function
+/*! \brief Poll the port once
 	\details This function handles port communication, delegating processing and calibration to its DataParser.
-	\returns A value from 0 to 3
+	\returns The number of ms to wait before the next call
 */
-int32_t MtThread::innerFunction(void)
+int32_t MtThread::pollOnce(void)
 {
 	if (m_doGotoConfig)
 	{
@@ -94,5 +94,5 @@ int32_t MtThread::innerFunction(void)
 		XsTime_msleep((uint32_t)(((unsigned)rand()) / (RAND_MAX / 10) + 5));	// if we sent a goto config, wait a bit for the result
 	}
 
-	return DataPoller::innerFunction();
+	return DataPoller::pollOnce();
 }
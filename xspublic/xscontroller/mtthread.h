@@ -46,9 +46,7 @@ public:
 	virtual ~MtThread(void);
 
 	void setDoGotoConfig(bool doit);
-
-protected:
-	virtual int32_t innerFunction(void);
+	int32_t pollOnce() override;
 
 private:
 	bool m_doGotoConfig;
@@ -0,0 +1,526 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+#include "packetstreamserver.h"
+#include <xstypes/xssocket.h>
+#include <xstypes/xsdatapacket.h>
+#include <xstypes/xstime.h>
+#include <algorithm>
+#include <deque>
+#include <string.h>
+
+#ifdef _WIN32
+	#include <winsock2.h>
+	#include <ws2tcpip.h>
+#else
+	#include <sys/types.h>
+	#include <sys/socket.h>
+	#include <sys/uio.h>
+	#include <netinet/in.h>
+	#include <netinet/tcp.h>
+	#include <fcntl.h>
+	#include <errno.h>
+#endif
+
+#ifndef MSG_NOSIGNAL
+	#define MSG_NOSIGNAL 0
+#endif
+
+namespace
+{
+//! \brief The maximum number of buffers or datagrams that are passed to a single system call
+const int maxBatch = 64;
+//! \brief The time in ms that the server thread waits for new records when no subscriber has queued data
+const uint32_t idleWaitTime = 10;
+//! \brief The time in ms that the server thread waits for new records when a subscriber has queued data
+const uint32_t backlogWaitTime = 1;
+
+inline void putLe32(uint8_t* dest, uint32_t value)
+{
+	for (int i = 0; i < 4; ++i)
+		dest[i] = (uint8_t)(value >> (8 * i));
+}
+
+inline void putLe64(uint8_t* dest, uint64_t value)
+{
+	for (int i = 0; i < 8; ++i)
+		dest[i] = (uint8_t)(value >> (8 * i));
+}
+
+inline uint32_t getLe32(uint8_t const* src)
+{
+	return (uint32_t)src[0] | ((uint32_t)src[1] << 8) | ((uint32_t)src[2] << 16) | ((uint32_t)src[3] << 24);
+}
+
+//! \brief Make a socket non-blocking so the server thread never waits for a single subscriber
+void setNonBlocking(XSOCKET sd)
+{
+#ifdef _WIN32
+	u_long nonBlocking = 1;
+	(void)ioctlsocket(sd, FIONBIO, &nonBlocking);
+#else
+	(void)fcntl(sd, F_SETFL, fcntl(sd, F_GETFL, 0) | O_NONBLOCK);
+#ifdef SO_NOSIGPIPE
+	int one = 1;
+	(void)setsockopt(sd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+#endif
+}
+
+//! \returns True if the last socket error only indicates that the operation would block
+bool wouldBlock()
+{
+#ifdef _WIN32
+	return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+	return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+}
+
+/*! \brief The state of a TCP subscriber of a PacketStreamServer */
+struct PacketStreamClient
+{
+	explicit PacketStreamClient(XsSocket* socket)
+		: m_socket(socket)
+		, m_offset(0)
+		, m_queued(0)
+	{
+	}
+
+	~PacketStreamClient()
+	{
+		delete m_socket;
+	}
+
+	XsSocket* m_socket;
+	std::deque<std::shared_ptr<std::vector<uint8_t>>> m_queue;	//!< The blocks that still have to be sent
+	XsSize m_offset;		//!< The number of bytes of the first block in m_queue that were already sent
+	XsSize m_queued;		//!< The number of bytes in m_queue that still have to be sent
+};
+
+/*! \brief Constructor, the server does not send anything until open() is called */
+PacketStreamServer::PacketStreamServer()
+	: m_pendingCondition(m_mutex)
+	, m_sequence(0)
+	, m_open(false)
+	, m_clientQueueLimit(defaultClientQueueLimit)
+	, m_pendingLimit(0)
+	, m_listener(nullptr)
+	, m_udp(nullptr)
+	, m_backlog(false)
+	, m_clientCount(0)
+	, m_publishedCount(0)
+	, m_overflowCount(0)
+	, m_droppedClientCount(0)
+	, m_bytesSent(0)
+{
+}
+
+/*! \brief Destructor, closes the server */
+PacketStreamServer::~PacketStreamServer()
+{
+	close();
+}
+
+/*! \brief Start serving
+	\param tcpPort The TCP port to accept subscribers on, 0 to disable TCP
+	\param udpHost The host or multicast group to send datagrams to, empty to disable UDP. Multicast datagrams are
+	sent with the default time-to-live of 1, so they do not leave the local network.
+	\param udpPort The UDP port to send datagrams to
+	\param clientQueueLimit The maximum number of bytes that can be queued for a single TCP subscriber
+	\returns XRV_OK if successful, XRV_INVALIDPARAM if both TCP and UDP are disabled
+*/
+XsResultValue PacketStreamServer::open(uint16_t tcpPort, const XsString& udpHost, uint16_t udpPort, XsSize clientQueueLimit)
+{
+	if (isOpen())
+		return XRV_ALREADYOPEN;
+	if (tcpPort == 0 && udpHost.empty())
+		return XRV_INVALIDPARAM;
+
+	XsResultValue res = XRV_OK;
+	if (tcpPort)
+	{
+		m_listener = new XsSocket(IP_TCP, NLP_IPVX);
+		int zero = 0;
+		(void)setsockopt(m_listener->nativeDescriptor(), IPPROTO_IPV6, IPV6_V6ONLY, (char const*)&zero, sizeof(zero));
+		m_listener->setSocketOption(XSO_ReuseAddress, 1);
+		res = m_listener->bind(tcpPort);
+		if (res == XRV_OK)
+			res = m_listener->listen();
+	}
+
+	if (res == XRV_OK && !udpHost.empty())
+	{
+		m_udp = new XsSocket(IP_UDP, strchr(udpHost.c_str(), ':') ? NLP_IPV6 : NLP_IPV4);
+		res = m_udp->connect(udpHost, udpPort);
+		if (res == XRV_OK)
+			setNonBlocking(m_udp->nativeDescriptor());
+	}
+
+	if (res != XRV_OK)
+	{
+		delete m_listener;
+		m_listener = nullptr;
+		delete m_udp;
+		m_udp = nullptr;
+		return res;
+	}
+
+	{
+		xsens::Lock locky(&m_mutex);
+		m_clientQueueLimit = clientQueueLimit;
+		m_pendingLimit = (4 * clientQueueLimit > defaultClientQueueLimit) ? 4 * clientQueueLimit : defaultClientQueueLimit;
+		m_sequence = 0;
+		m_pending.clear();
+		m_open = true;
+	}
+	m_publishedCount = 0;
+	m_overflowCount = 0;
+	m_droppedClientCount = 0;
+	m_bytesSent = 0;
+	m_backlog = false;
+
+	startThread("PacketStreamServer");
+	return XRV_OK;
+}
+
+/*! \brief Stop serving and disconnect all subscribers
+	\details Records that were not sent yet are discarded.
+*/
+void PacketStreamServer::close()
+{
+	stopThread();
+
+	xsens::Lock locky(&m_mutex);
+	for (PacketStreamClient* client : m_clients)
+		delete client;
+	m_clients.clear();
+	m_clientCount = 0;
+	delete m_listener;
+	m_listener = nullptr;
+	delete m_udp;
+	m_udp = nullptr;
+	m_pending.clear();
+	m_open = false;
+}
+
+//! \returns True if the server is open
+bool PacketStreamServer::isOpen() const
+{
+	xsens::Lock locky(&m_mutex);
+	return m_open;
+}
+
+/*! \brief Publish a received MtData2 message
+	\param message The message to publish
+	\param deviceId The id of the device that produced the message
+	\returns XRV_OK if successful
+*/
+XsResultValue PacketStreamServer::publish(const XsMessage& message, uint64_t deviceId)
+{
+	return publish(message.getMessageStart(), message.getTotalMessageSize(), deviceId, XsTime_monotonicUs());
+}
+
+/*! \brief Publish a data packet
+	\details The packet is converted to an MtData2 message. Its device id is sent with the frame.
+	\param packet The packet to publish
+	\returns XRV_OK if successful
+*/
+XsResultValue PacketStreamServer::publish(const XsDataPacket& packet)
+{
+	XsMessage message = packet.toMessage();
+	return publish(message.getMessageStart(), message.getTotalMessageSize(), packet.deviceId().toInt(), XsTime_monotonicUs());
+}
+
+/*! \brief Publish a complete MtData2 frame
+	\param frame The frame including preamble and checksum
+	\param size The size of the frame
+	\param deviceId The id of the device that produced the frame
+	\param timeOfArrival The time at which the frame was received from XsTime_monotonicUs()
+	\returns XRV_OK if successful, XRV_NOPORTOPEN if the server is not open or XRV_INSUFFICIENTSPACE if the frame
+	was discarded because the server thread could not keep up
+*/
+XsResultValue PacketStreamServer::publish(uint8_t const* frame, XsSize size, uint64_t deviceId, int64_t timeOfArrival)
+{
+	xsens::Lock locky(&m_mutex);
+	if (!m_open)
+		return XRV_NOPORTOPEN;
+	if (m_pending.size() + recordHeaderSize + size > m_pendingLimit)
+	{
+		++m_overflowCount;
+		return XRV_INSUFFICIENTSPACE;
+	}
+
+	XsSize offset = m_pending.size();
+	m_pending.resize(offset + recordHeaderSize + size);
+	uint8_t* record = m_pending.data() + offset;
+	putLe32(record, (uint32_t)(recordHeaderSize - 4 + size));
+	putLe32(record + 4, m_sequence++);
+	putLe64(record + 8, deviceId);
+	putLe64(record + 16, (uint64_t)timeOfArrival);
+	memcpy(record + recordHeaderSize, frame, size);
+	++m_publishedCount;
+
+	if (offset == 0)
+		m_pendingCondition.signal();
+	return XRV_OK;
+}
+
+/*! \brief Tell the server thread to stop and wake it up */
+void PacketStreamServer::signalStopThread()
+{
+	xsens::StandardThread::signalStopThread();
+	xsens::Lock locky(&m_mutex);
+	m_pendingCondition.signal();
+}
+
+/*! \brief Distribute the published records to the subscribers
+	\returns 0 to run again immediately, the function does its own waiting
+*/
+int32_t PacketStreamServer::innerFunction()
+{
+	Block block;
+	{
+		xsens::Lock locky(&m_mutex);
+		if (m_pending.empty() && !isTerminating())
+			m_pendingCondition.wait(m_backlog ? backlogWaitTime : idleWaitTime);
+		if (isTerminating())
+			return 0;
+		if (!m_pending.empty())
+		{
+			block = std::make_shared<std::vector<uint8_t>>();
+			block->swap(m_pending);
+			m_pending.reserve(block->size());
+		}
+	}
+
+	if (m_listener)
+		acceptClients();
+
+	if (!block)
+	{
+		flushClients();
+		return 0;
+	}
+
+	if (m_udp)
+		sendDatagrams(*block);
+
+	// records that accumulated while this thread was busy are handed out in parts that fit in every send queue,
+	// so subscribers that keep up can send each part before the next one is queued
+	XsSize partLimit = m_clientQueueLimit / 4;
+	if (m_clients.empty() || block->size() <= partLimit)
+	{
+		queueBlock(block);
+		flushClients();
+		return 0;
+	}
+
+	XsSize begin = 0;
+	while (begin < block->size())
+	{
+		XsSize end = begin + 4 + getLe32(block->data() + begin);
+		while (end < block->size() && end + 4 + getLe32(block->data() + end) - begin <= partLimit)
+			end += 4 + getLe32(block->data() + end);
+		queueBlock(std::make_shared<std::vector<uint8_t>>(block->begin() + (ptrdiff_t) begin, block->begin() + (ptrdiff_t) end));
+		flushClients();
+		begin = end;
+	}
+	return 0;
+}
+
+/*! \brief Send the queued data of all subscribers as far as their sockets accept it without blocking
+	\details Subscribers whose connection failed are removed.
+*/
+void PacketStreamServer::flushClients()
+{
+	m_backlog = false;
+	for (XsSize i = m_clients.size(); i > 0; --i)
+	{
+		PacketStreamClient& client = *m_clients[i - 1];
+		if (client.m_queued == 0)
+			continue;
+		if (!flushClient(client))
+			removeClient(i - 1);
+		else if (client.m_queued)
+			m_backlog = true;
+	}
+}
+
+/*! \brief Accept all pending TCP subscribers
+	\details New subscribers receive the records that are published after they connected.
+*/
+void PacketStreamServer::acceptClients()
+{
+	int canRead = 0;
+	while (m_listener->select(0, &canRead, nullptr) > 0 && canRead)
+	{
+		XsSocket* socket = m_listener->accept(0);
+		if (!socket)
+			break;
+
+		XSOCKET sd = socket->nativeDescriptor();
+		setNonBlocking(sd);
+		int one = 1;
+		(void)setsockopt(sd, IPPROTO_TCP, TCP_NODELAY, (char const*)&one, sizeof(one));
+		m_clients.push_back(new PacketStreamClient(socket));
+		m_clientCount = m_clients.size();
+	}
+}
+
+/*! \brief Add \a block to the send queue of each subscriber
+	\details Subscribers whose queue would exceed the queue limit are disconnected.
+*/
+void PacketStreamServer::queueBlock(Block const& block)
+{
+	for (XsSize i = m_clients.size(); i > 0; --i)
+	{
+		PacketStreamClient& client = *m_clients[i - 1];
+		if (client.m_queued + block->size() > m_clientQueueLimit)
+		{
+			++m_droppedClientCount;
+			removeClient(i - 1);
+			continue;
+		}
+		client.m_queue.push_back(block);
+		client.m_queued += block->size();
+	}
+}
+
+/*! \brief Send as much of the queue of \a client as the socket accepts without blocking
+	\returns false if the connection failed and the subscriber should be removed
+*/
+bool PacketStreamServer::flushClient(PacketStreamClient& client)
+{
+	while (client.m_queued)
+	{
+		int count = (int) std::min<XsSize>(client.m_queue.size(), maxBatch);
+		XsSize offset = client.m_offset;
+		XsSize batchSize = 0;
+#ifdef _WIN32
+		WSABUF buffers[maxBatch];
+		for (int i = 0; i < count; ++i)
+		{
+			buffers[i].buf = (char*)client.m_queue[i]->data() + offset;
+			buffers[i].len = (ULONG)(client.m_queue[i]->size() - offset);
+			batchSize += buffers[i].len;
+			offset = 0;
+		}
+		DWORD written = 0;
+		if (WSASend(client.m_socket->nativeDescriptor(), buffers, (DWORD)count, &written, 0, NULL, NULL) != 0)
+			return wouldBlock();
+		XsSize sent = written;
+#else
+		struct iovec buffers[maxBatch];
+		for (int i = 0; i < count; ++i)
+		{
+			buffers[i].iov_base = client.m_queue[i]->data() + offset;
+			buffers[i].iov_len = client.m_queue[i]->size() - offset;
+			batchSize += buffers[i].iov_len;
+			offset = 0;
+		}
+		struct msghdr msg;
+		memset(&msg, 0, sizeof(msg));
+		msg.msg_iov = buffers;
+		msg.msg_iovlen = count;
+		ssize_t written = sendmsg(client.m_socket->nativeDescriptor(), &msg, MSG_NOSIGNAL);
+		if (written < 0)
+			return wouldBlock();
+		XsSize sent = (XsSize) written;
+#endif
+		m_bytesSent += sent;
+		client.m_queued -= sent;
+		bool full = sent < batchSize;
+		sent += client.m_offset;
+		while (!client.m_queue.empty() && sent >= client.m_queue.front()->size())
+		{
+			sent -= client.m_queue.front()->size();
+			client.m_queue.pop_front();
+		}
+		client.m_offset = sent;
+
+		// a partial write means the socket buffer is full
+		if (full)
+			break;
+	}
+	return true;
+}
+
+/*! \brief Send each record in \a block as a separate datagram to the UDP target
+	\details Datagrams that the socket does not accept without blocking are discarded, receivers can detect this
+	from the sequence numbers.
+*/
+void PacketStreamServer::sendDatagrams(std::vector<uint8_t> const& block)
+{
+	XSOCKET sd = m_udp->nativeDescriptor();
+	XsSize offset = 0;
+	while (offset < block.size())
+	{
+#ifdef __linux__
+		struct iovec buffers[maxBatch];
+		struct mmsghdr messages[maxBatch];
+		unsigned int count = 0;
+		memset(messages, 0, sizeof(messages));
+		for (; count < (unsigned int) maxBatch && offset < block.size(); ++count)
+		{
+			XsSize length = 4 + getLe32(block.data() + offset);
+			buffers[count].iov_base = (void*)(block.data() + offset);
+			buffers[count].iov_len = length;
+			messages[count].msg_hdr.msg_iov = &buffers[count];
+			messages[count].msg_hdr.msg_iovlen = 1;
+			offset += length;
+		}
+		int sent = sendmmsg(sd, messages, count, MSG_NOSIGNAL);
+		if (sent < 0)
+			return;
+		for (int i = 0; i < sent; ++i)
+			m_bytesSent += messages[i].msg_len;
+		if (sent < (int) count)
+			return;
+#else
+		XsSize length = 4 + getLe32(block.data() + offset);
+		int sent = (int)send(sd, (char const*)block.data() + offset, (int)length, MSG_NOSIGNAL);
+		if (sent < 0)
+			return;
+		m_bytesSent += (uint64_t) sent;
+		offset += length;
+#endif
+	}
+}
+
+/*! \brief Disconnect the subscriber at \a index */
+void PacketStreamServer::removeClient(XsSize index)
+{
+	delete m_clients[index];
+	m_clients.erase(m_clients.begin() + (ptrdiff_t) index);
+	m_clientCount = m_clients.size();
+}
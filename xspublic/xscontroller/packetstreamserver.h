@@ -0,0 +1,162 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+#ifndef PACKETSTREAMSERVER_H
+#define PACKETSTREAMSERVER_H
+
+#include <xstypes/xsmessage.h>
+#include <xstypes/xsstring.h>
+#include <xstypes/xsresultvalue.h>
+#include <xscommon/xsens_mutex.h>
+#include <xscommon/threading.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+struct XsDataPacket;
+struct XsSocket;
+struct PacketStreamClient;
+
+/*! \brief Streams MtData2 frames to network subscribers over TCP and/or to a UDP (multicast) group
+	\details Frames are sent as records of a 24 byte little endian header followed by the complete frame:
+	\verbatim
+	uint32 length		the number of bytes following this field, so 20 + the frame size
+	uint32 sequence		the sequence number of the record, incremented for each published frame
+	uint64 deviceId		the id of the device that produced the frame
+	int64 timeUs		the time of arrival of the frame from XsTime_monotonicUs()
+	\endverbatim
+	TCP subscribers receive a stream of records, each UDP datagram contains exactly one record.
+
+	Publishing never blocks on the network: publish() appends the record to a pending buffer and the server thread
+	distributes it. Every TCP subscriber has its own send queue that is bounded to clientQueueLimit() bytes. A
+	subscriber that does not read fast enough to stay within that bound is disconnected, so it can not delay the
+	other subscribers. Queued records are sent with a single gathering write per subscriber and UDP datagrams are
+	sent in batches where the platform supports it. When more records were published than fit in a quarter of the
+	queue limit while the server thread was busy, they are queued in parts of that size and the subscribers are
+	flushed after each part, so a burst only disconnects the subscribers that can not keep up with it.
+
+	Publishing is thread safe, so one server can be shared by several devices.
+	\sa XsDevice::setPacketStreamServer
+*/
+class PacketStreamServer : protected xsens::StandardThread
+{
+public:
+	//! \brief The size of the header of each record in bytes
+	static const XsSize recordHeaderSize = 24;
+	//! \brief The default maximum number of bytes that can be queued for a single TCP subscriber
+	static const XsSize defaultClientQueueLimit = 1024 * 1024;
+
+	PacketStreamServer();
+	~PacketStreamServer();
+
+	XsResultValue open(uint16_t tcpPort, const XsString& udpHost = XsString(), uint16_t udpPort = 0, XsSize clientQueueLimit = defaultClientQueueLimit);
+	void close();
+	bool isOpen() const;
+
+	XsResultValue publish(const XsMessage& message, uint64_t deviceId);
+	XsResultValue publish(const XsDataPacket& packet);
+	XsResultValue publish(uint8_t const* frame, XsSize size, uint64_t deviceId, int64_t timeOfArrival);
+
+	//! \returns The maximum number of bytes that can be queued for a single TCP subscriber
+	inline XsSize clientQueueLimit() const
+	{
+		return m_clientQueueLimit;
+	}
+
+	//! \returns The number of connected TCP subscribers
+	inline XsSize clientCount() const
+	{
+		return m_clientCount.load(std::memory_order_relaxed);
+	}
+
+	//! \returns The number of frames that were published
+	inline uint64_t publishedCount() const
+	{
+		return m_publishedCount.load(std::memory_order_relaxed);
+	}
+
+	//! \returns The number of frames that were rejected because the server thread could not keep up
+	inline uint64_t overflowCount() const
+	{
+		return m_overflowCount.load(std::memory_order_relaxed);
+	}
+
+	//! \returns The number of TCP subscribers that were disconnected because they fell too far behind
+	inline uint64_t droppedClientCount() const
+	{
+		return m_droppedClientCount.load(std::memory_order_relaxed);
+	}
+
+	//! \returns The number of bytes that were sent to TCP subscribers and the UDP target
+	inline uint64_t bytesSent() const
+	{
+		return m_bytesSent.load(std::memory_order_relaxed);
+	}
+
+protected:
+	int32_t innerFunction() override;
+	void signalStopThread() override;
+
+private:
+	PacketStreamServer(PacketStreamServer const&) = delete;
+	PacketStreamServer& operator=(PacketStreamServer const&) = delete;
+
+	//! \brief A block of records that is shared by the send queues of all subscribers
+	typedef std::shared_ptr<std::vector<uint8_t>> Block;
+
+	void acceptClients();
+	void queueBlock(Block const& block);
+	void flushClients();
+	bool flushClient(PacketStreamClient& client);
+	void sendDatagrams(std::vector<uint8_t> const& block);
+	void removeClient(XsSize index);
+
+	mutable xsens::Mutex m_mutex;
+	xsens::WaitCondition m_pendingCondition;	//!< Signalled when records are added to m_pending or the thread must stop
+	std::vector<uint8_t> m_pending;			//!< Records that were published but not yet handed to the server thread, protected by m_mutex
+	uint32_t m_sequence;					//!< The sequence number of the next record, protected by m_mutex
+	bool m_open;
+	XsSize m_clientQueueLimit;
+	XsSize m_pendingLimit;					//!< The maximum size of m_pending
+
+	XsSocket* m_listener;					//!< The socket that accepts TCP subscribers, nullptr if TCP is disabled
+	XsSocket* m_udp;						//!< The socket connected to the UDP target, nullptr if UDP is disabled
+	std::vector<PacketStreamClient*> m_clients;	//!< Only accessed by the server thread
+	bool m_backlog;							//!< True when a subscriber has queued data, only accessed by the server thread
+
+	std::atomic<XsSize> m_clientCount;
+	std::atomic<uint64_t> m_publishedCount;
+	std::atomic<uint64_t> m_overflowCount;
+	std::atomic<uint64_t> m_droppedClientCount;
+	std::atomic<uint64_t> m_bytesSent;
+};
+
+#endif
@@ -0,0 +1,351 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+
+#include "portscheduler.h"
+#include <xscommon/threading.h>
+#include <xscommon/xsens_threadpool.h>
+#include <xstypes/xstime.h>
+#include <stdio.h>
+
+/*! \cond XS_INTERNAL */
+namespace
+{
+std::atomic<bool> g_enabled(false);
+xsens::Mutex g_instanceMutex;
+PortScheduler* g_instance = nullptr;
+
+//! \brief The maximum time an idle worker sleeps before checking for work, in ms
+const uint32_t maxIdleWait = 10;
+
+//! \returns The monotonic time in ms
+inline int64_t monotonicMs()
+{
+	return XsTime_monotonicUs() / 1000;
+}
+}
+
+/*! \brief A registered port */
+struct PortScheduler::Port
+{
+	PortId m_id;					//!< The id of the port
+	PollFunction m_poll;			//!< The poll function of the port
+	std::atomic<bool> m_removed;	//!< Set when the port has been removed, it will not be polled again
+	xsens::Mutex m_runMutex;		//!< Held while m_poll is running, so removePort() can wait for it
+};
+
+/*! \brief A worker thread of the PortScheduler */
+class PortScheduler::Worker : public xsens::StandardThread
+{
+public:
+	//! \brief Constructor
+	Worker(PortScheduler& scheduler, unsigned int index)
+		: m_scheduler(scheduler)
+		, m_index(index)
+	{
+	}
+
+	//! \brief Destructor, stops the thread
+	~Worker() override
+	{
+		try
+		{
+			stopThread();
+		}
+		catch (...)
+		{
+		}
+	}
+
+	//! \brief Wake the worker when it is waiting
+	void signalStopThread() override
+	{
+		StandardThread::signalStopThread();
+		xsens::Lock lock(&m_scheduler.m_mutex);
+		m_scheduler.m_wake.broadcast();
+	}
+
+protected:
+	//! \brief Set the priority and name of the thread
+	void initFunction() override
+	{
+		setPriority(XS_THREAD_PRIORITY_HIGHER);
+		char buffer[64];
+		sprintf(buffer, "XDA PortScheduler %u", m_index);
+		xsNameThisThread(buffer);
+	}
+
+	//! \brief Poll the next ready port
+	int32_t innerFunction() override
+	{
+		m_scheduler.work(m_index);
+		return 0;
+	}
+
+private:
+	PortScheduler& m_scheduler;
+	unsigned int m_index;
+};
+/*! \endcond */
+
+/*! \brief Enable or disable the shared scheduling model
+	\details This must be set before the ports are opened, communicators that already exist keep using the model
+	that was active when they were created.
+	\param enabled true to poll all ports from a shared pool of workers
+*/
+void PortScheduler::setEnabled(bool enabled)
+{
+	g_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+//! \returns true if new communicators should use the shared scheduling model
+bool PortScheduler::isEnabled()
+{
+	return g_enabled.load(std::memory_order_relaxed);
+}
+
+/*! \brief Return the scheduler, creating it with one worker per processor when it does not exist yet
+	\returns The scheduler
+*/
+PortScheduler* PortScheduler::instance()
+{
+	xsens::Lock lock(&g_instanceMutex);
+	if (!g_instance)
+	{
+		int count = xsens::processorCount();
+		g_instance = new PortScheduler(count > 0 ? (unsigned int) count : 1);
+	}
+	return g_instance;
+}
+
+/*! \brief Stop the workers and destroy the scheduler
+	\note All ports must have been removed before calling this function
+*/
+void PortScheduler::destroy()
+{
+	xsens::Lock lock(&g_instanceMutex);
+	delete g_instance;
+	g_instance = nullptr;
+}
+
+/*! \brief Constructor, starts \a workerCount workers */
+PortScheduler::PortScheduler(unsigned int workerCount)
+	: m_wake(m_mutex)
+	, m_nextId(1)
+	, m_nextWorker(0)
+	, m_steals(0)
+	, m_ready(0)
+{
+	m_queues.resize(workerCount);
+	for (unsigned int i = 0; i < workerCount; ++i)
+		m_queueMutexes.push_back(std::unique_ptr<xsens::Mutex>(new xsens::Mutex));
+	for (unsigned int i = 0; i < workerCount; ++i)
+		m_workers.push_back(new Worker(*this, i));
+	for (auto worker : m_workers)
+		worker->startThread();
+}
+
+/*! \brief Destructor, stops the workers */
+PortScheduler::~PortScheduler()
+{
+	for (auto worker : m_workers)
+		worker->signalStopThread();
+	for (auto worker : m_workers)
+		delete worker;
+	m_workers.clear();
+}
+
+/*! \brief Register a port
+	\param poll The function that polls and parses the port. It is called from the worker threads, but never
+	concurrently with itself.
+	\returns The id of the port, to be supplied to removePort()
+*/
+PortScheduler::PortId PortScheduler::addPort(PollFunction const& poll)
+{
+	std::shared_ptr<Port> port = std::make_shared<Port>();
+	port->m_poll = poll;
+	port->m_removed = false;
+	{
+		xsens::Lock lock(&m_mutex);
+		port->m_id = m_nextId++;
+		m_ports[port->m_id] = port;
+	}
+	push(m_nextWorker.fetch_add(1, std::memory_order_relaxed) % workerCount(), port);
+	return port->m_id;
+}
+
+/*! \brief Unregister a port
+	\details When the poll function of the port is running, this function waits for it to return. The poll
+	function will not be called anymore after this function returns. It may be called from the poll function itself.
+	\param id The id of the port as returned by addPort()
+*/
+void PortScheduler::removePort(PortId id)
+{
+	std::shared_ptr<Port> port;
+	{
+		xsens::Lock lock(&m_mutex);
+		auto it = m_ports.find(id);
+		if (it == m_ports.end())
+			return;
+		port = it->second;
+		m_ports.erase(it);
+	}
+
+	port->m_removed = true;
+	xsens::Lock wait(&port->m_runMutex);
+}
+
+/*! \brief Apply the thread settings of \a profile to the workers
+	\details Each worker gets the next processor and the poller priority, since the workers both read and parse.
+	\param profile The profile to apply
+	\param coreIndex The index of the next processor to assign in RealTimeProfile::m_cores
+	\param report Receives the results
+*/
+void PortScheduler::applyRealTimeProfile(RealTimeProfile const& profile, XsSize& coreIndex, RealTimeProfileReport& report)
+{
+	for (unsigned int i = 0; i < workerCount(); ++i)
+	{
+		char name[64];
+		sprintf(name, "PortScheduler %u", i);
+		report.addThread(name, m_workers[i]->setRealTimeSettings(profile.nextSettings(coreIndex, profile.m_pollerPriority)));
+	}
+}
+
+/*! \brief Add \a port to the back of the deque of \a worker and wake an idle worker */
+void PortScheduler::push(unsigned int worker, std::shared_ptr<Port> const& port)
+{
+	{
+		xsens::Lock lock(m_queueMutexes[worker].get());
+		m_queues[worker].push_back(port);
+	}
+	m_ready.fetch_add(1, std::memory_order_release);
+
+	xsens::Lock lock(&m_mutex);
+	m_wake.signal();
+}
+
+/*! \brief Take a port from the front of the own deque or steal one from the back of another deque
+	\returns The port or nullptr if no port is ready
+*/
+std::shared_ptr<PortScheduler::Port> PortScheduler::takeWork(unsigned int self)
+{
+	std::shared_ptr<Port> port;
+	unsigned int count = workerCount();
+	for (unsigned int n = 0; n < count && !port; ++n)
+	{
+		unsigned int victim = (self + n) % count;
+		xsens::Lock lock(m_queueMutexes[victim].get());
+		auto& queue = m_queues[victim];
+		if (queue.empty())
+			continue;
+
+		if (victim == self)
+		{
+			port = queue.front();
+			queue.pop_front();
+		}
+		else
+		{
+			port = queue.back();
+			queue.pop_back();
+			m_steals.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	if (port)
+		m_ready.fetch_sub(1, std::memory_order_relaxed);
+	return port;
+}
+
+/*! \brief Move the ports of which the wait time has passed to the deque of worker \a self */
+void PortScheduler::promoteTimers(unsigned int self)
+{
+	int64_t now = monotonicMs();
+	std::vector<std::shared_ptr<Port>> due;
+	{
+		xsens::Lock lock(&m_mutex);
+		while (!m_timers.empty() && m_timers.begin()->first <= now)
+		{
+			due.push_back(m_timers.begin()->second);
+			m_timers.erase(m_timers.begin());
+		}
+	}
+
+	for (auto const& port : due)
+		push(self, port);
+}
+
+/*! \brief Perform one scheduling step on worker \a self
+	\details Promotes due timers, runs one ready port and reschedules it. When no port is ready, the worker waits
+	until the next timer is due or a port becomes ready.
+*/
+void PortScheduler::work(unsigned int self)
+{
+	promoteTimers(self);
+
+	std::shared_ptr<Port> port = takeWork(self);
+	if (!port)
+	{
+		xsens::Lock lock(&m_mutex);
+		if (m_ready.load(std::memory_order_acquire) > 0 || m_workers[self]->isTerminating())
+			return;
+
+		uint32_t timeout = maxIdleWait;
+		if (!m_timers.empty())
+		{
+			int64_t delta = m_timers.begin()->first - monotonicMs();
+			if (delta <= 0)
+				return;
+			if (delta < (int64_t) timeout)
+				timeout = (uint32_t) delta;
+		}
+		m_wake.wait(timeout);
+		return;
+	}
+
+	int32_t delay;
+	{
+		xsens::Lock running(&port->m_runMutex);
+		if (port->m_removed)
+			return;
+		delay = port->m_poll();
+	}
+	if (port->m_removed)
+		return;
+
+	if (delay <= 0)
+		push(self, port);
+	else
+	{
+		xsens::Lock lock(&m_mutex);
+		m_timers.insert(std::make_pair(monotonicMs() + delay, port));
+	}
+}
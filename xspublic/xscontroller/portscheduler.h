@@ -0,0 +1,110 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+
+#ifndef PORTSCHEDULER_H
+#define PORTSCHEDULER_H
+
+#include <xscommon/xsens_mutex.h>
+#include "realtimeprofile.h"
+#include <functional>
+#include <memory>
+#include <vector>
+#include <deque>
+#include <map>
+
+/*! \class PortScheduler
+	\brief A fixed pool of worker threads that polls and parses the data of all open ports
+	\details By default every SerialCommunicator runs its own poller thread and parser thread. When the shared
+	model is enabled with setEnabled() before any port is opened, the communicators register a poll function here
+	instead. Each worker owns a deque of ready ports, takes work from the front of its own deque and steals from the
+	back of the other deques when it runs out. A port is in at most one deque, the timer list or a worker at any
+	time, so the data of a single port is always processed in order.
+
+	The poll function returns the number of ms to wait before it should be called again, like the innerFunction
+	of a StandardThread.
+*/
+class PortScheduler
+{
+public:
+	//! \brief The function that polls and parses a port, returns the number of ms to wait before the next poll
+	typedef std::function<int32_t()> PollFunction;
+	//! \brief The identifier of a registered port, 0 is never used
+	typedef unsigned int PortId;
+
+	static void setEnabled(bool enabled);
+	static bool isEnabled();
+	static PortScheduler* instance();
+	static void destroy();
+
+	PortId addPort(PollFunction const& poll);
+	void removePort(PortId id);
+	void applyRealTimeProfile(RealTimeProfile const& profile, XsSize& coreIndex, RealTimeProfileReport& report);
+
+	//! \returns The number of worker threads
+	inline unsigned int workerCount() const
+	{
+		return (unsigned int) m_workers.size();
+	}
+
+	//! \returns The number of times a worker took a port from the deque of another worker
+	inline uint64_t stealCount() const
+	{
+		return m_steals.load(std::memory_order_relaxed);
+	}
+
+private:
+	class Worker;
+	struct Port;
+	friend class Worker;
+
+	explicit PortScheduler(unsigned int workerCount);
+	~PortScheduler();
+
+	void work(unsigned int self);
+	std::shared_ptr<Port> takeWork(unsigned int self);
+	void push(unsigned int worker, std::shared_ptr<Port> const& port);
+	void promoteTimers(unsigned int self);
+
+	std::vector<Worker*> m_workers;						//!< The worker threads
+	std::vector<std::unique_ptr<xsens::Mutex>> m_queueMutexes;	//!< Guards the deque of each worker
+	std::vector<std::deque<std::shared_ptr<Port>>> m_queues;	//!< The ready ports of each worker
+	xsens::Mutex m_mutex;								//!< Guards m_ports, m_timers and m_nextId
+	xsens::WaitCondition m_wake;						//!< Signalled when ports become ready
+	std::map<PortId, std::shared_ptr<Port>> m_ports;	//!< The registered ports
+	std::multimap<int64_t, std::shared_ptr<Port>> m_timers;	//!< Ports waiting until the key time in ms
+	PortId m_nextId;									//!< The next port id
+	std::atomic<unsigned int> m_nextWorker;				//!< Round-robin counter for ports added from outside the workers
+	std::atomic<uint64_t> m_steals;						//!< The number of stolen ports
+	std::atomic<int> m_ready;							//!< The number of ports in the deques
+};
+
+#endif
@@ -80,6 +80,18 @@ static int expectedMessageSize(const unsigned char* buffer, int sz)
 	return XS_LEN_MSGHEADERCS + (int)(hdr->m_length);
 }
 
+/*! \brief Returns true if the checksum of the complete message of \a size bytes at \a msg is correct
+	\details This gives the same result as loading the message into an XsMessage and calling isChecksumOk(), but
+	doesn't copy the message
+*/
+static bool isChecksumOk(const uint8_t* msg, int size)
+{
+	uint8_t sum = 0;
+	for (int i = 1; i < size; ++i)
+		sum += msg[i];
+	return sum == 0;
+}
+
 /*! \brief Write the contents of a uint8 buffer to string as hex characters */
 inline std::string dumpBuffer(const uint8_t* buff, XsSize sz)
 {
@@ -165,13 +177,11 @@ MessageLocation ProtocolHandler::findMessage(const XsByteArray& raw) const
 				continue;
 			}
 
-			XsMessage rcv;
-			// we have read enough data to fulfill our target so we'll try to parse the message
-			// and check the checksum
-			if (rcv.loadFromString(msgStart, (uint16_t)target))
+			// we have read enough data to fulfill our target so we'll check the checksum
+			if (isChecksumOk(msgStart, target))
 			{
-				JLTRACEG("OK, size = " << (int) rcv.getTotalMessageSize() << " buffer: " << dumpBuffer(msgStart, target));
-				rv.m_size = (int) rcv.getTotalMessageSize();
+				JLTRACEG("OK, size = " << target << " buffer: " << dumpBuffer(msgStart, target));
+				rv.m_size = target;
 				rv.m_startPos = pre;
 #if 0
 				JLDEBUGG("OK: rv.m_size = " << rv.m_size <<
@@ -186,13 +196,14 @@ MessageLocation ProtocolHandler::findMessage(const XsByteArray& raw) const
 			// Only alert the checksum error if this is not an embedded message
 			if (rv.m_incompletePos == -1)
 			{
+				++rv.m_checksumFailures;
 				JLALERTG(
 					"Invalid checksum for msg at offset " << pre << " bufferSize = " << bufferSize
 					<< " buffer at offset: " << dumpBuffer(raw.data() + pre, raw.size() - pre));
 			}
 			else
 			{
-				JLTRACEG("Invalid checksum, size = " << (int)rcv.getTotalMessageSize() << " buffer: " << dumpBuffer(msgStart, target));
+				JLTRACEG("Invalid checksum, size = " << target << " buffer: " << dumpBuffer(msgStart, target));
 			}
 		}
 	}
@@ -205,12 +216,12 @@ MessageLocation ProtocolHandler::findMessage(const XsByteArray& raw) const
 */
 XsMessage ProtocolHandler::convertToMessage(MessageLocation& location, const XsByteArray& raw) const
 {
-	XsMessage message;
-
 	const unsigned char* buffer = raw.data();
 	const uint8_t* msgStart = &(buffer[location.m_startPos]);
 
-	if (message.loadFromString(msgStart, (uint16_t)location.m_size))
+	// load the message directly, a default constructed message would allocate a header that is then discarded
+	XsMessage message(msgStart, (uint16_t)location.m_size);
+	if (message.isChecksumOk())
 	{
 		JLTRACEG("OK, size = " << (int)message.getTotalMessageSize() << " buffer: " << dumpBuffer(msgStart, location.m_size));
 		location.m_size = (int)message.getTotalMessageSize();
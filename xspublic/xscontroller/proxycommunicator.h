@@ -45,6 +45,10 @@ public:
 	~ProxyCommunicator() override;
 
 	XsResultValue readDataToBuffer(XsByteArray& raw) override;
+	bool receivesPushedData() const override
+	{
+		return true;
+	}
 	XsResultValue processBufferedData(const XsByteArray& rawIn, std::deque<XsMessage>& messages) override;
 	void handleMessage(const XsMessage& message) override;
 
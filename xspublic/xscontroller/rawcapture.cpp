@@ -0,0 +1,399 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+#include "rawcapture.h"
+#include <xstypes/xstime.h>
+#include <string.h>
+
+namespace
+{
+	//! \brief The magic at the start of a raw capture file
+	const char captureMagic[8] = {'X', 'S', 'R', 'A', 'W', 'C', 'A', 'P'};
+
+	//! \brief The number of bytes that RawCaptureReader reads from the file at once
+	const XsSize readBlockSize = 256 * 1024;
+
+	//! \brief Append \a value to \a buffer as an unsigned LEB128 varint
+	void appendVarint(std::vector<uint8_t>& buffer, uint64_t value)
+	{
+		while (value >= 0x80)
+		{
+			buffer.push_back((uint8_t) (value | 0x80));
+			value >>= 7;
+		}
+		buffer.push_back((uint8_t) value);
+	}
+}
+
+/*! \class RawCaptureWriter
+	\sa DataParser::startRawCapture, RawCaptureReader, ReplayStreamInterface
+*/
+
+RawCaptureWriter::RawCaptureWriter()
+	: m_open(false)
+	, m_lastTime(0)
+	, m_chunkCount(0)
+	, m_lastResult(XRV_OK)
+{
+}
+
+RawCaptureWriter::~RawCaptureWriter()
+{
+	try
+	{
+		close();
+	}
+	catch (...)
+	{
+	}
+}
+
+/*! \brief Create a new capture file and start the background writer thread
+	\details The times of the chunks are relative to the moment this function is called.
+	\param filename The name of the file to create, an existing file is overwritten
+	\returns XRV_OK if successful
+*/
+XsResultValue RawCaptureWriter::create(const XsString& filename)
+{
+	xsens::Lock locky(&m_mutex);
+	if (m_open)
+		return XRV_ALREADYOPEN;
+
+	XsResultValue result = m_file.create(filename);
+	if (result != XRV_OK)
+		return result;
+
+	uint8_t header[headerSize] = {};
+	memcpy(header, captureMagic, sizeof(captureMagic));
+	for (int i = 0; i < 4; ++i)
+		header[sizeof(captureMagic) + i] = (uint8_t) (version >> (8 * i));
+	result = m_file.writeData(XsByteArray(header, headerSize, XSDF_None), nullptr);
+	if (result != XRV_OK)
+	{
+		m_file.closeAndDelete();
+		return result;
+	}
+
+	m_open = true;
+	m_buffer.clear();
+	m_buffer.reserve(writeBlockSize + 8192);
+	m_queue.clear();
+	m_lastTime = XsTime_monotonicUs();
+	m_chunkCount = 0;
+	m_lastResult = XRV_OK;
+	m_queuedEvent.reset();
+	startThread("RawCaptureWriter");
+	return XRV_OK;
+}
+
+/*! \brief Write the remaining records and close the file
+	\details This waits until the background thread has written all full blocks.
+	\returns XRV_OK if all data was written successfully
+*/
+XsResultValue RawCaptureWriter::close()
+{
+	{
+		xsens::Lock locky(&m_mutex);
+		if (!m_open)
+			return XRV_NOFILEOPEN;
+		m_open = false;
+		if (!m_buffer.empty())
+			queueBuffer();
+	}
+
+	stopThread();
+	writeQueued();
+	XsResultValue result = m_file.close();
+
+	xsens::Lock locky(&m_mutex);
+	m_queue.clear();
+	std::vector<uint8_t>().swap(m_buffer);
+	std::vector<std::vector<uint8_t>>().swap(m_spareBuffers);
+	return m_lastResult != XRV_OK ? m_lastResult : result;
+}
+
+//! \returns true if a capture file is open
+bool RawCaptureWriter::isOpen() const
+{
+	xsens::Lock locky(&m_mutex);
+	return m_open;
+}
+
+/*! \brief Add a received chunk to the capture
+	\details The chunk is copied into the current block, full blocks are written by the background thread.
+	\param timeUs The time at which the chunk was received, from XsTime_monotonicUs()
+	\param data The received bytes
+	\param size The number of received bytes
+*/
+void RawCaptureWriter::write(int64_t timeUs, uint8_t const* data, XsSize size)
+{
+	if (!size)
+		return;
+
+	xsens::Lock locky(&m_mutex);
+	if (!m_open)
+		return;
+
+	appendVarint(m_buffer, (uint64_t) (timeUs > m_lastTime ? timeUs - m_lastTime : 0));
+	if (timeUs > m_lastTime)
+		m_lastTime = timeUs;
+	appendVarint(m_buffer, size);
+	m_buffer.insert(m_buffer.end(), data, data + size);
+	++m_chunkCount;
+
+	if (m_buffer.size() >= writeBlockSize)
+		queueBuffer();
+}
+
+/*! \brief Move the current block to the queue of the background thread
+	\details When the queue is full, this waits until the background thread has written a block.
+	\note m_mutex must be locked exactly once by the caller
+*/
+void RawCaptureWriter::queueBuffer()
+{
+	while (m_queue.size() >= maxQueuedBlocks && isAlive() && !isTerminating())
+	{
+		m_writtenEvent.reset();
+		m_mutex.releaseMutex();
+		m_writtenEvent.wait();
+		m_mutex.claimMutex();
+	}
+
+	m_queue.push_back(std::vector<uint8_t>());
+	std::swap(m_queue.back(), m_buffer);
+
+	if (!m_spareBuffers.empty())
+	{
+		std::swap(m_buffer, m_spareBuffers.back());
+		m_spareBuffers.pop_back();
+	}
+	else
+		m_buffer.reserve(writeBlockSize + 8192);
+	m_queuedEvent.set();
+}
+
+//! \brief Write all queued blocks to the file
+void RawCaptureWriter::writeQueued()
+{
+	xsens::Lock writeLock(&m_writeMutex);
+	xsens::Lock locky(&m_mutex);
+	while (!m_queue.empty())
+	{
+		std::vector<uint8_t> block;
+		std::swap(block, m_queue.front());
+		m_queue.pop_front();
+		locky.unlock();
+
+		XsResultValue result = m_file.writeData(XsByteArray(block.data(), block.size(), XSDF_None), nullptr);
+
+		locky.lock();
+		if (result != XRV_OK && m_lastResult == XRV_OK)
+			m_lastResult = result;
+		block.clear();
+		if (m_spareBuffers.size() < maxQueuedBlocks)
+			m_spareBuffers.push_back(std::move(block));
+		m_writtenEvent.set();
+	}
+}
+
+//! \brief Write the queued blocks when the capturing thread signals that a block is available
+int32_t RawCaptureWriter::innerFunction()
+{
+	if (!m_queuedEvent.wait())
+		return 1;
+
+	// reset before taking blocks from the queue, so a block that is queued after the last check sets the event again
+	m_queuedEvent.reset();
+	writeQueued();
+	return 0;
+}
+
+//! \brief Wake up the background thread so it notices that it should stop
+void RawCaptureWriter::signalStopThread(void)
+{
+	StandardThread::signalStopThread();
+	m_queuedEvent.set();
+}
+
+/*! \class RawCaptureReader
+	\sa RawCaptureWriter
+*/
+
+RawCaptureReader::RawCaptureReader()
+	: m_begin(0)
+	, m_end(0)
+	, m_time(0)
+	, m_lastResult(XRV_OK)
+{
+}
+
+RawCaptureReader::~RawCaptureReader()
+{
+	try
+	{
+		close();
+	}
+	catch (...)
+	{
+	}
+}
+
+/*! \brief Open a capture file for reading
+	\param filename The name of the file to open
+	\returns XRV_OK if successful, XRV_DATACORRUPT if the file is not a raw capture file
+*/
+XsResultValue RawCaptureReader::open(const XsString& filename)
+{
+	if (m_file.isOpen())
+		return m_lastResult = XRV_ALREADYOPEN;
+
+	m_lastResult = m_file.open(filename, false, true);
+	if (m_lastResult != XRV_OK)
+		return m_lastResult;
+	m_file.adviseSequentialAccess();
+
+	m_buffer.resize(readBlockSize);
+	m_begin = 0;
+	m_end = 0;
+	m_time = 0;
+
+	bool valid = fill(RawCaptureWriter::headerSize);
+	uint8_t const* header = m_buffer.data();
+	if (valid)
+	{
+		uint32_t fileVersion = header[8] | (header[9] << 8) | (header[10] << 16) | ((uint32_t) header[11] << 24);
+		valid = memcmp(header, captureMagic, sizeof(captureMagic)) == 0 && fileVersion <= RawCaptureWriter::version;
+	}
+	if (!valid)
+	{
+		close();
+		return m_lastResult = XRV_DATACORRUPT;
+	}
+	m_begin = RawCaptureWriter::headerSize;
+	return m_lastResult = XRV_OK;
+}
+
+/*! \brief Close the file */
+void RawCaptureReader::close()
+{
+	if (m_file.isOpen())
+		m_file.close();
+	std::vector<uint8_t>().swap(m_buffer);
+	m_begin = 0;
+	m_end = 0;
+}
+
+//! \returns true if a file is open
+bool RawCaptureReader::isOpen() const
+{
+	return m_file.isOpen();
+}
+
+/*! \brief Make sure that at least \a count unprocessed bytes are in the buffer
+	\param count The number of bytes that are needed
+	\returns false if the file does not contain that many more bytes
+*/
+bool RawCaptureReader::fill(XsSize count)
+{
+	if (m_end - m_begin >= count)
+		return true;
+
+	if (m_begin)
+	{
+		memmove(m_buffer.data(), m_buffer.data() + m_begin, m_end - m_begin);
+		m_end -= m_begin;
+		m_begin = 0;
+	}
+	if (m_buffer.size() < count)
+		m_buffer.resize(count);
+
+	while (m_end < count)
+	{
+		XsFilePos length = 0;
+		XsResultValue result = m_file.readData((XsFilePos) (m_buffer.size() - m_end), m_buffer.data() + m_end, length);
+		if (result != XRV_OK || length <= 0)
+			return false;
+		m_end += (XsSize) length;
+	}
+	return true;
+}
+
+/*! \brief Read an unsigned LEB128 varint
+	\param value Receives the value
+	\returns false if the file ended before the varint was complete
+*/
+bool RawCaptureReader::readVarint(uint64_t& value)
+{
+	value = 0;
+	for (int shift = 0; shift < 64; shift += 7)
+	{
+		if (!fill(1))
+			return false;
+		uint8_t byte = m_buffer[m_begin++];
+		value |= (uint64_t) (byte & 0x7F) << shift;
+		if (!(byte & 0x80))
+			return true;
+	}
+	return false;
+}
+
+/*! \brief Read the next chunk
+	\param timeUs Receives the time at which the chunk was received in microseconds since the start of the capture
+	\param data Receives the bytes of the chunk
+	\returns false at the end of the file, lastResult() is XRV_DATACORRUPT when the last record is incomplete
+*/
+bool RawCaptureReader::readChunk(int64_t& timeUs, XsByteArray& data)
+{
+	if (!m_file.isOpen())
+	{
+		m_lastResult = XRV_NOFILEOPEN;
+		return false;
+	}
+
+	uint64_t delta, size;
+	if (!readVarint(delta))
+	{
+		m_lastResult = (m_begin == m_end) ? XRV_ENDOFFILE : XRV_DATACORRUPT;
+		return false;
+	}
+	if (!readVarint(size) || size > (uint64_t) XS_MAXMSGLEN * 1024 || !fill((XsSize) size))
+	{
+		m_lastResult = XRV_DATACORRUPT;
+		return false;
+	}
+
+	m_time += (int64_t) delta;
+	timeUs = m_time;
+	data.assign((XsSize) size, m_buffer.data() + m_begin);
+	m_begin += (XsSize) size;
+	m_lastResult = XRV_OK;
+	return true;
+}
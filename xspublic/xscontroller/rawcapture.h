@@ -0,0 +1,129 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+#ifndef RAWCAPTURE_H
+#define RAWCAPTURE_H
+
+#include "iointerfacefile.h"
+#include <xscommon/threading.h>
+#include <deque>
+#include <vector>
+
+/*! \brief Writes received data chunks with their time of arrival to a raw capture file
+	\details A capture file starts with a header of headerSize bytes: the 8 byte magic "XSRAWCAP", a 32-bit little
+	endian version and 4 reserved bytes. The header is followed by one record per received chunk: the time since the
+	previous chunk in microseconds and the size of the chunk, both as unsigned LEB128 varints, followed by the bytes
+	of the chunk. The time of the first chunk is relative to the moment the capture was started.
+
+	Writing is thread safe. The records are collected in memory in blocks of writeBlockSize bytes, full blocks are
+	written to the file by a background thread, so capturing does not add a file operation to the thread that reads
+	the port. When the background thread falls more than maxQueuedBlocks blocks behind, the capturing thread waits
+	for it rather than dropping data.
+*/
+class RawCaptureWriter : protected xsens::StandardThread
+{
+public:
+	//! \brief The size of the file header
+	static const XsSize headerSize = 16;
+	//! \brief The version of the format that is written
+	static const uint32_t version = 1;
+	//! \brief The amount of record data at which a block is handed to the background thread
+	static const XsSize writeBlockSize = 64 * 1024;
+	//! \brief The maximum number of full blocks that can wait for the background thread
+	static const XsSize maxQueuedBlocks = 16;
+
+	RawCaptureWriter();
+	~RawCaptureWriter() override;
+
+	XsResultValue create(const XsString& filename);
+	XsResultValue close();
+	bool isOpen() const;
+	void write(int64_t timeUs, uint8_t const* data, XsSize size);
+
+	//! \returns The number of chunks that were written since the file was created
+	inline uint64_t chunkCount() const
+	{
+		return m_chunkCount;
+	}
+
+protected:
+	int32_t innerFunction() override;
+	void signalStopThread(void) override;
+
+private:
+	void queueBuffer();
+	void writeQueued();
+
+	mutable xsens::Mutex m_mutex;		//!< Guards the members below, except m_file
+	IoInterfaceFile m_file;				//!< The capture file, only written by the background thread while it runs
+	bool m_open;						//!< Whether a capture file is open
+	std::vector<uint8_t> m_buffer;		//!< The records that have not been queued yet
+	std::deque<std::vector<uint8_t>> m_queue;			//!< The full blocks that wait for the background thread
+	std::vector<std::vector<uint8_t>> m_spareBuffers;	//!< Buffers of written blocks, kept to reuse their memory
+	int64_t m_lastTime;					//!< The time of the last chunk in microseconds
+	uint64_t m_chunkCount;
+	XsResultValue m_lastResult;			//!< The first error that occurred while writing
+	xsens::Mutex m_writeMutex;			//!< Serializes writing blocks to the file
+	xsens::WaitEvent m_queuedEvent;		//!< Set when a block was added to m_queue
+	xsens::WaitEvent m_writtenEvent;	//!< Set when a block was taken from m_queue and written
+};
+
+/*! \brief Reads the chunks from a raw capture file in order */
+class RawCaptureReader
+{
+public:
+	RawCaptureReader();
+	~RawCaptureReader();
+
+	XsResultValue open(const XsString& filename);
+	void close();
+	bool isOpen() const;
+	bool readChunk(int64_t& timeUs, XsByteArray& data);
+
+	//! \returns The result of the last operation, XRV_ENDOFFILE after the last chunk was read
+	inline XsResultValue lastResult() const
+	{
+		return m_lastResult;
+	}
+
+private:
+	bool fill(XsSize count);
+	bool readVarint(uint64_t& value);
+
+	IoInterfaceFile m_file;
+	std::vector<uint8_t> m_buffer;
+	XsSize m_begin;					//!< The offset of the first unprocessed byte in m_buffer
+	XsSize m_end;					//!< The offset of the end of the data in m_buffer
+	int64_t m_time;					//!< The time of the last chunk in microseconds since the start of the capture
+	XsResultValue m_lastResult;
+};
+
+#endif
@@ -0,0 +1,116 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+
+#include "realtimeprofile.h"
+#include <sstream>
+#include <string.h>
+#include <stdlib.h>
+#if defined(__linux__)
+	#include <sys/mman.h>
+	#include <malloc.h>
+#endif
+
+/*! \brief Return the settings for the next thread
+	\param coreIndex The index in m_cores of the next processor, incremented when a processor is assigned
+	\param priority The real-time priority for the thread
+	\returns The settings for the thread
+*/
+xsens::ThreadRealTimeSettings RealTimeProfile::nextSettings(XsSize& coreIndex, int priority) const
+{
+	int cpu = -1;
+	if (!m_cores.empty())
+		cpu = m_cores[coreIndex++ % m_cores.size()];
+	return xsens::ThreadRealTimeSettings(cpu, priority, m_roundRobin);
+}
+
+/*! \brief Add the result of StandardThread::setRealTimeSettings for thread \a name to the report */
+void RealTimeProfileReport::addThread(char const* name, int result)
+{
+	if (result & xsens::TRR_Pinned)
+		++m_threadsPinned;
+	if (result & xsens::TRR_RealTime)
+		++m_threadsRealTime;
+	if (result & xsens::TRR_Pending)
+		++m_threadsPending;
+	if (result & xsens::TRR_Failed)
+		++m_threadsFailed;
+
+	std::ostringstream os;
+	os << name << ":";
+	if (result == xsens::TRR_None)
+		os << " unchanged";
+	if (result & xsens::TRR_Pinned)
+		os << " pinned";
+	if (result & xsens::TRR_RealTime)
+		os << " real-time";
+	if (result & xsens::TRR_Pending)
+		os << " pending";
+	if (result & xsens::TRR_Failed)
+		os << " failed";
+	m_details += os.str() + "\n";
+}
+
+/*! \brief Apply the memory settings of \a profile to the process
+	\details Locks the memory with mlockall and prefaults the heap. To keep the prefaulted heap available,
+	trimming and mmap based allocations are disabled in the allocator. This is only supported on Linux.
+	\param profile The profile to apply
+	\param report Receives the results
+*/
+void applyRealTimeMemory(RealTimeProfile const& profile, RealTimeProfileReport& report)
+{
+#if defined(__linux__)
+	if (profile.m_lockMemory)
+	{
+		report.m_memoryLocked = (mlockall(MCL_CURRENT | MCL_FUTURE) == 0);
+		report.m_details += report.m_memoryLocked ? "memory: locked\n" : "memory: lock failed\n";
+	}
+
+	if (profile.m_prefaultHeapSize)
+	{
+		mallopt(M_TRIM_THRESHOLD, -1);
+		mallopt(M_MMAP_MAX, 0);
+		char* block = (char*) malloc(profile.m_prefaultHeapSize);
+		if (block)
+		{
+			memset(block, 0, profile.m_prefaultHeapSize);
+			free(block);
+			report.m_prefaultedSize = profile.m_prefaultHeapSize;
+		}
+		std::ostringstream os;
+		os << "heap: prefaulted " << report.m_prefaultedSize << " bytes\n";
+		report.m_details += os.str();
+	}
+#else
+	if (profile.m_lockMemory || profile.m_prefaultHeapSize)
+		report.m_details += "memory: not supported on this platform\n";
+#endif
+}
@@ -0,0 +1,93 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+
+#ifndef REALTIMEPROFILE_H
+#define REALTIMEPROFILE_H
+
+#include <xstypes/xstypesconfig.h>
+#include <xscommon/threading.h>
+#include <string>
+#include <vector>
+
+/*! \brief Settings for running the communication threads with deterministic latency
+	\sa XsControl::applyRealTimeProfile
+*/
+struct RealTimeProfile
+{
+	std::vector<int> m_cores;		//!< The processors to pin the threads to in order of assignment, empty to leave the affinity unchanged
+	int m_pollerPriority;			//!< The real-time priority of the threads that read the ports, 0 to keep the normal scheduling
+	int m_parserPriority;			//!< The real-time priority of the threads that parse the data, 0 to keep the normal scheduling
+	bool m_roundRobin;				//!< Use SCHED_RR instead of SCHED_FIFO
+	bool m_lockMemory;				//!< Lock all current and future memory of the process with mlockall
+	XsSize m_prefaultHeapSize;		//!< The number of bytes of heap to allocate and touch so later allocations do not page fault
+
+	//! \brief Constructor, initializes to a profile that changes nothing
+	RealTimeProfile()
+		: m_pollerPriority(0)
+		, m_parserPriority(0)
+		, m_roundRobin(false)
+		, m_lockMemory(false)
+		, m_prefaultHeapSize(0)
+	{
+	}
+
+	xsens::ThreadRealTimeSettings nextSettings(XsSize& coreIndex, int priority) const;
+};
+
+/*! \brief The result of applying a RealTimeProfile */
+struct RealTimeProfileReport
+{
+	bool m_memoryLocked;			//!< Whether mlockall succeeded
+	XsSize m_prefaultedSize;		//!< The number of bytes of heap that were prefaulted
+	int m_threadsPinned;			//!< The number of threads that were pinned to a processor
+	int m_threadsRealTime;			//!< The number of threads that got a real-time priority
+	int m_threadsPending;			//!< The number of threads that were not running, they get the settings when they start
+	int m_threadsFailed;			//!< The number of threads for which at least one setting could not be applied
+	std::string m_details;			//!< A human readable description of what was applied, one line per item
+
+	//! \brief Constructor, initializes to an empty report
+	RealTimeProfileReport()
+		: m_memoryLocked(false)
+		, m_prefaultedSize(0)
+		, m_threadsPinned(0)
+		, m_threadsRealTime(0)
+		, m_threadsPending(0)
+		, m_threadsFailed(0)
+	{
+	}
+
+	void addThread(char const* name, int result);
+};
+
+void applyRealTimeMemory(RealTimeProfile const& profile, RealTimeProfileReport& report);
+
+#endif
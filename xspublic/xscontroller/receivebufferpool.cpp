@@ -0,0 +1,110 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+
+#include "receivebufferpool.h"
+
+/*! \brief Constructor, creates \a bufferCount buffers with \a bufferSize bytes reserved
+*/
+ReceiveBufferPool::ReceiveBufferPool(XsSize bufferCount, XsSize bufferSize)
+	: m_free(bufferCount)
+	, m_ready(bufferCount)
+	, m_exhausted(0)
+{
+	m_buffers.reserve(bufferCount);
+	for (XsSize i = 0; i < bufferCount; ++i)
+	{
+		ReceiveBuffer* buffer = new ReceiveBuffer;
+		buffer->m_data.reserve(bufferSize);
+		buffer->m_queued = 0;
+		m_buffers.push_back(buffer);
+		m_free.push(buffer);
+	}
+}
+
+/*! \brief Destructor, destroys all buffers, including the ones that are still in use
+*/
+ReceiveBufferPool::~ReceiveBufferPool()
+{
+	for (auto buffer : m_buffers)
+		delete buffer;
+}
+
+/*! \brief Get an empty buffer to fill, called by the producer
+	\returns The buffer or nullptr if all buffers are in use
+*/
+ReceiveBuffer* ReceiveBufferPool::acquire()
+{
+	ReceiveBuffer* buffer = nullptr;
+	if (!m_free.pop(buffer))
+	{
+		m_exhausted.fetch_add(1, std::memory_order_relaxed);
+		return nullptr;
+	}
+	return buffer;
+}
+
+/*! \brief Hand a filled \a buffer to the consumer, called by the producer
+	\details Ownership of the buffer passes to the consumer
+*/
+void ReceiveBufferPool::submit(ReceiveBuffer* buffer)
+{
+	// the ring can hold all buffers, so this never fails
+	m_ready.push(buffer);
+}
+
+/*! \brief Get the next submitted buffer, called by the consumer
+	\returns The buffer or nullptr if no buffer was submitted
+*/
+ReceiveBuffer* ReceiveBufferPool::receive()
+{
+	ReceiveBuffer* buffer = nullptr;
+	m_ready.pop(buffer);
+	return buffer;
+}
+
+/*! \brief Return a processed \a buffer to the pool, called by the consumer
+	\details The data is cleared, but the allocated memory is kept for the next block
+*/
+void ReceiveBufferPool::release(ReceiveBuffer* buffer)
+{
+	buffer->m_data.assign(0, nullptr);
+	m_free.push(buffer);
+}
+
+/*! \brief Release all submitted buffers without processing them, called by the consumer
+*/
+void ReceiveBufferPool::clear()
+{
+	ReceiveBuffer* buffer;
+	while ((buffer = receive()) != nullptr)
+		release(buffer);
+}
@@ -0,0 +1,155 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+
+#ifndef RECEIVEBUFFERPOOL_H
+#define RECEIVEBUFFERPOOL_H
+
+#include <xstypes/xsbytearray.h>
+#include <atomic>
+#include <vector>
+
+/*! \brief A fixed capacity queue for exactly one producer thread and one consumer thread
+	\details push() may only be called by the producer and pop() only by the consumer, neither blocks nor locks.
+	\tparam T The item type, should be cheap to copy
+*/
+template <typename T>
+class SpscRing
+{
+public:
+	/*! \brief Constructor
+		\param capacity The maximum number of items in the queue, rounded up to a power of two
+	*/
+	explicit SpscRing(XsSize capacity)
+		: m_head(0)
+		, m_tail(0)
+	{
+		XsSize size = 1;
+		while (size < capacity)
+			size <<= 1;
+		m_items.resize(size);
+		m_mask = size - 1;
+	}
+
+	/*! \brief Add \a item to the back of the queue
+		\returns false if the queue is full
+	*/
+	bool push(T const& item)
+	{
+		XsSize tail = m_tail.load(std::memory_order_relaxed);
+		if (tail - m_head.load(std::memory_order_acquire) > m_mask)
+			return false;
+		m_items[tail & m_mask] = item;
+		m_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	/*! \brief Remove the item at the front of the queue and store it in \a item
+		\returns false if the queue is empty
+	*/
+	bool pop(T& item)
+	{
+		XsSize head = m_head.load(std::memory_order_relaxed);
+		if (head == m_tail.load(std::memory_order_acquire))
+			return false;
+		item = m_items[head & m_mask];
+		m_head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	//! \returns The number of items in the queue, may be outdated when it is returned
+	XsSize size() const
+	{
+		return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+	}
+
+private:
+	std::vector<T> m_items;			//!< The storage of the items
+	XsSize m_mask;					//!< The capacity minus one
+	std::atomic<XsSize> m_head;		//!< The number of items popped so far, written by the consumer
+	char m_padding[64 - sizeof(std::atomic<XsSize>)];	//!< Padding to keep the producer and consumer indices in separate cache lines
+	std::atomic<XsSize> m_tail;		//!< The number of items pushed so far, written by the producer
+};
+
+/*! \brief A block of received data that is handed from the reading thread to the parsing thread */
+struct ReceiveBuffer
+{
+	XsByteArray m_data;		//!< The received data
+	int64_t m_queued;		//!< The monotonic time in microseconds at which the buffer was submitted, only set when latency tracing is enabled
+};
+
+/*! \class ReceiveBufferPool
+	\brief A fixed set of reusable receive buffers that are passed from a producer thread to a consumer thread
+	\details The producer acquires a free buffer, fills it and submits it. The consumer receives it, processes it
+	and releases it back to the pool. Both directions use an SpscRing, so the handoff neither locks nor copies
+	and after startup no memory is allocated unless a block is larger than the reserved buffer size.
+
+	acquire() and submit() must be called from one producer thread, receive() and release() from one consumer
+	thread, which may be the same thread.
+*/
+class ReceiveBufferPool
+{
+public:
+	ReceiveBufferPool(XsSize bufferCount, XsSize bufferSize);
+	~ReceiveBufferPool();
+
+	ReceiveBuffer* acquire();
+	void submit(ReceiveBuffer* buffer);
+	ReceiveBuffer* receive();
+	void release(ReceiveBuffer* buffer);
+	void clear();
+
+	//! \returns The number of submitted buffers that have not been received yet
+	inline XsSize pending() const
+	{
+		return m_ready.size();
+	}
+
+	//! \returns The total number of buffers in the pool
+	inline XsSize bufferCount() const
+	{
+		return m_buffers.size();
+	}
+
+	//! \returns The number of times acquire() failed because all buffers were in use
+	inline uint64_t exhaustedCount() const
+	{
+		return m_exhausted.load(std::memory_order_relaxed);
+	}
+
+private:
+	std::vector<ReceiveBuffer*> m_buffers;	//!< All buffers, owned by the pool
+	SpscRing<ReceiveBuffer*> m_free;		//!< Buffers that can be acquired, from consumer to producer
+	SpscRing<ReceiveBuffer*> m_ready;		//!< Buffers that have been submitted, from producer to consumer
+	std::atomic<uint64_t> m_exhausted;		//!< The number of failed acquire() calls
+};
+
+#endif
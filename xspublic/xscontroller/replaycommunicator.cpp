@@ -0,0 +1,73 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+#include "replaycommunicator.h"
+
+/*! \brief Constructor
+	\param pacing The speed at which the captured data is replayed
+*/
+ReplayCommunicator::ReplayCommunicator(ReplayPacing pacing)
+	: m_pacing(pacing)
+	, m_replayInterface(nullptr)
+{
+}
+
+ReplayCommunicator::~ReplayCommunicator()
+{
+}
+
+/*! \brief Creates a stream interface that replays the capture file named by the port name of \a pi
+	\param pi The port to use
+	\returns The shared pointer to a stream interface
+*/
+std::shared_ptr<StreamInterface> ReplayCommunicator::createStreamInterface(const XsPortInfo& pi)
+{
+	m_replayInterface = new ReplayStreamInterface(m_pacing);
+	std::shared_ptr<StreamInterface> stream(m_replayInterface,
+		[this](StreamInterface * intf)
+	{
+		m_replayInterface = nullptr;
+		delete intf;
+	}
+	);
+
+	setLastResult(m_replayInterface->open(pi));
+
+	return stream;
+}
+
+/*! \returns true when all captured data has been read from the capture file
+	\note The data that was read last may still be in the parser
+*/
+bool ReplayCommunicator::replayFinished() const
+{
+	return !m_replayInterface || m_replayInterface->endOfCapture();
+}
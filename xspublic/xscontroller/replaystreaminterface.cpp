@@ -0,0 +1,208 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+#include "replaystreaminterface.h"
+#include <xstypes/xsportinfo.h>
+#include <xstypes/xstime.h>
+#include <algorithm>
+
+/*! \brief Constructor
+	\param pacing The speed at which the captured data is returned
+*/
+ReplayStreamInterface::ReplayStreamInterface(ReplayPacing pacing)
+	: m_pacing(pacing)
+	, m_chunkOffset(0)
+	, m_chunkTime(0)
+	, m_chunkValid(false)
+	, m_endOfCapture(false)
+	, m_startTime(0)
+	, m_timeout(0)
+	, m_lastResult(XRV_OK)
+{
+}
+
+ReplayStreamInterface::~ReplayStreamInterface()
+{
+	try
+	{
+		close();
+	}
+	catch (...)
+	{
+	}
+}
+
+/*! \brief Open the capture file named by the port name of \a portInfo
+	\details The replay timing starts at the first call to readData.
+	\param portInfo The port information, the port name is the name of the capture file
+	\param readBufSize Ignored
+	\param writeBufSize Ignored
+	\param options Ignored
+	\returns XRV_OK if successful
+*/
+XsResultValue ReplayStreamInterface::open(const XsPortInfo& portInfo, XsFilePos readBufSize, XsFilePos writeBufSize, PortOptions options)
+{
+	(void) readBufSize;
+	(void) writeBufSize;
+	(void) options;
+
+	xsens::Lock locky(&m_mutex);
+	m_chunkValid = false;
+	m_chunkOffset = 0;
+	m_endOfCapture = false;
+	m_startTime = 0;
+	return m_lastResult = m_reader.open(portInfo.portName());
+}
+
+/*! \brief Close the capture file
+	\returns XRV_OK
+*/
+XsResultValue ReplayStreamInterface::close()
+{
+	xsens::Lock locky(&m_mutex);
+	m_reader.close();
+	m_chunk.clear();
+	m_chunkValid = false;
+	return m_lastResult = XRV_OK;
+}
+
+/*! \brief Does nothing, the captured data is never discarded
+	\returns XRV_OK
+*/
+XsResultValue ReplayStreamInterface::flushData()
+{
+	return m_lastResult = XRV_OK;
+}
+
+//! \returns true if a capture file is open
+bool ReplayStreamInterface::isOpen() const
+{
+	xsens::Lock locky(&m_mutex);
+	return m_reader.isOpen();
+}
+
+//! \returns The result of the last operation
+XsResultValue ReplayStreamInterface::getLastResult() const
+{
+	return m_lastResult;
+}
+
+/*! \brief Discard \a data, there is no device to send it to
+	\param data The data to write
+	\param written When not null, receives the size of \a data
+	\returns XRV_OK if a capture file is open
+*/
+XsResultValue ReplayStreamInterface::writeData(const XsByteArray& data, XsFilePos* written)
+{
+	if (written)
+		*written = 0;
+	if (!isOpen())
+		return m_lastResult = XRV_NOPORTOPEN;
+	if (written)
+		*written = (XsFilePos) data.size();
+	return m_lastResult = XRV_OK;
+}
+
+/*! \brief Return the next captured chunk, or the part of it that fits in \a maxLength
+	\details With RP_Original pacing, no data is returned before the chunk is due. When a timeout is set, the
+	function waits at most that long for the chunk to become due.
+	\param maxLength The maximum number of bytes to return
+	\param data Receives the data
+	\returns XRV_OK if data was returned, XRV_TIMEOUTNODATA if no data is available (yet)
+*/
+XsResultValue ReplayStreamInterface::readData(XsFilePos maxLength, XsByteArray& data)
+{
+	data.clear();
+
+	xsens::Lock locky(&m_mutex);
+	if (!m_reader.isOpen())
+		return m_lastResult = XRV_NOPORTOPEN;
+
+	if (!m_chunkValid)
+	{
+		if (m_endOfCapture || !m_reader.readChunk(m_chunkTime, m_chunk))
+		{
+			m_endOfCapture = true;
+			return m_lastResult = XRV_TIMEOUTNODATA;
+		}
+		m_chunkValid = true;
+		m_chunkOffset = 0;
+	}
+
+	if (m_pacing == RP_Original)
+	{
+		int64_t now = XsTime_monotonicUs();
+		if (!m_startTime)
+			m_startTime = now - m_chunkTime;
+
+		int64_t due = m_startTime + m_chunkTime;
+		if (now < due)
+		{
+			if (!m_timeout || (due - now) > (int64_t) m_timeout * 1000)
+			{
+				if (m_timeout)
+					XsTime_msleep(m_timeout);
+				return m_lastResult = XRV_TIMEOUTNODATA;
+			}
+			XsTime_msleep((uint32_t) ((due - now + 999) / 1000));
+		}
+	}
+
+	XsSize count = std::min<XsSize>((XsSize) maxLength, m_chunk.size() - m_chunkOffset);
+	data.assign(count, m_chunk.data() + m_chunkOffset);
+	m_chunkOffset += count;
+	if (m_chunkOffset >= m_chunk.size())
+		m_chunkValid = false;
+	return m_lastResult = XRV_OK;
+}
+
+/*! \brief Set the time that readData waits for a chunk to become due
+	\param ms The timeout in milliseconds, 0 to never wait
+	\returns XRV_OK
+*/
+XsResultValue ReplayStreamInterface::setTimeout(uint32_t ms)
+{
+	m_timeout = ms;
+	return m_lastResult = XRV_OK;
+}
+
+//! \returns The timeout that readData waits for a chunk to become due
+uint32_t ReplayStreamInterface::getTimeout() const
+{
+	return m_timeout;
+}
+
+//! \returns true when all captured chunks have been returned
+bool ReplayStreamInterface::endOfCapture() const
+{
+	xsens::Lock locky(&m_mutex);
+	return m_endOfCapture;
+}
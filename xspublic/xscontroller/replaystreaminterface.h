@@ -0,0 +1,89 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+#ifndef REPLAYSTREAMINTERFACE_H
+#define REPLAYSTREAMINTERFACE_H
+
+#include "streaminterface.h"
+#include "rawcapture.h"
+#include <xscommon/xsens_mutex.h>
+
+//! \brief The speed at which a ReplayStreamInterface returns the captured data
+enum ReplayPacing {
+	RP_Original = 0,			//!< Return each chunk at the time it was received during the capture
+	RP_AsFastAsPossible = 1		//!< Return each chunk as soon as it is requested
+};
+
+/*! \brief A stream interface that returns the data of a raw capture file instead of reading a port
+	\details Each readData call returns at most one captured chunk, so the data reaches the parser in the same
+	chunks as during the capture. Written data is discarded. When all chunks have been returned, readData keeps
+	returning XRV_TIMEOUTNODATA like an idle port and endOfCapture() becomes true.
+	\sa RawCaptureWriter, ReplayCommunicator
+*/
+class ReplayStreamInterface : public StreamInterface
+{
+public:
+	explicit ReplayStreamInterface(ReplayPacing pacing = RP_Original);
+	~ReplayStreamInterface() override;
+
+	XsResultValue open(const XsPortInfo& portInfo, XsFilePos readBufSize = XS_DEFAULT_READ_BUFFER_SIZE, XsFilePos writeBufSize = XS_DEFAULT_WRITE_BUFFER_SIZE, PortOptions options = PO_XsensDefaults) override;
+	XsResultValue close() override;
+	XsResultValue flushData() override;
+	bool isOpen() const override;
+	XsResultValue getLastResult() const override;
+	XsResultValue writeData(const XsByteArray& data, XsFilePos* written = nullptr) override;
+	XsResultValue readData(XsFilePos maxLength, XsByteArray& data) override;
+	XsResultValue setTimeout(uint32_t ms) override;
+	uint32_t getTimeout() const override;
+
+	bool endOfCapture() const;
+
+	//! \returns The pacing of the replay
+	inline ReplayPacing pacing() const
+	{
+		return m_pacing;
+	}
+
+private:
+	ReplayPacing m_pacing;
+	mutable xsens::Mutex m_mutex;
+	RawCaptureReader m_reader;
+	XsByteArray m_chunk;		//!< The chunk that is being returned
+	XsSize m_chunkOffset;		//!< The number of bytes of m_chunk that have already been returned
+	int64_t m_chunkTime;		//!< The capture time of m_chunk in microseconds
+	bool m_chunkValid;			//!< True when m_chunk holds a chunk that has not been returned completely
+	bool m_endOfCapture;
+	int64_t m_startTime;		//!< The monotonic time at which the replay started, 0 before the first read
+	uint32_t m_timeout;
+	XsResultValue m_lastResult;
+};
+
+#endif
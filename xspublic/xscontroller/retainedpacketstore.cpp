@@ -0,0 +1,849 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+
+#include "retainedpacketstore.h"
+#include "mtdata2items.h"
+#include "xscontrollerconfig.h"
+#include <xstypes/xsmessage.h>
+#include <xscommon/xsens_threadpool.h>
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <string.h>
+#ifndef _WIN32
+	#include <sys/mman.h>
+	#include <unistd.h>
+#endif
+
+/*! \cond XS_INTERNAL */
+/*! \brief The serialized packets of a complete chunk
+	\details The bytes stay valid while a reference exists, also when the chunk is spilled or taken from the store
+	or when the spill file is compacted or closed.
+*/
+class RetainedPacketStore::ChunkBytes
+{
+public:
+	//! \brief Destructor
+	virtual ~ChunkBytes() {}
+
+	//! \returns The serialized packets
+	inline uint8_t const* data() const
+	{
+		return m_data;
+	}
+
+	//! \returns The number of bytes in data()
+	inline XsSize size() const
+	{
+		return m_size;
+	}
+
+protected:
+	//! \brief Constructor
+	ChunkBytes() : m_data(nullptr), m_size(0) {}
+
+	uint8_t const* m_data;		//!< The serialized packets
+	XsSize m_size;				//!< The number of bytes in m_data
+};
+
+namespace
+{
+//! \brief Chunk bytes in a heap buffer
+class HeapChunkBytes : public RetainedPacketStore::ChunkBytes
+{
+public:
+	//! \brief Constructor, takes the contents of \a data
+	explicit HeapChunkBytes(std::vector<uint8_t>& data)
+	{
+		m_buffer.swap(data);
+		m_data = m_buffer.data();
+		m_size = m_buffer.size();
+	}
+
+private:
+	std::vector<uint8_t> m_buffer;	//!< The serialized packets
+};
+
+#ifndef _WIN32
+//! \brief Chunk bytes mapped from the spill file
+class MappedChunkBytes : public RetainedPacketStore::ChunkBytes
+{
+public:
+	/*! \brief Map \a size bytes at \a offset of \a file
+		\returns The mapping or NULL if the file could not be mapped
+	*/
+	static RetainedPacketStore::ChunkBytesPtr map(FILE* file, uint64_t offset, XsSize size)
+	{
+		// the offset of a mapping must be a multiple of the page size
+		uint64_t pageSize = (uint64_t) sysconf(_SC_PAGESIZE);
+		uint64_t mapOffset = offset - offset % pageSize;
+		size_t mapSize = (size_t)(size + (offset - mapOffset));
+		void* map = mmap(nullptr, mapSize, PROT_READ, MAP_SHARED, fileno(file), (off_t) mapOffset);
+		if (map == MAP_FAILED)
+			return RetainedPacketStore::ChunkBytesPtr();
+		return RetainedPacketStore::ChunkBytesPtr(new MappedChunkBytes(map, mapSize, (XsSize)(offset - mapOffset), size));
+	}
+
+	~MappedChunkBytes()
+	{
+		munmap(m_map, m_mapSize);
+	}
+
+private:
+	//! \brief Constructor, takes ownership of mapping \a map
+	MappedChunkBytes(void* map, size_t mapSize, XsSize skip, XsSize size)
+		: m_map(map)
+		, m_mapSize(mapSize)
+	{
+		m_data = (uint8_t const*) map + skip;
+		m_size = size;
+	}
+
+	void* m_map;			//!< The mapping
+	size_t m_mapSize;		//!< The size of the mapping
+};
+#endif
+
+/*! \returns true if all items of \a pack can be written to an MtData2 message */
+bool isSerializable(XsDataPacket const& pack)
+{
+	return !pack.containsGloveData() && !pack.containsGloveSnapshot();
+}
+
+/*! \brief The fixed part of a serialized packet, followed by m_dataSize bytes of MtData2 payload */
+struct RecordHeader
+{
+	int64_t m_packetId;			//!< XsDataPacket::m_packetId
+	int64_t m_toa;				//!< XsDataPacket::m_toa in ms
+	int64_t m_etos;				//!< XsDataPacket::m_etos in ms
+	uint32_t m_dataSize;		//!< The size of the MtData2 payload
+	XsDeviceId m_deviceId;		//!< XsDataPacket::m_deviceId
+};
+
+/*! \brief Write the requested items of the MtData2 payload in \a msg to row \a row of the columns
+	\param found Incremented for each request that was found in the payload
+*/
+void exportRow(XsMessage const& msg, XsColumnRequest* requests, XsSize requestCount, XsSize row, XsSize* found)
+{
+	XsSize sz = msg.getDataSize();
+	XsSize offset = 0;
+	while (offset + 3 <= sz)
+	{
+		XsDataIdentifier id = static_cast<XsDataIdentifier>(XsMessage_getDataShort(&msg, offset));
+		XsSize itemSize = XsMessage_getDataByte(&msg, offset + 2);
+		if (offset + itemSize + 3 > sz)
+			break;
+
+		for (XsSize r = 0; r < requestCount; ++r)
+		{
+			XsColumnRequest& req = requests[r];
+			if ((req.m_id & XDI_FullTypeMask) != (id & XDI_FullTypeMask))
+				continue;
+
+			double values[16];
+			XsSize n = 0;
+			if (MtData2Items::isRealItem(id))
+			{
+				XsSize valueSize = XsMessage_getFPValueSize(id);
+				n = valueSize ? itemSize / valueSize : 0;
+				n = std::min(std::min(n, req.m_components), (XsSize) 16);
+				XsMessage_getDataFPValuesById(&msg, id, values, offset + 3, n);
+			}
+			else if (itemSize == MtData2Items::integerItemSize(id) && req.m_components)
+			{
+				uint64_t v = 0;
+				for (XsSize i = 0; i < itemSize; ++i)
+					v = (v << 8) | XsMessage_getDataByte(&msg, offset + 3 + i);
+				values[0] = (double) v;
+				n = 1;
+			}
+
+			for (XsSize c = 0; c < n; ++c)
+				req.m_data[c * req.m_stride + row] = values[c];
+			if (n)
+				++found[r];
+		}
+		offset += 3 + itemSize;
+	}
+}
+
+/*! \brief Set row \a row of all columns to NaN */
+void clearRow(XsColumnRequest* requests, XsSize requestCount, XsSize row)
+{
+	const double nan = std::numeric_limits<double>::quiet_NaN();
+	for (XsSize r = 0; r < requestCount; ++r)
+		for (XsSize c = 0; c < requests[r].m_components; ++c)
+			requests[r].m_data[c * requests[r].m_stride + row] = nan;
+}
+
+//! \brief A run of consecutive serialized packets in one chunk
+struct ColumnRange
+{
+	uint8_t const* m_data;		//!< The serialized data of the chunk
+	RetainedPacketStore::ChunkBytesPtr m_bytes;	//!< Keeps m_data valid
+	uint32_t const* m_offsets;	//!< The offsets in m_data of the packets of the range
+	XsSize m_count;				//!< The number of packets
+	XsSize m_row;				//!< The output row of the first packet
+};
+}
+
+/*! \brief The packets selected for a column export
+	\details The serialized data of complete chunks is referenced, everything that changes when the store is modified
+	is copied. The snapshot can therefore be exported without holding the lock that guards the store.
+*/
+struct RetainedPacketStore::ColumnSnapshot
+{
+	//! \brief Constructor, creates an empty snapshot
+	ColumnSnapshot() : m_count(0), m_hasPending(false), m_pendingId(0) {}
+
+	std::vector<ColumnRange> m_ranges;		//!< The ranges of serialized packets
+	std::vector<uint32_t> m_offsets;		//!< The packet offsets of all ranges
+	XsSize m_count;							//!< The number of selected packets
+	bool m_hasPending;						//!< Whether the last selected packet is the one that was not serialized yet
+	int64_t m_pendingId;					//!< The packet id of the pending packet
+	std::vector<uint8_t> m_pendingPayload;	//!< The MtData2 payload of the pending packet
+};
+
+namespace
+{
+
+/*! \brief The shared state of a column export
+	\details The ranges are claimed one at a time by the exporting thread and by thread pool tasks. Tasks that
+	start after all ranges have been claimed return without touching the output, so the exporting thread only
+	has to wait for the claimed ranges.
+*/
+struct ColumnExportJob
+{
+	RetainedPacketStore::ColumnSnapshotPtr m_snapshot;	//!< The snapshot with the ranges to export
+	XsColumnRequest* m_requests;			//!< The requests
+	XsSize m_requestCount;					//!< The number of requests
+	int64_t* m_packetIds;					//!< The destination of the packet ids, may be NULL
+	std::atomic<XsSize> m_next;				//!< The index of the next range to claim
+	std::atomic<XsSize> m_remaining;		//!< The number of ranges that have not been completed
+	xsens::Mutex m_mutex;					//!< Guards m_found
+	std::vector<XsSize> m_found;			//!< The number of samples found per request
+	xsens::WaitEvent m_done;				//!< Set when m_remaining reaches 0
+
+	//! \brief Export \a range using scratch message \a msg, counting found items in \a found
+	void exportRange(ColumnRange const& range, XsMessage& msg, XsSize* found)
+	{
+		for (XsSize i = 0; i < range.m_count; ++i)
+		{
+			XsSize row = range.m_row + i;
+			RecordHeader hdr;
+			uint8_t const* rec = range.m_data + range.m_offsets[i];
+			memcpy((void*) &hdr, rec, sizeof(hdr));
+			if (m_packetIds)
+				m_packetIds[row] = hdr.m_packetId;
+
+			clearRow(m_requests, m_requestCount, row);
+			msg.resizeData(hdr.m_dataSize);
+			if (hdr.m_dataSize)
+				msg.setDataBuffer(rec + sizeof(hdr), hdr.m_dataSize, 0);
+			exportRow(msg, m_requests, m_requestCount, row, found);
+		}
+	}
+
+	//! \brief Claim and export ranges until none are left
+	void run()
+	{
+		XsMessage msg(XMID_MtData2);
+		std::vector<XsSize> found(m_requestCount);
+		while (true)
+		{
+			XsSize index = m_next++;
+			if (index >= m_snapshot->m_ranges.size())
+				return;
+
+			std::fill(found.begin(), found.end(), 0);
+			exportRange(m_snapshot->m_ranges[index], msg, found.data());
+			{
+				xsens::Lock lock(&m_mutex);
+				for (XsSize r = 0; r < m_requestCount; ++r)
+					m_found[r] += found[r];
+			}
+			if (--m_remaining == 0)
+				m_done.set();
+		}
+	}
+};
+
+//! \brief A thread pool task that helps with a ColumnExportJob
+class ColumnExportTask : public xsens::ThreadPoolTask
+{
+public:
+	//! \brief Constructor
+	explicit ColumnExportTask(std::shared_ptr<ColumnExportJob> const& job) : m_job(job) {}
+
+	bool exec() override
+	{
+		m_job->run();
+		return true;
+	}
+
+private:
+	std::shared_ptr<ColumnExportJob> m_job;
+};
+}
+/*! \endcond */
+
+/*! \brief Constructor
+	\param packetsPerChunk The number of packets in a complete chunk
+	\param hotChunkCount The number of complete chunks that is kept in memory
+*/
+RetainedPacketStore::RetainedPacketStore(XsSize packetsPerChunk, XsSize hotChunkCount)
+	: m_packetsPerChunk(packetsPerChunk ? packetsPerChunk : 1)
+	, m_hotChunkCount(hotChunkCount)
+	, m_serialized(0)
+	, m_front(0)
+	, m_hasPending(false)
+	, m_pendingHasPayload(false)
+	, m_rejected(0)
+	, m_spillFile(nullptr)
+	, m_spillSize(0)
+	, m_spillUnused(0)
+	, m_readCacheNext(0)
+{
+	for (XsSize i = 0; i < readCacheSize; ++i)
+		m_readCacheOffset[i] = ~0ULL;
+}
+
+/*! \brief Destructor, removes the spill file */
+RetainedPacketStore::~RetainedPacketStore()
+{
+	try
+	{
+		closeSpillFile();
+	}
+	catch (...)
+	{
+	}
+}
+
+/*! \brief Add \a pack to the end of the store
+	\details When \a pack has the same packet id as the newest packet in the store, it is merged into that packet.
+	Packets that cannot be stored in MtData2 format are counted in rejectedCount() and discarded.
+	\param pack The packet to add
+	\param source The MtData2 message that \a pack was created from or NULL. When supplied, its payload is stored
+	instead of serializing \a pack, so it must contain exactly the items of \a pack
+*/
+void RetainedPacketStore::append(XsDataPacket const& pack, XsMessage const* source)
+{
+	bool merge = m_hasPending && m_pending.packetId() == pack.packetId();
+	if ((!source && !isSerializable(pack)) || (merge && m_pendingHasPayload && !isSerializable(m_pending)))
+	{
+		if (m_rejected++ == 0)
+			JLALERTG("Packet " << pack.packetId() << " contains glove data that cannot be retained without its source message, it is discarded");
+		return;
+	}
+
+	if (merge)
+	{
+		m_pending.merge(pack, true);
+		m_pendingHasPayload = false;
+		return;
+	}
+
+	if (m_hasPending)
+		serialize(m_pending, m_pendingHasPayload ? m_pendingPayload.data() : nullptr, m_pendingPayload.size());
+	m_pending = pack;
+	m_hasPending = true;
+	m_pendingHasPayload = source != nullptr;
+	m_pendingPayload.clear();
+	if (source && source->getDataSize())
+		m_pendingPayload.assign(source->getDataBuffer(0), source->getDataBuffer(0) + source->getDataSize());
+}
+
+/*! \brief Return the packet at \a index
+	\param index The index of the packet, 0 is the oldest packet in the store
+	\returns The requested packet or an empty packet if \a index is out of range
+*/
+XsDataPacket RetainedPacketStore::at(XsSize index) const
+{
+	XsSize i = index + m_front;
+	if (i >= m_serialized)
+	{
+		if (m_hasPending && i == m_serialized)
+			return m_pending;
+		return XsDataPacket();
+	}
+
+	Chunk const& chunk = m_chunks[i / m_packetsPerChunk];
+	ChunkBytesPtr bytes;
+	uint8_t const* data = chunkData(chunk, bytes);
+	if (!data)
+		return XsDataPacket();
+
+	RecordHeader hdr;
+	uint8_t const* rec = data + chunk.m_offsets[i % m_packetsPerChunk];
+	memcpy((void*) &hdr, rec, sizeof(hdr));
+
+	m_message.resizeData(hdr.m_dataSize);
+	if (hdr.m_dataSize)
+		m_message.setDataBuffer(rec + sizeof(hdr), hdr.m_dataSize, 0);
+
+	XsDataPacket pack(&m_message);
+	pack.setPacketId(hdr.m_packetId);
+	pack.setTimeOfArrival(XsTimeStamp(hdr.m_toa));
+	pack.setEstimatedTimeOfSampling(XsTimeStamp(hdr.m_etos));
+	pack.setDeviceId(hdr.m_deviceId);
+	return pack;
+}
+
+/*! \brief Export items of the packets in the range [\a first, \a first + \a count) as columns
+	\details This is snapshotColumns() followed by exporting the snapshot.
+	\param first The index of the first packet to export
+	\param count The maximum number of packets to export
+	\param requests The items to export, see XsColumnRequest. m_found is set for each request
+	\param requestCount The number of requests
+	\param packetIds When not NULL this receives the packet id of each exported packet
+	\returns The number of exported packets, this is less than \a count when the store contains fewer packets
+*/
+XsSize RetainedPacketStore::exportColumns(XsSize first, XsSize count, XsColumnRequest* requests, XsSize requestCount, int64_t* packetIds) const
+{
+	return exportColumns(snapshotColumns(first, count), requests, requestCount, packetIds);
+}
+
+/*! \brief Select the packets in the range [\a first, \a first + \a count) for a column export
+	\details This only collects references to the serialized chunks and copies the packet offsets, the packets of the
+	incomplete chunk and the newest packet. The returned snapshot stays valid when the store is modified, so the
+	potentially long export with exportColumns(ColumnSnapshotPtr const&, ...) does not need to hold the lock that
+	guards the store.
+	\param first The index of the first packet to export
+	\param count The maximum number of packets to export
+	\returns The snapshot or NULL if the spill file could not be read
+*/
+RetainedPacketStore::ColumnSnapshotPtr RetainedPacketStore::snapshotColumns(XsSize first, XsSize count) const
+{
+	std::shared_ptr<ColumnSnapshot> snapshot = std::make_shared<ColumnSnapshot>();
+	XsSize total = size();
+	if (first >= total)
+		return snapshot;
+	count = std::min(count, total - first);
+	snapshot->m_count = count;
+
+	// split the serialized packets into ranges of at most rangeSize packets within one chunk
+	const XsSize rangeSize = 1024;
+	XsSize serializedEnd = std::min(first + count, m_serialized - m_front);
+	if (serializedEnd > first)
+		snapshot->m_offsets.resize(serializedEnd - first);
+	for (XsSize row = 0, i = first; i < serializedEnd;)
+	{
+		XsSize abs = i + m_front;
+		Chunk const& chunk = m_chunks[abs / m_packetsPerChunk];
+		XsSize inChunk = abs % m_packetsPerChunk;
+		XsSize n = std::min(std::min(rangeSize, chunk.m_offsets.size() - inChunk), serializedEnd - i);
+		ColumnRange range;
+		uint8_t const* data = chunkData(chunk, range.m_bytes);
+		if (!data)
+			return ColumnSnapshotPtr();
+
+		uint32_t* offsets = &snapshot->m_offsets[row];
+		memcpy(offsets, &chunk.m_offsets[inChunk], n * sizeof(uint32_t));
+		if (!range.m_bytes)
+		{
+			// the incomplete chunk changes with the next append, copy the packets of the range
+			uint32_t begin = offsets[0];
+			XsSize end = (inChunk + n < chunk.m_offsets.size()) ? chunk.m_offsets[inChunk + n] : chunk.m_data.size();
+			std::vector<uint8_t> copy(data + begin, data + end);
+			for (XsSize k = 0; k < n; ++k)
+				offsets[k] -= begin;
+			range.m_bytes = std::make_shared<HeapChunkBytes>(copy);
+			data = range.m_bytes->data();
+		}
+		range.m_data = data;
+		range.m_offsets = offsets;
+		range.m_count = n;
+		range.m_row = row;
+		snapshot->m_ranges.push_back(range);
+		i += n;
+		row += n;
+	}
+
+	if (serializedEnd < first + count)
+	{
+		// the newest packet has not been serialized yet
+		snapshot->m_hasPending = true;
+		snapshot->m_pendingId = m_pending.packetId();
+		if (m_pendingHasPayload)
+			snapshot->m_pendingPayload = m_pendingPayload;
+		else
+		{
+			XsDataPacket_toMessage(&m_pending, &m_message);
+			uint8_t const* payload = m_message.getDataBuffer();
+			snapshot->m_pendingPayload.assign(payload, payload + m_message.getDataSize());
+		}
+	}
+	return snapshot;
+}
+
+/*! \brief Export items of the packets in \a snapshot as columns
+	\details The serialized packets are decoded directly, without creating XsDataPacket objects, so no memory is
+	allocated per packet. Ranges of packets are decoded in parallel by the calling thread and the thread pool.
+	The store that created the snapshot is not accessed, so it does not need to be locked.
+	\param snapshot The packets to export, as returned by snapshotColumns()
+	\param requests The items to export, see XsColumnRequest. m_found is set for each request
+	\param requestCount The number of requests
+	\param packetIds When not NULL this receives the packet id of each exported packet
+	\returns The number of exported packets, 0 when \a snapshot is NULL
+*/
+XsSize RetainedPacketStore::exportColumns(ColumnSnapshotPtr const& snapshot, XsColumnRequest* requests, XsSize requestCount, int64_t* packetIds)
+{
+	for (XsSize r = 0; r < requestCount; ++r)
+		requests[r].m_found = 0;
+	if (!snapshot || !snapshot->m_count)
+		return 0;
+
+	std::shared_ptr<ColumnExportJob> job = std::make_shared<ColumnExportJob>();
+	job->m_snapshot = snapshot;
+	job->m_requests = requests;
+	job->m_requestCount = requestCount;
+	job->m_packetIds = packetIds;
+	job->m_found.assign(requestCount, 0);
+
+	if (!snapshot->m_ranges.empty())
+	{
+		job->m_next = 0;
+		job->m_remaining = snapshot->m_ranges.size();
+		XsSize helpers = std::min((XsSize) xsens::ThreadPool::instance()->poolSize(), snapshot->m_ranges.size() - 1);
+		for (XsSize h = 0; h < helpers; ++h)
+			xsens::ThreadPool::instance()->addTask(new ColumnExportTask(job));
+		job->run();
+		job->m_done.wait();
+	}
+
+	if (snapshot->m_hasPending)
+	{
+		XsSize row = snapshot->m_count - 1;
+		if (packetIds)
+			packetIds[row] = snapshot->m_pendingId;
+		clearRow(requests, requestCount, row);
+		XsMessage msg(XMID_MtData2, snapshot->m_pendingPayload.size());
+		if (!snapshot->m_pendingPayload.empty())
+			msg.setDataBuffer(snapshot->m_pendingPayload.data(), snapshot->m_pendingPayload.size(), 0);
+		exportRow(msg, requests, requestCount, row, job->m_found.data());
+	}
+
+	for (XsSize r = 0; r < requestCount; ++r)
+		requests[r].m_found = job->m_found[r];
+	return snapshot->m_count;
+}
+
+/*! \brief Remove the oldest packet from the store
+	\param pack Receives the removed packet
+	\returns false if the store was empty
+*/
+bool RetainedPacketStore::takeFirst(XsDataPacket& pack)
+{
+	if (empty())
+		return false;
+
+	if (m_front == m_serialized)
+	{
+		pack = m_pending;
+		m_pending.clear();
+		m_hasPending = false;
+		m_pendingHasPayload = false;
+		return true;
+	}
+
+	pack = at(0);
+	++m_front;
+	Chunk const& first = m_chunks.front();
+	if (m_front == first.m_offsets.size())
+	{
+		m_serialized -= m_front;
+		m_front = 0;
+		releaseChunk(first);
+		m_chunks.pop_front();
+		if (m_serialized == 0)
+			closeSpillFile();
+		else if (m_spillUnused >= spillCompactionThreshold && m_spillUnused * 2 > m_spillSize)
+			compactSpillFile();
+	}
+	return true;
+}
+
+/*! \brief Remove all packets from the store and remove the spill file */
+void RetainedPacketStore::clear()
+{
+	m_chunks.clear();
+	m_serialized = 0;
+	m_front = 0;
+	m_pending.clear();
+	m_hasPending = false;
+	m_pendingHasPayload = false;
+	m_pendingPayload.clear();
+	closeSpillFile();
+}
+
+/*! \brief Set the number of complete chunks that is kept in memory
+	\details Chunks that no longer fit are spilled to the spill file immediately.
+	\param count The new number of hot chunks
+*/
+void RetainedPacketStore::setHotChunkCount(XsSize count)
+{
+	m_hotChunkCount = count;
+	spillColdChunks();
+}
+
+/*! \returns The number of bytes in memory used for retained packets, excluding the memory mapped spill file */
+XsSize RetainedPacketStore::memoryUsage() const
+{
+	XsSize total = m_pendingPayload.capacity();
+	for (auto const& chunk : m_chunks)
+	{
+		total += chunk.m_data.capacity() + chunk.m_offsets.capacity() * sizeof(uint32_t);
+		if (chunk.m_bytes)
+			total += chunk.m_bytes->size();
+	}
+#ifdef _WIN32
+	// spilled chunks are read into memory
+	for (XsSize i = 0; i < readCacheSize; ++i)
+		if (m_readCache[i])
+			total += m_readCache[i]->size();
+#endif
+	return total;
+}
+
+/*! \brief Append \a pack to the last chunk, starting a new chunk when necessary
+	\param pack The packet to append
+	\param payload The MtData2 payload of \a pack or NULL to serialize \a pack
+	\param payloadSize The number of bytes in \a payload
+*/
+void RetainedPacketStore::serialize(XsDataPacket const& pack, uint8_t const* payload, XsSize payloadSize)
+{
+	if (!payload)
+	{
+		XsDataPacket_toMessage(&pack, &m_message);
+		payloadSize = m_message.getDataSize();
+		payload = payloadSize ? m_message.getDataBuffer(0) : nullptr;
+	}
+
+	if (m_chunks.empty() || m_chunks.back().m_offsets.size() == m_packetsPerChunk)
+	{
+		m_chunks.push_back(Chunk());
+		Chunk& chunk = m_chunks.back();
+		chunk.m_offsets.reserve(m_packetsPerChunk);
+		chunk.m_fileOffset = 0;
+		chunk.m_size = 0;
+		chunk.m_spilled = false;
+	}
+
+	Chunk& chunk = m_chunks.back();
+	RecordHeader hdr;
+	hdr.m_packetId = pack.packetId();
+	hdr.m_toa = pack.timeOfArrival().msTime();
+	hdr.m_etos = pack.estimatedTimeOfSampling().msTime();
+	hdr.m_dataSize = (uint32_t) payloadSize;
+	hdr.m_deviceId = pack.deviceId();
+
+	chunk.m_offsets.push_back((uint32_t) chunk.m_size);
+	chunk.m_data.resize(chunk.m_size + sizeof(hdr) + hdr.m_dataSize);
+	memcpy(&chunk.m_data[chunk.m_size], (void const*) &hdr, sizeof(hdr));
+	if (hdr.m_dataSize)
+		memcpy(&chunk.m_data[chunk.m_size + sizeof(hdr)], payload, hdr.m_dataSize);
+	chunk.m_size += sizeof(hdr) + hdr.m_dataSize;
+	++m_serialized;
+
+	if (chunk.m_offsets.size() == m_packetsPerChunk)
+	{
+		chunk.m_data.shrink_to_fit();
+		chunk.m_bytes = std::make_shared<HeapChunkBytes>(chunk.m_data);
+		spillColdChunks();
+	}
+}
+
+/*! \brief Spill the oldest complete chunks until at most hotChunkCount() complete chunks are in memory */
+void RetainedPacketStore::spillColdChunks()
+{
+	XsSize hot = 0;
+	for (auto it = m_chunks.rbegin(); it != m_chunks.rend(); ++it)
+	{
+		if (it->m_spilled || it->m_offsets.size() < m_packetsPerChunk)
+			continue;
+		if (++hot > m_hotChunkCount && !spill(*it))
+			return;
+	}
+}
+
+/*! \brief Write \a chunk to the spill file and release its memory
+	\details Exports that still reference the chunk bytes keep them alive until they are done.
+	\returns false if the chunk could not be written, it then stays in memory
+*/
+bool RetainedPacketStore::spill(Chunk& chunk)
+{
+	if (!m_spillFile)
+	{
+		m_spillFile = tmpfile();
+		if (!m_spillFile)
+			return false;
+		m_spillSize = 0;
+		m_spillUnused = 0;
+	}
+
+	if (fseek(m_spillFile, 0, SEEK_END) != 0 ||
+		fwrite(chunk.m_bytes->data(), 1, chunk.m_size, m_spillFile) != chunk.m_size ||
+		fflush(m_spillFile) != 0)
+		return false;
+
+	chunk.m_fileOffset = m_spillSize;
+	chunk.m_spilled = true;
+	m_spillSize += chunk.m_size;
+	chunk.m_bytes.reset();
+	return true;
+}
+
+/*! \brief Returns a pointer to the serialized data of \a chunk, reading it from the spill file when necessary
+	\param chunk The chunk
+	\param bytes Receives the reference that keeps the returned data valid, NULL for the incomplete chunk whose data is
+	only valid until the next append()
+	\returns The data or NULL if the spill file could not be read
+*/
+uint8_t const* RetainedPacketStore::chunkData(Chunk const& chunk, ChunkBytesPtr& bytes) const
+{
+	if (chunk.m_spilled)
+		bytes = readSpilled(chunk.m_fileOffset, chunk.m_size);
+	else
+		bytes = chunk.m_bytes;
+
+	if (bytes)
+		return bytes->data();
+	return chunk.m_spilled ? nullptr : chunk.m_data.data();
+}
+
+/*! \brief Returns the \a size bytes at \a fileOffset of the spill file
+	\details Each chunk is mapped separately, so earlier mappings stay valid. The most recently read chunks are
+	kept in a small cache for repeated lookups. Platforms without mmap read the chunk into memory.
+	\returns The chunk bytes or NULL if the spill file could not be read
+*/
+RetainedPacketStore::ChunkBytesPtr RetainedPacketStore::readSpilled(uint64_t fileOffset, XsSize size) const
+{
+	for (XsSize i = 0; i < readCacheSize; ++i)
+		if (m_readCacheOffset[i] == fileOffset && m_readCache[i])
+			return m_readCache[i];
+
+#ifndef _WIN32
+	ChunkBytesPtr bytes = MappedChunkBytes::map(m_spillFile, fileOffset, size);
+#else
+	std::vector<uint8_t> buffer(size);
+	if (_fseeki64(m_spillFile, (__int64) fileOffset, SEEK_SET) != 0 ||
+		fread(buffer.data(), 1, size, m_spillFile) != size)
+		return ChunkBytesPtr();
+	ChunkBytesPtr bytes = std::make_shared<HeapChunkBytes>(buffer);
+#endif
+	if (!bytes)
+		return bytes;
+
+	m_readCache[m_readCacheNext] = bytes;
+	m_readCacheOffset[m_readCacheNext] = fileOffset;
+	m_readCacheNext = (m_readCacheNext + 1) % readCacheSize;
+	return bytes;
+}
+
+/*! \brief Account for the removal of \a chunk from the store */
+void RetainedPacketStore::releaseChunk(Chunk const& chunk)
+{
+	if (!chunk.m_spilled)
+		return;
+
+	m_spillUnused += chunk.m_size;
+	for (XsSize i = 0; i < readCacheSize; ++i)
+	{
+		if (m_readCacheOffset[i] == chunk.m_fileOffset)
+		{
+			m_readCache[i].reset();
+			m_readCacheOffset[i] = ~0ULL;
+		}
+	}
+}
+
+/*! \brief Copy the spilled chunks that are still in the store to a new spill file
+	\details This releases the disk space of the chunks that have been taken from the store. When the new file cannot
+	be written, the old file is kept.
+*/
+void RetainedPacketStore::compactSpillFile()
+{
+	FILE* file = tmpfile();
+	if (!file)
+		return;
+
+	std::vector<uint64_t> offsets;
+	uint64_t size = 0;
+	for (auto const& chunk : m_chunks)
+	{
+		if (!chunk.m_spilled)
+			continue;
+
+		ChunkBytesPtr bytes = readSpilled(chunk.m_fileOffset, chunk.m_size);
+		if (!bytes || fwrite(bytes->data(), 1, chunk.m_size, file) != chunk.m_size)
+		{
+			fclose(file);
+			return;
+		}
+		offsets.push_back(size);
+		size += chunk.m_size;
+	}
+	if (fflush(file) != 0)
+	{
+		fclose(file);
+		return;
+	}
+
+	auto offset = offsets.begin();
+	for (auto& chunk : m_chunks)
+		if (chunk.m_spilled)
+			chunk.m_fileOffset = *offset++;
+
+	// existing mappings of the old file stay valid after it has been closed
+	closeSpillFile();
+	m_spillFile = file;
+	m_spillSize = size;
+}
+
+/*! \brief Remove the spill file and drop the cached chunks that were read from it */
+void RetainedPacketStore::closeSpillFile()
+{
+	for (XsSize i = 0; i < readCacheSize; ++i)
+	{
+		m_readCache[i].reset();
+		m_readCacheOffset[i] = ~0ULL;
+	}
+	m_readCacheNext = 0;
+
+	if (m_spillFile)
+		fclose(m_spillFile);
+	m_spillFile = nullptr;
+	m_spillSize = 0;
+	m_spillUnused = 0;
+}
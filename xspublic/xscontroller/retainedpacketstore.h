@@ -0,0 +1,169 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+
+#ifndef RETAINEDPACKETSTORE_H
+#define RETAINEDPACKETSTORE_H
+
+#include <xstypes/xsdatapacket.h>
+#include "xscolumnrequest.h"
+#include <vector>
+#include <deque>
+#include <memory>
+#include <stdio.h>
+
+/*! \class RetainedPacketStore
+	\brief Storage for the packets that an XsDevice retains with XSO_RetainLiveData or XSO_RetainBufferedData
+	\details Packets are stored in MtData2 format in chunks of packetsPerChunk() packets. When the MtData2 message
+	that a packet was created from is supplied, its payload is stored as received, otherwise the packet is
+	serialized with XsDataPacket_toMessage. The newest hotChunkCount() complete chunks are kept in memory, older
+	chunks are spilled to an anonymous temporary file from which each chunk is mapped separately for reading. When
+	most of the spill file is occupied by chunks that have been taken from the store, the remaining chunks are
+	copied to a new spill file. The newest packet is kept as an XsDataPacket until a packet with a different packet
+	id arrives, so it can still be merged with late data for the same packet id.
+
+	Packets without a source message that contain items that cannot be written to an MtData2 message, such as
+	glove data, are not retained, see rejectedCount(). The class is not thread-safe, XsDevice guards it with its
+	device mutex. A snapshot made with snapshotColumns() can be exported without holding that mutex.
+*/
+class RetainedPacketStore
+{
+public:
+	//! \brief The default for packetsPerChunk()
+	static const XsSize defaultPacketsPerChunk = 4096;
+	//! \brief The default for hotChunkCount()
+	static const XsSize defaultHotChunkCount = 16;
+	//! \brief The minimum number of unused bytes in the spill file before it is compacted
+	static const uint64_t spillCompactionThreshold = 64 * 1024 * 1024;
+
+	RetainedPacketStore(XsSize packetsPerChunk = defaultPacketsPerChunk, XsSize hotChunkCount = defaultHotChunkCount);
+	~RetainedPacketStore();
+
+	void append(XsDataPacket const& pack, XsMessage const* source = nullptr);
+	XsDataPacket at(XsSize index) const;
+	XsSize exportColumns(XsSize first, XsSize count, XsColumnRequest* requests, XsSize requestCount, int64_t* packetIds) const;
+
+	struct ColumnSnapshot;
+	//! \brief A shared reference to the packets selected for a column export
+	typedef std::shared_ptr<ColumnSnapshot const> ColumnSnapshotPtr;
+	ColumnSnapshotPtr snapshotColumns(XsSize first, XsSize count) const;
+	static XsSize exportColumns(ColumnSnapshotPtr const& snapshot, XsColumnRequest* requests, XsSize requestCount, int64_t* packetIds);
+
+	bool takeFirst(XsDataPacket& pack);
+	void clear();
+
+	//! \returns The number of packets in the store
+	inline XsSize size() const
+	{
+		return m_serialized - m_front + (m_hasPending ? 1 : 0);
+	}
+
+	//! \returns true if the store contains no packets
+	inline bool empty() const
+	{
+		return size() == 0;
+	}
+
+	//! \returns The number of packets per serialized chunk
+	inline XsSize packetsPerChunk() const
+	{
+		return m_packetsPerChunk;
+	}
+
+	//! \returns The number of complete chunks that is kept in memory
+	inline XsSize hotChunkCount() const
+	{
+		return m_hotChunkCount;
+	}
+
+	void setHotChunkCount(XsSize count);
+	XsSize memoryUsage() const;
+
+	//! \returns The size of the spill file in bytes
+	inline XsSize spilledSize() const
+	{
+		return (XsSize) m_spillSize;
+	}
+
+	//! \returns The number of packets that were not retained because they cannot be stored in MtData2 format
+	inline XsSize rejectedCount() const
+	{
+		return m_rejected;
+	}
+
+	class ChunkBytes;
+	//! \brief A shared reference to the serialized packets of a complete chunk
+	typedef std::shared_ptr<ChunkBytes const> ChunkBytesPtr;
+
+private:
+	//! \brief A block of serialized packets
+	struct Chunk
+	{
+		std::vector<uint8_t> m_data;		//!< The serialized packets while the chunk is incomplete
+		std::vector<uint32_t> m_offsets;	//!< The offset of each packet in the chunk
+		ChunkBytesPtr m_bytes;				//!< The serialized packets of a complete chunk in memory, NULL when the chunk is incomplete or spilled
+		uint64_t m_fileOffset;				//!< The offset of the chunk in the spill file, only valid when m_spilled is true
+		XsSize m_size;						//!< The size of the serialized data in bytes
+		bool m_spilled;						//!< Whether the chunk is stored in the spill file
+	};
+
+	void serialize(XsDataPacket const& pack, uint8_t const* payload, XsSize payloadSize);
+	void spillColdChunks();
+	bool spill(Chunk& chunk);
+	uint8_t const* chunkData(Chunk const& chunk, ChunkBytesPtr& bytes) const;
+	ChunkBytesPtr readSpilled(uint64_t fileOffset, XsSize size) const;
+	void releaseChunk(Chunk const& chunk);
+	void compactSpillFile();
+	void closeSpillFile();
+
+	std::deque<Chunk> m_chunks;		//!< The chunks, the last one is the only one that may be incomplete
+	XsSize m_packetsPerChunk;		//!< The number of packets in a complete chunk
+	XsSize m_hotChunkCount;			//!< The number of complete chunks that is kept in memory
+	XsSize m_serialized;			//!< The number of packets in m_chunks, including the ones taken from the front
+	XsSize m_front;					//!< The number of packets that have been taken from the first chunk
+	XsDataPacket m_pending;			//!< The newest packet, not serialized yet
+	bool m_hasPending;				//!< Whether m_pending contains a packet
+	std::vector<uint8_t> m_pendingPayload;	//!< The payload of the source message of m_pending
+	bool m_pendingHasPayload;		//!< Whether m_pendingPayload contains exactly the items of m_pending
+	XsSize m_rejected;				//!< The number of packets that were not retained
+	mutable XsMessage m_message;	//!< Scratch message used for (de)serialization
+
+	//! \brief The number of recently read spilled chunks that is kept mapped
+	static const XsSize readCacheSize = 8;
+	FILE* m_spillFile;				//!< The spill file or NULL if nothing has been spilled
+	uint64_t m_spillSize;			//!< The number of bytes written to m_spillFile
+	uint64_t m_spillUnused;			//!< The number of bytes in m_spillFile of chunks that have been removed
+	mutable ChunkBytesPtr m_readCache[readCacheSize];		//!< Recently read spilled chunks
+	mutable uint64_t m_readCacheOffset[readCacheSize];		//!< The spill file offset of each chunk in m_readCache
+	mutable XsSize m_readCacheNext;							//!< The m_readCache entry to replace next
+};
+
+#endif
@@ -53,6 +53,7 @@
 */
 SerialCommunicator::SerialCommunicator()
 	: m_thread(*this, *this)
+	, m_portId(0)
 	, m_firmwareRevision(0, 0, 0)
 	, m_hardwareRevision(0, 0)
 {
@@ -152,6 +153,34 @@ XsResultValue SerialCommunicator::writeRawData(const XsByteArray& data)
 	return m_streamInterface->writeData(data, nullptr);
 }
 
+/*! \copydoc Communicator::applyRealTimeProfile
+	\details The poller thread and the parser thread each get the next processor. When the port is polled by the
+	PortScheduler, the workers are configured by XsControl::applyRealTimeProfile instead.
+*/
+void SerialCommunicator::applyRealTimeProfile(RealTimeProfile const& profile, XsSize& coreIndex, RealTimeProfileReport& report)
+{
+	if (usesSharedScheduling())
+		return;
+
+	std::string name = portInfo().portName().toStdString();
+	report.addThread((name + " poller").c_str(), m_thread.setRealTimeSettings(profile.nextSettings(coreIndex, profile.m_pollerPriority)));
+	report.addThread((name + " parser").c_str(), setRealTimeSettings(profile.nextSettings(coreIndex, profile.m_parserPriority)));
+}
+
+/*! \copydoc DataParser::startRawCapture
+*/
+XsResultValue SerialCommunicator::startRawCapture(const XsString& filename)
+{
+	return DataParser::startRawCapture(filename);
+}
+
+/*! \copydoc DataParser::stopRawCapture
+*/
+XsResultValue SerialCommunicator::stopRawCapture()
+{
+	return DataParser::stopRawCapture();
+}
+
 /*! \brief Flushes all remaining data on the open port
 */
 void SerialCommunicator::flushPort()
@@ -161,16 +190,30 @@ void SerialCommunicator::flushPort()
 }
 
 /*! \brief Stops polling the thread
+	\details With shared scheduling the port is removed from the PortScheduler instead.
 */
 void SerialCommunicator::stopPollThread()
 {
+	if (m_portId)
+	{
+		PortScheduler::instance()->removePort(m_portId);
+		m_portId = 0;
+		return;
+	}
 	m_thread.stopThread();
 }
 
 /*! \brief Starts polling the thread
+	\details With shared scheduling the port is added to the PortScheduler instead.
 */
 void SerialCommunicator::startPollThread()
 {
+	if (usesSharedScheduling())
+	{
+		if (!m_portId)
+			m_portId = PortScheduler::instance()->addPort([this]() { return m_thread.pollOnce(); });
+		return;
+	}
 	m_thread.startThread();
 }
 /*! \brief Closes the port
@@ -229,6 +272,12 @@ bool SerialCommunicator::openPort(const XsPortInfo& portInfo, OpenPortStage stag
 			m_streamInterface.reset();
 			return false;
 		}
+		// a poll thread that closed the port itself after a disconnect may still be finishing, and any partial
+		// message it left behind belongs to the previous connection, as does the cached state of the device
+		if (m_thread.isTerminating())
+			m_thread.stopThread();
+		messageExtractor().clearBuffer();
+		resetDescriptorState();
 		startPollThread();
 	}
 	if (!m_streamInterface)
@@ -325,7 +374,7 @@ bool SerialCommunicator::reopenPort(OpenPortStage stage, bool skipDeviceIdCheck)
 /*! \returns True if the thread is alive*/
 bool SerialCommunicator::isActive() const
 {
-	return ((masterDevice() != nullptr) && (m_thread.isAlive()));
+	return ((masterDevice() != nullptr) && (m_portId != 0 || m_thread.isAlive()));
 }
 
 /*! \brief Sets do go to config in a thread
@@ -385,6 +434,15 @@ XsResultValue SerialCommunicator::readDataToBuffer(XsByteArray& raw)
 	return res;
 }
 
+/*! \copydoc DataParser::parserMetrics
+	\note Overridden here to count the data in the metrics of the master device
+*/
+DeviceMetrics* SerialCommunicator::parserMetrics() const
+{
+	XsDevice* dev = masterDevice();
+	return dev ? &dev->metrics() : nullptr;
+}
+
 /*! \copybrief Communicator::handleMessage
 	\note Overridden here for implementation of DataParser::handleMessage
 	\param msg The XsMessage to handle
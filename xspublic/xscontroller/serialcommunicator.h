@@ -39,6 +39,7 @@
 #include <xstypes/xsversion.h>
 #include "dataparser.h"
 #include "mtthread.h"
+#include "portscheduler.h"
 
 class SerialCommunicator : public DeviceCommunicator, public DataParser
 {
@@ -59,6 +60,9 @@ public:
 	bool isDockedAt(Communicator* other) const override;
 
 	XsResultValue writeRawData(const XsByteArray& data) override;
+	void applyRealTimeProfile(RealTimeProfile const& profile, XsSize& coreIndex, RealTimeProfileReport& report) override;
+	XsResultValue startRawCapture(const XsString& filename) override;
+	XsResultValue stopRawCapture() override;
 
 	XsVersion firmwareRevision();
 	XsVersion hardwareRevision();
@@ -73,6 +77,7 @@ protected:
 	virtual std::shared_ptr<StreamInterface> createStreamInterface(const XsPortInfo& pi) = 0;
 
 	XsResultValue readDataToBuffer(XsByteArray& raw) override;
+	DeviceMetrics* parserMetrics() const override;
 	XsResultValue processBufferedData(const XsByteArray& rawIn, std::deque<XsMessage>& messages) override;
 
 	bool isActive() const;
@@ -93,6 +98,7 @@ protected:
 
 private:
 	MtThread m_thread;
+	PortScheduler::PortId m_portId;		//!< The id of the port in the PortScheduler, 0 when not scheduled there
 	std::shared_ptr<StreamInterface> m_streamInterface;
 	XsVersion m_firmwareRevision;
 	XsVersion m_hardwareRevision;
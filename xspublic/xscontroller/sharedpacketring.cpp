@@ -0,0 +1,810 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+#include "sharedpacketring.h"
+#include <xstypes/xsdatapacket.h>
+#include <xstypes/xstime.h>
+#include <atomic>
+#include <stddef.h>
+#include <string.h>
+#include <new>
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <signal.h>
+	#include <errno.h>
+	#ifdef __linux__
+		#include <linux/futex.h>
+		#include <sys/syscall.h>
+		#include <time.h>
+	#endif
+#endif
+
+/*! \brief The state of one reader of a shared ring, one cache line in size */
+struct SharedRingReaderSlot
+{
+	std::atomic<uint32_t> m_active;		//!< 1 when the slot is in use
+	uint32_t m_processId;				//!< The id of the process that uses the slot
+	std::atomic<uint64_t> m_position;	//!< The ring position of the next frame that the reader will read
+	std::atomic<uint64_t> m_dropped;	//!< The number of frames that the reader lost because it fell behind
+	char m_padding[40];					//!< Padding to fill the cache line
+};
+
+/*! \brief The header at the start of the shared memory of a ring
+	\details The data area of the ring follows the reader slots. Ring positions only increase, the offset of a
+	position in the data area is the position modulo the capacity. Each record in the data area starts with a
+	RecordHeader and is padded to a multiple of 8 bytes. A record that does not fit before the end of the data area
+	is preceded by a padding record that fills the remaining space, which may be as small as 8 bytes.
+*/
+struct SharedRingHeader
+{
+	char m_magic[8];						//!< "XSSHRING"
+	uint32_t m_version;						//!< The version of the layout
+	uint32_t m_maxReaders;					//!< The number of reader slots
+	uint64_t m_capacity;					//!< The size of the data area, a power of two
+	uint64_t m_dataOffset;					//!< The offset of the data area from the start of the header
+	std::atomic<uint32_t> m_ready;			//!< Set to 1 when the publisher has initialized the header
+	std::atomic<uint32_t> m_closed;			//!< Set to 1 when the publisher has closed the ring
+	char m_padding0[24];
+
+	std::atomic<uint64_t> m_writePosition;	//!< The ring position after the last published record
+	std::atomic<uint64_t> m_oldestPosition;	//!< The ring position of the oldest record that has not been overwritten
+	std::atomic<uint64_t> m_publishedCount;	//!< The number of published frames, the sequence number of the next frame
+	std::atomic<uint64_t> m_oldestSequence;	//!< The sequence number of the first frame at or after m_oldestPosition
+	std::atomic<uint32_t> m_stateVersion;	//!< Odd while the publisher updates the fields above, see SharedRingReader::attach
+	std::atomic<uint32_t> m_wakeSequence;	//!< Incremented for each publication, readers wait on it
+	std::atomic<uint32_t> m_waiters;		//!< The number of readers that are waiting on m_wakeSequence
+	char m_padding1[20];
+
+	SharedRingReaderSlot m_readers[1];		//!< The reader slots, m_maxReaders of them
+};
+
+static_assert(sizeof(SharedRingReaderSlot) == 64, "A reader slot should fill one cache line");
+static_assert(offsetof(SharedRingHeader, m_writePosition) == 64 && offsetof(SharedRingHeader, m_readers) == 128, "The header fields should be cache line aligned");
+
+namespace
+{
+	const char ringMagic[8] = {'X', 'S', 'S', 'H', 'R', 'I', 'N', 'G'};
+	const uint32_t ringVersion = 1;
+
+	//! \brief The types of records in the data area
+	enum RecordType {
+		RT_Padding = 0,		//!< Fills the space up to the end of the data area
+		RT_Frame = 1		//!< A complete MtData2 frame
+	};
+
+	//! \brief The header of a record in the data area, only m_length and m_type are present in padding records
+	struct RecordHeader
+	{
+		uint32_t m_length;		//!< The size of the record including this header and the padding
+		uint32_t m_type;		//!< The RecordType
+		uint32_t m_size;		//!< The size of the frame
+		uint32_t m_sequence;	//!< The number of frames that were published before this one, modulo 2^32
+		uint64_t m_deviceId;	//!< The device id of the device that produced the frame
+		int64_t m_time;			//!< The time of arrival from XsTime_monotonicUs()
+	};
+
+	inline uint64_t align8(uint64_t value)
+	{
+		return (value + 7) & ~(uint64_t) 7;
+	}
+
+	inline XsSize headerSize(uint32_t maxReaders)
+	{
+		return align8(sizeof(SharedRingHeader) + (maxReaders - 1) * sizeof(SharedRingReaderSlot));
+	}
+
+	inline bool processExists(uint32_t processId)
+	{
+#ifdef _WIN32
+		HANDLE process = OpenProcess(SYNCHRONIZE, FALSE, processId);
+		if (!process)
+			return false;
+		bool running = WaitForSingleObject(process, 0) == WAIT_TIMEOUT;
+		CloseHandle(process);
+		return running;
+#else
+		return kill((pid_t) processId, 0) == 0 || errno != ESRCH;
+#endif
+	}
+
+	inline uint32_t currentProcessId()
+	{
+#ifdef _WIN32
+		return (uint32_t) GetCurrentProcessId();
+#else
+		return (uint32_t) getpid();
+#endif
+	}
+
+	/*! \brief Wait until \a word no longer has \a value or \a timeoutMs has passed
+		\details The word lives in shared memory, so the wait is not process-private. Without futexes the function
+		sleeps 1 ms and leaves the retry to the caller.
+	*/
+	void waitOnWord(std::atomic<uint32_t>* word, uint32_t value, uint32_t timeoutMs)
+	{
+#ifdef __linux__
+		struct timespec timeout;
+		timeout.tv_sec = timeoutMs / 1000;
+		timeout.tv_nsec = (long) (timeoutMs % 1000) * 1000000;
+		syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT, value, &timeout, nullptr, 0);
+#else
+		(void) timeoutMs;
+		if (word->load() == value)
+			XsTime_msleep(1);
+#endif
+	}
+
+	//! \brief Wake all threads that wait on \a word
+	void wakeOnWord(std::atomic<uint32_t>* word)
+	{
+#ifdef __linux__
+		syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+#else
+		(void) word;
+#endif
+	}
+}
+
+/*! \class SharedRingMapping
+	\details On POSIX systems the memory is a shm_open object, on Windows a named file mapping backed by the page file.
+*/
+
+SharedRingMapping::SharedRingMapping()
+	: m_data(nullptr)
+	, m_size(0)
+	, m_owner(false)
+#ifdef _WIN32
+	, m_handle(nullptr)
+#endif
+{
+}
+
+SharedRingMapping::~SharedRingMapping()
+{
+	close();
+}
+
+/*! \brief Create a new shared memory object of \a size bytes and map it
+	\details An existing object with the same name is replaced. The object is removed again by close().
+	\param name The name of the object, on POSIX systems a leading '/' is added when it is missing
+	\param size The size of the object
+	\returns XRV_OK if successful
+*/
+XsResultValue SharedRingMapping::create(const XsString& name, XsSize size)
+{
+	if (m_data)
+		return XRV_ALREADYOPEN;
+
+#ifdef _WIN32
+	m_name = name.toStdString();
+	HANDLE handle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, (DWORD) ((uint64_t) size >> 32), (DWORD) size, m_name.c_str());
+	if (!handle)
+		return XRV_OUTPUTCANNOTBEOPENED;
+	void* data = MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0, 0, size);
+	if (!data)
+	{
+		CloseHandle(handle);
+		return XRV_OUTPUTCANNOTBEOPENED;
+	}
+	m_handle = handle;
+#else
+	m_name = name.toStdString();
+	if (m_name.empty() || m_name[0] != '/')
+		m_name.insert(0, "/");
+	shm_unlink(m_name.c_str());
+	int fd = shm_open(m_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+	if (fd < 0)
+		return XRV_OUTPUTCANNOTBEOPENED;
+	if (ftruncate(fd, (off_t) size) != 0)
+	{
+		::close(fd);
+		shm_unlink(m_name.c_str());
+		return XRV_OUTPUTCANNOTBEOPENED;
+	}
+	void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (data == MAP_FAILED)
+	{
+		shm_unlink(m_name.c_str());
+		return XRV_OUTPUTCANNOTBEOPENED;
+	}
+#endif
+	m_data = (uint8_t*) data;
+	m_size = size;
+	m_owner = true;
+	return XRV_OK;
+}
+
+/*! \brief Map an existing shared memory object
+	\param name The name of the object
+	\returns XRV_OK if successful, XRV_NOTFOUND if no object with that name exists
+*/
+XsResultValue SharedRingMapping::open(const XsString& name)
+{
+	if (m_data)
+		return XRV_ALREADYOPEN;
+
+#ifdef _WIN32
+	m_name = name.toStdString();
+	HANDLE handle = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, m_name.c_str());
+	if (!handle)
+		return XRV_NOTFOUND;
+	void* data = MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+	MEMORY_BASIC_INFORMATION info;
+	if (!data || !VirtualQuery(data, &info, sizeof(info)))
+	{
+		if (data)
+			UnmapViewOfFile(data);
+		CloseHandle(handle);
+		return XRV_NOTFOUND;
+	}
+	m_handle = handle;
+	m_size = info.RegionSize;
+#else
+	m_name = name.toStdString();
+	if (m_name.empty() || m_name[0] != '/')
+		m_name.insert(0, "/");
+	int fd = shm_open(m_name.c_str(), O_RDWR, 0);
+	if (fd < 0)
+		return XRV_NOTFOUND;
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size <= 0)
+	{
+		::close(fd);
+		return XRV_NOTFOUND;
+	}
+	void* data = mmap(nullptr, (size_t) info.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (data == MAP_FAILED)
+		return XRV_NOTFOUND;
+	m_size = (XsSize) info.st_size;
+#endif
+	m_data = (uint8_t*) data;
+	m_owner = false;
+	return XRV_OK;
+}
+
+/*! \brief Unmap the memory and remove the object if it was created by this mapping
+	\details Other processes that have the object mapped keep their mapping.
+*/
+void SharedRingMapping::close()
+{
+	if (!m_data)
+		return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(m_data);
+	CloseHandle((HANDLE) m_handle);
+	m_handle = nullptr;
+#else
+	munmap(m_data, m_size);
+	if (m_owner)
+		shm_unlink(m_name.c_str());
+#endif
+	m_data = nullptr;
+	m_size = 0;
+	m_owner = false;
+}
+
+SharedRingPublisher::SharedRingPublisher()
+	: m_header(nullptr)
+	, m_ring(nullptr)
+	, m_mask(0)
+	, m_publishedCount(0)
+{
+}
+
+SharedRingPublisher::~SharedRingPublisher()
+{
+	try
+	{
+		close();
+	}
+	catch (...)
+	{
+	}
+}
+
+/*! \brief Create the shared memory ring
+	\param name The name of the ring, readers attach to it by this name
+	\param capacity The size of the data area in bytes, rounded up to a power of two
+	\param maxReaders The maximum number of readers that can be attached at the same time
+	\returns XRV_OK if successful
+*/
+XsResultValue SharedRingPublisher::create(const XsString& name, XsSize capacity, uint32_t maxReaders)
+{
+	xsens::Lock locky(&m_mutex);
+	if (m_header)
+		return XRV_ALREADYOPEN;
+	if (!maxReaders || capacity < 4096)
+		return XRV_INVALIDPARAM;
+
+	uint64_t ringCapacity = 4096;
+	while (ringCapacity < capacity)
+		ringCapacity <<= 1;
+
+	XsSize dataOffset = headerSize(maxReaders);
+	XsResultValue result = m_mapping.create(name, dataOffset + (XsSize) ringCapacity);
+	if (result != XRV_OK)
+		return result;
+
+	// the memory of a new object is zero filled, so only the non-zero fields need to be set
+	m_header = new (m_mapping.data()) SharedRingHeader;
+	m_header->m_version = ringVersion;
+	m_header->m_maxReaders = maxReaders;
+	m_header->m_capacity = ringCapacity;
+	m_header->m_dataOffset = dataOffset;
+	memcpy(m_header->m_magic, ringMagic, sizeof(ringMagic));
+	m_header->m_ready.store(1, std::memory_order_release);
+
+	m_ring = m_mapping.data() + dataOffset;
+	m_mask = ringCapacity - 1;
+	m_publishedCount = 0;
+	return XRV_OK;
+}
+
+/*! \brief Close the ring
+	\details Attached readers are woken up and see publisherClosed(). They can still read the frames that are in
+	the ring.
+*/
+void SharedRingPublisher::close()
+{
+	xsens::Lock locky(&m_mutex);
+	if (!m_header)
+		return;
+
+	m_header->m_closed.store(1);
+	wakeReaders();
+	m_mapping.close();
+	m_header = nullptr;
+	m_ring = nullptr;
+}
+
+//! \returns true if the ring has been created
+bool SharedRingPublisher::isOpen() const
+{
+	xsens::Lock locky(&m_mutex);
+	return m_header != nullptr;
+}
+
+/*! \brief Publish an MtData2 message
+	\param message The message to publish
+	\param deviceId The id of the device that produced the message, see XsDeviceId::toInt()
+	\returns XRV_OK if successful
+*/
+XsResultValue SharedRingPublisher::publish(const XsMessage& message, uint64_t deviceId)
+{
+	return publish(message.getMessageStart(), message.getTotalMessageSize(), deviceId, XsTime_monotonicUs());
+}
+
+/*! \brief Publish a data packet
+	\details The packet is converted to an MtData2 message. Its device id is stored with the frame.
+	\param packet The packet to publish
+	\returns XRV_OK if successful
+*/
+XsResultValue SharedRingPublisher::publish(const XsDataPacket& packet)
+{
+	XsMessage message = packet.toMessage();
+	return publish(message.getMessageStart(), message.getTotalMessageSize(), packet.deviceId().toInt(), XsTime_monotonicUs());
+}
+
+/*! \brief Publish a complete MtData2 frame
+	\param frame The frame including preamble and checksum
+	\param size The size of the frame
+	\param deviceId The id of the device that produced the frame
+	\param timeOfArrival The time at which the frame was received from XsTime_monotonicUs()
+	\returns XRV_OK if successful, XRV_INVALIDPARAM if the frame does not fit in the ring
+*/
+XsResultValue SharedRingPublisher::publish(uint8_t const* frame, XsSize size, uint64_t deviceId, int64_t timeOfArrival)
+{
+	uint64_t length = align8(sizeof(RecordHeader) + size);
+
+	xsens::Lock locky(&m_mutex);
+	if (!m_header)
+		return XRV_NOFILEOPEN;
+	if (length > (m_mask + 1) / 2)
+		return XRV_INVALIDPARAM;
+
+	uint64_t position = m_header->m_writePosition.load(std::memory_order_relaxed);
+	uint64_t offset = position & m_mask;
+	if (offset + length > m_mask + 1)
+	{
+		uint64_t padding = m_mask + 1 - offset;
+		reserve(position, padding);
+		RecordHeader* pad = reinterpret_cast<RecordHeader*>(m_ring + offset);
+		pad->m_length = (uint32_t) padding;
+		pad->m_type = RT_Padding;
+		position += padding;
+		offset = 0;
+	}
+
+	reserve(position, length);
+	RecordHeader* record = reinterpret_cast<RecordHeader*>(m_ring + offset);
+	record->m_length = (uint32_t) length;
+	record->m_type = RT_Frame;
+	record->m_size = (uint32_t) size;
+	record->m_sequence = (uint32_t) m_publishedCount;
+	record->m_deviceId = deviceId;
+	record->m_time = timeOfArrival;
+	memcpy(record + 1, frame, size);
+
+	++m_publishedCount;
+	beginStateUpdate();
+	m_header->m_publishedCount.store(m_publishedCount, std::memory_order_relaxed);
+	m_header->m_writePosition.store(position + length, std::memory_order_release);
+	endStateUpdate();
+	wakeReaders();
+	return XRV_OK;
+}
+
+/*! \brief Move the oldest position past the records that will be overwritten by \a length bytes at \a position
+	\details The oldest position is updated before the data is overwritten, so a reader that checks it after reading
+	a record knows whether the record was intact.
+	\note The mutex must be locked by the caller
+*/
+void SharedRingPublisher::reserve(uint64_t position, uint64_t length)
+{
+	uint64_t oldest = m_header->m_oldestPosition.load(std::memory_order_relaxed);
+	uint64_t sequence = m_header->m_oldestSequence.load(std::memory_order_relaxed);
+	uint64_t start = oldest;
+	while (position + length - oldest > m_mask + 1)
+	{
+		RecordHeader const* record = reinterpret_cast<RecordHeader const*>(m_ring + (oldest & m_mask));
+		if (record->m_type == RT_Frame)
+			++sequence;
+		oldest += record->m_length;
+	}
+	if (oldest != start)
+	{
+		beginStateUpdate();
+		m_header->m_oldestPosition.store(oldest, std::memory_order_relaxed);
+		m_header->m_oldestSequence.store(sequence, std::memory_order_relaxed);
+		endStateUpdate();
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+	}
+}
+
+/*! \brief Mark the start of an update of the positions and sequence numbers in the header
+	\note The mutex must be locked by the caller
+*/
+void SharedRingPublisher::beginStateUpdate()
+{
+	m_header->m_stateVersion.store(m_header->m_stateVersion.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+}
+
+/*! \brief Mark the end of an update of the positions and sequence numbers in the header
+	\note The mutex must be locked by the caller
+*/
+void SharedRingPublisher::endStateUpdate()
+{
+	m_header->m_stateVersion.store(m_header->m_stateVersion.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+/*! \brief Signal the readers that new data is available
+	\note The mutex must be locked by the caller
+*/
+void SharedRingPublisher::wakeReaders()
+{
+	m_header->m_wakeSequence.fetch_add(1);
+	if (m_header->m_waiters.load())
+		wakeOnWord(&m_header->m_wakeSequence);
+}
+
+//! \returns The maximum number of readers that can be attached
+uint32_t SharedRingPublisher::maxReaders() const
+{
+	xsens::Lock locky(&m_mutex);
+	return m_header ? m_header->m_maxReaders : 0;
+}
+
+//! \returns The number of readers that are currently attached
+uint32_t SharedRingPublisher::readerCount() const
+{
+	xsens::Lock locky(&m_mutex);
+	if (!m_header)
+		return 0;
+	uint32_t count = 0;
+	for (uint32_t i = 0; i < m_header->m_maxReaders; ++i)
+		count += m_header->m_readers[i].m_active.load(std::memory_order_relaxed);
+	return count;
+}
+
+SharedRingReader::SharedRingReader()
+	: m_header(nullptr)
+	, m_ring(nullptr)
+	, m_mask(0)
+	, m_slot(0)
+	, m_position(0)
+	, m_framePosition(0)
+	, m_frameEnd(0)
+	, m_frameSequence(0)
+	, m_frameDeviceId(0)
+	, m_frameTime(0)
+	, m_nextSequence(0)
+	, m_dropped(0)
+{
+}
+
+SharedRingReader::~SharedRingReader()
+{
+	detach();
+}
+
+/*! \brief Attach to the ring with the name \a name
+	\details A reader slot is claimed in the ring. Slots of processes that no longer exist are reused.
+	\param name The name that was passed to SharedRingPublisher::create
+	\param fromOldest When true, reading starts at the oldest frame in the ring instead of at the next new frame
+	\returns XRV_OK if successful, XRV_NOTFOUND if the ring does not exist, XRV_OUTOFMEMORY if all reader slots
+	are in use
+*/
+XsResultValue SharedRingReader::attach(const XsString& name, bool fromOldest)
+{
+	if (m_header)
+		return XRV_ALREADYOPEN;
+
+	XsResultValue result = m_mapping.open(name);
+	if (result != XRV_OK)
+		return result;
+
+	SharedRingHeader* header = reinterpret_cast<SharedRingHeader*>(m_mapping.data());
+	if (m_mapping.size() < sizeof(SharedRingHeader) || !header->m_ready.load(std::memory_order_acquire)
+		|| memcmp(header->m_magic, ringMagic, sizeof(ringMagic)) != 0 || header->m_version != ringVersion
+		|| header->m_dataOffset + header->m_capacity > m_mapping.size())
+	{
+		m_mapping.close();
+		return XRV_DATACORRUPT;
+	}
+
+	uint32_t processId = currentProcessId();
+	for (int pass = 0; pass < 2 && !m_header; ++pass)
+	{
+		for (uint32_t i = 0; i < header->m_maxReaders; ++i)
+		{
+			SharedRingReaderSlot& slot = header->m_readers[i];
+			uint32_t active = slot.m_active.load();
+			// in the second pass, take over the slots of readers that were not detached because their process ended
+			if (active && (pass == 0 || processExists(slot.m_processId)))
+				continue;
+			if (!slot.m_active.compare_exchange_strong(active, 1))
+				continue;
+			slot.m_processId = processId;
+			m_slot = i;
+			m_header = header;
+			break;
+		}
+	}
+	if (!m_header)
+	{
+		m_mapping.close();
+		return XRV_OUTOFMEMORY;
+	}
+
+	m_ring = m_mapping.data() + m_header->m_dataOffset;
+	m_mask = m_header->m_capacity - 1;
+
+	// read a consistent position and sequence number while the publisher may be updating them
+	while (true)
+	{
+		uint32_t version = m_header->m_stateVersion.load(std::memory_order_acquire);
+		m_position = (fromOldest ? m_header->m_oldestPosition : m_header->m_writePosition).load(std::memory_order_relaxed);
+		m_nextSequence = (uint32_t) (fromOldest ? m_header->m_oldestSequence : m_header->m_publishedCount).load(std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (!(version & 1) && m_header->m_stateVersion.load(std::memory_order_relaxed) == version)
+			break;
+	}
+	m_frameEnd = m_framePosition = m_position;
+	m_dropped = 0;
+	m_header->m_readers[m_slot].m_position.store(m_position, std::memory_order_relaxed);
+	m_header->m_readers[m_slot].m_dropped.store(0, std::memory_order_relaxed);
+	return XRV_OK;
+}
+
+/*! \brief Release the reader slot and unmap the ring */
+void SharedRingReader::detach()
+{
+	if (!m_header)
+		return;
+	m_header->m_readers[m_slot].m_active.store(0);
+	m_header = nullptr;
+	m_ring = nullptr;
+	m_mapping.close();
+}
+
+//! \returns true if the reader is attached to a ring
+bool SharedRingReader::isAttached() const
+{
+	return m_header != nullptr;
+}
+
+/*! \brief Wait until a frame is available
+	\param timeoutMs The maximum time to wait in milliseconds
+	\returns true if a frame is available, false on timeout or when the publisher closed the ring and all frames
+	have been read
+*/
+bool SharedRingReader::waitForData(uint32_t timeoutMs)
+{
+	if (!m_header)
+		return false;
+
+	int64_t end = XsTime_monotonicUs() + (int64_t) timeoutMs * 1000;
+	while (true)
+	{
+		m_header->m_waiters.fetch_add(1);
+		uint32_t sequence = m_header->m_wakeSequence.load();
+		bool available = m_header->m_writePosition.load() != m_position;
+		bool closed = m_header->m_closed.load() != 0;
+		if (!available && !closed)
+		{
+			int64_t remaining = end - XsTime_monotonicUs();
+			if (remaining > 0)
+				waitOnWord(&m_header->m_wakeSequence, sequence, (uint32_t) ((remaining + 999) / 1000));
+		}
+		m_header->m_waiters.fetch_sub(1);
+
+		if (available || m_header->m_writePosition.load() != m_position)
+			return true;
+		if (closed || XsTime_monotonicUs() >= end)
+			return false;
+	}
+}
+
+/*! \brief Get the next frame without copying it
+	\details The frame stays in the shared memory, where the publisher may overwrite it when this reader falls
+	behind. Call consumeFrame() after using the frame to find out whether it was intact.
+	\param data Receives a pointer to the frame, including preamble and checksum
+	\param size Receives the size of the frame
+	\returns false if no frame is available
+*/
+bool SharedRingReader::peekFrame(uint8_t const*& data, XsSize& size)
+{
+	if (!m_header)
+		return false;
+
+	while (true)
+	{
+		uint64_t writePosition = m_header->m_writePosition.load(std::memory_order_acquire);
+		if (m_position == writePosition)
+			return false;
+
+		uint64_t oldest = m_header->m_oldestPosition.load(std::memory_order_acquire);
+		if (m_position < oldest)
+		{
+			// the publisher overtook this reader, continue at the oldest intact record
+			m_position = oldest;
+			continue;
+		}
+
+		uint64_t offset = m_position & m_mask;
+		RecordHeader const* record = reinterpret_cast<RecordHeader const*>(m_ring + offset);
+		uint32_t length = record->m_length;
+		uint32_t type = record->m_type;
+		uint32_t frameSize = (type == RT_Frame) ? record->m_size : 0;
+		uint32_t sequence = (type == RT_Frame) ? record->m_sequence : 0;
+		uint64_t deviceId = (type == RT_Frame) ? record->m_deviceId : 0;
+		int64_t time = (type == RT_Frame) ? record->m_time : 0;
+
+		// the record may have been overwritten while reading its header, in which case it must not be used
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (m_header->m_oldestPosition.load(std::memory_order_relaxed) > m_position)
+			continue;
+
+		if (length < 8 || (length & 7) || offset + length > m_mask + 1
+			|| (type == RT_Frame && (length < sizeof(RecordHeader) + frameSize)))
+		{
+			// only possible when the ring is corrupted, skip everything that is currently in it
+			m_position = writePosition;
+			continue;
+		}
+
+		if (type != RT_Frame)
+		{
+			m_position += length;
+			continue;
+		}
+
+		m_framePosition = m_position;
+		m_frameEnd = m_position + length;
+		m_frameSequence = sequence;
+		m_frameDeviceId = deviceId;
+		m_frameTime = time;
+		data = reinterpret_cast<uint8_t const*>(record + 1);
+		size = frameSize;
+		return true;
+	}
+}
+
+/*! \brief Move past the frame returned by peekFrame()
+	\returns true if the frame was intact during the whole time since peekFrame() returned it, false if the publisher
+	overwrote (part of) it and the data must be discarded
+*/
+bool SharedRingReader::consumeFrame()
+{
+	if (!m_header || m_frameEnd == m_framePosition)
+		return false;
+
+	std::atomic_thread_fence(std::memory_order_acquire);
+	bool intact = m_header->m_oldestPosition.load(std::memory_order_relaxed) <= m_framePosition;
+	m_position = m_frameEnd;
+	m_framePosition = m_frameEnd;
+	if (intact)
+	{
+		// frames that were skipped or overwritten show up as a gap in the sequence numbers
+		m_dropped += (uint32_t) (m_frameSequence - m_nextSequence);
+		m_nextSequence = m_frameSequence + 1;
+	}
+
+	SharedRingReaderSlot& slot = m_header->m_readers[m_slot];
+	slot.m_position.store(m_position, std::memory_order_relaxed);
+	slot.m_dropped.store(m_dropped, std::memory_order_relaxed);
+	return intact;
+}
+
+/*! \brief Read the next data packet
+	\details The frame is decoded straight from the shared memory. Frames that were overwritten while they were
+	decoded are skipped.
+	\param packet Receives the packet, with the device id that was published with it
+	\returns false if no packet is available
+*/
+bool SharedRingReader::readDataPacket(XsDataPacket& packet)
+{
+	uint8_t const* data;
+	XsSize size;
+	while (peekFrame(data, size))
+	{
+		bool valid = m_message.loadFromString(data, size);
+		if (!consumeFrame() || !valid)
+			continue;
+
+		packet.setMessage(m_message);
+		packet.setDeviceId(XsDeviceId(m_frameDeviceId));
+		return true;
+	}
+	return false;
+}
+
+//! \returns The number of frames that this reader lost because the publisher overwrote them
+uint64_t SharedRingReader::droppedCount() const
+{
+	return m_dropped;
+}
+
+//! \returns true if the publisher has closed the ring
+bool SharedRingReader::publisherClosed() const
+{
+	return !m_header || m_header->m_closed.load() != 0;
+}
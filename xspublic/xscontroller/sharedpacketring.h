@@ -0,0 +1,185 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+#ifndef SHAREDPACKETRING_H
+#define SHAREDPACKETRING_H
+
+#include <xstypes/xsmessage.h>
+#include <xstypes/xsstring.h>
+#include <xstypes/xsresultvalue.h>
+#include <xscommon/xsens_mutex.h>
+#include <string>
+
+struct XsDataPacket;
+struct SharedRingHeader;
+
+/*! \brief The mapping of a named shared memory object into the address space of this process */
+class SharedRingMapping
+{
+public:
+	SharedRingMapping();
+	~SharedRingMapping();
+
+	XsResultValue create(const XsString& name, XsSize size);
+	XsResultValue open(const XsString& name);
+	void close();
+
+	//! \returns The start of the mapped memory or nullptr if nothing is mapped
+	inline uint8_t* data() const
+	{
+		return m_data;
+	}
+
+	//! \returns The size of the mapped memory
+	inline XsSize size() const
+	{
+		return m_size;
+	}
+
+private:
+	SharedRingMapping(SharedRingMapping const&) = delete;
+	SharedRingMapping& operator=(SharedRingMapping const&) = delete;
+
+	uint8_t* m_data;
+	XsSize m_size;
+	bool m_owner;			//!< True when the object was created by this mapping and should be removed when it is closed
+	std::string m_name;
+#ifdef _WIN32
+	void* m_handle;
+#endif
+};
+
+/*! \brief Publishes MtData2 frames into a shared memory ring that can be read by other processes
+	\details The ring has a single writer and up to maxReaders() readers that each keep their own read cursor in the
+	shared memory. The publisher never waits for readers: a reader that falls more than the ring capacity behind
+	loses the oldest frames, which it counts in SharedRingReader::droppedCount().
+
+	Publishing is thread safe, so one ring can be shared by several devices. Each frame is stored with the id of
+	the device that produced it and its time of arrival.
+	\sa SharedRingReader, XsDevice::setSharedRingPublisher
+*/
+class SharedRingPublisher
+{
+public:
+	//! \brief The default capacity of the ring in bytes
+	static const XsSize defaultCapacity = 4 * 1024 * 1024;
+	//! \brief The default maximum number of readers
+	static const uint32_t defaultMaxReaders = 16;
+
+	SharedRingPublisher();
+	~SharedRingPublisher();
+
+	XsResultValue create(const XsString& name, XsSize capacity = defaultCapacity, uint32_t maxReaders = defaultMaxReaders);
+	void close();
+	bool isOpen() const;
+
+	XsResultValue publish(const XsMessage& message, uint64_t deviceId);
+	XsResultValue publish(const XsDataPacket& packet);
+	XsResultValue publish(uint8_t const* frame, XsSize size, uint64_t deviceId, int64_t timeOfArrival);
+
+	uint32_t maxReaders() const;
+	uint32_t readerCount() const;
+
+	//! \returns The number of frames that were published
+	inline uint64_t publishedCount() const
+	{
+		return m_publishedCount;
+	}
+
+private:
+	void reserve(uint64_t position, uint64_t length);
+	void beginStateUpdate();
+	void endStateUpdate();
+	void wakeReaders();
+
+	mutable xsens::Mutex m_mutex;
+	SharedRingMapping m_mapping;
+	SharedRingHeader* m_header;
+	uint8_t* m_ring;			//!< The start of the data area of the ring
+	uint64_t m_mask;			//!< The capacity of the ring minus one
+	uint64_t m_publishedCount;
+};
+
+/*! \brief Reads the frames that a SharedRingPublisher in another process writes into a shared memory ring
+	\details Frames are read directly from the shared memory. A frame returned by peekFrame() can be overwritten by
+	the publisher at any time, so it must be released with consumeFrame(), which reports whether the frame was still
+	intact. readDataPacket() does this internally and only returns intact packets.
+
+	A reader must only be used by one thread at a time.
+*/
+class SharedRingReader
+{
+public:
+	SharedRingReader();
+	~SharedRingReader();
+
+	XsResultValue attach(const XsString& name, bool fromOldest = false);
+	void detach();
+	bool isAttached() const;
+
+	bool waitForData(uint32_t timeoutMs);
+	bool peekFrame(uint8_t const*& data, XsSize& size);
+	bool consumeFrame();
+	bool readDataPacket(XsDataPacket& packet);
+
+	//! \returns The device id of the frame returned by peekFrame()
+	inline uint64_t frameDeviceId() const
+	{
+		return m_frameDeviceId;
+	}
+
+	//! \returns The time of arrival of the frame returned by peekFrame(), in microseconds from XsTime_monotonicUs()
+	inline int64_t frameTimeOfArrival() const
+	{
+		return m_frameTime;
+	}
+
+	uint64_t droppedCount() const;
+	bool publisherClosed() const;
+
+private:
+	SharedRingMapping m_mapping;
+	SharedRingHeader* m_header;
+	uint8_t const* m_ring;
+	uint64_t m_mask;
+	uint32_t m_slot;			//!< The index of the reader slot of this reader in the header
+	uint64_t m_position;		//!< The ring position of the next frame to read
+	uint64_t m_framePosition;	//!< The ring position of the frame returned by peekFrame()
+	uint64_t m_frameEnd;		//!< The ring position after the frame returned by peekFrame()
+	uint32_t m_frameSequence;	//!< The sequence number of the frame returned by peekFrame()
+	uint64_t m_frameDeviceId;
+	int64_t m_frameTime;
+	uint32_t m_nextSequence;	//!< The sequence number of the next frame that this reader expects
+	uint64_t m_dropped;
+	XsMessage m_message;		//!< Scratch message for readDataPacket
+};
+
+#endif
@@ -0,0 +1,91 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+#include "socketcommunicator.h"
+#include "socketstreaminterface.h"
+
+namespace
+{
+//! \brief The maximum time in ms that the receive loop waits on the socket when no data is available
+const uint32_t receiveWaitTime = 10;
+}
+
+/*! \brief Constructs a new SocketCommunicator
+*/
+Communicator* SocketCommunicator::construct()
+{
+	return new SocketCommunicator;
+}
+
+/*! Default constructor
+*/
+SocketCommunicator::SocketCommunicator()
+	: m_socketInterface(nullptr)
+{
+}
+
+SocketCommunicator::~SocketCommunicator()
+{
+}
+
+/*! \brief Creates a stream interface that connects to the device server named by the port name of \a pi
+	\param pi The port to use
+	\returns The shared pointer to a stream interface
+*/
+std::shared_ptr<StreamInterface> SocketCommunicator::createStreamInterface(const XsPortInfo& pi)
+{
+	m_socketInterface = new SocketStreamInterface();
+	std::shared_ptr<StreamInterface> stream(m_socketInterface,
+		[this](StreamInterface * intf)
+	{
+		m_socketInterface = nullptr;
+		delete intf;
+	}
+	);
+
+	setLastResult(m_socketInterface->open(pi, 65536, 65536));
+
+	return stream;
+}
+
+/*! \brief Read the available data, waiting briefly on the socket when there is none
+	\details The wait is only done for non-blocking reads, when the stream has a timeout it already waited.
+	\param raw A buffer that will receive the read data
+	\returns The result of the operation
+*/
+XsResultValue SocketCommunicator::readDataToBuffer(XsByteArray& raw)
+{
+	XsResultValue res = SerialCommunicator::readDataToBuffer(raw);
+	if (res == XRV_TIMEOUT && m_socketInterface && m_socketInterface->getTimeout() == 0
+		&& m_socketInterface->waitForSocket(false, receiveWaitTime) == XRV_OK)
+		res = SerialCommunicator::readDataToBuffer(raw);
+	return res;
+}
@@ -0,0 +1,62 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+#ifndef SOCKETCOMMUNICATOR_H
+#define SOCKETCOMMUNICATOR_H
+
+#include "serialcommunicator.h"
+
+class SocketStreamInterface;
+
+/*! \brief A communicator for devices behind a serial-to-Ethernet device server
+	\details The port name is a <tt>tcp://</tt> or <tt>udp://</tt> URL, see SocketStreamInterface. The device
+	server must be configured with the baud rate of the device, the baud rate in the port info is not used.
+
+	When no data is available, the receive loop waits on the socket for a short while before it falls back to its
+	normal idle sleep, so data that arrives while the device streams is parsed immediately instead of after the next
+	poll interval.
+*/
+class SocketCommunicator : public SerialCommunicator
+{
+public:
+	static Communicator* construct();
+	SocketCommunicator();
+
+protected:
+	~SocketCommunicator() override;
+	std::shared_ptr<StreamInterface> createStreamInterface(const XsPortInfo& pi) override;
+	XsResultValue readDataToBuffer(XsByteArray& raw) override;
+
+private:
+	SocketStreamInterface* m_socketInterface;	//!< The interface created by createStreamInterface, owned by SerialCommunicator
+};
+
+#endif
@@ -0,0 +1,387 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+#include "socketstreaminterface.h"
+#include <xstypes/xsportinfo.h>
+#include <string>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+	#include <winsock2.h>
+	#include <ws2tcpip.h>
+#else
+	#include <sys/types.h>
+	#include <sys/socket.h>
+	#include <netinet/in.h>
+	#include <netinet/tcp.h>
+	#include <fcntl.h>
+	#include <errno.h>
+#endif
+
+#ifndef MSG_NOSIGNAL
+	#define MSG_NOSIGNAL 0
+#endif
+
+namespace
+{
+//! \returns True if the last socket error only indicates that the operation would block
+bool wouldBlock()
+{
+#ifdef _WIN32
+	return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+	return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
+/*! \brief Parse a port number
+	\returns False if \a text is not a number in the range 1-65535
+*/
+bool parsePort(std::string const& text, uint16_t& port)
+{
+	if (text.empty() || text.size() > 5 || text.find_first_not_of("0123456789") != std::string::npos)
+		return false;
+	unsigned long value = strtoul(text.c_str(), nullptr, 10);
+	if (value == 0 || value > 65535)
+		return false;
+	port = (uint16_t) value;
+	return true;
+}
+}
+
+/*! \brief Constructor, the interface must be opened before it can be used */
+SocketStreamInterface::SocketStreamInterface()
+	: m_socket(nullptr)
+	, m_descriptor(0)
+	, m_protocol(IP_TCP)
+	, m_timeout(0)
+	, m_lastResult(XRV_OK)
+{
+}
+
+SocketStreamInterface::~SocketStreamInterface()
+{
+	try
+	{
+		close();
+	}
+	catch (...)
+	{
+	}
+}
+
+/*! \returns True if \a portName is a URL that can be opened by a SocketStreamInterface
+	\param portName The port name to check
+*/
+bool SocketStreamInterface::isSocketUrl(const XsString& portName)
+{
+	return strncmp(portName.c_str(), "tcp://", 6) == 0 || strncmp(portName.c_str(), "udp://", 6) == 0;
+}
+
+/*! \brief Split a port URL into its parts
+	\param url The URL, see the class description for the format
+	\param protocol Receives the protocol
+	\param host Receives the host name or address, without brackets
+	\param port Receives the remote port
+	\param localPort Receives the local UDP port, 0 if it is not specified
+	\returns False if \a url is not a valid port URL
+*/
+bool SocketStreamInterface::parseUrl(const XsString& url, IpProtocol& protocol, XsString& host, uint16_t& port, uint16_t& localPort)
+{
+	if (!isSocketUrl(url))
+		return false;
+
+	std::string rest = std::string(url.c_str()).substr(6);
+	protocol = (url.c_str()[0] == 't') ? IP_TCP : IP_UDP;
+	localPort = 0;
+
+	std::string::size_type query = rest.find('?');
+	if (query != std::string::npos)
+	{
+		std::string option = rest.substr(query + 1);
+		rest.resize(query);
+		if (protocol != IP_UDP || option.compare(0, 6, "local=") != 0 || !parsePort(option.substr(6), localPort))
+			return false;
+	}
+
+	std::string hostName;
+	std::string::size_type colon;
+	if (!rest.empty() && rest[0] == '[')
+	{
+		std::string::size_type close = rest.find(']');
+		if (close == std::string::npos || close + 1 >= rest.size() || rest[close + 1] != ':')
+			return false;
+		hostName = rest.substr(1, close - 1);
+		colon = close + 1;
+	}
+	else
+	{
+		colon = rest.rfind(':');
+		if (colon == std::string::npos)
+			return false;
+		hostName = rest.substr(0, colon);
+	}
+
+	if (hostName.empty() || (rest[0] != '[' && hostName.find(':') != std::string::npos))
+		return false;
+	if (!parsePort(rest.substr(colon + 1), port))
+		return false;
+
+	host = XsString(hostName);
+	return true;
+}
+
+/*! \brief Connect to the device server named by the port name of \a portInfo
+	\param portInfo The port information, the port name is a URL as described in the class description
+	\param readBufSize The size of the receive buffer of the socket, 0 to use the system default
+	\param writeBufSize Ignored
+	\param options Ignored, the serial settings are configured in the device server
+	\returns XRV_OK if successful, XRV_INVALIDPARAM if the port name is not a valid URL
+*/
+XsResultValue SocketStreamInterface::open(const XsPortInfo& portInfo, XsFilePos readBufSize, XsFilePos writeBufSize, PortOptions options)
+{
+	(void) writeBufSize;
+	(void) options;
+
+	if (isOpen())
+		return m_lastResult = XRV_ALREADYOPEN;
+
+	IpProtocol protocol;
+	XsString host;
+	uint16_t port = 0;
+	uint16_t localPort = 0;
+	if (!parseUrl(portInfo.portName(), protocol, host, port, localPort))
+		return m_lastResult = XRV_INVALIDPARAM;
+
+	XsSocket* socket = new XsSocket(protocol, strchr(host.c_str(), ':') ? NLP_IPV6 : NLP_IPV4);
+	XSOCKET sd = socket->nativeDescriptor();
+	if (readBufSize > 0)
+	{
+		int size = (int) readBufSize;
+		(void)setsockopt(sd, SOL_SOCKET, SO_RCVBUF, (char const*)&size, sizeof(size));
+	}
+
+	XsResultValue res = XRV_OK;
+	if (localPort)
+	{
+		socket->setSocketOption(XSO_ReuseAddress, 1);
+		res = socket->bind(localPort);
+	}
+	if (res == XRV_OK)
+		res = socket->connect(host, port);
+	if (res != XRV_OK)
+	{
+		delete socket;
+		return m_lastResult = res;
+	}
+
+	if (protocol == IP_TCP)
+	{
+		int one = 1;
+		(void)setsockopt(sd, IPPROTO_TCP, TCP_NODELAY, (char const*)&one, sizeof(one));
+	}
+#ifdef _WIN32
+	u_long nonBlocking = 1;
+	(void)ioctlsocket(sd, FIONBIO, &nonBlocking);
+#else
+	(void)fcntl(sd, F_SETFL, fcntl(sd, F_GETFL, 0) | O_NONBLOCK);
+#ifdef SO_NOSIGPIPE
+	int one = 1;
+	(void)setsockopt(sd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+#endif
+
+	xsens::Lock locky(&m_writeMutex);
+	m_socket = socket;
+	m_descriptor = sd;
+	m_protocol = protocol;
+	return m_lastResult = XRV_OK;
+}
+
+/*! \brief Close the connection
+	\returns XRV_OK
+*/
+XsResultValue SocketStreamInterface::close()
+{
+	xsens::Lock locky(&m_writeMutex);
+	delete m_socket;
+	m_socket = nullptr;
+	m_descriptor = 0;
+	return m_lastResult = XRV_OK;
+}
+
+/*! \brief Discard the data that was received but not read yet
+	\returns XRV_OK if successful
+*/
+XsResultValue SocketStreamInterface::flushData()
+{
+	if (!isOpen())
+		return m_lastResult = XRV_NOPORTOPEN;
+
+	char buffer[4096];
+	while (recv(m_descriptor, buffer, sizeof(buffer), 0) > 0)
+	{
+	}
+	return m_lastResult = XRV_OK;
+}
+
+//! \returns true if the interface is connected
+bool SocketStreamInterface::isOpen() const
+{
+	return m_socket != nullptr;
+}
+
+//! \returns The result of the last operation
+XsResultValue SocketStreamInterface::getLastResult() const
+{
+	return m_lastResult;
+}
+
+/*! \brief Wait until the socket can be read from or written to
+	\param forWriting True to wait until the socket can be written to, false to wait for received data
+	\param timeout The maximum time to wait in ms
+	\returns XRV_OK if the socket is ready, XRV_TIMEOUT if it is not or XRV_UNEXPECTED_DISCONNECT if the socket failed
+*/
+XsResultValue SocketStreamInterface::waitForSocket(bool forWriting, uint32_t timeout)
+{
+	if (!isOpen())
+		return XRV_NOPORTOPEN;
+
+	int ready = 0;
+	int rv = forWriting ? m_socket->select((int) timeout, nullptr, &ready) : m_socket->select((int) timeout, &ready, nullptr);
+	if (rv < 0)
+		return XRV_UNEXPECTED_DISCONNECT;
+	return ready ? XRV_OK : XRV_TIMEOUT;
+}
+
+/*! \brief Send \a data to the device server
+	\details When the socket buffer is full the function waits at most the timeout for space to become available.
+	\param data The data to write
+	\param written When not null, receives the number of bytes that were sent
+	\returns XRV_OK if all data was sent
+*/
+XsResultValue SocketStreamInterface::writeData(const XsByteArray& data, XsFilePos* written)
+{
+	if (written)
+		*written = 0;
+
+	xsens::Lock locky(&m_writeMutex);
+	if (!isOpen())
+		return m_lastResult = XRV_NOPORTOPEN;
+
+	XsSize sent = 0;
+	while (sent < data.size())
+	{
+		int rv = (int) send(m_descriptor, (char const*)data.data() + sent, (int)(data.size() - sent), MSG_NOSIGNAL);
+		if (rv > 0)
+		{
+			sent += (XsSize) rv;
+			continue;
+		}
+		if (rv < 0 && !wouldBlock())
+		{
+			m_lastResult = XRV_UNEXPECTED_DISCONNECT;
+			break;
+		}
+		m_lastResult = waitForSocket(true, m_timeout);
+		if (m_lastResult != XRV_OK)
+			break;
+	}
+
+	if (written)
+		*written = (XsFilePos) sent;
+	if (sent == data.size())
+		m_lastResult = XRV_OK;
+	return m_lastResult;
+}
+
+/*! \brief Read the data that the device server sent
+	\details With a timeout of 0 this is a single non-blocking receive call, otherwise the function waits at most
+	the timeout for data to arrive. A UDP read returns at most one datagram.
+	\param maxLength The maximum number of bytes to read
+	\param data Receives the data
+	\returns XRV_OK if data was read, XRV_TIMEOUT if no data was available or XRV_UNEXPECTED_DISCONNECT if the
+	device server closed the connection
+*/
+XsResultValue SocketStreamInterface::readData(XsFilePos maxLength, XsByteArray& data)
+{
+	if (!isOpen())
+	{
+		data.clear();
+		return m_lastResult = XRV_NOPORTOPEN;
+	}
+
+	data.setSize((XsSize) maxLength);
+	int rv = (int) recv(m_descriptor, (char*)data.data(), (int) maxLength, 0);
+	if (rv < 0 && wouldBlock() && m_timeout)
+	{
+		XsResultValue res = waitForSocket(false, m_timeout);
+		if (res == XRV_OK)
+			rv = (int) recv(m_descriptor, (char*)data.data(), (int) maxLength, 0);
+		else if (res != XRV_TIMEOUT)
+		{
+			data.clear();
+			return m_lastResult = res;
+		}
+	}
+
+	if (rv > 0)
+	{
+		data.pop_back((XsSize)(maxLength - rv));
+		return m_lastResult = XRV_OK;
+	}
+
+	data.clear();
+	if (rv < 0 && wouldBlock())
+		return m_lastResult = XRV_TIMEOUT;
+
+	// an empty TCP read means the device server closed the connection, an empty datagram carries no data
+	if (rv == 0 && m_protocol == IP_UDP)
+		return m_lastResult = XRV_TIMEOUT;
+	return m_lastResult = XRV_UNEXPECTED_DISCONNECT;
+}
+
+/*! \brief Set the time that readData and writeData wait for the socket
+	\param ms The timeout in milliseconds, 0 for non-blocking operation
+	\returns XRV_OK
+*/
+XsResultValue SocketStreamInterface::setTimeout(uint32_t ms)
+{
+	m_timeout = ms;
+	return m_lastResult = XRV_OK;
+}
+
+//! \returns The timeout that readData and writeData wait for the socket
+uint32_t SocketStreamInterface::getTimeout() const
+{
+	return m_timeout;
+}
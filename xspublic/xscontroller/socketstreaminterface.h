@@ -0,0 +1,80 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+#ifndef SOCKETSTREAMINTERFACE_H
+#define SOCKETSTREAMINTERFACE_H
+
+#include "streaminterface.h"
+#include <xstypes/xssocket.h>
+#include <xscommon/xsens_mutex.h>
+
+/*! \brief A stream interface that talks to a device through a serial-to-Ethernet device server
+	\details The port name is a URL of the form <tt>tcp://host:port</tt> or <tt>udp://host:port</tt>, optionally
+	followed by <tt>?local=port</tt> for UDP to receive on a fixed local port. IPv6 addresses must be enclosed in
+	brackets, e.g. <tt>tcp://[fe80::1]:4001</tt>.
+
+	The socket is non-blocking and TCP sockets have Nagle's algorithm disabled, so short commands are sent
+	immediately. With a timeout of 0, readData() is a single receive call that returns whatever the socket has
+	buffered, which fits the polling receive loop of the SerialCommunicator.
+	\sa SocketCommunicator
+*/
+class SocketStreamInterface : public StreamInterface
+{
+public:
+	SocketStreamInterface();
+	~SocketStreamInterface() override;
+
+	static bool isSocketUrl(const XsString& portName);
+	static bool parseUrl(const XsString& url, IpProtocol& protocol, XsString& host, uint16_t& port, uint16_t& localPort);
+
+	XsResultValue open(const XsPortInfo& portInfo, XsFilePos readBufSize = XS_DEFAULT_READ_BUFFER_SIZE, XsFilePos writeBufSize = XS_DEFAULT_WRITE_BUFFER_SIZE, PortOptions options = PO_XsensDefaults) override;
+	XsResultValue close() override;
+	XsResultValue flushData() override;
+	bool isOpen() const override;
+	XsResultValue getLastResult() const override;
+	XsResultValue writeData(const XsByteArray& data, XsFilePos* written = nullptr) override;
+	XsResultValue readData(XsFilePos maxLength, XsByteArray& data) override;
+	XsResultValue setTimeout(uint32_t ms) override;
+	uint32_t getTimeout() const override;
+
+	XsResultValue waitForSocket(bool forWriting, uint32_t timeout);
+
+private:
+
+	mutable xsens::Mutex m_writeMutex;	//!< Serializes writes, reads are only done by the receive thread
+	XsSocket* m_socket;
+	XSOCKET m_descriptor;				//!< The native descriptor of m_socket
+	IpProtocol m_protocol;
+	uint32_t m_timeout;
+	XsResultValue m_lastResult;
+};
+
+#endif
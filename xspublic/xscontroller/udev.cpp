@@ -71,6 +71,13 @@ void Udev::initLibrary()
 		m_uDev.device_get_devnode = (uDEV_device_get_devnode*)m_libraryLoader->resolve("udev_device_get_devnode");
 		m_uDev.device_get_parent_with_subsystem_devtype = (uDEV_device_get_parent_with_subsystem_devtype*)m_libraryLoader->resolve("udev_device_get_parent_with_subsystem_devtype");
 		m_uDev.device_get_sysattr_value = (uDEV_device_get_sysattr_value*)m_libraryLoader->resolve("udev_device_get_sysattr_value");
+		m_uDev.device_get_action = (uDEV_device_get_action*)m_libraryLoader->resolve("udev_device_get_action");
+		m_uDev.monitor_new_from_netlink = (uDEV_monitor_new_from_netlink*)m_libraryLoader->resolve("udev_monitor_new_from_netlink");
+		m_uDev.monitor_filter_add_match_subsystem_devtype = (uDEV_monitor_filter_add_match_subsystem_devtype*)m_libraryLoader->resolve("udev_monitor_filter_add_match_subsystem_devtype");
+		m_uDev.monitor_enable_receiving = (uDEV_monitor_enable_receiving*)m_libraryLoader->resolve("udev_monitor_enable_receiving");
+		m_uDev.monitor_get_fd = (uDEV_monitor_get_fd*)m_libraryLoader->resolve("udev_monitor_get_fd");
+		m_uDev.monitor_receive_device = (uDEV_monitor_receive_device*)m_libraryLoader->resolve("udev_monitor_receive_device");
+		m_uDev.monitor_unref = (uDEV_monitor_unref*)m_libraryLoader->resolve("udev_monitor_unref");
 	}
 }
 
@@ -296,3 +303,113 @@ const char* Udev::device_get_sysattr_value(struct udev_device* udev_device, cons
 	else
 		return "";
 }
+
+/*! \brief Get the action of a device received from a monitor, such as "add" or "remove"
+
+	\param udev_device udev device
+
+	\return the kernel action value, or NULL if there is no action value available.
+*/
+const char* Udev::device_get_action(struct udev_device* udev_device)
+{
+	if (m_uDev.device_get_action)
+		return m_uDev.device_get_action(udev_device);
+	else
+		return NULL;
+}
+
+/*! \brief Create a new udev monitor and connect it to a specified event source.
+
+	Applications should usually not connect directly to the "kernel" events, because the devices might not be usable
+	at that time, before udev has configured them and created the device nodes. Use the "udev" name instead.
+
+	The initial refcount is 1, and needs to be decremented to release the resources of the udev monitor.
+
+	\param udev udev library context
+	\param name name of event source
+	\return a new udev monitor, or NULL in case of an error
+*/
+udev_monitor* Udev::monitor_new_from_netlink(struct udev* udev, const char* name)
+{
+	if (m_uDev.monitor_new_from_netlink)
+		return m_uDev.monitor_new_from_netlink(udev, name);
+	else
+		return NULL;
+}
+
+/*! \brief Filter events by subsystem and devtype in the kernel
+
+	This filter is efficiently executed inside the kernel, and libudev subscribers will usually not be woken up
+	for devices which do not match. The filter must be installed before the monitor is switched to listening mode.
+
+	\param udev_monitor the monitor
+	\param subsystem the subsystem value to match the incoming devices against
+	\param devtype the devtype value to match the incoming devices against, NULL matches any devtype
+	\return 0 on success, otherwise a negative error value.
+*/
+int Udev::monitor_filter_add_match_subsystem_devtype(struct udev_monitor* udev_monitor, const char* subsystem, const char* devtype)
+{
+	if (m_uDev.monitor_filter_add_match_subsystem_devtype)
+		return m_uDev.monitor_filter_add_match_subsystem_devtype(udev_monitor, subsystem, devtype);
+	else
+		return -1;
+}
+
+/*! \brief Binds the udev monitor socket to the event source.
+
+	\param udev_monitor the monitor which should receive events
+	\return 0 on success, otherwise a negative error value.
+*/
+int Udev::monitor_enable_receiving(struct udev_monitor* udev_monitor)
+{
+	if (m_uDev.monitor_enable_receiving)
+		return m_uDev.monitor_enable_receiving(udev_monitor);
+	else
+		return -1;
+}
+
+/*! \brief Retrieve the socket file descriptor associated with the monitor.
+
+	\param udev_monitor the monitor
+	\return the socket file descriptor, or a negative value in case of an error
+*/
+int Udev::monitor_get_fd(struct udev_monitor* udev_monitor)
+{
+	if (m_uDev.monitor_get_fd)
+		return m_uDev.monitor_get_fd(udev_monitor);
+	else
+		return -1;
+}
+
+/*! \brief Receive data from the udev monitor socket, allocate a new udev device, fill in the received data, and return the device.
+
+	Only socket connections with uid=0 are accepted. The monitor socket is non-blocking by default, so poll() the
+	file descriptor of the monitor before calling this function.
+
+	The initial refcount is 1, and needs to be decremented to release the resources of the udev device.
+
+	\param udev_monitor udev monitor
+	\return a new udev device, or NULL in case of an error
+*/
+udev_device* Udev::monitor_receive_device(struct udev_monitor* udev_monitor)
+{
+	if (m_uDev.monitor_receive_device)
+		return m_uDev.monitor_receive_device(udev_monitor);
+	else
+		return NULL;
+}
+
+/*! \brief Drop a reference of a udev monitor.
+
+	If the refcount reaches zero, the bound socket will be closed, and the resources of the monitor will be released.
+
+	\param udev_monitor udev monitor
+	\return NULL
+*/
+udev_monitor* Udev::monitor_unref(struct udev_monitor* udev_monitor)
+{
+	if (m_uDev.monitor_unref)
+		return m_uDev.monitor_unref(udev_monitor);
+	else
+		return NULL;
+}
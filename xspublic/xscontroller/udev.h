@@ -37,6 +37,7 @@ struct udev;
 struct udev_device;
 struct udev_enumerate;
 struct udev_list_entry;
+struct udev_monitor;
 
 struct XsLibraryLoader;
 
@@ -55,6 +56,13 @@ typedef struct udev_device* uDEV_device_get_parent(struct udev_device* udev_devi
 typedef const char* uDEV_device_get_devnode(struct udev_device* udev_device);
 typedef struct udev_device* uDEV_device_get_parent_with_subsystem_devtype(struct udev_device* udev_device, const char* subsystem, const char* devtype);
 typedef const char* uDEV_device_get_sysattr_value(struct udev_device* udev_device, const char* sysattr);
+typedef const char* uDEV_device_get_action(struct udev_device* udev_device);
+typedef struct udev_monitor* uDEV_monitor_new_from_netlink(struct udev* udev, const char* name);
+typedef int uDEV_monitor_filter_add_match_subsystem_devtype(struct udev_monitor* udev_monitor, const char* subsystem, const char* devtype);
+typedef int uDEV_monitor_enable_receiving(struct udev_monitor* udev_monitor);
+typedef int uDEV_monitor_get_fd(struct udev_monitor* udev_monitor);
+typedef struct udev_device* uDEV_monitor_receive_device(struct udev_monitor* udev_monitor);
+typedef struct udev_monitor* uDEV_monitor_unref(struct udev_monitor* udev_monitor);
 
 #ifdef __cplusplus
 class Udev
@@ -78,6 +86,13 @@ public:
 	uDEV_device_get_devnode device_get_devnode;
 	uDEV_device_get_parent_with_subsystem_devtype device_get_parent_with_subsystem_devtype;
 	uDEV_device_get_sysattr_value device_get_sysattr_value;
+	uDEV_device_get_action device_get_action;
+	uDEV_monitor_new_from_netlink monitor_new_from_netlink;
+	uDEV_monitor_filter_add_match_subsystem_devtype monitor_filter_add_match_subsystem_devtype;
+	uDEV_monitor_enable_receiving monitor_enable_receiving;
+	uDEV_monitor_get_fd monitor_get_fd;
+	uDEV_monitor_receive_device monitor_receive_device;
+	uDEV_monitor_unref monitor_unref;
 
 private:
 
@@ -98,6 +113,13 @@ private:
 		uDEV_device_get_devnode* device_get_devnode;
 		uDEV_device_get_parent_with_subsystem_devtype* device_get_parent_with_subsystem_devtype;
 		uDEV_device_get_sysattr_value* device_get_sysattr_value;
+		uDEV_device_get_action* device_get_action;
+		uDEV_monitor_new_from_netlink* monitor_new_from_netlink;
+		uDEV_monitor_filter_add_match_subsystem_devtype* monitor_filter_add_match_subsystem_devtype;
+		uDEV_monitor_enable_receiving* monitor_enable_receiving;
+		uDEV_monitor_get_fd* monitor_get_fd;
+		uDEV_monitor_receive_device* monitor_receive_device;
+		uDEV_monitor_unref* monitor_unref;
 	} m_uDev;
 
 	XsLibraryLoader* m_libraryLoader;
@@ -34,6 +34,8 @@
 #include "mtbfilecommunicator.h"
 #include "serialportcommunicator.h"
 #include "usbcommunicator.h"
+#include "socketcommunicator.h"
+#include "socketstreaminterface.h"
 
 namespace CommunicatorType
 {
@@ -41,6 +43,7 @@ static const CommunicatorFactory::CommunicatorTypeId UNKNOWN    = 0;
 static const CommunicatorFactory::CommunicatorTypeId MTBFILE    = 1;
 static const CommunicatorFactory::CommunicatorTypeId USB        = 2;
 static const CommunicatorFactory::CommunicatorTypeId SERIALPORT = 3;
+static const CommunicatorFactory::CommunicatorTypeId SOCKET     = 4;
 }
 
 /*! \class XdaCommunicatorFactory
@@ -83,12 +86,20 @@ bool isUsb(const XsPortInfo& portInfo)
 	return portInfo.isUsb();
 }
 
+/*! \returns True if a \a portInfo is a tcp:// or udp:// URL of a device server
+	\param portInfo The port info to check
+*/
+bool isSocket(const XsPortInfo& portInfo)
+{
+	return SocketStreamInterface::isSocketUrl(portInfo.portName());
+}
+
 /*! \returns True if a \a portInfo is a serial port
 	\param portInfo The port info to check
 */
 bool isSerialPort(const XsPortInfo& portInfo)
 {
-	return !portInfo.isUsb() && !portInfo.isNetwork() && !portInfo.isBluetooth();
+	return !portInfo.isUsb() && !portInfo.isNetwork() && !portInfo.isBluetooth() && !isSocket(portInfo);
 }
 }
 
@@ -98,4 +109,5 @@ void XdaCommunicatorFactory::registerCommunicatorTypes()
 	(void)registerType(CommunicatorType::MTBFILE, &MtbFileCommunicator::construct, nullptr);
 	(void)registerType(CommunicatorType::SERIALPORT, &SerialPortCommunicator::construct, &isSerialPort);
 	(void)registerType(CommunicatorType::USB, &UsbCommunicator::construct, &isUsb);
+	(void)registerType(CommunicatorType::SOCKET, &SocketCommunicator::construct, &isSocket);
 }
@@ -0,0 +1,69 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+#ifndef XSCOLUMNREQUEST_H
+#define XSCOLUMNREQUEST_H
+
+#include "xscontrollerconfig.h"
+#include <xstypes/xsdataidentifier.h>
+
+#ifndef __cplusplus
+#define XSCOLUMNREQUEST_INITIALIZER	{ XDI_None, 0, 0, 0, 0 }
+typedef struct XsColumnRequest XsColumnRequest;
+#endif
+
+/*! \brief A request to export one data item as columns, used by XsDevice::exportDataColumns
+	\details Each component of the item gets its own contiguous column of doubles, so for XDI_Acceleration with
+	m_components 3 the x, y and z values of all samples end up in three consecutive arrays. Component \a c of
+	sample \a i is written to m_data[c * m_stride + i]. Samples that do not contain the item are set to NaN.
+*/
+struct XsColumnRequest
+{
+	XsDataIdentifier m_id;		//!< The item to export, the format bits are ignored
+	XsSize m_components;		//!< The number of components to export, for example 4 for XDI_Quaternion
+	double* m_data;				//!< The destination, this must have room for m_components * m_stride values
+	XsSize m_stride;			//!< The distance between the starts of two component columns, at least the number of samples
+	XsSize m_found;				//!< Set to the number of exported samples that contained the item
+
+#ifdef __cplusplus
+	//! \brief Constructs a request for \a components columns of item \a id in \a data, with columns \a stride values apart
+	explicit XsColumnRequest(XsDataIdentifier id = XDI_None, XsSize components = 0, double* data = 0, XsSize stride = 0)
+		: m_id(id)
+		, m_components(components)
+		, m_data(data)
+		, m_stride(stride)
+		, m_found(0)
+	{
+	}
+#endif
+};
+
+#endif
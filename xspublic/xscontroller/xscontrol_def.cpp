@@ -40,6 +40,8 @@
 
 #include "proxycommunicator.h"
 #include "restorecommunication.h"
+#include "hotplugreconnector.h"
+#include "devicedescriptorcache.h"
 
 #include <xstypes/xsversion.h>
 
@@ -56,6 +58,7 @@
 #include <xstypes/xssyncsettingarray.h>
 #include "broadcastdevice.h"
 #include "idfetchhelpers.h"
+#include "portscheduler.h"
 
 using namespace xsens;
 using namespace XsMath;
@@ -94,6 +97,15 @@ using namespace XsMath;
 			chaining is still done.
 */
 
+/*! \fn XsControl::setCallbackHandlerFilter(XsCallbackPlainC* cb, XsDataIdentifier const* ids, XsSize count, bool chain = true)
+	\brief Restrict the data packets delivered to a handler to the items in \a ids
+	\param cb The handler to set the filter for, it must have been added with addCallbackHandler()
+	\param ids The data identifiers to deliver, matched using XDI_FullTypeMask
+	\param count The number of items in \a ids, supply 0 to remove the filter
+	\param chain When set to true (default) the filter is applied to connected devices as well
+	\note Only the data callbacks are filtered, log files and other handlers still receive complete packets.
+*/
+
 /*! \fn XsControl::broadcast() const
 	\brief Returns the broadcast device
 	\details The broadcast device can be used to apply an operation to all connected devices at once (if
@@ -117,12 +129,14 @@ XsControl::XsControl()
 	, m_deviceFactory(new DeviceFactory)
 	, m_communicatorFactory(new XdaCommunicatorFactory)
 	, m_restoreCommunication(nullptr)
+	, m_hotplugReconnector(nullptr)
 {
 	m_communicatorFactory->registerCommunicatorTypes();
 	m_deviceFactory->registerDevices();
 
 	m_broadcaster = new BroadcastDevice(this);
 	m_restoreCommunication = new RestoreCommunication(this);
+	m_hotplugReconnector = new HotplugReconnector(this);
 }
 
 
@@ -134,6 +148,8 @@ XsControl::~XsControl()
 {
 	try
 	{
+		delete m_hotplugReconnector;
+		m_hotplugReconnector = nullptr;
 		close();
 		delete m_broadcaster;
 		delete m_restoreCommunication;
@@ -279,6 +295,39 @@ void XsControl::flushInputBuffers()
 	}
 }
 
+/*! \brief Apply a real-time execution profile to the communication threads
+	\details Pins the poller and parser threads of all open ports to the processors in RealTimeProfile::m_cores,
+	in the order in which the ports were opened, and gives them a real-time scheduling priority. When the
+	PortScheduler is enabled, its workers are configured instead. Threads that are not running yet get their
+	settings when they start. Additionally the memory of the process can be locked and the heap prefaulted.
+
+	Real-time priorities usually require elevated privileges (CAP_SYS_NICE or an rtprio limit on Linux), the
+	returned report shows what was actually applied.
+	\param profile The profile to apply
+	\returns A report of the applied settings
+*/
+RealTimeProfileReport XsControl::applyRealTimeProfile(RealTimeProfile const& profile)
+{
+	JLDEBUGG("");
+	XSEXITLOGD(gJournal);
+
+	RealTimeProfileReport report;
+	applyRealTimeMemory(profile, report);
+
+	XsSize coreIndex = 0;
+	if (PortScheduler::isEnabled())
+		PortScheduler::instance()->applyRealTimeProfile(profile, coreIndex, report);
+
+	std::set<Communicator*> done;
+	for (auto dev : m_deviceList)
+	{
+		Communicator* comm = dev->communicator();
+		if (comm && done.insert(comm).second)
+			comm->applyRealTimeProfile(profile, coreIndex, report);
+	}
+	return report;
+}
+
 /*! \brief Get the number of connected devices.
 	\returns The number of connected devices
 */
@@ -515,6 +564,67 @@ void XsControl::stopRestoreCommunication()
 	m_restoreCommunication->stop();
 }
 
+/*! \brief Automatically reconnect master devices that are unplugged and plugged back in
+	\details When a device returns, its port is reopened, its output configuration is restored and measurement is
+	restarted if it was measuring. The XsDevice object stays valid during the outage.
+	\param useUdev When true (default) the ports are monitored through udev, otherwise the hot-plug events must be
+	supplied through hotplugReconnector()->handleEvent()
+	\returns XRV_OK if the reconnector was started, XRV_UNSUPPORTED if udev is not available
+	\sa HotplugReconnector
+*/
+XsResultValue XsControl::startHotplugReconnect(bool useUdev)
+{
+	return m_hotplugReconnector->start(useUdev);
+}
+
+/*! \brief Stop reconnecting devices that are plugged back in
+*/
+void XsControl::stopHotplugReconnect()
+{
+	m_hotplugReconnector->stop();
+}
+
+/*! \returns The object that reconnects returning devices, for statistics and for supplying hot-plug events
+*/
+HotplugReconnector* XsControl::hotplugReconnector() const
+{
+	return m_hotplugReconnector;
+}
+
+/*! \brief Cache the static replies of devices in \a directory to speed up opening them
+	\details The product code, hardware version, configuration, output configuration and filter profiles that a device
+	reports while its port is opened are stored per device id. When the device is opened again with the same firmware
+	revision, these are taken from the cache instead of being requested. Only ports that are opened after this call
+	use the cache.
+	\param directory The directory that contains the cache files, it must exist. An empty string disables the cache.
+	\returns XRV_OK if successful, otherwise the reason why the directory could not be written
+	\sa DeviceDescriptorCache
+*/
+XsResultValue XsControl::setDescriptorCacheDirectory(const XsString& directory)
+{
+	if (directory.empty())
+	{
+		m_descriptorCache.reset();
+		return XRV_OK;
+	}
+
+	std::shared_ptr<DeviceDescriptorCache> cache = std::make_shared<DeviceDescriptorCache>(directory);
+	XsResultValue res = cache->store(0, DeviceDescriptorCache::Descriptors());
+	if (res != XRV_OK)
+		return res;
+	cache->remove(0);
+
+	m_descriptorCache = cache;
+	return XRV_OK;
+}
+
+/*! \returns The cache of device initialization replies, for its statistics. Empty when the cache is disabled.
+*/
+std::shared_ptr<DeviceDescriptorCache> XsControl::descriptorCache() const
+{
+	return m_descriptorCache;
+}
+
 /*! \brief Test if the given \a deviceId is docked
 
 	Only wireless devices can be regarded as docked.
@@ -640,6 +750,10 @@ bool XsControl::openPort(int portNr, XsBaudRate baudrate, uint32_t timeout, bool
 
 	The expected value for \a portname on Microsoft Windows platforms is "COMx" where x is the port number.
 
+	A device behind a serial-to-Ethernet device server is opened with a URL such as "tcp://192.168.1.10:4001" or
+	"udp://192.168.1.10:4001?local=4001", see SocketStreamInterface. The baud rate must then be configured in the
+	device server.
+
 	\param baudrate The baudrate used on the port.
 	\param portname The name of the port.
 	\param timeout The maximum number of ms to try to put the device in config mode before giving up, if 0 the default value is used
@@ -679,6 +793,9 @@ bool XsControl::finalizeOpenPort(Communicator* communicator, XsPortInfo& portinf
 	if (timeout)
 		serialPort->setGotoConfigTimeout(timeout);
 
+	if (m_descriptorCache)
+		serialPort->setDescriptorCache(m_descriptorCache);
+
 	bool retval = serialPort->openPort(portinfo, OPS_Full, detectRs485);
 	if (serialPort->masterDeviceId().isValid())
 		portinfo.setDeviceId(serialPort->masterDeviceId());
@@ -37,6 +37,7 @@
 #include <vector>
 #include "xscallback.h"
 #include <atomic>
+#include <memory>
 
 #include <xstypes/xsdeviceid.h>
 #include <xstypes/xsfilepos.h>
@@ -44,6 +45,7 @@
 #include <xstypes/xsresultvalue.h>
 #include <xstypes/xsmessage.h>
 #include <xscommon/xsens_mutex.h>
+#include "realtimeprofile.h"
 #include <xstypes/xsresetmethod.h>
 #include "devicefactory.h"
 #include "callbackmanagerxda.h"
@@ -56,6 +58,8 @@ class XSNOEXPORT BroadcastDevice;
 class XSNOEXPORT XdaCommunicatorFactory;
 class XSNOEXPORT ProxyCommunicator;
 class XSNOEXPORT RestoreCommunication;
+class XSNOEXPORT HotplugReconnector;
+class XSNOEXPORT DeviceDescriptorCache;
 
 struct XSNOEXPORT XsDevice;
 class XSNOEXPORT EmtsManager;
@@ -161,11 +165,13 @@ public:
 	XsDevice* broadcast() const;
 
 	void transmissionReceived(int channelId, const XsByteArray& data);
+	XSNOEXPORT RealTimeProfileReport applyRealTimeProfile(RealTimeProfile const& profile);
 #ifdef DOXYGEN
 	// Explicit inheritance for generator and doxygen
 	void XSNOCOMEXPORT clearCallbackHandlers(bool chain = true);
 	void XSNOCOMEXPORT addCallbackHandler(XsCallbackPlainC* cb, bool chain = true);
 	void XSNOCOMEXPORT removeCallbackHandler(XsCallbackPlainC* cb, bool chain = true);
+	void XSNOCOMEXPORT setCallbackHandlerFilter(XsCallbackPlainC* cb, XsDataIdentifier const* ids, XsSize count, bool chain = true);
 #endif
 
 	// these are only required to allow using the lib the same way as to using the dll
@@ -182,6 +188,13 @@ public:
 	XsResultValue startRestoreCommunication(const XsString& portName);
 	void stopRestoreCommunication();
 
+	XSNOEXPORT XsResultValue startHotplugReconnect(bool useUdev = true);
+	XSNOEXPORT void stopHotplugReconnect();
+	XSNOEXPORT HotplugReconnector* hotplugReconnector() const;
+
+	XSNOEXPORT XsResultValue setDescriptorCacheDirectory(const XsString& directory);
+	XSNOEXPORT std::shared_ptr<DeviceDescriptorCache> descriptorCache() const;
+
 protected:
 	virtual XsDevice* XSNOCOMEXPORT addMasterDevice(Communicator* communicator);
 
@@ -255,6 +268,12 @@ protected:
 	//! The restore communication object
 	RestoreCommunication* m_restoreCommunication;
 
+	//! The object that reopens the ports of unplugged devices when they return
+	HotplugReconnector* m_hotplugReconnector;
+
+	//! The cache of device initialization replies used by ports that are opened, empty when disabled
+	std::shared_ptr<DeviceDescriptorCache> m_descriptorCache;
+
 	/*! \cond XS_INTERNAL */
 	friend class BroadcastDevice;
 	friend class BroadcastForwardFunc;
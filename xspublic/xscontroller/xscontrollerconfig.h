@@ -40,6 +40,11 @@
 	//#define HAVE_JOURNALLER
 #endif
 
+// define to build with the receive pipeline latency trace points, see LatencyTracer
+#ifndef XSENS_LATENCY_TRACING
+	//#define XSENS_LATENCY_TRACING
+#endif
+
 //////////////////////////////////////////////////
 // generic preprocessor defines
 
@@ -44,6 +44,9 @@
 #include "protocolhandler.h"
 #include "communicator.h"
 #include "mtbdatalogger.h"
+#include "columnardatalogger.h"
+#include "sharedpacketring.h"
+#include "packetstreamserver.h"
 #include <xstypes/xsbaud.h>
 #include <xstypes/xsfilterprofile.h>
 #include "xsselftestresult.h"
@@ -56,6 +59,7 @@
 #include "supportedsyncsettings.h"
 #include "messageserializer.h"
 #include "xsdeviceptrarray.h"
+#include "latencytracer.h"
 #include <functional>
 #include <xstypes/xsdatapacketptrarray.h>
 #include <xstypes/xsfilterprofilearray.h>
@@ -111,6 +115,15 @@ using namespace XsTime;
 			chaining is still done.
 */
 
+/*! \fn XsDevice::setCallbackHandlerFilter(XsCallbackPlainC* cb, XsDataIdentifier const* ids, XsSize count, bool chain = true)
+	\brief Restrict the data packets delivered to a handler to the items in \a ids
+	\param cb The handler to set the filter for, it must have been added with addCallbackHandler()
+	\param ids The data identifiers to deliver, matched using XDI_FullTypeMask
+	\param count The number of items in \a ids, supply 0 to remove the filter
+	\param chain When set to true (default) the filter is applied to child devices as well
+	\note Only the data callbacks are filtered, log files and other handlers still receive complete packets.
+*/
+
 #if LOGTRANSACTIONS
 std::string msgToString(XsMessage const& msg)
 {
@@ -151,6 +164,9 @@ XsDevice::XsDevice(XsDeviceId const& id)
 	, m_startRecordingPacketId(-1)
 	, m_stopRecordingPacketId(-1)
 	, m_stoppedRecordingPacketId(-1)
+	, m_sourceMessage(nullptr)
+	, m_sourcePacketId(-1)
+	, m_sourceItemCount(0)
 	, m_lastAvailableLiveDataCache(new XsDataPacket)
 	, m_toaDumpFile(nullptr)
 {
@@ -183,6 +199,9 @@ XsDevice::XsDevice(Communicator* comm)
 	, m_startRecordingPacketId(-1)
 	, m_stopRecordingPacketId(-1)
 	, m_stoppedRecordingPacketId(-1)
+	, m_sourceMessage(nullptr)
+	, m_sourcePacketId(-1)
+	, m_sourceItemCount(0)
 	, m_lastAvailableLiveDataCache(new XsDataPacket)
 	, m_toaDumpFile(nullptr)
 {
@@ -231,6 +250,9 @@ XsDevice::XsDevice(XsDevice* masterDevice, const XsDeviceId& childDeviceId)
 	, m_startRecordingPacketId(-1)
 	, m_stopRecordingPacketId(-1)
 	, m_stoppedRecordingPacketId(-1)
+	, m_sourceMessage(nullptr)
+	, m_sourcePacketId(-1)
+	, m_sourceItemCount(0)
 	, m_lastAvailableLiveDataCache(new XsDataPacket)
 	, m_toaDumpFile(nullptr)
 {
@@ -1415,9 +1437,21 @@ void XsDevice::handleMessage(const XsMessage& msg)
 	{
 		case XMID_MtData2:
 		{
+			std::shared_ptr<SharedRingPublisher> publisher = std::atomic_load(&m_ringPublisher);
+			if (publisher)
+				publisher->publish(msg, deviceId().toInt());
+			std::shared_ptr<PacketStreamServer> server = std::atomic_load(&m_streamServer);
+			if (server)
+				server->publish(msg, deviceId().toInt());
+
 			XsDataPacket packet(&msg);
 			packet.setDeviceId(deviceId());
+			LockGuarded locky(&m_deviceMutex);
+			m_sourceMessage = &msg;
+			m_sourcePacketId = -1;
+			m_sourceItemCount = packet.itemCount();
 			handleDataPacket(packet);
+			m_sourceMessage = nullptr;
 			break;
 		}
 
@@ -1490,23 +1524,29 @@ void XsDevice::insertIntoDataCache(int64_t pid, XsDataPacket* pack)
 {
 	LockGuarded lockG(&m_deviceMutex);
 
-	if (m_dataCache.empty())
-		m_dataCache.insert(std::make_pair(pid, pack));
-	else
+	XsDataPacket* existing = m_dataCache.find(pid);
+	if (existing)
 	{
-		auto it = m_dataCache.lower_bound(pid);
-		if (it == m_dataCache.end())
-			m_dataCache.insert(it, std::make_pair(pid, pack));
-		else
-		{
-			if (it->first != pid)
-				m_dataCache.insert(it, std::make_pair(pid, pack));
-			else
-			{
-				it->second->merge(*pack, true);
-				delete pack;
-			}
-		}
+		existing->merge(*pack, true);
+		delete pack;
+		return;
+	}
+
+	if (!m_dataCache.fits(pid) && pid > m_dataCache.lastPacketId())
+	{
+		// The cache is full, stop waiting for retransmissions of the oldest missing data so the front of the
+		// cache can be flushed. Whatever is still blocking after that is evicted.
+		int64_t boundary = pid - (int64_t) m_dataCache.maxSlots();
+		JLDEBUGG("Device " << m_deviceId << " data cache limit reached, giving up on data up to " << boundary);
+		m_unavailableDataBoundary = (std::max)(m_unavailableDataBoundary, boundary); // Note: (std::max) to prevent a macro for max() to be substituted
+		checkDataCache();
+		m_dataCache.evictBefore(boundary + 1);
+	}
+
+	if (!m_dataCache.insert(pid, pack))
+	{
+		JLDEBUGG("Device " << m_deviceId << " dropping packet " << pid << " because it does not fit in the data cache");
+		delete pack;
 	}
 }
 
@@ -1516,8 +1556,6 @@ void XsDevice::clearDataCache()
 {
 	LockGuarded lockG(&m_deviceMutex);
 
-	for (auto& it : m_dataCache)
-		delete it.second;
 	m_dataCache.clear();
 	//m_latestLivePacket->clear();
 	m_latestBufferedPacket->clear();
@@ -1588,6 +1626,7 @@ void XsDevice::handleDataPacket(const XsDataPacket& packet)
 	if (m_terminationPrepared)
 		return;	// we're being destroyed, abort handling of datapacket, state may be invalid
 
+	XSLATENCY_MARK(LM_Handled);
 	m_lastDataOkStamp = XsTimeStamp::now();
 	int64_t fastest = latestLivePacketConst().packetId();
 	int64_t slowest = latestBufferedPacketConst().packetId();
@@ -1595,6 +1634,8 @@ void XsDevice::handleDataPacket(const XsDataPacket& packet)
 	std::unique_ptr<XsDataPacket> pack(new XsDataPacket(packet));
 	master()->m_packetStamper.stampPacket(*pack, latestLivePacket());	// always go through master for stamping packets so we have consistent timing
 	int64_t current = pack->packetId();
+	if (m_sourceMessage && m_sourcePacketId == -1)
+		m_sourcePacketId = current;
 
 #if TOADUMP
 	fprintf(master()->m_toaDumpFile, "%llu,%llu,%llu\n", current, pack->timeOfArrival().msTime(), pack->estimatedTimeOfSampling().msTime());
@@ -1623,6 +1664,7 @@ void XsDevice::handleDataPacket(const XsDataPacket& packet)
 			int64_t lastMissed = current - 1;
 			ONLYFIRSTMTX2
 			JLDEBUGG("Detected " << (dpc - 1) << " packets have been missed by device " << deviceId() << ", last was " << fastest << " (" << (uint16_t) fastest << ") current is " << current << " (" << (uint16_t) current << ")");
+			m_metrics.m_packetsMissed->add((uint64_t)(dpc - 1));
 			onMissedPackets(this, (int) dpc - 1, (int) firstMissed, (int) lastMissed);
 
 			for (int64_t i = firstMissed; i <= lastMissed; ++i)
@@ -1668,11 +1710,14 @@ void XsDevice::handleDataPacket(const XsDataPacket& packet)
 		{
 			if (m_options & XSO_KeepLastLiveData)
 				updateLastAvailableLiveDataCache(latestLivePacketConst());
+			m_latestValues.update(latestLivePacketConst());
 			if (m_options & XSO_RetainLiveData)
 				retainPacket(latestLivePacketConst());
 
 			//if (isRecording())
 			//	JLDEBUGG("Device " << m_deviceId << " triggering onLiveDataAvailable " << latestLivePacketConst().packetId());
+			XSLATENCY_MARK(LM_Callback);
+			int64_t callbackStart = XsTime_monotonicUs();
 			onLiveDataAvailable(this, &latestLivePacketConst());
 			if (!isReadingFromFile())
 				onDataAvailable(this, &latestLivePacketConst());
@@ -1687,6 +1732,8 @@ void XsDevice::handleDataPacket(const XsDataPacket& packet)
 				if (!isReadingFromFile())
 					onAllDataAvailable(&devs, &packs);
 			}
+			m_metrics.m_callbackDuration->observe((uint64_t)(XsTime_monotonicUs() - callbackStart));
+			XSLATENCY_FINISH(m_metrics, deviceId(), latestLivePacketConst().packetId());
 		}
 	}
 	else
@@ -2034,15 +2081,7 @@ XsResultValue XsDevice::createLogFile(const XsString& filename)
 	{
 		m_logFileInterface = newfile.release();
 		JLDEBUGG("Creation ok");
-		tm dateTime;
-		getDateTime(&dateTime);
-		getDateAsString((char*) m_config.masterInfo().m_date, &dateTime);
-		getTimeAsString((char*) m_config.masterInfo().m_time, &dateTime);
-
-		XsMessage msg;
-		deviceConfiguration().writeToMessage(msg);
-		m_logFileInterface->writeMessage(msg);
-		writeDeviceSettingsToFile();
+		writeLogFileHeader();
 		return XRV_OK;
 	}
 	JLDEBUGG("Creation failed");
@@ -2051,6 +2090,85 @@ XsResultValue XsDevice::createLogFile(const XsString& filename)
 	return XRV_OUTPUTCANNOTBEOPENED;
 }
 
+/*! \brief Create a log file in the compact columnar format for logging
+	\details The file is written by a ColumnarDataLogger and can be read with a ColumnarLogReader. It contains the
+	same messages as an mtb file created with createLogFile, but MtData2 messages are stored per column and the
+	file is compressed in chunks by a background thread.
+	\param filename The desired path and filename of the log file
+	\returns Result value indicating success (XRV_OK) or failure
+*/
+XsResultValue XsDevice::createColumnarLogFile(const XsString& filename)
+{
+	JLDEBUGG(filename);
+	Communicator* comm = communicator();
+	if (!comm || !comm->isPortOpen())
+	{
+		JLALERTG("No port open");
+		return XRV_NOPORTOPEN;
+	}
+
+	std::unique_ptr<xsens::Lock> myLock(new xsens::Lock(&m_logFileMutex, true));
+	if (logFileInterface(myLock))
+	{
+		JLERRORG("A file is already open");
+		return XRV_ALREADYOPEN;
+	}
+
+	std::unique_ptr<ColumnarDataLogger> newfile(new ColumnarDataLogger);
+	if (newfile->create(filename))
+	{
+		m_logFileInterface = newfile.release();
+		JLDEBUGG("Creation ok");
+		writeLogFileHeader();
+		return XRV_OK;
+	}
+	JLDEBUGG("Creation failed");
+	return XRV_OUTPUTCANNOTBEOPENED;
+}
+
+/*! \brief Start capturing the raw data received from the port of this device
+	\details All received bytes are written to \a filename with their time of arrival, before they are parsed. The
+	capture can be replayed with a ReplayCommunicator, at the original pace or as fast as possible.
+	\param filename The name of the capture file, an existing file is overwritten
+	\returns XRV_OK if successful
+	\sa stopRawCapture, DataParser::startRawCapture
+*/
+XsResultValue XsDevice::startRawCapture(const XsString& filename)
+{
+	JLDEBUGG(filename);
+	Communicator* comm = communicator();
+	if (!comm || !comm->isPortOpen())
+		return XRV_NOPORTOPEN;
+	return comm->startRawCapture(filename);
+}
+
+/*! \brief Stop the raw capture that was started with startRawCapture
+	\returns XRV_OK if the capture file was written successfully
+*/
+XsResultValue XsDevice::stopRawCapture()
+{
+	Communicator* comm = communicator();
+	if (!comm)
+		return XRV_NOPORTOPEN;
+	return comm->stopRawCapture();
+}
+
+/*! \brief Write the device configuration and settings at the start of a newly created log file
+	\note The log file mutex must be locked by the caller
+*/
+void XsDevice::writeLogFileHeader()
+{
+	tm dateTime;
+	getDateTime(&dateTime);
+	getDateAsString((char*) m_config.masterInfo().m_date, &dateTime);
+	getTimeAsString((char*) m_config.masterInfo().m_time, &dateTime);
+
+	XsMessage msg;
+	deviceConfiguration().writeToMessage(msg);
+	m_logFileInterface->writeMessage(msg);
+	writeDeviceSettingsToFile();
+}
+
 /*! \brief Stores the current device configuration in a config file(.xsa)
 	\param[in] filename The desired path and filename of the config file
 	\returns Result value indicating success (XRV_OK) or failure
@@ -2231,8 +2349,8 @@ void XsDevice::checkDataCache()
 	// process available data
 	while (!m_dataCache.empty())
 	{
-		auto it = m_dataCache.begin();
-		//JLWRITEG("pid: " << it->second->packetId() << " range? " << it->second->containsFrameRange() << " retransmission? " << it->second->isAwindaSnapshotARetransmission() << " snapshotA,F? " << it->second->containsAwindaSnapshot() << "," << it->second->containsFullSnapshot());
+		XsDataPacket* front = m_dataCache.front();
+		//JLWRITEG("pid: " << front->packetId() << " range? " << front->containsFrameRange() << " retransmission? " << front->isAwindaSnapshotARetransmission() << " snapshotA,F? " << front->containsAwindaSnapshot() << "," << front->containsFullSnapshot());
 
 		int64_t expectedPacketId = latestBufferedPacketId() < 0 ? -1 : latestBufferedPacketId() + 1;
 		if (expectedPacketId < m_startRecordingPacketId)
@@ -2241,10 +2359,10 @@ void XsDevice::checkDataCache()
 			//The startRecordingPacketId always is equal to the start value of an interval. Therefore if using the startRecordingPacketId to
 			//calculate the expected packetId for an ideal interval (no missing data) is to +1 the startRecordingPacketId
 			//For an ideal (expected) situation this would be 1 higher than the startRecordingPacketId
-			expectedPacketId = it->second->containsFrameRange() ? m_startRecordingPacketId + 1 : getStartRecordingPacketId();
+			expectedPacketId = front->containsFrameRange() ? m_startRecordingPacketId + 1 : getStartRecordingPacketId();
 			expectedPacketId = PacketStamper::calculateLargePacketCounter(expectedPacketId, latestLivePacketId(), PacketStamper::MTSCBOUNDARY);
 		}
-		int64_t packetId = it->first;
+		int64_t packetId = m_dataCache.firstPacketId();
 
 		auto missingDataIsUnavailable = [this](int64_t rFirst, int64_t rLast)
 		{
@@ -2281,9 +2399,9 @@ void XsDevice::checkDataCache()
 
 		int64_t rFirst = expectedPacketId >= 0 ? expectedPacketId : packetId;
 		int64_t rLast = packetId;
-		if (it->second->containsFrameRange())
+		if (front->containsFrameRange())
 		{
-			XsRange rng = it->second->frameRange();
+			XsRange rng = front->frameRange();
 			rFirst = rng.first() + 1;
 		}
 
@@ -2296,7 +2414,7 @@ void XsDevice::checkDataCache()
 			}
 		}
 		// we need to 'else' here to avoid duplicate and erroneous missed packet handling
-		else if (it->second->containsFrameRange())
+		else if (front->containsFrameRange())
 		{
 			if (rLast > rFirst)
 			{
@@ -2306,14 +2424,13 @@ void XsDevice::checkDataCache()
 		}
 
 		// do 'buffered' processing
-		processBufferedPacket(*it->second);
+		processBufferedPacket(*front);
 
 		// store result
-		latestBufferedPacket().swap(*it->second);
+		latestBufferedPacket().swap(*front);
 		//		ONLYFIRSTMTX2
-		//		JLDEBUGG("latestBufferedPacket is now " << latestBufferedPacket().packetId() << " old: " << it->second->packetId());
-		delete it->second;
-		m_dataCache.erase(it);
+		//		JLDEBUGG("latestBufferedPacket is now " << latestBufferedPacket().packetId() << " old: " << front->packetId());
+		m_dataCache.popFront();
 
 		if (latestBufferedPacketConst().empty())
 			continue;
@@ -3110,6 +3227,9 @@ XsString XsDevice::logFileName() const
 			MtbDataLogger const* mtb = dynamic_cast<MtbDataLogger const*>(logFileInterface(myLock));
 			if (mtb != nullptr)
 				return mtb->filename();
+			ColumnarDataLogger const* columnar = dynamic_cast<ColumnarDataLogger const*>(logFileInterface(myLock));
+			if (columnar != nullptr)
+				return columnar->filename();
 		}
 		return XsString();
 	}
@@ -3147,7 +3267,7 @@ int XsDevice::recordingQueueLength() const
 	if (m_dataCache.empty())
 		return 0;
 
-	return (int)(m_dataCache.rbegin()->first - latestBufferedPacketId());
+	return (int)(m_dataCache.lastPacketId() - latestBufferedPacketId());
 }
 
 /*!	\brief Get the number of items currently in the slow data cache for the device
@@ -3159,6 +3279,55 @@ int XsDevice::cacheSize() const
 	return (int) m_dataCache.size();
 }
 
+/*!	\brief Get the usage counters of the slow data cache for the device
+	\details The counters include how many packet ids were waited on for retransmission, how long that took
+	and how many packets were evicted because the cache limit was reached.
+	\returns The statistics of the data cache
+	\sa setDataCacheLimit
+*/
+DataPacketCacheStatistics XsDevice::dataCacheStatistics() const
+{
+	LockGuarded lockG(&m_deviceMutex);
+	return m_dataCache.statistics();
+}
+
+/*!	\brief Set the maximum number of packet ids the slow data cache for the device may span
+	\details When a new packet would exceed this limit, the device stops waiting for retransmissions of the
+	oldest missing data and flushes the cache up to the new limit. Packets that still block the cache after that
+	are evicted. The default is DataPacketCache::defaultMaxSlots.
+	\param maxPackets The new limit
+	\sa dataCacheStatistics
+*/
+void XsDevice::setDataCacheLimit(XsSize maxPackets)
+{
+	LockGuarded lockG(&m_deviceMutex);
+	m_dataCache.setMaxSlots(maxPackets);
+}
+
+/*!	\brief Get the amount of memory used by the packets retained with XSO_RetainLiveData or XSO_RetainBufferedData
+	\details Only the packets that are kept in memory are counted, older packets are spilled to a temporary file.
+	\returns The number of bytes in memory used for retained packets
+	\sa setRetainedDataMemoryChunks
+*/
+XsSize XsDevice::retainedDataMemoryUsage() const
+{
+	LockGuarded lockG(&m_deviceMutex);
+	return m_linearPacketCache.memoryUsage();
+}
+
+/*!	\brief Set how many chunks of retained packets are kept in memory
+	\details Each chunk contains RetainedPacketStore::defaultPacketsPerChunk packets. Older chunks are spilled to a
+	temporary file that is removed when the retained packets are cleared. The default is
+	RetainedPacketStore::defaultHotChunkCount.
+	\param chunkCount The number of complete chunks to keep in memory
+	\sa retainedDataMemoryUsage
+*/
+void XsDevice::setRetainedDataMemoryChunks(XsSize chunkCount)
+{
+	LockGuarded lockG(&m_deviceMutex);
+	m_linearPacketCache.setHotChunkCount(chunkCount);
+}
+
 
 /*!	\brief Get all the current synchronization settings of the device
 	\details This function is a generic way of requesting the synchonization options of a device,
@@ -3942,6 +4111,11 @@ void XsDevice::onConnectionLost()
 	updateConnectivityState(XCS_Disconnected);
 }
 
+void XsDevice::onConnectionRestored()
+{
+	updateConnectivityState(XCS_PluggedIn);
+}
+
 void XsDevice::onEofReached()
 {
 	LockGuarded locky(&m_deviceMutex);
@@ -4165,8 +4339,6 @@ void XsDevice::setRecordingStopFrame(uint16_t stopFrame)
 void XsDevice::clearExternalPacketCaches()
 {
 	LockGuarded lock(&m_deviceMutex);
-	for (auto item : m_linearPacketCache)
-		delete item;
 	m_linearPacketCache.clear();
 	m_lastAvailableLiveDataCache->clear();
 }
@@ -4176,16 +4348,7 @@ void XsDevice::clearExternalPacketCaches()
 void XsDevice::clearCacheToRecordingStart()
 {
 	LockGuarded lockG(&m_deviceMutex);
-	for (auto it = m_dataCache.begin(); it != m_dataCache.end(); )
-	{
-		if (it->first < m_startRecordingPacketId) {
-			delete it->second;
-			it = m_dataCache.erase(it); // Erase and move to the next element safely
-		}
-		else {
-			++it; // Move to the next element
-		}
-	}
+	m_dataCache.eraseBefore(m_startRecordingPacketId);
 }
 
 /*! \brief Merge the supplied \a pack into m_lastAvailableLiveDataCache so its data is now available when calling lastAvailableLiveData()
@@ -4202,10 +4365,11 @@ void XsDevice::updateLastAvailableLiveDataCache(XsDataPacket const& pack)
 void XsDevice::retainPacket(XsDataPacket const& pack)
 {
 	LockGuarded lockG(&m_deviceMutex);
-	if (!m_linearPacketCache.empty() && m_linearPacketCache.back()->packetId() == pack.packetId())
-		m_linearPacketCache.back()->merge(pack, true);
+	// retain the received payload when pack is the unmodified packet of the message that is being handled
+	if (m_sourceMessage && pack.packetId() == m_sourcePacketId && pack.itemCount() == m_sourceItemCount)
+		m_linearPacketCache.append(pack, m_sourceMessage);
 	else
-		m_linearPacketCache.push_back(new XsDataPacket(pack));
+		m_linearPacketCache.append(pack);
 }
 
 /*! \brief Return whether a device reset will remove the COM port connection
@@ -4228,9 +4392,7 @@ bool XsDevice::resetRemovesPort() const
 XsDataPacket XsDevice::getDataPacketByIndex(XsSize index) const
 {
 	LockGuarded lockG(&m_deviceMutex);
-	if (index < m_linearPacketCache.size())
-		return *m_linearPacketCache.at(index);
-	return XsDataPacket();
+	return m_linearPacketCache.at(index);
 }
 
 /*! \brief Return the current size of the retained data packet cache
@@ -4244,6 +4406,32 @@ XsSize XsDevice::getDataPacketCount() const
 	return m_linearPacketCache.size();
 }
 
+/*! \brief Export items of the retained data packets as contiguous per-component columns
+	\details This retrieves a range of retained packets in a single call, without creating an XsDataPacket per
+	packet. Each component of each requested item is written to its own column of doubles, ready for vectorized
+	processing. Packets that do not contain an item get NaN values in its columns. Integer items such as
+	XDI_PacketCounter and XDI_SampleTimeFine are exported as a single component.
+	The packets are decoded in parallel chunks. The device is only locked while the packets are selected, so
+	processing live data is not held up by the export.
+	\param first The index of the first packet to export, as used by getDataPacketByIndex
+	\param count The maximum number of packets to export
+	\param requests The items to export and their destinations, m_found is set for each request
+	\param requestCount The number of requests
+	\param packetIds When not NULL, this must have room for \a count values and receives the packet ids
+	\returns The number of exported packets
+	\note This only works if XSO_RetainLiveData or XSO_RetainBufferedData was set before the data was read
+	\sa getDataPacketCount, getDataPacketByIndex
+*/
+XsSize XsDevice::exportDataColumns(XsSize first, XsSize count, XsColumnRequest* requests, XsSize requestCount, int64_t* packetIds) const
+{
+	RetainedPacketStore::ColumnSnapshotPtr snapshot;
+	{
+		LockGuarded lockG(&m_deviceMutex);
+		snapshot = m_linearPacketCache.snapshotColumns(first, count);
+	}
+	return RetainedPacketStore::exportColumns(snapshot, requests, requestCount, packetIds);
+}
+
 /*! \brief Return the last available live data
 	\return A packet containing the latest available live data. This packet will contain the latest data of each
 	appropriate type, so it may contain old data mixed with new data if different data comes in at different speeds.
@@ -4256,6 +4444,103 @@ XsDataPacket XsDevice::lastAvailableLiveData() const
 	return *m_lastAvailableLiveDataCache;
 }
 
+/*! \brief Start tracking the newest value of data identifier \a id in live data
+	\details The value can then be read with latestValue() without locking the device, which makes it suitable for
+	threads that poll the device at a fixed rate. This works independently of XSO_KeepLastLiveData.
+	\param id The identifier to track, the format bits are ignored
+	\returns false if LatestValueTable::maxEntries identifiers are already being tracked
+	\sa latestValue, clearLatestValueWatches
+*/
+bool XsDevice::watchLatestValue(XsDataIdentifier id)
+{
+	return m_latestValues.watch(id);
+}
+
+/*! \brief Stop tracking all identifiers added with watchLatestValue()
+	\sa watchLatestValue
+*/
+void XsDevice::clearLatestValueWatches()
+{
+	m_latestValues.clear();
+}
+
+/*! \brief Copy the newest value of data identifier \a id into \a value
+	\details This function does not lock the device and does not allocate memory.
+	\param id The identifier to read, it must have been added with watchLatestValue()
+	\param value Receives the value
+	\returns false if \a id is not being tracked or no value has been received for it yet
+	\sa watchLatestValue
+*/
+bool XsDevice::latestValue(XsDataIdentifier id, LatestValue& value) const
+{
+	return m_latestValues.read(id, value);
+}
+
+/*! \brief Create a decoder for the MtData2 frames produced with the current output configuration
+	\details Use the decoder on the raw messages received from the device, for example in
+	XsCallback::onMessageReceivedFromDevice, to decode frames into a plain FixedLayoutFrame without creating an
+	XsDataPacket. Create a new decoder after changing the output configuration.
+	\returns A decoder configured with outputConfiguration()
+	\sa FixedLayoutDecoder
+*/
+FixedLayoutDecoder XsDevice::createFixedLayoutDecoder() const
+{
+	return FixedLayoutDecoder(outputConfiguration());
+}
+
+/*! \brief Return the receive pipeline metrics of the device
+	\details The metrics count the bytes read, the messages found, checksum failures, skipped bytes and missed
+	packets, and track the parser queue depth and the time spent in the live data callbacks. For a device that
+	is connected through a master device, only the packet and callback metrics are updated, the byte and message
+	metrics are kept by the master device.
+	\returns The metrics registry of the device
+	\sa metricsExposition
+*/
+DeviceMetrics& XsDevice::metrics()
+{
+	return m_metrics;
+}
+
+/*! \copydoc metrics() */
+DeviceMetrics const& XsDevice::metrics() const
+{
+	return m_metrics;
+}
+
+/*! \brief Return the metrics of the device in a plain-text exposition format
+	\details Each sample is labeled with the device id of this device.
+	\returns The metrics as text, one sample per line
+	\sa metrics
+*/
+XsString XsDevice::metricsExposition() const
+{
+	std::string labels = std::string("device=\"") + deviceId().toString().c_str() + "\"";
+	return XsString(m_metrics.exposition(labels));
+}
+
+/*! \brief Publish the data messages of this device to a shared memory ring
+	\details Each MtData2 message is published as it is received, before it is processed, so processes that attach
+	a SharedRingReader to the ring get the data of this device with minimal delay. Several devices can publish to the
+	same ring.
+	\param publisher The publisher to use, nullptr to stop publishing
+	\sa SharedRingPublisher
+*/
+void XsDevice::setSharedRingPublisher(std::shared_ptr<SharedRingPublisher> publisher)
+{
+	std::atomic_store(&m_ringPublisher, publisher);
+}
+
+/*! \brief Publish the data messages of this device to network subscribers
+	\details Each MtData2 message is handed to the server as it is received, before it is processed. Several devices
+	can publish to the same server, subscribers can tell them apart by the device id in each record.
+	\param server The server to use, nullptr to stop publishing
+	\sa PacketStreamServer
+*/
+void XsDevice::setPacketStreamServer(std::shared_ptr<PacketStreamServer> server)
+{
+	std::atomic_store(&m_streamServer, server);
+}
+
 /*! \brief Return the first packet in the packet queue or an empty packet if the queue is empty
 	\details This function will only return a packet when XSO_RetainLiveData or XSO_RetainBufferedData is specified for the
 	device. It will return the first packet in the queue and remove the packet from the queue.
@@ -4265,12 +4550,9 @@ XsDataPacket XsDevice::lastAvailableLiveData() const
 XsDataPacket XsDevice::takeFirstDataPacketInQueue()
 {
 	LockGuarded lockG(&m_deviceMutex);
-	if (m_linearPacketCache.empty())
-		return XsDataPacket();
-
-	std::unique_ptr<XsDataPacket> rv(m_linearPacketCache.at(0));
-	m_linearPacketCache.pop_front();
-	return *rv;	// copy and delete, hopefully optimizing the copy into a move operation
+	XsDataPacket rv;
+	m_linearPacketCache.takeFirst(rv);
+	return rv;
 }
 
 /*! \cond XS_INTERNAL */
@@ -46,6 +46,10 @@
 #include "xsalignmentframe.h"
 #include "xsaccesscontrolmode.h"
 #include "datapacketcache.h"
+#include "retainedpacketstore.h"
+#include "latestvaluetable.h"
+#include "fixedlayoutdecoder.h"
+#include "metrics.h"
 #include <xstypes/xsdeviceoptionflag.h>
 #include <xstypes/xsoutputconfigurationarray.h>
 #include "lastresultmanager.h"
@@ -57,6 +61,8 @@
 class XSNOEXPORT MtContainer;
 class XSNOEXPORT DataLogger;
 class XSNOEXPORT PacketProcessor;
+class XSNOEXPORT SharedRingPublisher;
+class XSNOEXPORT PacketStreamServer;
 
 //AUTO namespace xstypes {
 struct XsString;
@@ -164,6 +170,9 @@ public:
 	void setGotoConfigOnClose(bool gotoConfigOnClose);
 
 	virtual XsResultValue createLogFile(const XsString& filename);
+	XSNOEXPORT XsResultValue createColumnarLogFile(const XsString& filename);
+	XSNOEXPORT XsResultValue startRawCapture(const XsString& filename);
+	XSNOEXPORT XsResultValue stopRawCapture();
 	virtual bool closeLogFile();
 
 	virtual bool isMeasuring() const;
@@ -178,6 +187,10 @@ public:
 
 	int recordingQueueLength() const;
 	int cacheSize() const;
+	XSNOEXPORT DataPacketCacheStatistics dataCacheStatistics() const;
+	XSNOEXPORT void setDataCacheLimit(XsSize maxPackets);
+	XSNOEXPORT XsSize retainedDataMemoryUsage() const;
+	XSNOEXPORT void setRetainedDataMemoryChunks(XsSize chunkCount);
 
 	virtual XsDeviceState deviceState() const;
 
@@ -190,6 +203,7 @@ public:
 	void XSNOCOMEXPORT clearCallbackHandlers(bool chain = true);
 	void XSNOCOMEXPORT addCallbackHandler(XsCallbackPlainC* cb, bool chain = true);
 	void XSNOCOMEXPORT removeCallbackHandler(XsCallbackPlainC* cb, bool chain = true);
+	void XSNOCOMEXPORT setCallbackHandlerFilter(XsCallbackPlainC* cb, XsDataIdentifier const* ids, XsSize count, bool chain = true);
 #endif
 
 	//! \brief Compare device ID with that of \a dev \param dev Device to compare against \returns true if \a dev has a higher device ID \sa deviceId()
@@ -450,8 +464,18 @@ public:
 
 	virtual XsDataPacket getDataPacketByIndex(XsSize index) const;
 	XsSize getDataPacketCount() const;
+	XsSize exportDataColumns(XsSize first, XsSize count, XsColumnRequest* requests, XsSize requestCount, int64_t* packetIds) const;
 	XsDataPacket lastAvailableLiveData() const;
 	XsDataPacket takeFirstDataPacketInQueue();
+	XSNOEXPORT bool watchLatestValue(XsDataIdentifier id);
+	XSNOEXPORT void clearLatestValueWatches();
+	XSNOEXPORT bool latestValue(XsDataIdentifier id, LatestValue& value) const;
+	XSNOEXPORT FixedLayoutDecoder createFixedLayoutDecoder() const;
+	XSNOEXPORT DeviceMetrics& metrics();
+	XSNOEXPORT DeviceMetrics const& metrics() const;
+	XSNOEXPORT XsString metricsExposition() const;
+	XSNOEXPORT void setSharedRingPublisher(std::shared_ptr<SharedRingPublisher> publisher);
+	XSNOEXPORT void setPacketStreamServer(std::shared_ptr<PacketStreamServer> server);
 
 	// MTix device
 	virtual bool isInitialBiasUpdateEnabled() const;
@@ -541,6 +565,7 @@ protected:
 	XsOutputConfiguration findConfiguration(XsDataIdentifier dataType) const;
 
 	virtual void writeMessageToLogFile(const XsMessage& message);
+	void writeLogFileHeader();
 
 	virtual void writeFilterStateToFile();
 
@@ -606,6 +631,7 @@ public:
 
 	XSNOEXPORT virtual void onSessionRestarted();
 	XSNOEXPORT virtual void onConnectionLost();
+	XSNOEXPORT virtual void onConnectionRestored();
 	XSNOEXPORT virtual void onEofReached();
 	XSNOEXPORT virtual void onWirelessConnectionLost();
 	XSNOEXPORT virtual int64_t deviceRecordingBufferItemCount(int64_t& lastCompletePacketId) const;
@@ -754,12 +780,33 @@ protected:
 	void retainPacket(XsDataPacket const& pack);
 	static bool packetContainsRetransmission(XsDataPacket const& pack);
 
-	//! \brief A linear data packet cache
-	std::deque<XsDataPacket*> m_linearPacketCache;
+	//! \brief A linear data packet cache, older packets are spilled to disk
+	RetainedPacketStore m_linearPacketCache;
+
+	//! \brief The MtData2 message that is being handled, its payload is retained instead of the packet. Guarded by m_deviceMutex
+	XsMessage const* m_sourceMessage;
+
+	//! \brief The packet id that was assigned to the packet created from m_sourceMessage, -1 until it has been stamped
+	int64_t m_sourcePacketId;
+
+	//! \brief The number of items in the packet created from m_sourceMessage
+	int m_sourceItemCount;
 
 	//! \brief A last available live data cache
 	XsDataPacket* m_lastAvailableLiveDataCache;
 
+	//! \brief The newest values of the identifiers watched with watchLatestValue()
+	LatestValueTable m_latestValues;
+
+	//! \brief The receive pipeline metrics of the device
+	DeviceMetrics m_metrics;
+
+	//! \brief The ring that received data frames are published to, only accessed with the std::atomic_ functions
+	std::shared_ptr<SharedRingPublisher> m_ringPublisher;
+
+	//! \brief The network server that received data frames are published to, only accessed with the std::atomic_ functions
+	std::shared_ptr<PacketStreamServer> m_streamServer;
+
 	/*! \brief To a dump file.
 		\details For debugging purposes only, but doesn't do any harm to always be there.
 	*/
@@ -37,6 +37,7 @@
 #include "xsdeviceid.h"
 #include "xstimestamp.h"
 #include <map>
+#include <typeinfo>
 #include <atomic>
 #include "xsquaternion.h"
 #include "xsushortvector.h"
@@ -78,6 +79,33 @@ public:
 	*/
 	virtual Variant* clone() const = 0;
 
+	/*! \brief Overwrite the contents with those of \a other without allocating
+		\returns false when \a other is of a different type or the Variant does not support this, the caller should
+		replace the Variant by a clone of \a other in that case
+	*/
+	virtual bool assign(Variant const& other)
+	{
+		(void)other;
+		return false;
+	}
+
+	/*! \brief Copy at most \a count numeric values of the Variant to \a dest
+		\returns The number of values copied, 0 for Variants that do not consist of numeric values
+	*/
+	virtual XsSize toDoubles(double* dest, XsSize count) const
+	{
+		(void)dest;
+		(void)count;
+		return 0;
+	}
+	/*! \copydoc toDoubles */
+	virtual XsSize toFloats(float* dest, XsSize count) const
+	{
+		(void)dest;
+		(void)count;
+		return 0;
+	}
+
 	/*! \brief Set the dataId to \a id */
 	void setDataId(XsDataIdentifier id)
 	{
@@ -141,6 +169,29 @@ public:
 	{
 		return (XsSize)(ptrdiff_t) XsMessage::sizeInMsg<T>(dataId(), C);
 	}
+
+	/*! \copydoc Variant::toDoubles */
+	XsSize toDoubles(double* dest, XsSize count) const override
+	{
+		return copyValues(dest, count);
+	}
+	/*! \copydoc Variant::toDoubles */
+	XsSize toFloats(float* dest, XsSize count) const override
+	{
+		return copyValues(dest, count);
+	}
+
+private:
+	/*! \brief Copy at most \a count values to \a dest, converting them to \a D */
+	template <typename D>
+	XsSize copyValues(D* dest, XsSize count) const
+	{
+		XsSize n = (count < (XsSize) C) ? count : (XsSize) C;
+		T const* src = constData();
+		for (XsSize i = 0; i < n; ++i)
+			dest[i] = (D) src[i];
+		return n;
+	}
 };
 
 /*! \brief Read the data from the message \a msg at the given \a offset */
@@ -193,6 +244,16 @@ struct SimpleVariant : public GenericVariant<T, 1>
 		return new SimpleVariant<T>(dataId(), m_data);
 	}
 
+	/*! \copydoc Variant::assign */
+	bool assign(Variant const& other) override
+	{
+		if (typeid(other) != typeid(*this))
+			return false;
+		this->setDataId(other.dataId());
+		m_data = static_cast<SimpleVariant<T> const&>(other).m_data;
+		return true;
+	}
+
 	/*! \brief Return the size the Variant would have in a message */
 	XsSize sizeInMsg() const override
 	{
@@ -230,6 +291,19 @@ struct ComplexVariant : public GenericVariant<T, C>
 	{
 		return new ComplexVariant<U, T, C>(dataId(), m_data);
 	}
+
+	/*! \copydoc Variant::assign */
+	bool assign(Variant const& other) override
+	{
+		if (typeid(other) != typeid(*this))
+			return false;
+		this->setDataId(other.dataId());
+		T const* src = static_cast<ComplexVariant<U, T, C> const&>(other).constData();
+		T* dest = data();
+		for (int i = 0; i < C; ++i)
+			dest[i] = src[i];
+		return true;
+	}
 };
 
 /*! \brief Variant containing an XsQuaternion value */
@@ -2509,6 +2509,110 @@ extern "C" {
 		return thisPtr;
 	}
 
+	/*! \brief Overwrite the contents of the XsDataPacket with the items from \a src that are listed in \a ids
+		\details Items are matched with the same loose comparison as the other accessors, so the data format
+		bits of the entries in \a ids are ignored. Items in \a ids that are not present in \a src are skipped.
+		The device id, time of arrival, packet id and estimated time of sampling are always copied.
+		When the contents of the packet are not shared with another packet, the existing items are overwritten in
+		place, so repeatedly copying the same selection into the same packet does not allocate memory.
+		\param src The packet to copy the items from, this may be the same object as \a thisPtr
+		\param ids The identifiers of the items to copy
+		\param count The number of identifiers in \a ids
+	*/
+	void XsDataPacket_copySelection(XsDataPacket* thisPtr, const XsDataPacket* src, const XsDataIdentifier* ids, XsSize count)
+	{
+		DataPacketPrivate* d = thisPtr->d;
+		bool reuse = (d && d != src->d && d->m_refCount == 1);
+		if (reuse)
+		{
+			// remove the items that will not be overwritten
+			auto it = d->begin();
+			while (it != d->end())
+			{
+				bool keep = false;
+				for (XsSize i = 0; i < count && !keep; ++i)
+					keep = ((ids[i] & XDI_FullTypeMask) == it->first && src->d->find(ids[i]) != src->d->end());
+				auto next = it;
+				++next;
+				if (!keep)
+					d->erase(it);
+				it = next;
+			}
+		}
+		else
+			d = new DataPacketPrivate;
+
+		for (XsSize i = 0; i < count; ++i)
+		{
+			auto it = src->d->find(ids[i]);
+			if (it == src->d->end())
+				continue;
+			auto existing = d->find(it->first);
+			if (existing == d->end() || !existing->second->assign(*it->second))
+				d->insert(it->first, it->second->clone());
+		}
+
+		thisPtr->m_deviceId = src->m_deviceId;
+		thisPtr->m_toa = src->m_toa;
+		thisPtr->m_packetId = src->m_packetId;
+		thisPtr->m_etos = src->m_etos;
+
+		if (!reuse)
+		{
+			XsDataPacket_destruct(thisPtr);
+			thisPtr->d = d;
+		}
+	}
+
+	/*! \brief Copy the values of item \a id to \a dest as doubles
+		\details Unlike the typed accessors this does not convert between representations, for example it does not
+		compute a quaternion from Euler angles, and it never allocates memory. Matrices are copied in storage order.
+		\param id The identifier of the item, the format bits are ignored
+		\param dest The destination, this must have room for \a count values
+		\param count The maximum number of values to copy
+		\returns The number of values copied, 0 if the packet does not contain a numeric item \a id
+	*/
+	XsSize XsDataPacket_getDoubles(const XsDataPacket* thisPtr, XsDataIdentifier id, double* dest, XsSize count)
+	{
+		auto it = MAP.find(id);
+		if (it == MAP.end())
+			return 0;
+		return it->second->toDoubles(dest, count);
+	}
+
+	/*! \copydoc XsDataPacket_getDoubles
+		\note The values are converted to single precision
+	*/
+	XsSize XsDataPacket_getFloats(const XsDataPacket* thisPtr, XsDataIdentifier id, float* dest, XsSize count)
+	{
+		auto it = MAP.find(id);
+		if (it == MAP.end())
+			return 0;
+		return it->second->toFloats(dest, count);
+	}
+
+	/*! \brief Retrieve the values of several items in one call
+		\details Each item is looked up once and its values are copied like XsDataPacket_getDoubles does, no memory is
+		allocated. The m_found field of each request is set to the number of values written, 0 if the item is not
+		present.
+		\param requests The requests to fill
+		\param count The number of requests
+		\returns The number of requests that were found in the packet
+	*/
+	XsSize XsDataPacket_getValues(const XsDataPacket* thisPtr, XsDataPacketValueRequest* requests, XsSize count)
+	{
+		XsSize found = 0;
+		for (XsSize r = 0; r < count; ++r)
+		{
+			XsDataPacketValueRequest& req = requests[r];
+			auto it = MAP.find(req.m_id);
+			req.m_found = (it == MAP.end()) ? 0 : it->second->toDoubles(req.m_values, req.m_count);
+			if (req.m_found)
+				++found;
+		}
+		return found;
+	}
+
 	/*!	\brief Overwrite the contents of the XsDataPacket with the contents of the supplied XsMessage
 		\param msg The XsMessage to read from
 		\note The packet is cleared before inserting new items
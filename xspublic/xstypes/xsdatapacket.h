@@ -45,6 +45,7 @@
 #include "xspressure.h"
 #include "xssdidata.h"
 #include "xsvector.h"
+#include "xsvector3.h"
 #include "xsquaternion.h"
 #include "xsmatrix.h"
 #include "xseuler.h"
@@ -59,6 +60,7 @@
 #include "xsglovesnapshot.h"
 #include "xsglovedata.h"
 #include "xshandid.h"
+#include "xsdatapacketvaluerequest.h"
 
 #ifndef XSNOEXPORT
 	#define XSNOEXPORT
@@ -254,6 +256,10 @@ XSTYPES_DLL_API int XsDataPacket_containsGnssPvtPulse(const XsDataPacket* thisPt
 XSTYPES_DLL_API void XsDataPacket_setGnssPvtPulse(XsDataPacket* thisPtr, uint32_t counter);
 
 XSTYPES_DLL_API XsDataPacket* XsDataPacket_merge(XsDataPacket* thisPtr, const XsDataPacket* other, int overwrite);
+XSTYPES_DLL_API void XsDataPacket_copySelection(XsDataPacket* thisPtr, const XsDataPacket* src, const XsDataIdentifier* ids, XsSize count);
+XSTYPES_DLL_API XsSize XsDataPacket_getDoubles(const XsDataPacket* thisPtr, XsDataIdentifier id, double* dest, XsSize count);
+XSTYPES_DLL_API XsSize XsDataPacket_getFloats(const XsDataPacket* thisPtr, XsDataIdentifier id, float* dest, XsSize count);
+XSTYPES_DLL_API XsSize XsDataPacket_getValues(const XsDataPacket* thisPtr, XsDataPacketValueRequest* requests, XsSize count);
 XSTYPES_DLL_API void XsDataPacket_setTriggerIndication(XsDataPacket* thisPtr, XsDataIdentifier triggerId, const XsTriggerIndicationData* triggerIndicationData);
 XSTYPES_DLL_API XsTriggerIndicationData* XsDataPacket_triggerIndication(const XsDataPacket* thisPtr, XsDataIdentifier triggerId, XsTriggerIndicationData* returnVal);
 XSTYPES_DLL_API int XsDataPacket_containsTriggerIndication(const XsDataPacket* thisPtr, XsDataIdentifier triggerId);
@@ -1555,6 +1561,45 @@ struct XsDataPacket
 		return *XsDataPacket_merge(this, &other, overwrite ? 1 : 0);
 	}
 
+	/*! \copydoc XsDataPacket_copySelection(XsDataPacket*, const XsDataPacket*, const XsDataIdentifier*, XsSize) */
+	inline XsDataPacket& copySelection(const XsDataPacket& src, const XsDataIdentifier* ids, XsSize count)
+	{
+		XsDataPacket_copySelection(this, &src, ids, count);
+		return *this;
+	}
+
+	/*! \copydoc XsDataPacket_getDoubles(const XsDataPacket*, XsDataIdentifier, double*, XsSize) */
+	template <XsSize N>
+	inline XsSize getValues(XsDataIdentifier id, double (&dest)[N]) const
+	{
+		return XsDataPacket_getDoubles(this, id, dest, N);
+	}
+
+	/*! \copydoc XsDataPacket_getFloats(const XsDataPacket*, XsDataIdentifier, float*, XsSize) */
+	template <XsSize N>
+	inline XsSize getValues(XsDataIdentifier id, float (&dest)[N]) const
+	{
+		return XsDataPacket_getFloats(this, id, dest, N);
+	}
+
+	/*! \copydoc XsDataPacket_getValues(const XsDataPacket*, XsDataPacketValueRequest*, XsSize) */
+	inline XsSize getValues(XsDataPacketValueRequest* requests, XsSize count) const
+	{
+		return XsDataPacket_getValues(this, requests, count);
+	}
+
+	/*! \brief Returns the three values of item \a id as an XsVector3
+		\details Unlike the accessors that return an XsVector, this does not allocate memory.
+		\param id The identifier of the item, such as XDI_Acceleration or XDI_RateOfTurn
+		\returns The values of the item, or a zero vector if the packet does not contain it
+	*/
+	inline XsVector3 vector3(XsDataIdentifier id) const
+	{
+		double v[3] = { 0, 0, 0 };
+		XsDataPacket_getDoubles(this, id, v, 3);
+		return XsVector3((XsReal) v[0], (XsReal) v[1], (XsReal) v[2]);
+	}
+
 	/*! \brief Set the time of arrival of the data packet
 		\param t The time of arrival
 	*/
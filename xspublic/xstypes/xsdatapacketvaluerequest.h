@@ -0,0 +1,65 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+#ifndef XSDATAPACKETVALUEREQUEST_H
+#define XSDATAPACKETVALUEREQUEST_H
+
+#include "xstypesconfig.h"
+#include "xsdataidentifier.h"
+
+#ifndef __cplusplus
+#define XSDATAPACKETVALUEREQUEST_INITIALIZER	{ XDI_None, 0, 0, 0 }
+typedef struct XsDataPacketValueRequest XsDataPacketValueRequest;
+#endif
+
+/*! \brief A single item request for XsDataPacket_getValues
+	\details The caller provides the storage, so retrieving values does not allocate memory.
+*/
+struct XsDataPacketValueRequest
+{
+	XsDataIdentifier m_id;	//!< The identifier of the requested item, the format bits are ignored
+	double* m_values;		//!< The destination of the values, this must have room for m_count values
+	XsSize m_count;			//!< The maximum number of values to write to m_values
+	XsSize m_found;			//!< Set to the number of values that were written, 0 if the item was not found
+
+#ifdef __cplusplus
+	//! \brief Constructs a request for at most \a count values of item \a id, to be written to \a values
+	explicit XsDataPacketValueRequest(XsDataIdentifier id = XDI_None, double* values = 0, XsSize count = 0)
+		: m_id(id)
+		, m_values(values)
+		, m_count(count)
+		, m_found(0)
+	{
+	}
+#endif
+};
+
+#endif
@@ -232,6 +232,17 @@ struct XsMessage
 		updateChecksumPtr();
 	}
 
+#ifndef SWIG
+	//! \brief Move constructor, takes over the buffer of \a src and leaves \a src empty
+	inline XsMessage(XsMessage&& src) noexcept
+		: m_autoUpdateChecksum(src.m_autoUpdateChecksum)
+		, m_checksum(src.m_checksum)
+	{
+		m_message.swap(src.m_message);
+		*const_cast<uint8_t**>(&src.m_checksum) = 0;
+	}
+#endif
+
 	//! Destroy the message
 	inline ~XsMessage()
 	{
@@ -492,6 +503,22 @@ struct XsMessage
 		return *this;
 	}
 
+#ifndef SWIG
+	//! Move message src into this, leaving src empty
+	inline XsMessage& operator = (XsMessage&& src) noexcept
+	{
+		if (this != &src)
+		{
+			XsMessage_destruct(this);
+			m_message.swap(src.m_message);
+			m_autoUpdateChecksum = src.m_autoUpdateChecksum;
+			*const_cast<uint8_t**>(&m_checksum) = src.m_checksum;
+			*const_cast<uint8_t**>(&src.m_checksum) = 0;
+		}
+		return *this;
+	}
+#endif
+
 	/*! \copydoc XsMessage_deleteData */
 	inline void deleteData(XsSize count, XsSize offset = 0)
 	{
@@ -0,0 +1,578 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+#include "xsquaternionbatch.h"
+#include "xsquaternion.h"
+#include "xseuler.h"
+#include "xsmatrix.h"
+#include <math.h>
+
+/*	The vectorized kernels are only available for double precision on x86-64, where SSE2 is always present.
+	The AVX2 kernels are compiled for that instruction set regardless of the compiler flags and are only used
+	when the CPU reports support for AVX2 and FMA at runtime.
+*/
+#if !defined(XSENS_SINGLE_PRECISION) && (defined(__x86_64__) || defined(_M_X64))
+	#define XSQB_SIMD	1
+	#include <immintrin.h>
+	#ifdef _MSC_VER
+		#include <intrin.h>
+	#endif
+#else
+	#define XSQB_SIMD	0
+#endif
+
+/*! \struct XsQuaternionSoA
+	\brief An array of quaternions in structure-of-arrays form
+	\details The XsQuaternionBatch functions operate on arrays of samples stored per component, which allows
+	them to process several samples with a single SIMD instruction. The results are equal to the results of
+	the corresponding XsQuaternion, XsMatrix and XsEuler functions up to a few ulp. All functions accept the
+	same arrays for input and output, as long as an output does not partially overlap an input.
+*/
+
+//! \brief Dot products above 1 - slerpLinearLimit are interpolated linearly by XsQuaternionBatch_slerp
+static const XsReal slerpLinearLimit = 1e-9;
+
+static void multiplyScalar(const XsQuaternionSoA* left, const XsQuaternionSoA* right, XsQuaternionSoA* dest, XsSize begin, XsSize count)
+{
+	XsSize i;
+	for (i = begin; i < count; ++i)
+	{
+		XsReal a0 = left->m_w[i], a1 = left->m_x[i], a2 = left->m_y[i], a3 = left->m_z[i];
+		XsReal b0 = right->m_w[i], b1 = right->m_x[i], b2 = right->m_y[i], b3 = right->m_z[i];
+
+		dest->m_w[i] = a0 * b0 - a1 * b1 - a2 * b2 - a3 * b3;
+		dest->m_x[i] = a1 * b0 + a0 * b1 - a3 * b2 + a2 * b3;
+		dest->m_y[i] = a2 * b0 + a3 * b1 + a0 * b2 - a1 * b3;
+		dest->m_z[i] = a3 * b0 - a2 * b1 + a1 * b2 + a0 * b3;
+	}
+}
+
+static void normalizeScalar(const XsQuaternionSoA* src, XsQuaternionSoA* dest, XsSize begin, XsSize count)
+{
+	XsSize i;
+	for (i = begin; i < count; ++i)
+	{
+		XsReal w = src->m_w[i], x = src->m_x[i], y = src->m_y[i], z = src->m_z[i];
+		XsReal divisor = XsMath_one / sqrt(w * w + x * x + y * y + z * z);
+		if (w < XsMath_zero)
+			divisor = -divisor;
+
+		dest->m_w[i] = w * divisor;
+		dest->m_x[i] = x * divisor;
+		dest->m_y[i] = y * divisor;
+		dest->m_z[i] = z * divisor;
+	}
+}
+
+//! \brief Compute the rotation matrix of quaternion \a i, the same way as XsMatrix_fromQuaternion
+static void rotationMatrixLane(const XsQuaternionSoA* quat, XsSize i, XsReal* r)
+{
+	XsReal w = quat->m_w[i], x = quat->m_x[i], y = quat->m_y[i], z = quat->m_z[i];
+	XsReal q00 = w * w, q11 = x * x, q22 = y * y, q33 = z * z;
+	XsReal q01 = w * x, q02 = w * y, q03 = w * z;
+	XsReal q12 = x * y, q13 = x * z, q23 = y * z;
+
+	r[0] = q00 + q11 - q22 - q33;
+	r[1] = XsMath_two * (q12 - q03);
+	r[2] = XsMath_two * (q13 + q02);
+	r[3] = XsMath_two * (q12 + q03);
+	r[4] = (q00 - q11) + (q22 - q33);
+	r[5] = XsMath_two * (q23 - q01);
+	r[6] = XsMath_two * (q13 - q02);
+	r[7] = XsMath_two * (q23 + q01);
+	r[8] = q00 - q11 - q22 + q33;
+}
+
+static void rotateVectorScalar(const XsQuaternionSoA* quat, const XsVector3SoA* vec, XsVector3SoA* dest, XsSize begin, XsSize count)
+{
+	XsSize i;
+	for (i = begin; i < count; ++i)
+	{
+		XsReal r[9];
+		XsReal x = vec->m_x[i], y = vec->m_y[i], z = vec->m_z[i];
+		rotationMatrixLane(quat, i, r);
+		dest->m_x[i] = r[0] * x + r[1] * y + r[2] * z;
+		dest->m_y[i] = r[3] * x + r[4] * y + r[5] * z;
+		dest->m_z[i] = r[6] * x + r[7] * y + r[8] * z;
+	}
+}
+
+static void toRotationMatrixScalar(const XsQuaternionSoA* quat, XsMatrix3x3SoA* dest, XsSize begin, XsSize count)
+{
+	XsSize i;
+	int k;
+	for (i = begin; i < count; ++i)
+	{
+		XsReal r[9];
+		rotationMatrixLane(quat, i, r);
+		for (k = 0; k < 9; ++k)
+			dest->m_data[k][i] = r[k];
+	}
+}
+
+static void fromRotationMatrixLane(const XsMatrix3x3SoA* ori, XsQuaternionSoA* dest, XsSize i)
+{
+	XsReal buffer[9];
+	XsMatrix m;
+	XsQuaternion q;
+	int k;
+
+	for (k = 0; k < 9; ++k)
+		buffer[k] = ori->m_data[k][i];
+	XsMatrix_ref(&m, 3, 3, 3, buffer, XSDF_None);
+	XsQuaternion_fromRotationMatrix(&q, &m);
+
+	dest->m_w[i] = q.m_w;
+	dest->m_x[i] = q.m_x;
+	dest->m_y[i] = q.m_y;
+	dest->m_z[i] = q.m_z;
+}
+
+static void fromRotationMatrixScalar(const XsMatrix3x3SoA* ori, XsQuaternionSoA* dest, XsSize begin, XsSize count)
+{
+	XsSize i;
+	for (i = begin; i < count; ++i)
+		fromRotationMatrixLane(ori, dest, i);
+}
+
+static void toEulerAnglesLane(const XsQuaternionSoA* quat, XsVector3SoA* dest, XsSize i)
+{
+	XsQuaternion q;
+	XsEuler e;
+
+	q.m_w = quat->m_w[i];
+	q.m_x = quat->m_x[i];
+	q.m_y = quat->m_y[i];
+	q.m_z = quat->m_z[i];
+	XsEuler_fromQuaternion(&e, &q);
+
+	dest->m_x[i] = e.m_x;
+	dest->m_y[i] = e.m_y;
+	dest->m_z[i] = e.m_z;
+}
+
+static void toEulerAnglesScalar(const XsQuaternionSoA* quat, XsVector3SoA* dest, XsSize begin, XsSize count)
+{
+	XsSize i;
+	for (i = begin; i < count; ++i)
+		toEulerAnglesLane(quat, dest, i);
+}
+
+static void slerpLane(const XsQuaternionSoA* from, const XsQuaternionSoA* to, const XsReal* t, XsQuaternionSoA* dest, XsSize i)
+{
+	XsReal aw = from->m_w[i], ax = from->m_x[i], ay = from->m_y[i], az = from->m_z[i];
+	XsReal bw = to->m_w[i], bx = to->m_x[i], by = to->m_y[i], bz = to->m_z[i];
+	XsReal dot = aw * bw + ax * bx + ay * by + az * bz;
+	XsReal wa, wb, rw, rx, ry, rz, scale = XsMath_one;
+
+	// take the shortest path
+	if (dot < XsMath_zero)
+	{
+		dot = -dot;
+		bw = -bw;
+		bx = -bx;
+		by = -by;
+		bz = -bz;
+	}
+
+	if (dot > XsMath_one - slerpLinearLimit)
+	{
+		wa = XsMath_one - t[i];
+		wb = t[i];
+	}
+	else
+	{
+		XsReal sinTheta = sqrt((XsMath_one - dot) * (XsMath_one + dot));
+		XsReal theta = atan2(sinTheta, dot);
+		wa = sin((XsMath_one - t[i]) * theta) / sinTheta;
+		wb = sin(t[i] * theta) / sinTheta;
+	}
+
+	rw = wa * aw + wb * bw;
+	rx = wa * ax + wb * bx;
+	ry = wa * ay + wb * by;
+	rz = wa * az + wb * bz;
+	if (dot > XsMath_one - slerpLinearLimit)
+		scale = XsMath_one / sqrt(rw * rw + rx * rx + ry * ry + rz * rz);
+
+	dest->m_w[i] = rw * scale;
+	dest->m_x[i] = rx * scale;
+	dest->m_y[i] = ry * scale;
+	dest->m_z[i] = rz * scale;
+}
+
+static void slerpScalar(const XsQuaternionSoA* from, const XsQuaternionSoA* to, const XsReal* t, XsQuaternionSoA* dest, XsSize begin, XsSize count)
+{
+	XsSize i;
+	for (i = begin; i < count; ++i)
+		slerpLane(from, to, t, dest, i);
+}
+
+#if XSQB_SIMD
+
+static const XsReal quarterPi = 0.78539816339744830962;
+static const XsReal halfPiHigh = 1.5707963267948966;			// pi/2 rounded to double
+static const XsReal halfPiLow = 6.123233995736766036e-17;		// pi/2 - halfPiHigh
+static const XsReal piHigh = 3.1415926535897931;				// pi rounded to double
+static const XsReal piLow = 1.2246467991473532072e-16;			// pi - piHigh
+
+// rational approximation of atan(x) for |x| <= 0.66, from the Cephes math library
+static const XsReal atanP[5] = {
+	-8.750608600031904122785E-1, -1.615753718733365076637E1, -7.500855792314704667340E1,
+	-1.228866684490136173410E2, -6.485021904942025371773E1
+};
+static const XsReal atanQ[5] = {
+	2.485846490142306297962E1, 1.650270098316988542046E2, 4.328810604912902668951E2,
+	4.853903996359136964868E2, 1.945506571482613964425E2
+};
+
+// polynomial approximations of sin(x) and cos(x) for |x| <= pi/4, from the Cephes math library
+static const XsReal sinCoefficients[6] = {
+	1.58962301576546568060E-10, -2.50507477628578072866E-8, 2.75573136213857245213E-6,
+	-1.98412698295895385996E-4, 8.33333333332211858878E-3, -1.66666666666666307295E-1
+};
+static const XsReal cosCoefficients[6] = {
+	-1.13585365213876817300E-11, 2.08757008419747316778E-9, -2.75573141792967388112E-7,
+	2.48015872888517045348E-5, -1.38888888888730564116E-3, 4.16666666666665929218E-2
+};
+
+#define XSQB_VEC		__m128d
+#define XSQB_WIDTH		2
+#define XSQB_FN(name)	name##_sse2
+#define VLOAD(p)		_mm_loadu_pd(p)
+#define VSTORE(p, v)	_mm_storeu_pd(p, v)
+#define VSET(x)			_mm_set1_pd(x)
+#define VZERO()			_mm_setzero_pd()
+#define VADD(a, b)		_mm_add_pd(a, b)
+#define VSUB(a, b)		_mm_sub_pd(a, b)
+#define VMUL(a, b)		_mm_mul_pd(a, b)
+#define VDIV(a, b)		_mm_div_pd(a, b)
+#define VSQRT(a)		_mm_sqrt_pd(a)
+#define VMIN(a, b)		_mm_min_pd(a, b)
+#define VMAX(a, b)		_mm_max_pd(a, b)
+#define VMADD(a, b, c)	_mm_add_pd(_mm_mul_pd(a, b), c)
+#define VMSUB(a, b, c)	_mm_sub_pd(_mm_mul_pd(a, b), c)
+#define VNMADD(a, b, c)	_mm_sub_pd(c, _mm_mul_pd(a, b))
+#define VAND(a, b)		_mm_and_pd(a, b)
+#define VOR(a, b)		_mm_or_pd(a, b)
+#define VXOR(a, b)		_mm_xor_pd(a, b)
+#define VANDNOT(a, b)	_mm_andnot_pd(a, b)
+#define VLT(a, b)		_mm_cmplt_pd(a, b)
+#define VGT(a, b)		_mm_cmpgt_pd(a, b)
+#define VEQ(a, b)		_mm_cmpeq_pd(a, b)
+#define VSELECT(m, a, b)	_mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b))
+#define VMASKBITS(m)	_mm_movemask_pd(m)
+
+#include "xsquaternionbatch_kernels.h"
+
+#undef XSQB_VEC
+#undef XSQB_WIDTH
+#undef XSQB_FN
+#undef VLOAD
+#undef VSTORE
+#undef VSET
+#undef VZERO
+#undef VADD
+#undef VSUB
+#undef VMUL
+#undef VDIV
+#undef VSQRT
+#undef VMIN
+#undef VMAX
+#undef VMADD
+#undef VMSUB
+#undef VNMADD
+#undef VAND
+#undef VOR
+#undef VXOR
+#undef VANDNOT
+#undef VLT
+#undef VGT
+#undef VEQ
+#undef VSELECT
+#undef VMASKBITS
+
+#if defined(__clang__)
+	#pragma clang attribute push(__attribute__((target("avx2,fma"))), apply_to = function)
+#elif defined(__GNUC__)
+	#pragma GCC push_options
+	#pragma GCC target("avx2,fma")
+#endif
+
+#define XSQB_VEC		__m256d
+#define XSQB_WIDTH		4
+#define XSQB_FN(name)	name##_avx2
+#define VLOAD(p)		_mm256_loadu_pd(p)
+#define VSTORE(p, v)	_mm256_storeu_pd(p, v)
+#define VSET(x)			_mm256_set1_pd(x)
+#define VZERO()			_mm256_setzero_pd()
+#define VADD(a, b)		_mm256_add_pd(a, b)
+#define VSUB(a, b)		_mm256_sub_pd(a, b)
+#define VMUL(a, b)		_mm256_mul_pd(a, b)
+#define VDIV(a, b)		_mm256_div_pd(a, b)
+#define VSQRT(a)		_mm256_sqrt_pd(a)
+#define VMIN(a, b)		_mm256_min_pd(a, b)
+#define VMAX(a, b)		_mm256_max_pd(a, b)
+#define VMADD(a, b, c)	_mm256_fmadd_pd(a, b, c)
+#define VMSUB(a, b, c)	_mm256_fmsub_pd(a, b, c)
+#define VNMADD(a, b, c)	_mm256_fnmadd_pd(a, b, c)
+#define VAND(a, b)		_mm256_and_pd(a, b)
+#define VOR(a, b)		_mm256_or_pd(a, b)
+#define VXOR(a, b)		_mm256_xor_pd(a, b)
+#define VANDNOT(a, b)	_mm256_andnot_pd(a, b)
+#define VLT(a, b)		_mm256_cmp_pd(a, b, _CMP_LT_OQ)
+#define VGT(a, b)		_mm256_cmp_pd(a, b, _CMP_GT_OQ)
+#define VEQ(a, b)		_mm256_cmp_pd(a, b, _CMP_EQ_OQ)
+#define VSELECT(m, a, b)	_mm256_blendv_pd(b, a, m)
+#define VMASKBITS(m)	_mm256_movemask_pd(m)
+
+#include "xsquaternionbatch_kernels.h"
+
+#if defined(__clang__)
+	#pragma clang attribute pop
+#elif defined(__GNUC__)
+	#pragma GCC pop_options
+#endif
+
+//! \brief Returns the best instruction set supported by the CPU and operating system
+static XsSimdLevel detectSimdLevel(void)
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] >= 7)
+	{
+		// FMA, OSXSAVE and AVX, with the AVX state enabled by the operating system
+		__cpuid(info, 1);
+		if ((info[2] & (1 << 12)) && (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6)
+		{
+			__cpuidex(info, 7, 0);
+			if (info[1] & (1 << 5))
+				return XSL_Avx2;
+		}
+	}
+	return XSL_Sse2;
+#else
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+		return XSL_Avx2;
+	return XSL_Sse2;
+#endif
+}
+
+#else
+
+static XsSimdLevel detectSimdLevel(void)
+{
+	return XSL_Scalar;
+}
+
+#endif
+
+static int g_supportedLevel = -1;
+static int g_activeLevel = -1;
+
+//! \brief Returns the instruction set to use, detecting it on first use
+static XsSimdLevel activeLevel(void)
+{
+	if (g_activeLevel < 0)
+	{
+		g_supportedLevel = (int) detectSimdLevel();
+		g_activeLevel = g_supportedLevel;
+	}
+	return (XsSimdLevel) g_activeLevel;
+}
+
+/*	Run the vectorized kernel for the active instruction set, which sets \a done to the number of samples it
+	processed. The scalar code processes the rest.
+*/
+#if XSQB_SIMD
+#define XSQB_DISPATCH(done, name, args)	\
+	switch (activeLevel())	\
+	{	\
+	case XSL_Avx2:	done = name##_avx2 args; break;	\
+	case XSL_Sse2:	done = name##_sse2 args; break;	\
+	default:		done = 0; break;	\
+	}
+#else
+#define XSQB_DISPATCH(done, name, args)	done = 0;
+#endif
+
+/*! \addtogroup cinterface C Interface
+	@{
+*/
+
+/*! \relates XsQuaternionSoA
+	\brief Returns the instruction set that is used by the XsQuaternionBatch functions
+	\details By default this is the best instruction set that is supported by the CPU.
+*/
+XsSimdLevel XsQuaternionBatch_simdLevel(void)
+{
+	return activeLevel();
+}
+
+/*! \relates XsQuaternionSoA
+	\brief Select the instruction set to use for the XsQuaternionBatch functions
+	\details This is mainly intended for comparing the vectorized and scalar results. The change applies to
+	all threads, so it should not be made while other threads use the XsQuaternionBatch functions.
+	\param level The requested instruction set, which is lowered to the best supported instruction set
+	\returns The instruction set that will be used
+*/
+XsSimdLevel XsQuaternionBatch_setSimdLevel(XsSimdLevel level)
+{
+	activeLevel();
+	g_activeLevel = ((int) level < g_supportedLevel) ? (int) level : g_supportedLevel;
+	if (g_activeLevel < 0)
+		g_activeLevel = XSL_Scalar;
+	return (XsSimdLevel) g_activeLevel;
+}
+
+/*! \relates XsQuaternionSoA
+	\brief Copy \a count quaternions from the array \a src into the component arrays of \a dest
+*/
+void XsQuaternionBatch_load(XsQuaternionSoA* dest, const struct XsQuaternion* src, XsSize count)
+{
+	XsSize i;
+	for (i = 0; i < count; ++i)
+	{
+		dest->m_w[i] = src[i].m_w;
+		dest->m_x[i] = src[i].m_x;
+		dest->m_y[i] = src[i].m_y;
+		dest->m_z[i] = src[i].m_z;
+	}
+}
+
+/*! \relates XsQuaternionSoA
+	\brief Copy \a count quaternions from the component arrays of \a src into the array \a dest
+*/
+void XsQuaternionBatch_store(const XsQuaternionSoA* src, struct XsQuaternion* dest, XsSize count)
+{
+	XsSize i;
+	for (i = 0; i < count; ++i)
+	{
+		dest[i].m_w = src->m_w[i];
+		dest[i].m_x = src->m_x[i];
+		dest[i].m_y = src->m_y[i];
+		dest[i].m_z = src->m_z[i];
+	}
+}
+
+/*! \relates XsQuaternionSoA
+	\brief Multiply \a count pairs of quaternions, see XsQuaternion_multiply
+	\param left The left hand side quaternions
+	\param right The right hand side quaternions
+	\param dest The arrays to write the products to
+	\param count The number of quaternions
+*/
+void XsQuaternionBatch_multiply(const XsQuaternionSoA* left, const XsQuaternionSoA* right, XsQuaternionSoA* dest, XsSize count)
+{
+	XsSize done;
+	XSQB_DISPATCH(done, multiply, (left, right, dest, count))
+	multiplyScalar(left, right, dest, done, count);
+}
+
+/*! \relates XsQuaternionSoA
+	\brief Normalize \a count quaternions so that they have a length of 1 and a positive w, see XsQuaternion_normalized
+*/
+void XsQuaternionBatch_normalize(const XsQuaternionSoA* src, XsQuaternionSoA* dest, XsSize count)
+{
+	XsSize done;
+	XSQB_DISPATCH(done, normalize, (src, dest, count))
+	normalizeScalar(src, dest, done, count);
+}
+
+/*! \relates XsQuaternionSoA
+	\brief Rotate \a count vectors by their corresponding unit quaternions
+	\details Each vector is multiplied by the rotation matrix of its quaternion as computed by XsMatrix_fromQuaternion.
+	\param quat The rotations to apply
+	\param vec The vectors to rotate
+	\param dest The arrays to write the rotated vectors to
+	\param count The number of vectors
+*/
+void XsQuaternionBatch_rotateVector(const XsQuaternionSoA* quat, const XsVector3SoA* vec, XsVector3SoA* dest, XsSize count)
+{
+	XsSize done;
+	XSQB_DISPATCH(done, rotateVector, (quat, vec, dest, count))
+	rotateVectorScalar(quat, vec, dest, done, count);
+}
+
+/*! \relates XsQuaternionSoA
+	\brief Compute the rotation matrices of \a count quaternions, see XsMatrix_fromQuaternion
+	\note Unlike XsMatrix_fromQuaternion this produces a zero matrix for an empty quaternion.
+*/
+void XsQuaternionBatch_toRotationMatrix(const XsQuaternionSoA* quat, XsMatrix3x3SoA* dest, XsSize count)
+{
+	XsSize done;
+	XSQB_DISPATCH(done, toRotationMatrix, (quat, dest, count))
+	toRotationMatrixScalar(quat, dest, done, count);
+}
+
+/*! \relates XsQuaternionSoA
+	\brief Compute the quaternions of \a count rotation matrices, see XsQuaternion_fromRotationMatrix
+*/
+void XsQuaternionBatch_fromRotationMatrix(const XsMatrix3x3SoA* ori, XsQuaternionSoA* dest, XsSize count)
+{
+	XsSize done;
+	XSQB_DISPATCH(done, fromRotationMatrix, (ori, dest, count))
+	fromRotationMatrixScalar(ori, dest, done, count);
+}
+
+/*! \relates XsQuaternionSoA
+	\brief Compute the Euler angles in degrees of \a count quaternions, see XsEuler_fromQuaternion
+	\param quat The quaternions to convert
+	\param dest The arrays to write the roll (x), pitch (y) and yaw (z) angles to
+	\param count The number of quaternions
+*/
+void XsQuaternionBatch_toEulerAngles(const XsQuaternionSoA* quat, XsVector3SoA* dest, XsSize count)
+{
+	XsSize done;
+	XSQB_DISPATCH(done, toEulerAngles, (quat, dest, count))
+	toEulerAnglesScalar(quat, dest, done, count);
+}
+
+/*! \relates XsQuaternionSoA
+	\brief Spherically interpolate \a count pairs of unit quaternions
+	\details The interpolation follows the shortest path, so the result may be the negation of \a to for t = 1.
+	Nearly equal rotations are interpolated linearly and normalized.
+	\param from The rotations at t = 0
+	\param to The rotations at t = 1
+	\param t The interpolation factors, the vectorized code is used for factors in the range [0, 1]
+	\param dest The arrays to write the interpolated rotations to
+	\param count The number of quaternions
+*/
+void XsQuaternionBatch_slerp(const XsQuaternionSoA* from, const XsQuaternionSoA* to, const XsReal* t, XsQuaternionSoA* dest, XsSize count)
+{
+	XsSize done;
+	XSQB_DISPATCH(done, slerp, (from, to, t, dest, count))
+	slerpScalar(from, to, t, dest, done, count);
+}
+
+/*! @} */
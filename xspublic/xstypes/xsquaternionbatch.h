@@ -0,0 +1,102 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+#ifndef XSQUATERNIONBATCH_H
+#define XSQUATERNIONBATCH_H
+
+#include "xsmath.h"
+
+struct XsQuaternion;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!	\addtogroup enums Global enumerations
+	@{
+*/
+/*! \brief The instruction set used by the XsQuaternionBatch functions */
+enum XsSimdLevel
+{
+	XSL_Scalar = 0,		//!< Plain C, one sample at a time
+	XSL_Sse2 = 1,		//!< SSE2, two samples at a time
+	XSL_Avx2 = 2		//!< AVX2 with FMA, four samples at a time
+};
+/*! @} */
+typedef enum XsSimdLevel XsSimdLevel;
+
+/*! \brief An array of quaternions in structure-of-arrays form, each member points to \a count values */
+struct XsQuaternionSoA
+{
+	XsReal* m_w;	//!< The w (real) components
+	XsReal* m_x;	//!< The x components
+	XsReal* m_y;	//!< The y components
+	XsReal* m_z;	//!< The z components
+};
+typedef struct XsQuaternionSoA XsQuaternionSoA;
+
+/*! \brief An array of 3D vectors or Euler angles in structure-of-arrays form */
+struct XsVector3SoA
+{
+	XsReal* m_x;	//!< The x components, or the roll angles
+	XsReal* m_y;	//!< The y components, or the pitch angles
+	XsReal* m_z;	//!< The z components, or the yaw angles
+};
+typedef struct XsVector3SoA XsVector3SoA;
+
+/*! \brief An array of 3x3 matrices in structure-of-arrays form
+	\details m_data[r * 3 + c] points to the values of row r, column c of all matrices.
+*/
+struct XsMatrix3x3SoA
+{
+	XsReal* m_data[9];	//!< The elements of the matrices in row-major order
+};
+typedef struct XsMatrix3x3SoA XsMatrix3x3SoA;
+
+XSTYPES_DLL_API XsSimdLevel XsQuaternionBatch_simdLevel(void);
+XSTYPES_DLL_API XsSimdLevel XsQuaternionBatch_setSimdLevel(XsSimdLevel level);
+
+XSTYPES_DLL_API void XsQuaternionBatch_load(XsQuaternionSoA* dest, const struct XsQuaternion* src, XsSize count);
+XSTYPES_DLL_API void XsQuaternionBatch_store(const XsQuaternionSoA* src, struct XsQuaternion* dest, XsSize count);
+
+XSTYPES_DLL_API void XsQuaternionBatch_multiply(const XsQuaternionSoA* left, const XsQuaternionSoA* right, XsQuaternionSoA* dest, XsSize count);
+XSTYPES_DLL_API void XsQuaternionBatch_normalize(const XsQuaternionSoA* src, XsQuaternionSoA* dest, XsSize count);
+XSTYPES_DLL_API void XsQuaternionBatch_rotateVector(const XsQuaternionSoA* quat, const XsVector3SoA* vec, XsVector3SoA* dest, XsSize count);
+XSTYPES_DLL_API void XsQuaternionBatch_toRotationMatrix(const XsQuaternionSoA* quat, XsMatrix3x3SoA* dest, XsSize count);
+XSTYPES_DLL_API void XsQuaternionBatch_fromRotationMatrix(const XsMatrix3x3SoA* ori, XsQuaternionSoA* dest, XsSize count);
+XSTYPES_DLL_API void XsQuaternionBatch_toEulerAngles(const XsQuaternionSoA* quat, XsVector3SoA* dest, XsSize count);
+XSTYPES_DLL_API void XsQuaternionBatch_slerp(const XsQuaternionSoA* from, const XsQuaternionSoA* to, const XsReal* t, XsQuaternionSoA* dest, XsSize count);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif
@@ -0,0 +1,296 @@
+
+//  Copyright (c) 2003-2025 Movella Technologies B.V. or subsidiaries worldwide.
+//  All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without modification,
+//  are permitted provided that the following conditions are met:
+//  
+//  1.	Redistributions of source code must retain the above copyright notice,
+//  	this list of conditions, and the following disclaimer.
+//  
+//  2.	Redistributions in binary form must reproduce the above copyright notice,
+//  	this list of conditions, and the following disclaimer in the documentation
+//  	and/or other materials provided with the distribution.
+//  
+//  3.	Neither the names of the copyright holders nor the names of their contributors
+//  	may be used to endorse or promote products derived from this software without
+//  	specific prior written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+//  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+//  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+//  THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+//  SPECIAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT 
+//  OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY OR
+//  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.THE LAWS OF THE NETHERLANDS 
+//  SHALL BE EXCLUSIVELY APPLICABLE AND ANY DISPUTES SHALL BE FINALLY SETTLED UNDER THE RULES 
+//  OF ARBITRATION OF THE INTERNATIONAL CHAMBER OF COMMERCE IN THE HAGUE BY ONE OR MORE 
+//  ARBITRATORS APPOINTED IN ACCORDANCE WITH SAID RULES.
+//  
+/*	Vectorized kernels of xsquaternionbatch.c
+
+	This file is included once per instruction set by xsquaternionbatch.c, which defines the vector type
+	XSQB_VEC of XSQB_WIDTH lanes, the function name decoration XSQB_FN and the following operations on it:
+	VLOAD, VSTORE, VSET, VZERO, VADD, VSUB, VMUL, VDIV, VSQRT, VMIN, VMAX, VMADD (a*b+c), VMSUB (a*b-c),
+	VNMADD (c-a*b), VAND, VOR, VXOR, VANDNOT (~a&b), VLT, VGT, VEQ, VSELECT (m ? a : b) and VMASKBITS.
+
+	Each kernel processes the largest multiple of XSQB_WIDTH samples and returns that number, the caller
+	processes the remaining samples with the scalar code. Blocks containing a sample that needs special handling
+	are processed by the scalar lane functions, so the results match the scalar functions in all cases.
+*/
+
+//! \brief Evaluate the polynomial with coefficients c[0] * x^n + ... + c[n] at \a x
+static XSQB_VEC XSQB_FN(polynomial)(XSQB_VEC x, const XsReal* c, int n)
+{
+	int i;
+	XSQB_VEC r = VSET(c[0]);
+	for (i = 1; i <= n; ++i)
+		r = VMADD(r, x, VSET(c[i]));
+	return r;
+}
+
+//! \brief Evaluate the polynomial x^n + c[0] * x^(n-1) + ... + c[n-1] at \a x
+static XSQB_VEC XSQB_FN(polynomial1)(XSQB_VEC x, const XsReal* c, int n)
+{
+	int i;
+	XSQB_VEC r = VADD(x, VSET(c[0]));
+	for (i = 1; i < n; ++i)
+		r = VMADD(r, x, VSET(c[i]));
+	return r;
+}
+
+//! \brief atan2(y, x) for all lanes, accurate to a few ulp
+static XSQB_VEC XSQB_FN(atan2)(XSQB_VEC y, XSQB_VEC x)
+{
+	const XSQB_VEC signMask = VSET(-0.0);
+	XSQB_VEC ax = VANDNOT(signMask, x);
+	XSQB_VEC ay = VANDNOT(signMask, y);
+	XSQB_VEC mx = VMAX(ax, ay);
+	XSQB_VEC mn = VMIN(ax, ay);
+	XSQB_VEC zeroMask = VEQ(mx, VZERO());
+	XSQB_VEC a = VSELECT(zeroMask, VZERO(), VDIV(mn, VSELECT(zeroMask, VSET(1.0), mx)));
+
+	// atan(a) for 0 <= a <= 1
+	XSQB_VEC big = VGT(a, VSET(0.66));
+	XSQB_VEC xr = VSELECT(big, VDIV(VSUB(a, VSET(1.0)), VADD(a, VSET(1.0))), a);
+	XSQB_VEC z = VMUL(xr, xr);
+	XSQB_VEC r = VDIV(VMUL(z, XSQB_FN(polynomial)(z, atanP, 4)), XSQB_FN(polynomial1)(z, atanQ, 5));
+	r = VMADD(xr, r, xr);
+	r = VSELECT(big, VADD(VSET(quarterPi), VADD(r, VSET(0.5 * halfPiLow))), r);
+
+	// octant and quadrant corrections
+	r = VSELECT(VGT(ay, ax), VADD(VSUB(VSET(halfPiHigh), r), VSET(halfPiLow)), r);
+	r = VSELECT(VLT(x, VZERO()), VADD(VSUB(VSET(piHigh), r), VSET(piLow)), r);
+	return VOR(r, VAND(signMask, y));
+}
+
+//! \brief sin(x) for all lanes, for 0 <= x <= pi/2
+static XSQB_VEC XSQB_FN(sinQuadrant)(XSQB_VEC x)
+{
+	XSQB_VEC big = VGT(x, VSET(quarterPi));
+	XSQB_VEC u = VSELECT(big, VADD(VSUB(VSET(halfPiHigh), x), VSET(halfPiLow)), x);
+	XSQB_VEC z = VMUL(u, u);
+	XSQB_VEC s = VMADD(VMUL(u, z), XSQB_FN(polynomial)(z, sinCoefficients, 5), u);
+	XSQB_VEC c = VMADD(VMUL(z, z), XSQB_FN(polynomial)(z, cosCoefficients, 5), VNMADD(VSET(0.5), z, VSET(1.0)));
+	return VSELECT(big, c, s);
+}
+
+static XsSize XSQB_FN(multiply)(const XsQuaternionSoA* left, const XsQuaternionSoA* right, XsQuaternionSoA* dest, XsSize count)
+{
+	XsSize i, n = count - count % XSQB_WIDTH;
+	for (i = 0; i < n; i += XSQB_WIDTH)
+	{
+		XSQB_VEC a0 = VLOAD(left->m_w + i), a1 = VLOAD(left->m_x + i), a2 = VLOAD(left->m_y + i), a3 = VLOAD(left->m_z + i);
+		XSQB_VEC b0 = VLOAD(right->m_w + i), b1 = VLOAD(right->m_x + i), b2 = VLOAD(right->m_y + i), b3 = VLOAD(right->m_z + i);
+
+		VSTORE(dest->m_w + i, VNMADD(a3, b3, VNMADD(a2, b2, VMSUB(a0, b0, VMUL(a1, b1)))));
+		VSTORE(dest->m_x + i, VMADD(a2, b3, VNMADD(a3, b2, VMADD(a1, b0, VMUL(a0, b1)))));
+		VSTORE(dest->m_y + i, VNMADD(a1, b3, VMADD(a0, b2, VMADD(a2, b0, VMUL(a3, b1)))));
+		VSTORE(dest->m_z + i, VMADD(a0, b3, VMADD(a1, b2, VNMADD(a2, b1, VMUL(a3, b0)))));
+	}
+	return n;
+}
+
+static XsSize XSQB_FN(normalize)(const XsQuaternionSoA* src, XsQuaternionSoA* dest, XsSize count)
+{
+	const XSQB_VEC signMask = VSET(-0.0);
+	XsSize i, n = count - count % XSQB_WIDTH;
+	for (i = 0; i < n; i += XSQB_WIDTH)
+	{
+		XSQB_VEC w = VLOAD(src->m_w + i), x = VLOAD(src->m_x + i), y = VLOAD(src->m_y + i), z = VLOAD(src->m_z + i);
+		XSQB_VEC length = VSQRT(VMADD(z, z, VMADD(y, y, VMADD(x, x, VMUL(w, w)))));
+		XSQB_VEC divisor = VDIV(VSET(1.0), length);
+		divisor = VXOR(divisor, VAND(VLT(w, VZERO()), signMask));
+
+		VSTORE(dest->m_w + i, VMUL(w, divisor));
+		VSTORE(dest->m_x + i, VMUL(x, divisor));
+		VSTORE(dest->m_y + i, VMUL(y, divisor));
+		VSTORE(dest->m_z + i, VMUL(z, divisor));
+	}
+	return n;
+}
+
+//! \brief Compute the rotation matrix of the quaternions at \a i, the same way as XsMatrix_fromQuaternion
+static void XSQB_FN(rotationMatrix)(const XsQuaternionSoA* quat, XsSize i, XSQB_VEC* r)
+{
+	const XSQB_VEC two = VSET(2.0);
+	XSQB_VEC w = VLOAD(quat->m_w + i), x = VLOAD(quat->m_x + i), y = VLOAD(quat->m_y + i), z = VLOAD(quat->m_z + i);
+	XSQB_VEC q00 = VMUL(w, w), q11 = VMUL(x, x), q22 = VMUL(y, y), q33 = VMUL(z, z);
+	XSQB_VEC q01 = VMUL(w, x), q02 = VMUL(w, y), q03 = VMUL(w, z);
+	XSQB_VEC q12 = VMUL(x, y), q13 = VMUL(x, z), q23 = VMUL(y, z);
+
+	r[0] = VSUB(VSUB(VADD(q00, q11), q22), q33);
+	r[1] = VMUL(VSUB(q12, q03), two);
+	r[2] = VMUL(VADD(q13, q02), two);
+	r[3] = VMUL(VADD(q12, q03), two);
+	r[4] = VADD(VSUB(q00, q11), VSUB(q22, q33));
+	r[5] = VMUL(VSUB(q23, q01), two);
+	r[6] = VMUL(VSUB(q13, q02), two);
+	r[7] = VMUL(VADD(q23, q01), two);
+	r[8] = VADD(VSUB(VSUB(q00, q11), q22), q33);
+}
+
+static XsSize XSQB_FN(rotateVector)(const XsQuaternionSoA* quat, const XsVector3SoA* vec, XsVector3SoA* dest, XsSize count)
+{
+	XsSize i, n = count - count % XSQB_WIDTH;
+	for (i = 0; i < n; i += XSQB_WIDTH)
+	{
+		XSQB_VEC r[9];
+		XSQB_VEC x = VLOAD(vec->m_x + i), y = VLOAD(vec->m_y + i), z = VLOAD(vec->m_z + i);
+		XSQB_FN(rotationMatrix)(quat, i, r);
+		VSTORE(dest->m_x + i, VMADD(r[2], z, VMADD(r[1], y, VMUL(r[0], x))));
+		VSTORE(dest->m_y + i, VMADD(r[5], z, VMADD(r[4], y, VMUL(r[3], x))));
+		VSTORE(dest->m_z + i, VMADD(r[8], z, VMADD(r[7], y, VMUL(r[6], x))));
+	}
+	return n;
+}
+
+static XsSize XSQB_FN(toRotationMatrix)(const XsQuaternionSoA* quat, XsMatrix3x3SoA* dest, XsSize count)
+{
+	XsSize i, n = count - count % XSQB_WIDTH;
+	int k;
+	for (i = 0; i < n; i += XSQB_WIDTH)
+	{
+		XSQB_VEC r[9];
+		XSQB_FN(rotationMatrix)(quat, i, r);
+		for (k = 0; k < 9; ++k)
+			VSTORE(dest->m_data[k] + i, r[k]);
+	}
+	return n;
+}
+
+static XsSize XSQB_FN(fromRotationMatrix)(const XsMatrix3x3SoA* ori, XsQuaternionSoA* dest, XsSize count)
+{
+	XsSize i, n = count - count % XSQB_WIDTH;
+	for (i = 0; i < n; i += XSQB_WIDTH)
+	{
+		XSQB_VEC m00 = VLOAD(ori->m_data[0] + i), m11 = VLOAD(ori->m_data[4] + i), m22 = VLOAD(ori->m_data[8] + i);
+		XSQB_VEC trace = VADD(VADD(VADD(m00, m11), m22), VSET(1.0));
+		XSQB_VEC s, w;
+
+		if (VMASKBITS(VLT(VMUL(trace, trace), VSET(XsMath_tinyValue))))
+		{
+			int lane;
+			for (lane = 0; lane < XSQB_WIDTH; ++lane)
+				fromRotationMatrixLane(ori, dest, i + lane);
+			continue;
+		}
+
+		s = VMUL(VSET(2.0), VSQRT(trace));
+		w = VMUL(VSET(0.25), s);
+		s = VDIV(VSET(1.0), s);
+
+		// the conjugate of the quaternion, as computed by XsQuaternion_fromRotationMatrix
+		VSTORE(dest->m_w + i, w);
+		VSTORE(dest->m_x + i, VMUL(VSUB(VLOAD(ori->m_data[7] + i), VLOAD(ori->m_data[5] + i)), s));
+		VSTORE(dest->m_y + i, VMUL(VSUB(VLOAD(ori->m_data[2] + i), VLOAD(ori->m_data[6] + i)), s));
+		VSTORE(dest->m_z + i, VMUL(VSUB(VLOAD(ori->m_data[3] + i), VLOAD(ori->m_data[1] + i)), s));
+	}
+	return n;
+}
+
+static XsSize XSQB_FN(toEulerAngles)(const XsQuaternionSoA* quat, XsVector3SoA* dest, XsSize count)
+{
+	const XSQB_VEC two = VSET(2.0), one = VSET(1.0), rad2deg = VSET(XsMath_rad2degValue);
+	XsSize i, n = count - count % XSQB_WIDTH;
+	for (i = 0; i < n; i += XSQB_WIDTH)
+	{
+		XSQB_VEC w = VLOAD(quat->m_w + i), x = VLOAD(quat->m_x + i), y = VLOAD(quat->m_y + i), z = VLOAD(quat->m_z + i);
+		XSQB_VEC sqw = VMUL(w, w);
+		XSQB_VEC dphi = VMSUB(two, VMADD(z, z, sqw), one);
+		XSQB_VEC dpsi = VMSUB(two, VMADD(x, x, sqw), one);
+		XSQB_VEC sinPitch = VMUL(two, VMSUB(x, z, VMUL(w, y)));
+		XSQB_VEC cosPitch;
+
+		// an empty quaternion produces zero angles
+		if (VMASKBITS(VAND(VAND(VEQ(w, VZERO()), VEQ(x, VZERO())), VAND(VEQ(y, VZERO()), VEQ(z, VZERO())))))
+		{
+			int lane;
+			for (lane = 0; lane < XSQB_WIDTH; ++lane)
+				toEulerAnglesLane(quat, dest, i + lane);
+			continue;
+		}
+
+		// asin(s) = atan2(s, sqrt(1 - s^2)), clamped like XsMath_asinClamped
+		sinPitch = VMAX(VSET(-1.0), VMIN(one, sinPitch));
+		cosPitch = VSQRT(VMUL(VSUB(one, sinPitch), VADD(one, sinPitch)));
+
+		VSTORE(dest->m_x + i, VMUL(rad2deg, XSQB_FN(atan2)(VMUL(two, VMADD(y, z, VMUL(w, x))), dphi)));
+		VSTORE(dest->m_y + i, VMUL(VSET(-XsMath_rad2degValue), XSQB_FN(atan2)(sinPitch, cosPitch)));
+		VSTORE(dest->m_z + i, VMUL(rad2deg, XSQB_FN(atan2)(VMUL(two, VMADD(x, y, VMUL(w, z))), dpsi)));
+	}
+	return n;
+}
+
+static XsSize XSQB_FN(slerp)(const XsQuaternionSoA* from, const XsQuaternionSoA* to, const XsReal* t, XsQuaternionSoA* dest, XsSize count)
+{
+	const XSQB_VEC signMask = VSET(-0.0), one = VSET(1.0);
+	XsSize i, n = count - count % XSQB_WIDTH;
+	for (i = 0; i < n; i += XSQB_WIDTH)
+	{
+		XSQB_VEC aw = VLOAD(from->m_w + i), ax = VLOAD(from->m_x + i), ay = VLOAD(from->m_y + i), az = VLOAD(from->m_z + i);
+		XSQB_VEC bw = VLOAD(to->m_w + i), bx = VLOAD(to->m_x + i), by = VLOAD(to->m_y + i), bz = VLOAD(to->m_z + i);
+		XSQB_VEC tt = VLOAD(t + i);
+		XSQB_VEC dot = VMADD(az, bz, VMADD(ay, by, VMADD(ax, bx, VMUL(aw, bw))));
+		XSQB_VEC flip = VAND(VLT(dot, VZERO()), signMask);
+		XSQB_VEC linear, sinTheta, theta, wa, wb, length, rw, rx, ry, rz;
+
+		// the sine approximation only covers 0 <= t <= 1
+		if (VMASKBITS(VOR(VLT(tt, VZERO()), VGT(tt, one))))
+		{
+			int lane;
+			for (lane = 0; lane < XSQB_WIDTH; ++lane)
+				slerpLane(from, to, t, dest, i + lane);
+			continue;
+		}
+
+		// take the shortest path
+		dot = VXOR(dot, flip);
+		bw = VXOR(bw, flip);
+		bx = VXOR(bx, flip);
+		by = VXOR(by, flip);
+		bz = VXOR(bz, flip);
+
+		linear = VGT(dot, VSET(1.0 - slerpLinearLimit));
+		sinTheta = VSQRT(VMUL(VSUB(one, VMIN(dot, one)), VADD(one, dot)));
+		theta = XSQB_FN(atan2)(sinTheta, dot);
+		sinTheta = VSELECT(linear, one, sinTheta);
+		wa = VSELECT(linear, VSUB(one, tt), VDIV(XSQB_FN(sinQuadrant)(VMUL(VSUB(one, tt), theta)), sinTheta));
+		wb = VSELECT(linear, tt, VDIV(XSQB_FN(sinQuadrant)(VMUL(tt, theta)), sinTheta));
+
+		rw = VMADD(wb, bw, VMUL(wa, aw));
+		rx = VMADD(wb, bx, VMUL(wa, ax));
+		ry = VMADD(wb, by, VMUL(wa, ay));
+		rz = VMADD(wb, bz, VMUL(wa, az));
+		length = VSQRT(VMADD(rz, rz, VMADD(ry, ry, VMADD(rx, rx, VMUL(rw, rw)))));
+		length = VSELECT(linear, VDIV(one, length), one);
+
+		VSTORE(dest->m_w + i, VMUL(rw, length));
+		VSTORE(dest->m_x + i, VMUL(rx, length));
+		VSTORE(dest->m_y + i, VMUL(ry, length));
+		VSTORE(dest->m_z + i, VMUL(rz, length));
+	}
+	return n;
+}
@@ -380,6 +380,31 @@ int64_t XsTime_timeStampNow(XsTimeStamp* now)
 	return now->m_msTime;
 }
 
+/*! \brief Returns a monotonic timestamp in microseconds
+	\details The timestamp has an arbitrary origin and is not affected by changes to the system time, so it is
+	only useful for measuring durations.
+	\returns The current value of the monotonic clock in microseconds
+*/
+int64_t XsTime_monotonicUs(void)
+{
+#ifdef _WIN32
+	static int64_t perfCountFreq = 0;
+	LARGE_INTEGER pc;
+	if (!perfCountFreq)
+	{
+		LARGE_INTEGER tmp;
+		QueryPerformanceFrequency(&tmp);
+		perfCountFreq = tmp.QuadPart;
+	}
+	QueryPerformanceCounter(&pc);
+	return (int64_t)((pc.QuadPart / perfCountFreq) * 1000000 + ((pc.QuadPart % perfCountFreq) * 1000000) / perfCountFreq);
+#else
+	struct timespec tp;
+	clock_gettime(CLOCK_MONOTONIC, &tp);
+	return ((int64_t) tp.tv_sec) * 1000000 + tp.tv_nsec / 1000;
+#endif
+}
+
 /*! \cond XS_INTERNAL */
 int64_t XsTime_utcToLocalValue = 0;	//!< Internal storage for UTC to local time correction (ms)
 int64_t XsTime_localToUtcValue = 0;	//!< Internal storage for local time to UTC correction (ms)
@@ -60,6 +60,7 @@ XSTYPES_DLL_API void XsTime_getTimeAsWString(wchar_t* dest, struct tm const* tim
 XSTYPES_DLL_API void XsTime_msleep(uint32_t ms);
 XSTYPES_DLL_API void XsTime_udelay(uint64_t us);
 XSTYPES_DLL_API int64_t XsTime_timeStampNow(XsTimeStamp* now);
+XSTYPES_DLL_API int64_t XsTime_monotonicUs(void);
 XSTYPES_DLL_API void XsTime_initializeTime(void);
 XSTYPES_DLL_API int64_t XsTime_utcToLocal();
 XSTYPES_DLL_API int64_t XsTime_localToUtc();
@@ -156,6 +157,12 @@ inline int64_t timeStampNow(XsTimeStamp* now = 0)
 {
 	return XsTime_timeStampNow(now);
 }
+
+//! \copydoc XsTime_monotonicUs
+inline int64_t monotonicUs()
+{
+	return XsTime_monotonicUs();
+}
 }
 #endif
 